@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+
+# Run ParsEval, LocusPocus, and CanonGFF3 on synthetic annotations of
+# increasing size, and record the wall time, peak memory, and throughput of each
+# run as tab-separated values. Settings can be overridden with environment
+# variables, for example:
+#
+#   BENCH_TIERS="small:1:1000000 large:20:10000000" make bench
+#
+# Each tier is NAME:NUMSEQS:SEQLEN; the generator's seed and gene density are
+# set with BENCH_SEED and BENCH_DENSITY. Results are appended to BENCH_OUT, so
+# that successive runs can be compared; runs that fail are reported and not
+# recorded.
+tiers=${BENCH_TIERS:-"small:1:1000000 medium:5:4000000 large:20:10000000"}
+seed=${BENCH_SEED:-42}
+density=${BENCH_DENSITY:-100}
+outfile=${BENCH_OUT:-bench.tsv}
+workdir=${BENCH_DIR:-bench.tmp}
+
+# GNU time reports peak memory; otherwise only wall time is recorded
+if /usr/bin/time -f '%e %M' -o /dev/null true > /dev/null 2>&1; then
+  timer="gnu"
+else
+  timer="bash"
+  echo "[bench] warning: GNU time not found, peak memory will not be recorded" >&2
+fi
+
+# Usage: measure LOGFILE COMMAND...
+# Prints the wall time in seconds, the peak resident set size in KB, and the
+# command's exit status.
+measure()
+{
+  local log=$1
+  shift
+  local status
+  if [ $timer == "gnu" ]; then
+    /usr/bin/time -f '%e %M' -o ${workdir}/time.txt "$@" > ${log} 2>&1
+    status=$?
+    echo "$(tail -n 1 ${workdir}/time.txt) ${status}"
+  else
+    local TIMEFORMAT='%R'
+    local seconds
+    seconds=$( { time "$@" > ${log} 2>&1 ; } 2>&1 )
+    status=$?
+    echo "${seconds} NA ${status}"
+  fi
+}
+
+mkdir -p ${workdir}
+failed=0
+version=$(git describe --always --dirty 2> /dev/null || echo "NA")
+if [ ! -s ${outfile} ]; then
+  printf "version\ttier\ttool\tseqs\tseqlen\tgenes\tloci\tseconds\tmaxrss_kb\tloci_per_sec\n" > ${outfile}
+fi
+echo "AEGeAn Benchmarks (${version})"
+for tier in ${tiers}
+do
+  IFS=: read name numseqs seqlen <<< "${tier}"
+  refr=${workdir}/${name}.refr.gff3
+  pred=${workdir}/${name}.pred.gff3
+  perl data/scripts/synthetic-gff3.pl --seed=${seed} --density=${density} \
+       --numseqs=${numseqs} --seqlen=${seqlen} --refr=${refr} --pred=${pred}
+  genes=$(grep -c $'\tgene\t' ${refr})
+
+  # Loci are counted once, from LocusPocus output, and used as the unit of
+  # throughput for every tool
+  runs=(
+    "locuspocus:bin/locuspocus --outfile=${workdir}/${name}.loci.gff3 ${refr} ${pred}"
+    "parseval:bin/parseval --summary --overwrite --outfile=${workdir}/${name}.pe.txt ${refr} ${pred}"
+    "canon-gff3:bin/canon-gff3 --outfile=${workdir}/${name}.canon.gff3 ${refr}"
+  )
+  loci=""
+  for run in "${runs[@]}"
+  do
+    tool=${run%%:*}
+    read seconds maxrss status <<< "$(measure ${workdir}/${name}.${tool}.log ${run#*:})"
+    if [ "${status}" != "0" ]; then
+      echo "[bench] error: ${name} ${tool} exited with status ${status}, see" \
+           "${workdir}/${name}.${tool}.log" >&2
+      failed=1
+      continue
+    fi
+    if [ -z "${loci}" ]; then
+      loci="NA"
+      if [ -f ${workdir}/${name}.loci.gff3 ]; then
+        loci=$(grep -c $'\tlocus\t' ${workdir}/${name}.loci.gff3)
+      fi
+    fi
+    rate=$(awk -v l=${loci} -v s=${seconds} 'BEGIN { printf(l == "NA" ? "NA" : "%.1f", s > 0 ? l / s : 0) }')
+    printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\n" ${version} ${name} ${tool} \
+           ${numseqs} ${seqlen} ${genes} ${loci} ${seconds} ${maxrss} ${rate} >> ${outfile}
+    printf "        | %-36s | %8ss %10sKB %10s loci/s\n" "${name} ${tool}" ${seconds} ${maxrss} ${rate}
+  done
+done
+echo "Results written to ${outfile}"
+if [ ${failed} -ne 0 ]; then
+  # Keep logs of the failed runs
+  exit 1
+fi
+rm -r ${workdir}
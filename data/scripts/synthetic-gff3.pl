@@ -0,0 +1,300 @@
+#!/usr/bin/env perl
+use strict;
+use Getopt::Long;
+
+sub print_usage
+{
+  my $OUT = shift(@_);
+  my $scriptname = `basename $0`;
+  chomp($scriptname);
+  print $OUT "\n$scriptname: generate synthetic reference and prediction annotations
+Gene models are placed at random along each sequence, with alternatively spliced
+isoforms and occasional overlapping genes on the opposite strand. The prediction
+is a copy of the reference in which some gene models are perturbed: exon
+boundaries are shifted, isoforms or whole genes are missing, and spurious genes
+are added. Output is the same for the same seed and settings.
+
+Usage: perl $0 [options] --refr=FILE --pred=FILE
+  Options:
+    -d|--density: REAL      average number of genes per megabase; default is 100
+    -e|--exons: INT         average number of exons per transcript; default is 5
+    -h|--help               print this help message and exit
+    -i|--isoforms: INT      maximum number of isoforms per gene; default is 3
+    -n|--numseqs: INT       number of sequences; default is 1
+    -o|--overlap: REAL      probability that a gene overlaps the previous gene,
+                            on the opposite strand; default is 0.05
+    -p|--perturb: REAL      probability that a gene model is perturbed in the
+                            prediction; default is 0.2
+    --pred: FILE            file to which the prediction will be written
+    --refr: FILE            file to which the reference will be written
+    -s|--seed: INT          seed for the random number generator; default is 42
+    -l|--seqlen: INT        length of each sequence; default is 1000000
+
+";
+}
+
+# Linear congruential generator, so that output does not depend on the
+# platform's rand() implementation
+my $state;
+sub rng_seed { $state = shift(@_) % 2147483647; $state = 1 if($state <= 0); }
+sub rng_real
+{
+  $state = ($state * 48271) % 2147483647;
+  return $state / 2147483647;
+}
+sub rng_int
+{
+  my($min, $max) = @_;
+  return $min + int(rng_real() * ($max - $min + 1));
+}
+sub rng_exp
+{
+  my $mean = shift(@_);
+  return -$mean * log(1.0 - rng_real());
+}
+
+# A gene model is a hash with the strand, the start of the gene, and a list of
+# transcripts; each transcript is a list of [start, end] exons and the lengths
+# of its 5' and 3' UTRs
+sub new_gene
+{
+  my($start, $strand, $numexons, $maxisoforms) = @_;
+  my @exons;
+  my $pos = $start;
+  for(my $i = 0; $i < $numexons; $i++)
+  {
+    $pos += rng_int(60, 1500) if($i > 0);
+    my $length = rng_int(50, 400);
+    push(@exons, [$pos, $pos + $length - 1]);
+    $pos += $length;
+  }
+
+  my @transcripts;
+  my %seen;
+  my $numisoforms = rng_int(1, $maxisoforms);
+  for(my $i = 0; $i < $numisoforms * 2 && @transcripts < $numisoforms; $i++)
+  {
+    # The first isoform includes every exon; others skip some internal exons
+    my @keep = ($exons[0]);
+    for(my $j = 1; $j < $numexons - 1; $j++)
+    {
+      push(@keep, $exons[$j]) if($i == 0 || rng_real() > 0.3);
+    }
+    push(@keep, $exons[$#exons]) if($numexons > 1);
+    my $key = join(",", map { $_->[0] } @keep);
+    next if($seen{$key});
+    $seen{$key} = 1;
+    push(@transcripts, { exons => \@keep, utr5 => rng_int(0, 40),
+                         utr3 => rng_int(0, 40) });
+  }
+  return { strand => $strand, transcripts => \@transcripts };
+}
+
+sub perturb_gene
+{
+  my($gene) = @_;
+  my @transcripts;
+  foreach my $trans(@{$gene->{transcripts}})
+  {
+    next if(@transcripts > 0 && rng_real() < 0.3);
+    my @exons = map { [@$_] } @{$trans->{exons}};
+    my $index = rng_int(0, $#exons);
+    my $shift = rng_int(-30, 30);
+    my $exon = $exons[$index];
+    if(rng_real() < 0.5)
+    {
+      my $min = $index > 0 ? $exons[$index-1]->[1] + 20 : 1;
+      $exon->[0] += $shift if($exon->[0] + $shift >= $min &&
+                              $exon->[0] + $shift < $exon->[1] - 20);
+    }
+    else
+    {
+      my $max = $index < $#exons ? $exons[$index+1]->[0] - 20 : -1;
+      $exon->[1] += $shift if(($max < 0 || $exon->[1] + $shift <= $max) &&
+                              $exon->[1] + $shift > $exon->[0] + 20);
+    }
+    push(@transcripts, { exons => \@exons, utr5 => rng_int(0, 40),
+                         utr3 => rng_int(0, 40) });
+  }
+  return { strand => $gene->{strand}, transcripts => \@transcripts };
+}
+
+sub gene_range
+{
+  my $gene = shift(@_);
+  my($start, $end);
+  foreach my $trans(@{$gene->{transcripts}})
+  {
+    my $exons = $trans->{exons};
+    $start = $exons->[0]->[0] if(!defined($start) || $exons->[0]->[0] < $start);
+    $end = $exons->[-1]->[1] if(!defined($end) || $exons->[-1]->[1] > $end);
+  }
+  return ($start, $end);
+}
+
+sub print_gene
+{
+  my($OUT, $seqid, $gene, $geneid) = @_;
+  my($gstart, $gend) = gene_range($gene);
+  my $strand = $gene->{strand};
+  print $OUT join("\t", $seqid, "synthetic", "gene", $gstart, $gend, ".",
+                  $strand, ".", "ID=$geneid"), "\n";
+
+  my $t = 0;
+  foreach my $trans(@{$gene->{transcripts}})
+  {
+    $t++;
+    my $mrnaid = "$geneid.$t";
+    my @exons = @{$trans->{exons}};
+    print $OUT join("\t", $seqid, "synthetic", "mRNA", $exons[0]->[0],
+                    $exons[-1]->[1], ".", $strand, ".",
+                    "ID=$mrnaid;Parent=$geneid"), "\n";
+    foreach my $exon(@exons)
+    {
+      print $OUT join("\t", $seqid, "synthetic", "exon", @$exon, ".", $strand,
+                      ".", "Parent=$mrnaid"), "\n";
+    }
+
+    # Trim the UTRs from the exons, in the direction of transcription, and
+    # assign phases to the remaining CDS segments
+    my @cds = map { [@$_] } @exons;
+    @cds = reverse(@cds) if($strand eq "-");
+    my($utr5, $utr3) = ($trans->{utr5}, $trans->{utr3});
+    my $length = 0;
+    $length += $_->[1] - $_->[0] + 1 foreach(@cds);
+    ($utr5, $utr3) = (0, 0) if($length - $utr5 - $utr3 < 30);
+    my $first = $strand eq "+" ? 0 : 1;
+    while($utr5 > 0 && @cds > 1 &&
+          $cds[0]->[1] - $cds[0]->[0] + 1 <= $utr5)
+    {
+      $utr5 -= $cds[0]->[1] - $cds[0]->[0] + 1;
+      shift(@cds);
+    }
+    $cds[0]->[$first] += $strand eq "+" ? $utr5 : -$utr5;
+    while($utr3 > 0 && @cds > 1 &&
+          $cds[-1]->[1] - $cds[-1]->[0] + 1 <= $utr3)
+    {
+      $utr3 -= $cds[-1]->[1] - $cds[-1]->[0] + 1;
+      pop(@cds);
+    }
+    $cds[-1]->[1 - $first] -= $strand eq "+" ? $utr3 : -$utr3;
+
+    my $cdslength = 0;
+    my @phases;
+    foreach my $segment(@cds)
+    {
+      push(@phases, (3 - ($cdslength % 3)) % 3);
+      $cdslength += $segment->[1] - $segment->[0] + 1;
+    }
+    if($strand eq "-")
+    {
+      @cds = reverse(@cds);
+      @phases = reverse(@phases);
+    }
+    for(my $i = 0; $i < @cds; $i++)
+    {
+      print $OUT join("\t", $seqid, "synthetic", "CDS", @{$cds[$i]}, ".",
+                      $strand, $phases[$i], "ID=$mrnaid.cds;Parent=$mrnaid"),
+                 "\n";
+    }
+  }
+  print $OUT "###\n";
+}
+
+my $density = 100;
+my $exons = 5;
+my $isoforms = 3;
+my $numseqs = 1;
+my $overlap = 0.05;
+my $perturb = 0.2;
+my $predfile = "";
+my $refrfile = "";
+my $seed = 42;
+my $seqlen = 1000000;
+GetOptions
+(
+  "d|density=f"  => \$density,
+  "e|exons=i"    => \$exons,
+  "h|help"       => sub { print_usage(\*STDOUT); exit(0); },
+  "i|isoforms=i" => \$isoforms,
+  "n|numseqs=i"  => \$numseqs,
+  "o|overlap=f"  => \$overlap,
+  "p|perturb=f"  => \$perturb,
+  "pred=s"       => \$predfile,
+  "refr=s"       => \$refrfile,
+  "s|seed=i"     => \$seed,
+  "l|seqlen=i"   => \$seqlen,
+);
+if($refrfile eq "" || $predfile eq "" || $density <= 0 || $exons < 1 ||
+   $isoforms < 1)
+{
+  print_usage(\*STDERR);
+  exit(1);
+}
+
+open(my $REFR, ">", $refrfile) or die("error opening '$refrfile': $!");
+open(my $PRED, ">", $predfile) or die("error opening '$predfile': $!");
+print $REFR "##gff-version   3\n";
+print $PRED "##gff-version   3\n";
+for(my $s = 1; $s <= $numseqs; $s++)
+{
+  printf $REFR "##sequence-region   seq%d 1 %d\n", $s, $seqlen;
+  printf $PRED "##sequence-region   seq%d 1 %d\n", $s, $seqlen;
+}
+
+rng_seed($seed);
+# Spacing between gene starts accounts for the average gene length, so that
+# the density is close to the requested number of genes per megabase
+my $meangap = 1000000 / $density - ($exons * 225 + ($exons - 1) * 780);
+$meangap = 100 if($meangap < 100);
+my($genecount, $predcount) = (0, 0);
+for(my $s = 1; $s <= $numseqs; $s++)
+{
+  my $seqid = "seq$s";
+  my(@refr, @pred);
+  my $pos = 1 + int(rng_exp($meangap));
+  my($prevstart, $prevend, $prevstrand) = (0, 0, "+");
+  while(1)
+  {
+    my $numexons = rng_int(1, 2 * $exons - 1);
+    my $strand = rng_real() < 0.5 ? "+" : "-";
+    my $start = $pos;
+    if($prevend > 0 && rng_real() < $overlap)
+    {
+      $start = rng_int($prevstart, $prevend);
+      $strand = $prevstrand eq "+" ? "-" : "+";
+    }
+    my $gene = new_gene($start, $strand, $numexons, $isoforms);
+    my($gstart, $gend) = gene_range($gene);
+    last if($gend > $seqlen);
+
+    push(@refr, $gene);
+    if(rng_real() < $perturb)
+    {
+      my $r = rng_real();
+      push(@pred, perturb_gene($gene)) if($r >= 0.1);
+      push(@pred, new_gene(rng_int($gstart, $gend), $strand eq "+" ? "-" : "+",
+                           $numexons, 1)) if($r < 0.2);
+    }
+    else
+    {
+      push(@pred, $gene);
+    }
+    ($prevstart, $prevend, $prevstrand) = ($gstart, $gend, $strand);
+    $pos = ($gend > $pos ? $gend : $pos) + 1 + int(rng_exp($meangap));
+  }
+
+  foreach my $list(\@refr, \@pred)
+  {
+    @$list = map  { $_->[1] }
+             sort { $a->[0] <=> $b->[0] }
+             map  { [(gene_range($_))[0], $_] }
+             grep { (gene_range($_))[1] <= $seqlen } @$list;
+  }
+  print_gene($REFR, $seqid, $_, sprintf("gene%06d", ++$genecount))
+    foreach(@refr);
+  print_gene($PRED, $seqid, $_, sprintf("pred%06d", ++$predcount))
+    foreach(@pred);
+}
+close($REFR);
+close($PRED);
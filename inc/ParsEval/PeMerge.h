@@ -0,0 +1,65 @@
+#ifndef PE_MERGE
+#define PE_MERGE
+
+/**
+ * @module PeMerge
+ * Module for writing the partial results of a ParsEval run over a subset of
+ * the annotated sequences (see the ``--shard`` option), and for reading and
+ * combining partial results so that the summary of a single run over all
+ * sequences can be printed.
+ */ //;
+
+#include "genometools.h"
+#include "AgnComparEval.h"
+#include "PeOptions.h"
+
+#define PE_PARTIAL_MAGIC "PEPART02"
+
+/**
+ * @type Partial results of a ParsEval run: the input files and labels, the
+ * settings that affect which loci are analyzed and how (locus filters and
+ * limits), the shard analyzed, the sequences it contained, and the aggregated
+ * comparison statistics over those sequences.
+ */
+struct PePartial
+{
+  GtStr *refrfile;
+  GtStr *predfile;
+  GtStr *refrlabel;
+  GtStr *predlabel;
+  GtStr *settings;
+  GtUword shard;
+  GtUword numshards;
+  GtStrArray *seqids;
+  AgnCompEvaluation eval;
+};
+typedef struct PePartial PePartial;
+
+/**
+ * @function Combine the given array of partial results (``PePartial *``),
+ * checking that they come from the same inputs and settings, that no sequence
+ * was analyzed twice, and that no shard is missing. Sequence IDs are sorted
+ * as in a single run. Returns NULL and sets ``error`` if the partial results
+ * are not compatible.
+ */
+PePartial *pe_partial_merge(GtArray *partials, GtError *error);
+
+/**
+ * @function Class destructor.
+ */
+void pe_partial_delete(PePartial *partial);
+
+/**
+ * @function Read partial results from the given file, or return NULL and set
+ * ``error`` if the file cannot be read or was not written by ParsEval.
+ */
+PePartial *pe_partial_read(const char *filename, GtError *error);
+
+/**
+ * @function Write the partial results of the current run, covering the given
+ * sequences, to ``outstream``. Returns 0 on success, -1 on error.
+ */
+int pe_partial_write(FILE *outstream, PeOptions *options, GtStrArray *seqids,
+                     AgnCompEvaluation *eval, GtError *error);
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "genometools.h"
 #include "AgnComparEval.h"
+#include "AgnGeneLocus.h"
 
 /**
  * @type This struct defines ParsEval's command-line options.
@@ -20,12 +21,14 @@ struct PeOptions
   char *outfilename;
   bool verbose;
   bool gff3;
-  int complimit;
+  AgnLocusBudget budget;
   bool summary_only;
   bool vectors;
   bool locus_graphics;
   const char *refrfile;
   const char *predfile;
+  const char **predfiles;
+  int numpreds;
   const char *refrlabel;
   const char *predlabel;
   const char *outfmt;
@@ -36,6 +39,13 @@ struct PeOptions
   const char *filterfile;
   AgnCompareFilters filters;
   int trans_per_locus;
+  bool fast;
+  GtUword shard;
+  GtUword numshards;
+  const char *seqidsfile;
+  GtUword procs;
+  const char *profilefile;
+  FILE *profile;
 };
 typedef struct PeOptions PeOptions;
 
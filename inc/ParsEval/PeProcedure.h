@@ -24,6 +24,8 @@ struct PeAnalysisData
   GtHashmap *locus_summaries;
   PeOptions *options;
   FILE *seqfile;
+  double locus_cost;
+  double locus_start;
 };
 typedef struct PeAnalysisData PeAnalysisData;
 
@@ -46,12 +48,37 @@ void pe_comparative_analysis(AgnLocusIndex *locusindex, GtHashmap **comp_evalsp,
                              PeOptions *options);
 
 /**
- * @function Load gene annotations into memory and identify gene loci.
+ * @function Load gene annotations into memory and identify gene loci. Only
+ * the sequences selected with ``--shard`` or ``--seqids`` are returned in
+ * ``seqidsp``, an array that belongs to the caller; the loci of all other
+ * sequences are discarded. Returns the number of loci to be analyzed.
  */
 GtUword pe_load_and_parse_loci(AgnLocusIndex **locusindexp, GtArray **locip,
                                GtStrArray **seqidsp, PeOptions *options,
                                AgnLogger *logger);
 
+/**
+ * @function Compare the reference against each of the predictions given on
+ * the command line. The reference is loaded only once, and each prediction is
+ * loaded, parsed into loci with the reference, and analyzed in turn. Returns
+ * an array with the overall :c:type:`AgnCompEvaluation` of each prediction, in
+ * the order given, or NULL if any input could not be loaded.
+ */
+GtArray *pe_multi_comparative_analysis(PeOptions *options, AgnLogger *logger);
+
+/**
+ * @function Perform comparative analysis of each locus and aggregate the
+ * results, as :c:func:`pe_comparative_analysis` and
+ * :c:func:`pe_aggregate_results` do, with each sequence analyzed in one of
+ * ``options->procs`` worker processes. Reports for each locus are written by
+ * the workers, and sequence-level statistics are collected through shared
+ * memory, so the output is the same as that of a serial run.
+ */
+void pe_parallel_analysis(AgnLocusIndex *locusindex,
+                          AgnCompEvaluation *overall_eval,
+                          GtArray **seqlevel_evalsp, GtStrArray *seqids,
+                          GtArray *seqfiles, GtArray *loci, PeOptions *options);
+
 /**
  * @function Collect information from the given locus following comparative
  * analysis.
@@ -13,6 +13,8 @@
 #include "PeOptions.h"
 
 #define PE_GENE_LOCUS_GRAPHIC_MIN_WIDTH 650
+#define PE_MULTI_CELL_LENGTH 32
+#define PE_PROFILE_TOP_LOCI 10
 
 /**
  * @function Get the filename for printing this locus' results.
@@ -33,6 +35,13 @@ GtUword pe_gene_locus_get_graphic_width(AgnGeneLocus *locus);
 void pe_gene_locus_get_png_filename(AgnGeneLocus *locus, char *buffer,
                                     const char *dirpath);
 
+/**
+ * @function Create the per-locus profile file (see ``--profile``) and write
+ * its header. The file is returned open for appending and line buffered, so
+ * that worker processes can share it.
+ */
+FILE *pe_profile_open(const char *filename);
+
 /**
  * @function Generate a string containing the current time. User is responsible
  * to free the string.
@@ -86,6 +95,21 @@ void pe_print_seqfile_header(FILE *outstream, const char *seqid);
  */
 void pe_print_seqfile_footer(FILE *outstream);
 
+/**
+ * @function Write one line of the per-locus profile: the locus' coordinates,
+ * size, and :c:type:`AgnLocusProfile`, followed by the time spent reporting
+ * results and the total time spent on the locus.
+ */
+void pe_print_locus_profile(AgnGeneLocus *locus, double report_seconds,
+                            double total_seconds, FILE *outstream);
+
+/**
+ * @function Read back a per-locus profile and print the ``numloci`` loci on
+ * which the most time was spent.
+ */
+void pe_print_profile_summary(const char *filename, GtUword numloci,
+                              FILE *outstream);
+
 /**
  * @function Print the ParsEval summary. FIXME this could use refactoring
  */
@@ -99,6 +123,15 @@ void pe_print_summary_html(const char *start_time, int argc,
                            GtArray *seq_summary_data, FILE *outstream,
                            PeOptions *options);
 
+/**
+ * @function Print summary statistics for several predictions side by side,
+ * one column per prediction. ``evals`` holds the overall evaluation of each
+ * prediction, in the same order as the prediction files.
+ */
+void pe_print_summary_multi(const char *start_time, int argc,
+                            char * const argv[], GtArray *evals,
+                            FILE *outstream, PeOptions *options);
+
 /**
  * @function ParsEval uses sequence IDs to create temporary and permanent output
  * files. Sequence IDs that contain characters that are not supported for POSIX
@@ -0,0 +1,145 @@
+#ifndef AEGEAN_BGZF
+#define AEGEAN_BGZF
+
+/**
+ * @module AgnBgzf
+ * Functions for reading and writing gzip-compressed data. Output is written in
+ * the blocked gzip format (BGZF) used by samtools and tabix: a series of gzip
+ * members, each holding at most 64 kB of uncompressed data, which can be
+ * compressed and decompressed independently. BGZF files are valid gzip files,
+ * so they can be read with ``zcat`` or ``gunzip`` as usual.
+ */ //;
+
+#include <stdio.h>
+#include "genometools.h"
+#include "AgnUnitTest.h"
+
+/**
+ * @type Reads lines from a BGZF file, starting at any virtual offset. As in
+ * samtools and tabix, a virtual offset is the offset of a block in the
+ * compressed file shifted left by 16 bits, combined with an offset into the
+ * block's uncompressed data.
+ */
+typedef struct AgnBgzfReader AgnBgzfReader;
+
+/**
+ * @type Writes BGZF-compressed data to a file. Data written to the stream
+ * returned by :c:func:`agn_bgzf_writer_stream` is compressed by a background
+ * thread, which hands blocks to a pool of worker threads so that compression
+ * proceeds in parallel with the code producing the data.
+ */
+typedef struct AgnBgzfWriter AgnBgzfWriter;
+
+/**
+ * @functype Function called with each line of data passed through a
+ * :c:type:`AgnBgzfWriter`, along with its offset in the uncompressed data. The
+ * line does not include its terminating newline. Lines are passed in order
+ * from the writer's background thread.
+ */
+typedef void (*AgnBgzfLineFunc)(const char *line, GtUword length,
+                                GtUword offset, void *data);
+
+/**
+ * @function Returns true if the given file name ends in ``.gz`` or ``.bgz``.
+ */
+bool agn_bgzf_has_extension(const char *filename);
+
+/**
+ * @function Decompress ``length`` bytes of gzip-compressed ``data`` into a
+ * newly allocated buffer, storing its size in ``outlength``. BGZF data is
+ * decompressed in parallel using ``numthreads`` threads (or one per processor
+ * if ``numthreads`` is 0); other gzip data is decompressed serially. Returns
+ * NULL and sets ``error`` if the data is not valid gzip data. The caller is
+ * responsible for freeing the buffer with ``gt_free``.
+ */
+char *agn_bgzf_inflate(const char *data, GtUword length, GtUword numthreads,
+                       GtUword *outlength, GtError *error);
+
+/**
+ * @function Returns true if ``data`` begins with the gzip magic number.
+ */
+bool agn_bgzf_is_gzip(const char *data, GtUword length);
+
+/**
+ * @function Class destructor.
+ */
+void agn_bgzf_reader_delete(AgnBgzfReader *reader);
+
+/**
+ * @function Read the next line (without its newline) into ``line``. Returns 1
+ * if a line was read, 0 at the end of the file, or -1 on error (``error`` is
+ * set).
+ */
+int agn_bgzf_reader_getline(AgnBgzfReader *reader, GtStr *line,
+                            GtError *error);
+
+/**
+ * @function Class constructor. Returns NULL and sets ``error`` if the file
+ * cannot be opened.
+ */
+AgnBgzfReader *agn_bgzf_reader_new(const char *filename, GtError *error);
+
+/**
+ * @function Move the reader to the given virtual offset. Returns 0 on success,
+ * or -1 on error (``error`` is set).
+ */
+int agn_bgzf_reader_seek(AgnBgzfReader *reader, GtUword voffset,
+                         GtError *error);
+
+/**
+ * @function Returns the virtual offset of the reader's current position.
+ */
+GtUword agn_bgzf_reader_tell(AgnBgzfReader *reader);
+
+/**
+ * @function Run unit tests for this module. Returns true if all tests passed.
+ */
+bool agn_bgzf_unit_test(AgnUnitTest *test);
+
+/**
+ * @function Class destructor. If :c:func:`agn_bgzf_writer_finish` has not been
+ * called, it is called here and any error is ignored.
+ */
+void agn_bgzf_writer_delete(AgnBgzfWriter *writer);
+
+/**
+ * @function Close the writer's stream, wait for all data written to it to be
+ * compressed, and terminate the file with an empty BGZF block. Returns 0 on
+ * success, or -1 if an error occurred at any point while writing (``error``
+ * is set).
+ */
+int agn_bgzf_writer_finish(AgnBgzfWriter *writer, GtError *error);
+
+/**
+ * @function Class constructor. Creates ``filename`` and starts the background
+ * compression thread, which uses ``numthreads`` workers (or one per processor
+ * if ``numthreads`` is 0). Returns NULL and sets ``error`` if the file cannot
+ * be created.
+ */
+AgnBgzfWriter *agn_bgzf_writer_new(const char *filename, GtUword numthreads,
+                                   GtError *error);
+
+/**
+ * @function Have each line of data written to the writer passed to
+ * ``linefunc``, along with ``linedata``. Must be called before any data is
+ * written.
+ */
+void agn_bgzf_writer_set_line_func(AgnBgzfWriter *writer,
+                                   AgnBgzfLineFunc linefunc, void *linedata);
+
+/**
+ * @function Returns the stream to which uncompressed data should be written.
+ * The stream remains owned by the writer and is closed by
+ * :c:func:`agn_bgzf_writer_finish`.
+ */
+FILE *agn_bgzf_writer_stream(AgnBgzfWriter *writer);
+
+/**
+ * @function Convert an offset in the uncompressed data written to the writer
+ * into a virtual offset in the compressed file. Only valid once
+ * :c:func:`agn_bgzf_writer_finish` has been called.
+ */
+GtUword agn_bgzf_writer_virtual_offset(AgnBgzfWriter *writer,
+                                       GtUword uoffset);
+
+#endif
@@ -19,4 +19,11 @@ typedef struct AgnCanonGeneStream AgnCanonGeneStream;
 GtNodeStream* agn_canon_gene_stream_new(GtNodeStream *in_stream,
                                         AgnLogger *logger);
 
+/**
+ * @function Get a NULL-terminated list of the types of features that this
+ * stream may create when inferring missing gene structure (see
+ * :c:func:`agn_parallel_stream_new`).
+ */
+const char **agn_canon_gene_stream_created_types();
+
 #endif
@@ -34,9 +34,27 @@ enum AgnCliquePairClassification
 };
 typedef enum AgnCliquePairClassification AgnCliquePairClassification;
 
+/**
+ * @type Indicates how much of the comparative analysis of a clique pair could
+ * be skipped by comparing clique fingerprints: ``AGN_CLIQUE_PAIR_NO_SHORTCUT``
+ * (full analysis), ``AGN_CLIQUE_PAIR_CDS_SHORTCUT`` (identical CDS structure,
+ * CDS counts not computed from the model vectors), and
+ * ``AGN_CLIQUE_PAIR_EXACT_SHORTCUT`` (identical structure, no model vectors
+ * needed at all).
+ */
+enum AgnCliquePairShortcut
+{
+  AGN_CLIQUE_PAIR_NO_SHORTCUT,
+  AGN_CLIQUE_PAIR_CDS_SHORTCUT,
+  AGN_CLIQUE_PAIR_EXACT_SHORTCUT
+};
+typedef enum AgnCliquePairShortcut AgnCliquePairShortcut;
+
 /**
  * @function Build a pair of model vectors to represent this pair of maximal
- * transcripts or transcript cliques.
+ * transcripts or transcript cliques. Does nothing if the vectors have already
+ * been built. Comparative analysis and the vector accessors call this function
+ * as needed, so calling it directly is optional.
  */
 void agn_clique_pair_build_model_vectors(AgnCliquePair *pair);
 
@@ -48,7 +66,12 @@ void agn_clique_pair_build_model_vectors(AgnCliquePair *pair);
 AgnCliquePairClassification agn_clique_pair_classify(AgnCliquePair *pair);
 
 /**
- * @function Compare the annotations for this pair, reference vs prediction.
+ * @function Compare the annotations for this pair, reference vs prediction. If
+ * the two cliques have identical fingerprints, the statistics for a perfect
+ * match are computed directly from the clique structure and the model vectors
+ * are never built. If only the CDS fingerprints match, the CDS statistics are
+ * computed directly and the remainder from the model vectors. See
+ * :c:func:`agn_clique_pair_get_shortcut`.
  */
 void agn_clique_pair_comparative_analysis(AgnCliquePair *pair);
 
@@ -105,6 +128,12 @@ AgnTranscriptClique *agn_clique_pair_get_refr_clique(AgnCliquePair *pair);
  */
 const char *agn_clique_pair_get_refr_vector(AgnCliquePair *pair);
 
+/**
+ * @function Indicate which shortcut, if any, was taken during comparative
+ * analysis of this clique pair.
+ */
+AgnCliquePairShortcut agn_clique_pair_get_shortcut(AgnCliquePair *pair);
+
 /**
  * @function Return a pointer to this clique pair's comparison statistics.
  */
@@ -60,7 +60,11 @@ typedef struct AgnCompStatsBinary AgnCompStatsBinary;
 
 /**
  * @type This struct contains various counts to be reported in the summary
- * report.
+ * report. The ``pairs_analyzed``, ``exact_shortcuts``, and ``cds_shortcuts``
+ * counts cover every clique pair analyzed (not just the reported pairs) and
+ * indicate how often clique fingerprints allowed comparison work to be skipped.
+ * ``degraded_loci`` counts the loci that exceeded their analysis budget (see
+ * :c:func:`agn_gene_locus_set_budget`).
  */
 struct AgnCompSummary
 {
@@ -78,6 +82,10 @@ struct AgnCompSummary
   unsigned int num_exon_match;
   unsigned int num_utr_match;
   unsigned int non_match;
+  GtUword      pairs_analyzed;
+  GtUword      exact_shortcuts;
+  GtUword      cds_shortcuts;
+  GtUword      degraded_loci;
 };
 typedef struct AgnCompSummary AgnCompSummary;
 
@@ -146,9 +154,52 @@ struct AgnCompEvaluation
 };
 typedef struct AgnCompEvaluation AgnCompEvaluation;
 
+/**
+ * @type Locus properties that can be tested by filtering criteria, listed in
+ * order of increasing cost to compute. Properties up to and including
+ * ``AGN_LOCUS_PRED_GENES`` are known as soon as a locus has been assembled; the
+ * remaining properties require walking the subfeatures of each gene.
+ */
+enum AgnLocusProperty
+{
+  AGN_LOCUS_LENGTH,
+  AGN_LOCUS_REFR_GENES,
+  AGN_LOCUS_PRED_GENES,
+  AGN_LOCUS_REFR_TRANSCRIPTS,
+  AGN_LOCUS_PRED_TRANSCRIPTS,
+  AGN_LOCUS_REFR_MOST_TRANSCRIPTS_PER_GENE,
+  AGN_LOCUS_REFR_FEWEST_TRANSCRIPTS_PER_GENE,
+  AGN_LOCUS_PRED_MOST_TRANSCRIPTS_PER_GENE,
+  AGN_LOCUS_PRED_FEWEST_TRANSCRIPTS_PER_GENE,
+  AGN_LOCUS_REFR_EXONS,
+  AGN_LOCUS_PRED_EXONS,
+  AGN_LOCUS_REFR_CDS_LENGTH,
+  AGN_LOCUS_PRED_CDS_LENGTH,
+  AGN_LOCUS_NUM_PROPERTIES
+};
+typedef enum AgnLocusProperty AgnLocusProperty;
+
+/**
+ * @type A single filtering criterion, reduced to a comparison of one locus
+ * property against a bound. If ``isupper`` is true, loci whose value for the
+ * property exceeds ``bound`` fail the criterion; otherwise loci whose value
+ * falls below ``bound`` fail.
+ */
+struct AgnFilterCriterion
+{
+  AgnLocusProperty property;
+  bool isupper;
+  GtUword bound;
+};
+typedef struct AgnFilterCriterion AgnFilterCriterion;
+
+#define AGN_MAX_FILTER_CRITERIA 22
+
 /**
  * @type This struct contains a list of filters to be used in determining which
- * loci should be included/excluded in a comparative analysis.
+ * loci should be included/excluded in a comparative analysis. The
+ * ``criteria`` array holds the compiled form of the active (non-zero) filters,
+ * cheapest first; see :c:func:`agn_compare_filters_compile`.
  */
 struct AgnCompareFilters
 {
@@ -174,6 +225,9 @@ struct AgnCompareFilters
   GtUword MaxReferenceCDSLength;
   GtUword MinPredictionCDSLength;
   GtUword MaxPredictionCDSLength;
+  AgnFilterCriterion criteria[AGN_MAX_FILTER_CRITERIA];
+  GtUword numcriteria;
+  bool compiled;
 };
 typedef struct AgnCompareFilters AgnCompareFilters;
 
@@ -232,6 +286,14 @@ void agn_comparison_combine(AgnComparison *c1, AgnComparison *c2);
  */
 void agn_comparison_init(AgnComparison *comparison);
 
+/**
+ * @function Compile the active filters into a list of criteria, ordered from
+ * cheapest to most expensive to evaluate, so that each locus can be tested
+ * with a single pass over the list. Must be called again if any of the filter
+ * values are changed after compilation.
+ */
+void agn_compare_filters_compile(AgnCompareFilters *filters);
+
 /**
  * @function Initialize filters to default values.
  */
@@ -62,6 +62,68 @@ struct AgnGeneLocusSummary
 };
 typedef struct AgnGeneLocusSummary AgnGeneLocusSummary;
 
+/**
+ * @type Limits on the work done in the comparative analysis of a single locus:
+ * the wall-clock time spent enumerating transcript cliques and comparing
+ * clique pairs, the number of cliques enumerated from each source, and the
+ * memory allocated for model vectors. A value of 0 means no limit. See
+ * :c:func:`agn_gene_locus_set_budget`.
+ */
+struct AgnLocusBudget
+{
+  double max_seconds;
+  GtUword max_cliques;
+  GtUword max_vector_bytes;
+};
+typedef struct AgnLocusBudget AgnLocusBudget;
+
+/**
+ * @type Flags identifying the budgets exceeded by a locus; see
+ * :c:func:`agn_gene_locus_budget_exceeded`.
+ */
+enum AgnLocusBudgetFlags
+{
+  AGN_LOCUS_OVER_TIME    = 1,
+  AGN_LOCUS_OVER_CLIQUES = 2,
+  AGN_LOCUS_OVER_MEMORY  = 4,
+};
+typedef enum AgnLocusBudgetFlags AgnLocusBudgetFlags;
+
+/**
+ * @type Where the time went in the comparative analysis of a locus: seconds
+ * spent enumerating transcript cliques and clique pairs, building model
+ * vectors, and comparing clique pairs, along with the number of cliques and
+ * clique pairs analyzed and the bytes allocated for model vectors. For a locus
+ * analyzed in degraded mode, times and bytes include the work abandoned when
+ * the budget was exceeded. Times are only measured for loci with profiling
+ * enabled; see :c:func:`agn_gene_locus_set_profiling`.
+ */
+struct AgnLocusProfile
+{
+  double clique_seconds;
+  double vector_seconds;
+  double pair_seconds;
+  GtUword refr_cliques;
+  GtUword pred_cliques;
+  GtUword pairs;
+  GtUword vector_bytes;
+};
+typedef struct AgnLocusProfile AgnLocusProfile;
+
+/**
+ * @type Lightweight representation of an interval locus (iLocus). Genic iLoci
+ * point to the gene locus from which they were derived, but have their own
+ * coordinates (extended to include flanking sequence); intergenic iLoci have
+ * no gene locus. See :c:func:`agn_locus_index_interval_loci`.
+ */
+struct AgnIntervalLocus
+{
+  GtRange range;
+  bool genic;
+  AgnGeneLocus *locus;
+};
+typedef struct AgnIntervalLocus AgnIntervalLocus;
+
 /**
  * @function Associate the given gene annotation with this gene locus. Rather
  * than calling this function directly, users are recommended to use one of the
@@ -100,6 +162,16 @@ AgnGeneLocus *agn_gene_locus_clone(AgnGeneLocus *locus);
  */
 int agn_gene_locus_array_compare(const void *p1, const void *p2);
 
+/**
+ * @function Returns 0 if the comparative analysis of this locus stayed within
+ * its budget (see :c:func:`agn_gene_locus_set_budget`), or a combination of
+ * :c:type:`AgnLocusBudgetFlags` otherwise. A locus that exceeded its budget
+ * was analyzed in degraded mode: only the transcript with the longest coding
+ * sequence of each gene was considered, and if even those formed too many
+ * cliques, each transcript was treated as a clique of its own.
+ */
+int agn_gene_locus_budget_exceeded(AgnGeneLocus *locus);
+
 /**
  * @function The combined length of all coding sequences associated with this
  * locus. Rather than calling this function directly, users are encouraged to
@@ -134,6 +206,17 @@ GtArray *agn_gene_locus_comparative_analysis(AgnGeneLocus *locus);
  */
 void agn_gene_locus_delete(AgnGeneLocus *locus);
 
+/**
+ * @function Estimate the cost of :c:func:`agn_gene_locus_comparative_analysis`
+ * for this locus, in arbitrary units, without running it. The number of
+ * transcript cliques from each source is estimated from the number of
+ * transcripts and how densely they overlap, and the cost of comparing each
+ * pair of cliques grows with the length of the locus. The estimate is cheap
+ * enough to compute for every locus in advance, for example to schedule the
+ * most expensive loci first.
+ */
+double agn_gene_locus_estimate_cost(AgnGeneLocus *locus);
+
 /**
  * @function Get the number of exons for the locus. Rather than calling this
  * function directly, users are encouraged to use one of the following macros:
@@ -153,7 +236,8 @@ GtUword agn_gene_locus_exon_num(AgnGeneLocus *locus, AgnComparisonSource src);
 /**
  * @function Given a set of filtering criteria, determine whether a locus meets
  * those criteria. Returns true if the locus should be filtered (if it does not
- * meet the criteria), false otherwise.
+ * meet the criteria), false otherwise. Criteria on locus length and gene counts
+ * are evaluated first; transcripts are only examined if those pass.
  */
 bool agn_gene_locus_filter(AgnGeneLocus *locus, AgnCompareFilters *filters);
 
@@ -215,6 +299,13 @@ GtUword agn_gene_locus_get_end(AgnGeneLocus *locus);
  */
 GtUword agn_gene_locus_get_length(AgnGeneLocus *locus);
 
+/**
+ * @function Get the profile of this locus' comparative analysis; see
+ * :c:type:`AgnLocusProfile`. Times are zero unless profiling was enabled with
+ * :c:func:`agn_gene_locus_set_profiling`.
+ */
+AgnLocusProfile agn_gene_locus_get_profile(AgnGeneLocus *locus);
+
 /**
  * @function Get this locus' sequence ID.
  */
@@ -281,6 +372,23 @@ void agn_gene_locus_print_transcript_mapping(AgnGeneLocus *locus,
  */
 GtRange agn_gene_locus_range(AgnGeneLocus *locus);
 
+/**
+ * @function Limit the work done in the comparative analysis of this locus. The
+ * budget is checked as transcript cliques are enumerated and as clique pairs
+ * are compared, and the analysis falls back to a degraded but bounded mode as
+ * soon as any limit is exceeded; see
+ * :c:func:`agn_gene_locus_budget_exceeded`. By default there is no limit.
+ */
+void agn_gene_locus_set_budget(AgnGeneLocus *locus, AgnLocusBudget *budget);
+
+/**
+ * @function Enable or disable timing of the stages of this locus' comparative
+ * analysis (see :c:func:`agn_gene_locus_get_profile`). Timing builds model
+ * vectors separately from the comparison of each clique pair, at some cost, so
+ * it is disabled by default.
+ */
+void agn_gene_locus_set_profiling(AgnGeneLocus *locus, bool profiling);
+
 /**
  * @function Set the range of this locus, no questions asked.
  */
@@ -375,4 +483,31 @@ GtUword agn_gene_locus_transcript_num(AgnGeneLocus *locus,
  */
 bool agn_gene_locus_unit_test(AgnUnitTest *test);
 
+/**
+ * @function Print a mapping of the gene(s) associated with this iLocus, as
+ * with :c:func:`agn_gene_locus_print_gene_mapping`.
+ */
+void agn_interval_locus_print_gene_mapping(AgnIntervalLocus *ilocus,
+                                           const char *seqid, FILE *outstream);
+
+/**
+ * @function Print a mapping of the transcript(s) associated with this iLocus,
+ * as with :c:func:`agn_gene_locus_print_transcript_mapping`.
+ */
+void agn_interval_locus_print_transcript_mapping(AgnIntervalLocus *ilocus,
+                                                 const char *seqid,
+                                                 FILE *outstream);
+
+/**
+ * @function Print the iLocus in GFF3 format, as with
+ * :c:func:`agn_gene_locus_to_gff3`.
+ */
+void agn_interval_locus_to_gff3(AgnIntervalLocus *ilocus, const char *seqid,
+                                FILE *outstream, const char *source);
+
+/**
+ * @function Initialize a budget with no limits.
+ */
+void agn_locus_budget_init(AgnLocusBudget *budget);
+
 #endif
@@ -9,6 +9,53 @@
  * A collection of extensions to core GenomeTools classes.
  */ //;
 
+/**
+ * @type Classes of feature types recognized by AEGeAn, as bit flags. Each class
+ * covers the Sequence Ontology term and its common synonyms (for example,
+ * ``AGN_FEATURE_CDS`` covers ``CDS``, ``coding_sequence`` and ``coding
+ * sequence``). ``AGN_FEATURE_UTR`` is only used for UTRs of unspecified
+ * orientation; ``AGN_FEATURE_ANY_UTR`` covers all three UTR classes.
+ */
+enum AgnFeatureClass
+{
+  AGN_FEATURE_OTHER            = 0,
+  AGN_FEATURE_GENE             = 1 << 0,
+  AGN_FEATURE_MRNA             = 1 << 1,
+  AGN_FEATURE_EXON             = 1 << 2,
+  AGN_FEATURE_INTRON           = 1 << 3,
+  AGN_FEATURE_CDS              = 1 << 4,
+  AGN_FEATURE_FIVE_PRIME_UTR   = 1 << 5,
+  AGN_FEATURE_THREE_PRIME_UTR  = 1 << 6,
+  AGN_FEATURE_UTR              = 1 << 7,
+  AGN_FEATURE_START_CODON      = 1 << 8,
+  AGN_FEATURE_STOP_CODON       = 1 << 9,
+  AGN_FEATURE_ANY_UTR          = AGN_FEATURE_FIVE_PRIME_UTR |
+                                 AGN_FEATURE_THREE_PRIME_UTR |
+                                 AGN_FEATURE_UTR
+};
+typedef enum AgnFeatureClass AgnFeatureClass;
+
+/**
+ * @type Buffers holding the subfeatures of a transcript (or of any other
+ * feature), grouped by class and sorted by position. Filled by
+ * :c:func:`agn_gt_feature_node_anatomy`, which clears the buffers first, so the
+ * same object can be reused for many features without reallocating. UTRs of
+ * all orientations share a single bucket. The feature itself is included in
+ * the appropriate bucket, just as it is with
+ * :c:func:`agn_gt_feature_node_children_of_type`.
+ */
+struct AgnTranscriptAnatomy
+{
+  GtArray *mrnas;
+  GtArray *exons;
+  GtArray *introns;
+  GtArray *cds;
+  GtArray *utrs;
+  GtArray *starts;
+  GtArray *stops;
+};
+typedef struct AgnTranscriptAnatomy AgnTranscriptAnatomy;
+
 /**
  * @function This function makes a copy of an array.
  */
@@ -19,12 +66,28 @@ GtArray* agn_gt_array_copy(GtArray *source, size_t size);
  */
 void agn_gt_feature_index_to_gff3(GtFeatureIndex *index, FILE *outstream);
 
+/**
+ * @function Walk the given feature and all of its subfeatures once, collecting
+ * them into the buckets of ``anatomy`` by class, and then sort each bucket.
+ * Anything previously stored in ``anatomy`` is discarded.
+ */
+void agn_gt_feature_node_anatomy(GtFeatureNode *fn,
+                                 AgnTranscriptAnatomy *anatomy);
+
 /**
  * @function Calculate the length of the given transcript's coding sequence in
  * amino acids.
  */
 GtUword agn_gt_feature_node_cds_length(GtFeatureNode *transcript);
 
+/**
+ * @function Determine the class of the given feature's type. See
+ * :c:type:`AgnFeatureClass`. Each distinct type is classified by name only
+ * once; subsequent calls for features of the same type cost a single table
+ * lookup. Safe to call from multiple threads.
+ */
+AgnFeatureClass agn_gt_feature_node_classify(GtFeatureNode *fn);
+
 /**
  * @function Gather the children of a given feature that have a certain type.
  * Type is tested by ``typetestfunc``, which accepts a single ``GtFeatureNode``
@@ -125,6 +188,12 @@ void agn_gt_feature_node_to_gff3(GtFeatureNode *feature, FILE *outstream,
  */
 int agn_gt_genome_node_compare(const void *n1, const void *n2);
 
+/**
+ * @function Determine the class of the given feature type name. Unlike
+ * :c:func:`agn_gt_feature_node_classify`, no lookup table is used.
+ */
+AgnFeatureClass agn_gt_feature_type_classify(const char *type);
+
 /**
  * @function Convert a GtPhase object into its corresponding character
  * representation.
@@ -148,4 +217,15 @@ GtStrArray* agn_gt_str_array_intersection(GtStrArray *a1, GtStrArray *a2);
  */
 GtStrArray* agn_gt_str_array_union(GtStrArray *a1, GtStrArray *a2);
 
+/**
+ * @function Free the buffers held by the given anatomy object (but not the
+ * features stored in them).
+ */
+void agn_transcript_anatomy_free(AgnTranscriptAnatomy *anatomy);
+
+/**
+ * @function Allocate empty buffers for the given anatomy object.
+ */
+void agn_transcript_anatomy_init(AgnTranscriptAnatomy *anatomy);
+
 #endif
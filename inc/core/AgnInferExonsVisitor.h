@@ -10,7 +10,9 @@
  *
  * Implements the GenomeTools ``GtNodeVisitor`` interface. This is a node
  * visitor used for inferring exon features when only CDS and UTR features are
- * provided explicitly. 
+ * provided explicitly. A gene with an mRNA whose exons overlap is left as is
+ * and marked (see ``gt_feature_node_mark``), so that it can be discarded
+ * downstream.
  */
 typedef struct AgnInferExonsVisitor AgnInferExonsVisitor;
 
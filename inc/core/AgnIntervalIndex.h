@@ -0,0 +1,108 @@
+#ifndef AEGEAN_INTERVAL_INDEX
+#define AEGEAN_INTERVAL_INDEX
+
+#include "genometools.h"
+#include "AgnUnitTest.h"
+
+/**
+ * @class AgnIntervalIndex
+ *
+ * A static interval index for a single sequence, similar to the implicit
+ * interval trees of cgranges. Intervals are added one at a time and the index
+ * is then sealed, which sorts them by start coordinate (then end coordinate)
+ * into a single contiguous array. Each element of the array doubles as a node
+ * of a balanced binary tree whose shape is implied by the element's position,
+ * and stores the maximum end coordinate of its subtree. Queries descend this
+ * tree without following any pointers, and scan small subtrees linearly. No
+ * intervals can be added once the index is sealed.
+ */
+typedef struct AgnIntervalIndex AgnIntervalIndex;
+
+/**
+ * @functype Signature functions must match to be applied to each interval
+ * found by :c:func:`agn_interval_index_find_batch` or
+ * :c:func:`agn_interval_index_find_sorted`. The function is called with
+ * the position of the query in the batch, the value stored with the
+ * overlapping interval, and an optional pointer to supplementary data.
+ */
+typedef void (*AgnIntervalIndexHitFunc)(GtUword query, void *value,
+                                        void *data);
+
+/**
+ * @function Add an interval with the associated ``value`` to the index. The
+ * index must not be sealed yet.
+ */
+void agn_interval_index_add(AgnIntervalIndex *idx, GtRange *range,
+                            void *value);
+
+/**
+ * @function Class destructor. Values stored in the index are not freed.
+ */
+void agn_interval_index_delete(AgnIntervalIndex *idx);
+
+/**
+ * @function Append the value of each interval overlapping ``range`` to
+ * ``values``, in sorted order. The index must be sealed.
+ */
+void agn_interval_index_find(AgnIntervalIndex *idx, GtRange *range,
+                             GtArray *values);
+
+/**
+ * @function Query the index with each of the ``numqueries`` ranges in
+ * ``queries``, passing each overlapping interval to ``func``. Hits for each
+ * query are reported in sorted order, and queries are processed in the order
+ * given. No memory is allocated for the results. Returns the total number of
+ * hits. The index must be sealed.
+ */
+GtUword agn_interval_index_find_batch(AgnIntervalIndex *idx,
+                                      const GtRange *queries,
+                                      GtUword numqueries,
+                                      AgnIntervalIndexHitFunc func,
+                                      void *data);
+
+/**
+ * @function Query the index with each of the ``numqueries`` ranges in
+ * ``queries``, which should be sorted by start coordinate, passing each
+ * overlapping interval to ``func`` as in
+ * :c:func:`agn_interval_index_find_batch`. Instead of searching the tree for
+ * each query, the sorted queries are merged with the sorted intervals in a
+ * single pass, which is much faster for dense queries such as variant
+ * positions or aligned reads. A query that starts before the previous one
+ * restarts the merge, so unsorted queries give correct but slower results.
+ * Returns the total number of hits. The index must be sealed.
+ */
+GtUword agn_interval_index_find_sorted(AgnIntervalIndex *idx,
+                                       const GtRange *queries,
+                                       GtUword numqueries,
+                                       AgnIntervalIndexHitFunc func,
+                                       void *data);
+
+/**
+ * @function Class constructor.
+ */
+AgnIntervalIndex *agn_interval_index_new(void);
+
+/**
+ * @function Sort the intervals and build the implicit tree. Sealing an index
+ * that is already sealed has no effect.
+ */
+void agn_interval_index_seal(AgnIntervalIndex *idx);
+
+/**
+ * @function Number of intervals in the index.
+ */
+GtUword agn_interval_index_size(AgnIntervalIndex *idx);
+
+/**
+ * @function Run unit tests for this class. Returns true if all tests passed.
+ */
+bool agn_interval_index_unit_test(AgnUnitTest *test);
+
+/**
+ * @function The values of all intervals in the index, in sorted order. The
+ * array belongs to the index and must not be modified; it remains valid until
+ * the index is deleted. The index must be sealed.
+ */
+GtArray *agn_interval_index_values(AgnIntervalIndex *idx);
+
+#endif
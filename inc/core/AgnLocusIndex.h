@@ -5,6 +5,7 @@
 #include "AgnComparEval.h"
 #include "AgnGeneLocus.h"
 #include "AgnLogger.h"
+#include "AgnUtils.h"
 
 /**
  * @class AgnLocusIndex
@@ -22,6 +23,25 @@ typedef struct AgnLocusIndex AgnLocusIndex;
  */
 typedef void (*AgnLocusIndexVisitFunc)(AgnGeneLocus *, void *);
 
+/**
+ * @functype Signature functions must match to be applied to each locus found
+ * by :c:func:`agn_locus_index_find_batch`. The function is called with the
+ * position of the query in the batch, a locus overlapping the query, and an
+ * optional pointer to supplementary data.
+ */
+typedef void (*AgnLocusIndexHitFunc)(GtUword query, AgnGeneLocus *locus,
+                                     void *data);
+
+/**
+ * @functype Signature functions must match to be applied to each interval
+ * locus computed by :c:func:`agn_locus_index_stream_interval_loci`. The
+ * function is called once for each iLocus, in order, along with the iLocus'
+ * sequence ID and an optional pointer to supplementary data. The iLocus and
+ * its gene locus are only valid for the duration of the call.
+ */
+typedef void (*AgnIntervalLocusVisitFunc)(AgnIntervalLocus *ilocus,
+                                          const char *seqid, void *data);
+
 /**
  * @function Perform a comparative analysis of each locus associated with
  * ``seqid`` in this index. If ``preanalyfunc`` is not NULL, it will be applied
@@ -43,24 +63,66 @@ void agn_locus_index_delete(AgnLocusIndex *idx);
 
 /**
  * @functype Find all overlapping features in the given range stored in this
- * locus index and store them in ``loci``.
+ * locus index and store them in ``loci``, in sorted order. Queries use the
+ * sequence's sealed index (see :c:func:`agn_locus_index_seal`), which is built
+ * on first use if needed.
  */
 void agn_locus_index_find(AgnLocusIndex *idx, const char *seqid, GtRange *range,
                           GtArray *loci);
 
 /**
- * @function Retrieve all loci corresponding to the specified sequence ID.
+ * @function Find the loci on ``seqid`` overlapping each of the ``numqueries``
+ * ranges in ``queries`` (use ranges of length 1 for positions), passing each
+ * overlapping locus to ``func``. Queries should be sorted by start coordinate:
+ * they are merged with the sorted loci in a single pass rather than searched
+ * for one at a time, and no memory is allocated for the results (see
+ * :c:func:`agn_interval_index_find_sorted`). Returns the total number of hits.
+ */
+GtUword agn_locus_index_find_batch(AgnLocusIndex *idx, const char *seqid,
+                                   const GtRange *queries, GtUword numqueries,
+                                   AgnLocusIndexHitFunc func, void *data);
+
+/**
+ * @function Retrieve all loci corresponding to the specified sequence ID, in
+ * sorted order. The caller is responsible for deleting the array; see
+ * :c:func:`agn_locus_index_get_sorted` to avoid the copy.
  */
 GtArray *agn_locus_index_get(AgnLocusIndex *idx, const char *seqid);
 
+/**
+ * @function Retrieve all loci corresponding to the specified sequence ID,
+ * sorted by location, without copying them. The array belongs to the index and
+ * must not be modified; it remains valid until the index is deleted or the
+ * sequence's loci are parsed again. Returns NULL if there are no loci for
+ * ``seqid``.
+ */
+GtArray *agn_locus_index_get_sorted(AgnLocusIndex *idx, const char *seqid);
+
 /**
  * @functype Compute interval loci with the given ``delta``. If running on
  * incomplete (contig/scaffold) genomic sequences, consider setting
- * ``skipterminal`` to true to ignore the ends of the sequence.
+ * ``skipterminal`` to true to ignore the ends of the sequence. Returns a sorted
+ * array of :c:type:`AgnIntervalLocus` objects (stored by value), which refer to
+ * but do not own the loci in the index; the caller is responsible for deleting
+ * the array.
  */
 GtArray *agn_locus_index_interval_loci(AgnLocusIndex *idx, const char *seqid,
                                        GtUword delta, bool skipterminal);
 
+/**
+ * @function Compute interval loci for each of the ``numdeltas`` values in
+ * ``deltas``, storing an array of :c:type:`AgnIntervalLocus` objects for
+ * ``deltas[i]`` in ``iloci[i]`` (see :c:func:`agn_locus_index_interval_loci`).
+ * The gene loci are retrieved and sorted only once, so each additional delta
+ * costs a single linear pass over them. Returns false if the index contains no
+ * loci for ``seqid``, in which case ``iloci`` is not modified.
+ */
+bool agn_locus_index_interval_loci_deltas(AgnLocusIndex *idx,
+                                          const char *seqid,
+                                          const GtUword *deltas,
+                                          GtUword numdeltas, bool skipterminal,
+                                          GtArray **iloci);
+
 /**
  * @function Class constructor
  */
@@ -77,12 +139,13 @@ GtUword agn_locus_index_parse_pairwise_memory(AgnLocusIndex *idx,
                                               AgnLogger *logger);
 
 /**
- * @function Given a pair of annotation feature sets in memory, identify loci
- * while keeping the two sources of annotation separate (to enable comparison).
+ * @function Given a pair of annotation files, identify loci while keeping the
+ * two sources of annotation separate (to enable comparison). See
+ * :c:type:`AgnGFF3InFlags` for a description of ``flags``.
  */
 GtUword agn_locus_index_parse_pairwise_disk(AgnLocusIndex *idx,
                                             const char *refrfile,
-                                            const char *predfile,
+                                            const char *predfile, int flags,
                                             AgnCompareFilters *filters,
                                             AgnLogger *logger);
 
@@ -94,17 +157,43 @@ GtUword agn_locus_index_parse_memory(AgnLocusIndex *idx,
                                      AgnLogger *logger);
 
 /**
- * @function Identify loci from the given set of annotation files.
+ * @function Identify loci from the given set of annotation files. See
+ * :c:type:`AgnGFF3InFlags` for a description of ``flags``.
  */
 GtUword agn_locus_index_parse_disk(AgnLocusIndex *idx, int numfiles,
-                                   const char **filenames,
+                                   const char **filenames, int flags,
                                    AgnLogger *logger);
 
+/**
+ * @function Build a sealed, static index of the loci of every sequence. Each
+ * sequence's loci are sorted into one contiguous array and searched with an
+ * implicit interval tree (see :c:type:`AgnIntervalIndex`), instead of the
+ * pointer-based tree used while loci are being added. Sequences that are not
+ * sealed here are sealed the first time they are queried; sealing them all up
+ * front keeps that cost out of the query loop.
+ */
+void agn_locus_index_seal(AgnLocusIndex *idx);
+
 /**
  * @function Get a list of the seqids stored in this locus index.
  */
 GtStrArray *agn_locus_index_seqids(AgnLocusIndex *idx);
 
+/**
+ * @function Compute interval loci directly from ``in_stream``, without building
+ * an index, passing each iLocus to ``func`` as soon as its boundaries are
+ * known. Gene features must be sorted: all features for a given sequence must
+ * be contiguous and in order of increasing start coordinate. Each gene locus is
+ * held only until the next one has been read, so memory use is bounded by a
+ * few loci rather than the size of the input. Sequences are reported in the
+ * order in which they appear. Returns 0 on success, or -1 if the stream fails
+ * or the input is not sorted (``error`` is set).
+ */
+int agn_locus_index_stream_interval_loci(GtNodeStream *in_stream,
+                                         GtUword delta, bool skipterminal,
+                                         AgnIntervalLocusVisitFunc func,
+                                         void *funcdata, GtError *error);
+
 /**
  * @function Run unit tests for this class. Returns true if all tests passed.
  */
@@ -2,11 +2,17 @@
 #define AEGEAN_LOGGER
 
 #include "genometools.h"
+#include "AgnUnitTest.h"
 
 /**
  * @class AgnLogger
  *
  * The AgnLogger class is desiged to store error, warning, and status messages.
+ * By default, all messages are held in memory until they are printed. A
+ * streaming logger (see :c:func:`agn_logger_new_streaming`) instead hands each
+ * message to a background writer thread through a fixed-size lock-free ring
+ * buffer, so memory use is constant regardless of message volume and messages
+ * can be logged from multiple threads concurrently.
  */
 typedef struct AgnLogger AgnLogger;
 
@@ -74,6 +80,20 @@ void agn_logger_log_warning(AgnLogger *logger, const char *format, ...);
  */
 AgnLogger *agn_logger_new();
 
+/**
+ * @function Constructor for a streaming logger, which writes messages to
+ * ``outstream`` as they are logged rather than storing them. Once more than
+ * ``ratelimit`` messages have been logged with the same format string, further
+ * status and warning messages with that format are counted but not written (a
+ * ``ratelimit`` of 0 disables this). Consecutive identical messages are
+ * collapsed into a single line. If the writer falls behind, status and warning
+ * messages are dropped (and counted) rather than buffered; errors are never
+ * dropped. Only the ``has_*`` queries and :c:func:`agn_logger_print_all` are
+ * meaningful for a streaming logger; the latter waits for all pending messages
+ * to be written and then prints per-class message counts.
+ */
+AgnLogger *agn_logger_new_streaming(FILE *outstream, GtUword ratelimit);
+
 /**
  * @function Print the status messages, warnings, and errors that have been
  * logged to the given file stream, ``printf``-style. Returns true if any errors
@@ -103,6 +123,11 @@ bool agn_logger_print_status(AgnLogger *logger, FILE *outstream,
 bool agn_logger_print_warning(AgnLogger *logger, FILE *outstream,
                               const char *format, ...);
 
+/**
+ * @function Run unit tests for this class. Returns true if all tests passed.
+ */
+bool agn_logger_unit_test(AgnUnitTest *test);
+
 /**
  * @function Reset this logger object.
  */
@@ -0,0 +1,37 @@
+#ifndef AEGEAN_MAPPED_IN_STREAM
+#define AEGEAN_MAPPED_IN_STREAM
+
+#include "extended/node_stream_api.h"
+
+/**
+ * @class AgnMappedInStream
+ *
+ * Implements the GenomeTools ``GtNodeStream`` interface. This is a node stream
+ * for reading GFF3 files, intended as a faster alternative to the GenomeTools
+ * GFF3 parser when loading large annotations. Each file is memory mapped and
+ * scanned in place, and only the attributes AEGeAn needs (``ID``, ``Parent``
+ * and ``Name``) are stored; all other attributes are dropped. Features are
+ * assembled into the same feature graphs the GenomeTools parser produces:
+ * ``Parent`` references are resolved within each block of features separated
+ * by ``###`` directives, features sharing an ``ID`` become multi-features, and
+ * a sequence region is created for each sequence (either from its
+ * ``##sequence-region`` directive or from the extent of its features). All
+ * input is read before any nodes are returned: region nodes first, then
+ * top-level features sorted by position. Gzip-compressed input is decompressed
+ * in memory before parsing, using one thread per processor for BGZF input
+ * (see :c:func:`agn_bgzf_inflate`).
+ *
+ * Comments are discarded, the nodes created carry no file name or line number,
+ * and none of the repairs of the GenomeTools tidy mode are attempted. Use the
+ * GenomeTools parser for input that needs them, or for output that must retain
+ * all attributes.
+ */
+typedef struct AgnMappedInStream AgnMappedInStream;
+
+/**
+ * @function Class constructor. If ``numfiles`` is 0, data is read from
+ * standard input.
+ */
+GtNodeStream* agn_mapped_in_stream_new(int numfiles, const char **filenames);
+
+#endif
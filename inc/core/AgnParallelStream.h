@@ -0,0 +1,66 @@
+#ifndef AEGEAN_PARALLEL_STREAM
+#define AEGEAN_PARALLEL_STREAM
+
+#include "extended/node_stream_api.h"
+#include "AgnUnitTest.h"
+
+/**
+ * @class AgnParallelStream
+ *
+ * Implements the GenomeTools ``GtNodeStream`` interface. This is a node stream
+ * that distributes the processing of feature nodes across several threads. A
+ * dedicated thread pulls nodes from the input stream and places them in a
+ * bounded queue; each worker thread takes nodes from the queue and passes them
+ * through its own copy of a node stream chain; and nodes are returned from
+ * this stream in the same order in which they were read from the input stream.
+ * Nodes other than feature nodes bypass the workers.
+ *
+ * The processing chain must handle each node independently: for every node fed
+ * into the chain, the chain must return all of its output nodes and then NULL,
+ * without holding nodes back for later calls. Visitor streams and the
+ * :c:type:`AgnFilterStream` and :c:type:`AgnCanonGeneStream` classes meet this
+ * requirement.
+ *
+ * GenomeTools is not thread safe unless it was built with ``threads=yes``: the
+ * table in which feature types are interned and the reference counts of
+ * shared objects are unprotected. This stream therefore never parses input
+ * while a worker is processing a node; gives each feature handed to a worker
+ * private copies of its sequence ID and source strings; and interns the types
+ * of all features that the chains create before any worker starts, so that
+ * workers only ever look types up. The chains must create no features of other
+ * types, and GenomeTools' memory bookkeeping (``GT_MEM_BOOKKEEPING=on``) must
+ * be off.
+ */
+typedef struct AgnParallelStream AgnParallelStream;
+
+/**
+ * @functype Signature that functions must match to build a processing chain
+ * for :c:type:`AgnParallelStream`. The function will be called once for each
+ * worker thread, with the chain's input stream as the first argument, and must
+ * return the last stream in the chain. That stream must hold references to all
+ * other streams in the chain, as it is the only one deleted when the worker is
+ * done. The second argument is available for an optional pointer to
+ * supplementary data (if needed).
+ */
+typedef GtNodeStream *(*AgnStreamChainFunc)(GtNodeStream *, void *);
+
+/**
+ * @function Class constructor. Feature nodes from ``in_stream`` will be
+ * processed by ``numthreads`` worker threads, each with its own chain built by
+ * ``chainfunc``. At most ``queuesize`` nodes will be in flight at any time.
+ * ``types`` is a NULL-terminated list of every type of feature that the chains
+ * may create (or NULL if they create none), which is required for thread
+ * safety (see above). Any data shared between chains (such as a logger) must
+ * be thread safe.
+ */
+GtNodeStream* agn_parallel_stream_new(GtNodeStream *in_stream,
+                                      GtUword numthreads, GtUword queuesize,
+                                      AgnStreamChainFunc chainfunc,
+                                      void *chaindata, const char **types);
+
+/**
+ * @function Run unit tests for this class. Returns true if all tests passed.
+ */
+bool agn_parallel_stream_unit_test(AgnUnitTest *test);
+
+#endif
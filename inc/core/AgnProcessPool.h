@@ -0,0 +1,98 @@
+#ifndef AEGEAN_PROCESS_POOL
+#define AEGEAN_PROCESS_POOL
+
+#include "genometools.h"
+#include "AgnUnitTest.h"
+
+/**
+ * @class AgnProcessPool
+ *
+ * Runs a fixed number of independent tasks in separate worker processes, as
+ * an alternative to threads for code that relies on parts of GenomeTools that
+ * are not thread-safe. Worker processes are forked once all input has been
+ * loaded, so they share it copy-on-write, and take tasks one at a time from a
+ * work counter in shared memory. Each task stores a fixed-size result in
+ * shared memory and may write variable-length output to a number of streams;
+ * each worker writes to its own temporary file for each stream, and the
+ * position of each task's output is recorded so that the parent process can
+ * assemble the output of all tasks in task order once the workers finish.
+ */
+typedef struct AgnProcessPool AgnProcessPool;
+
+/**
+ * @functype Signature functions must match to run a single task in a worker
+ * process. The function is called with the task number, the streams to which
+ * the task's output should be written, memory for the task's result
+ * (initialized to zero), and an optional pointer to supplementary data.
+ * Changes to any other memory are not seen by the parent process. Returns 0
+ * on success, or a non-zero value to report that the task failed.
+ */
+typedef int (*AgnProcessTaskFunc)(GtUword task, FILE **streams, void *result,
+                                  void *data);
+
+/**
+ * @functype Signature functions must match to report the progress of a pool
+ * while its tasks are running. The function is called in the parent process,
+ * and can use :c:func:`agn_process_pool_task_done` to determine which tasks
+ * have completed.
+ */
+typedef void (*AgnProcessProgressFunc)(AgnProcessPool *pool, void *data);
+
+/**
+ * @function Class destructor.
+ */
+void agn_process_pool_delete(AgnProcessPool *pool);
+
+/**
+ * @function Class constructor. The pool will run ``numtasks`` tasks in
+ * ``numprocs`` worker processes, with a result of ``resultsize`` bytes and
+ * ``numstreams`` output streams for each task. If ``numprocs`` is 1, tasks
+ * are run in the calling process.
+ */
+AgnProcessPool *agn_process_pool_new(GtUword numprocs, GtUword numtasks,
+                                     GtUword numstreams, size_t resultsize);
+
+/**
+ * @function The result of the given task, once the pool has been run.
+ */
+void *agn_process_pool_result(AgnProcessPool *pool, GtUword task);
+
+/**
+ * @function Run all tasks with ``func``. Workers take tasks in the order given
+ * by the ``numtasks`` task numbers in ``order``, or in increasing order if
+ * ``order`` is NULL. All output streams are flushed before the workers are
+ * forked. Returns 0 once all tasks have completed, or -1 and sets ``error`` if
+ * a worker could not be created or any task failed.
+ */
+int agn_process_pool_run(AgnProcessPool *pool, const GtUword *order,
+                         AgnProcessTaskFunc func, void *data, GtError *error);
+
+/**
+ * @function Call ``func`` about every ``interval`` seconds while the pool is
+ * running, to report progress. Must be called before
+ * :c:func:`agn_process_pool_run`.
+ */
+void agn_process_pool_set_progress(AgnProcessPool *pool,
+                                   AgnProcessProgressFunc func, void *data,
+                                   double interval);
+
+/**
+ * @function Determine whether the given task has completed successfully.
+ */
+bool agn_process_pool_task_done(AgnProcessPool *pool, GtUword task);
+
+/**
+ * @function Run unit tests for this class. Returns true if all tests passed.
+ */
+bool agn_process_pool_unit_test(AgnUnitTest *test);
+
+/**
+ * @function Copy the output written by the given task to the given stream to
+ * ``outstream``. Returns 0 on success, or -1 and sets ``error`` if the output
+ * could not be read back.
+ */
+int agn_process_pool_write_output(AgnProcessPool *pool, GtUword task,
+                                  GtUword stream, FILE *outstream,
+                                  GtError *error);
+
+#endif
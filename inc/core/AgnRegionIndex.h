@@ -0,0 +1,73 @@
+#ifndef AEGEAN_REGION_INDEX
+#define AEGEAN_REGION_INDEX
+
+#include "genometools.h"
+#include "AgnBgzf.h"
+
+// Suffix appended to the name of a BGZF file to name its index
+#define AGN_REGION_INDEX_SUFFIX ".agi"
+
+/**
+ * @class AgnRegionIndex
+ *
+ * A coordinate index for a BGZF-compressed GFF3 file, similar to the linear
+ * index used by tabix. Each sequence is divided into 16 kb windows, and for
+ * each window the index stores the virtual offset of the first top-level
+ * feature overlapping it (or, if there is none, of the first top-level feature
+ * after it). The index is built while the file is written, by attaching it to
+ * the :c:type:`AgnBgzfWriter`, and requires the file to be sorted: all
+ * features for a given sequence must be contiguous and in order of increasing
+ * start coordinate. Use :c:type:`AgnRegionReader` to query an indexed file.
+ */
+typedef struct AgnRegionIndex AgnRegionIndex;
+
+/**
+ * @function Index each line written to ``writer``. Must be called before any
+ * data is written.
+ */
+void agn_region_index_attach(AgnRegionIndex *idx, AgnBgzfWriter *writer);
+
+/**
+ * @function Class destructor.
+ */
+void agn_region_index_delete(AgnRegionIndex *idx);
+
+/**
+ * @function Find the virtual offset from which to start reading features that
+ * may overlap a region of ``seqid`` starting at ``start``. Returns false if no
+ * feature on ``seqid`` ends at or after ``start``.
+ */
+bool agn_region_index_lookup(AgnRegionIndex *idx, const char *seqid,
+                             GtUword start, GtUword *voffset);
+
+/**
+ * @function Class constructor. Creates an empty index, to be attached to a
+ * writer.
+ */
+AgnRegionIndex *agn_region_index_new(void);
+
+/**
+ * @function Parse the sequence ID, coordinates, and parentage of a GFF3 feature
+ * line of ``length`` characters (not necessarily NUL-terminated). Returns false
+ * if the line is not a feature line.
+ */
+bool agn_region_index_parse_record(const char *line, GtUword length,
+                                   GtStr *seqid, GtRange *range,
+                                   bool *toplevel);
+
+/**
+ * @function Load an index from ``filename``. Returns NULL and sets ``error`` if
+ * the file cannot be read or is not a valid index.
+ */
+AgnRegionIndex *agn_region_index_read(const char *filename, GtError *error);
+
+/**
+ * @function Write the index to ``filename``, converting offsets in the data
+ * passed through ``writer`` into virtual offsets in its compressed file. The
+ * writer must be finished first. Returns -1 and sets ``error`` if the data was
+ * not sorted or the index cannot be written, 0 otherwise.
+ */
+int agn_region_index_write(AgnRegionIndex *idx, const char *filename,
+                           AgnBgzfWriter *writer, GtError *error);
+
+#endif
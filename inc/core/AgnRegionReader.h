@@ -0,0 +1,53 @@
+#ifndef AEGEAN_REGION_READER
+#define AEGEAN_REGION_READER
+
+#include "genometools.h"
+#include "AgnUnitTest.h"
+
+/**
+ * @class AgnRegionReader
+ *
+ * Retrieves the features overlapping a given region from a sorted,
+ * BGZF-compressed GFF3 file with an accompanying :c:type:`AgnRegionIndex`
+ * (such as those written by ``canon-gff3`` and ``LocusPocus`` with the
+ * ``--index`` option). Rather than parsing the entire file, the reader uses the
+ * index to seek directly to the first block that may contain relevant
+ * features, and stops as soon as it passes the end of the region.
+ */
+typedef struct AgnRegionReader AgnRegionReader;
+
+/**
+ * @function Class destructor.
+ */
+void agn_region_reader_delete(AgnRegionReader *reader);
+
+/**
+ * @function Class constructor. Opens the BGZF-compressed file ``filename`` and
+ * loads its index from ``filename`` plus :c:macro:`AGN_REGION_INDEX_SUFFIX`.
+ * Returns NULL and sets ``error`` if either cannot be read.
+ */
+AgnRegionReader *agn_region_reader_new(const char *filename, GtError *error);
+
+/**
+ * @function Store the next top-level feature overlapping the current region in
+ * ``record``, including the lines of all of its subfeatures. Each line ends
+ * with a newline. Returns 1 if a record was read, 0 if there are no more
+ * records in the region, or -1 on error (``error`` is set).
+ */
+int agn_region_reader_next(AgnRegionReader *reader, GtStr *record,
+                           GtError *error);
+
+/**
+ * @function Position the reader at the first feature that may overlap
+ * ``range`` on sequence ``seqid``. Returns 0 on success, or -1 on error
+ * (``error`` is set).
+ */
+int agn_region_reader_seek(AgnRegionReader *reader, const char *seqid,
+                           GtRange *range, GtError *error);
+
+/**
+ * @function Run unit tests for this class. Returns true if all tests passed.
+ */
+bool agn_region_reader_unit_test(AgnUnitTest *test);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef AEGEAN_SORTED_IN_STREAM
+#define AEGEAN_SORTED_IN_STREAM
+
+#include "extended/node_stream_api.h"
+
+/**
+ * @class AgnSortedInStream
+ *
+ * Implements the GenomeTools ``GtNodeStream`` interface. This is a node stream
+ * for reading GFF3 files that are already sorted, with ``###`` directives
+ * separating independent features. Unlike the unsorted GFF3 input stream, which
+ * must read all of its input before returning any features, each feature is
+ * returned as soon as it is complete, so memory use is bounded by the largest
+ * feature graph rather than the size of the input. Files are read one after
+ * another, and each must be sorted on its own: all features for a given
+ * sequence must be contiguous and in order of increasing start coordinate.
+ * The stream fails with an error at the first feature out of order.
+ */
+typedef struct AgnSortedInStream AgnSortedInStream;
+
+/**
+ * @function Class constructor. If ``numfiles`` is 0, data is read from
+ * standard input.
+ */
+GtNodeStream* agn_sorted_in_stream_new(int numfiles, const char **filenames);
+
+#endif
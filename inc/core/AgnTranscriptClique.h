@@ -14,6 +14,19 @@
  */
 typedef struct AgnTranscriptClique AgnTranscriptClique;
 
+/**
+ * @type A single structural segment (CDS segment, UTR segment, or intron) of a
+ * transcript clique. ``type`` uses the same codes as the model vectors built
+ * for clique pair comparison: ``C`` for CDS, ``F`` for 5' UTR, ``T`` for 3'
+ * UTR, and ``I`` for intron.
+ */
+struct AgnCliqueSegment
+{
+  GtRange range;
+  char type;
+};
+typedef struct AgnCliqueSegment AgnCliqueSegment;
+
 /**
  * @functype
  * The signature that functions must match to be applied to each transcript in
@@ -30,11 +43,28 @@ typedef void (*AgnCliqueVisitFunc)(GtFeatureNode*, void*);
 void agn_transcript_clique_add(AgnTranscriptClique *clique,
                                GtFeatureNode *transcript);
 
+/**
+ * @function Get a hash of the ordered CDS segment coordinates of this clique.
+ * Two cliques with identical coding structure will have identical CDS
+ * fingerprints. Computed on first request and cached thereafter.
+ */
+GtUword agn_transcript_clique_cds_fingerprint(AgnTranscriptClique *clique);
+
 /**
  * @function Get the CDS length (in amino acids) for this transcript clique.
  */
 GtUword agn_transcript_clique_cds_length(AgnTranscriptClique *clique);
 
+/**
+ * @function Determine whether the two cliques have exactly the same CDS
+ * structure. The fingerprints are compared first, and segment coordinates are
+ * only compared when the fingerprints agree. Returns false if either clique
+ * contains overlapping segments, since their model vectors cannot be inferred
+ * from the segments alone.
+ */
+bool agn_transcript_clique_cds_match(AgnTranscriptClique *c1,
+                                     AgnTranscriptClique *c2);
+
 /**
  * @function Make a shallow copy of this transcript clique.
  */
@@ -45,6 +75,13 @@ AgnTranscriptClique* agn_transcript_clique_copy(AgnTranscriptClique *clique);
  */
 void agn_transcript_clique_delete(AgnTranscriptClique *clique);
 
+/**
+ * @function Get a hash of the ordered exon, CDS, and UTR coordinates of this
+ * clique. Two cliques with identical structure will have identical
+ * fingerprints. Computed on first request and cached thereafter.
+ */
+GtUword agn_transcript_clique_fingerprint(AgnTranscriptClique *clique);
+
 /**
  * @function Determine whether any of the transcript IDs associated with this
  * clique are keys in the given hash map.
@@ -88,11 +125,26 @@ void agn_transcript_clique_print_ids(AgnTranscriptClique *clique,
 void agn_transcript_clique_put_ids_in_hash(AgnTranscriptClique *clique,
                                            GtHashmap *map);
 
+/**
+ * @function Get the structural segments of this clique (see
+ * :c:type:`AgnCliqueSegment`), sorted by coordinate. The array belongs to the
+ * clique and must not be modified.
+ */
+GtArray *agn_transcript_clique_segments(AgnTranscriptClique *clique);
+
 /**
  * @function Get the number of transcripts in this clique.
  */
 GtUword agn_transcript_clique_size(AgnTranscriptClique *clique);
 
+/**
+ * @function Determine whether the two cliques have exactly the same exon, CDS,
+ * and UTR structure (and will therefore produce identical model vectors). The
+ * same caveats apply as for :c:func:`agn_transcript_clique_cds_match`.
+ */
+bool agn_transcript_clique_structure_match(AgnTranscriptClique *c1,
+                                           AgnTranscriptClique *c2);
+
 /**
  * @function Get an array containing all the transcripts in this clique. User is
  * responsible for deleting the array.
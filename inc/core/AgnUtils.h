@@ -51,6 +51,17 @@ double agn_calc_splice_complexity(GtArray *transcripts);
  */
 GtArray* agn_enumerate_feature_cliques(GtArray *feature_set);
 
+/**
+ * @function Same as :c:func:`agn_enumerate_feature_cliques`, but give up once
+ * more than ``maxcliques`` cliques have been found or the wall clock (see
+ * :c:func:`agn_wallclock`) passes ``deadline``, in which case any cliques found
+ * so far are deleted and NULL is returned. A value of 0 for either limit means
+ * no limit.
+ */
+GtArray* agn_enumerate_feature_cliques_bounded(GtArray *feature_set,
+                                               GtUword maxcliques,
+                                               double deadline);
+
 /**
  * @function For a set of features, we can construct a graph where each node
  * represents a feature and where two nodes are connected if the corresponding
@@ -66,19 +77,44 @@ GtArray* agn_feature_neighbors(GtGenomeNode *feature, GtArray *feature_set);
  */
 FILE *agn_fopen(const char *filename, const char *mode, FILE *errstream);
 
+/**
+ * @type Options for reading GFF3 input. With ``AGN_GFF3_SORTED``, the input
+ * must be sorted and features are returned as soon as they are complete (see
+ * :c:type:`AgnSortedInStream`). With ``AGN_GFF3_MAPPED``, input is read with
+ * the faster :c:type:`AgnMappedInStream` rather than the GenomeTools parser;
+ * this reads all input up front, so ``AGN_GFF3_SORTED`` is ignored. By default,
+ * the GenomeTools parser reads all input before any features are returned.
+ */
+enum AgnGFF3InFlags
+{
+  AGN_GFF3_DEFAULT = 0,
+  AGN_GFF3_SORTED  = 1 << 0,
+  AGN_GFF3_MAPPED  = 1 << 1
+};
+typedef enum AgnGFF3InFlags AgnGFF3InFlags;
+
+/**
+ * @function Create a node stream for reading the given GFF3 files (or standard
+ * input if ``numfiles`` is 0). See :c:type:`AgnGFF3InFlags` for a description
+ * of ``flags``.
+ */
+GtNodeStream *agn_gff3_in_stream_new(int numfiles, const char **filenames,
+                                     int flags);
+
 /**
  * @function Load canonical protein-coding genes from the given GFF3 files into
- * memory.
+ * memory. See :c:type:`AgnGFF3InFlags` for a description of ``flags``.
  */
 GtFeatureIndex *agn_import_canonical(int numfiles, const char **filenames,
-                                     AgnLogger *logger);
+                                     int flags, AgnLogger *logger);
 
 /**
  * @function Load features whose type is equal to ``type`` into memory from the
- * given GFF3 files.
+ * given GFF3 files. See :c:type:`AgnGFF3InFlags` for a description of
+ * ``flags``.
  */
 GtFeatureIndex *agn_import_simple(int numfiles, const char **filenames,
-                                  char *type, AgnLogger *logger);
+                                  char *type, int flags, AgnLogger *logger);
 
 /**
  * @function Given an exon and the start/stop codons associated with its
@@ -134,4 +170,11 @@ GtRange agn_transcript_cds_range(GtFeatureNode *transcript);
  */
 void agn_transcript_structure_gbk(GtFeatureNode *transcript, FILE *outstream);
 
+/**
+ * @function Elapsed time in seconds, with sub-second resolution, from an
+ * arbitrary but fixed point in the past; the difference between two calls is
+ * the wall-clock time between them.
+ */
+double agn_wallclock(void);
+
 #endif
@@ -0,0 +1,321 @@
+#include <string.h>
+#include "AgnGtExtensions.h"
+#include "PeMerge.h"
+
+//------------------------------------------------------------------------------
+// Prototype(s) for private function(s)
+//------------------------------------------------------------------------------
+
+/**
+ * @function Allocate a partial result with empty strings and statistics.
+ */
+static PePartial *pe_partial_new();
+
+/**
+ * @function Read a length-prefixed string from the given stream into ``str``.
+ * Returns false if the stream ends early.
+ */
+static bool pe_partial_read_string(FILE *instream, GtStr *str);
+
+/**
+ * @function Read a single integer from the given stream. Returns false if the
+ * stream ends early.
+ */
+static bool pe_partial_read_uword(FILE *instream, GtUword *value);
+
+/**
+ * @function Describe the settings of the current run that change its results
+ * (the compiled locus filters, which include ``--maxtrans``, and the locus
+ * budget) as a string, so that partial results computed with different
+ * settings are not combined.
+ */
+static void pe_partial_settings(PeOptions *options, GtStr *settings);
+
+/**
+ * @function Write a length-prefixed string to the given stream.
+ */
+static void pe_partial_write_string(FILE *outstream, const char *str);
+
+/**
+ * @function Write a single integer to the given stream.
+ */
+static void pe_partial_write_uword(FILE *outstream, GtUword value);
+
+
+//------------------------------------------------------------------------------
+// Method/function implementations
+//------------------------------------------------------------------------------
+
+PePartial *pe_partial_merge(GtArray *partials, GtError *error)
+{
+  gt_assert(gt_array_size(partials) > 0);
+  PePartial *first = *(PePartial **)gt_array_get(partials, 0);
+  PePartial *merged = pe_partial_new();
+  gt_str_append_str(merged->refrfile, first->refrfile);
+  gt_str_append_str(merged->predfile, first->predfile);
+  gt_str_append_str(merged->refrlabel, first->refrlabel);
+  gt_str_append_str(merged->predlabel, first->predlabel);
+  gt_str_append_str(merged->settings, first->settings);
+  merged->shard = 1;
+  merged->numshards = 1;
+
+  GtUword numshards = first->numshards;
+  bool *shardseen = gt_calloc(numshards, sizeof(bool));
+  GtHashmap *seqidsseen = gt_hashmap_new(GT_HASH_STRING, NULL, NULL);
+  GtStrArray *seqids = gt_str_array_new();
+  int had_err = 0;
+  GtUword i, j;
+  for(i = 0; !had_err && i < gt_array_size(partials); i++)
+  {
+    PePartial *partial = *(PePartial **)gt_array_get(partials, i);
+    if(gt_str_cmp(partial->refrfile, first->refrfile) != 0 ||
+       gt_str_cmp(partial->predfile, first->predfile) != 0)
+    {
+      gt_error_set(error, "partial results compare different files ('%s' vs "
+                   "'%s' and '%s' vs '%s')", gt_str_get(first->refrfile),
+                   gt_str_get(first->predfile), gt_str_get(partial->refrfile),
+                   gt_str_get(partial->predfile));
+      had_err = -1;
+      break;
+    }
+    if(gt_str_cmp(partial->settings, first->settings) != 0)
+    {
+      gt_error_set(error, "partial results were computed with different "
+                   "filters or limits ('%s' vs '%s')",
+                   gt_str_get(first->settings), gt_str_get(partial->settings));
+      had_err = -1;
+      break;
+    }
+    if(partial->numshards != numshards)
+    {
+      gt_error_set(error, "partial results split the sequences into different "
+                   "numbers of shards (%lu and %lu)", numshards,
+                   partial->numshards);
+      had_err = -1;
+      break;
+    }
+    if(numshards > 1 && shardseen[partial->shard - 1])
+    {
+      gt_error_set(error, "shard %lu/%lu given more than once", partial->shard,
+                   numshards);
+      had_err = -1;
+      break;
+    }
+    shardseen[partial->shard - 1] = true;
+
+    for(j = 0; j < gt_str_array_size(partial->seqids); j++)
+    {
+      char *seqid = (char *)gt_str_array_get(partial->seqids, j);
+      if(gt_hashmap_get(seqidsseen, seqid) != NULL)
+      {
+        gt_error_set(error, "sequence '%s' analyzed more than once", seqid);
+        had_err = -1;
+        break;
+      }
+      gt_hashmap_add(seqidsseen, seqid, seqid);
+      gt_str_array_add_cstr(seqids, seqid);
+    }
+    agn_comp_evaluation_combine(&merged->eval, &partial->eval);
+  }
+  for(i = 0; !had_err && i < numshards; i++)
+  {
+    if(!shardseen[i])
+    {
+      gt_error_set(error, "missing partial results for shard %lu/%lu", i + 1,
+                   numshards);
+      had_err = -1;
+    }
+  }
+
+  // Sort the sequence IDs as they would be in a single run
+  GtStrArray *empty = gt_str_array_new();
+  gt_str_array_delete(merged->seqids);
+  merged->seqids = agn_gt_str_array_union(seqids, empty);
+  gt_str_array_delete(empty);
+  gt_str_array_delete(seqids);
+  gt_hashmap_delete(seqidsseen);
+  gt_free(shardseen);
+  if(had_err)
+  {
+    pe_partial_delete(merged);
+    return NULL;
+  }
+  return merged;
+}
+
+void pe_partial_delete(PePartial *partial)
+{
+  gt_str_delete(partial->refrfile);
+  gt_str_delete(partial->predfile);
+  gt_str_delete(partial->refrlabel);
+  gt_str_delete(partial->predlabel);
+  gt_str_delete(partial->settings);
+  gt_str_array_delete(partial->seqids);
+  gt_free(partial);
+}
+
+static PePartial *pe_partial_new()
+{
+  PePartial *partial = gt_malloc( sizeof(PePartial) );
+  partial->refrfile = gt_str_new();
+  partial->predfile = gt_str_new();
+  partial->refrlabel = gt_str_new();
+  partial->predlabel = gt_str_new();
+  partial->settings = gt_str_new();
+  partial->shard = 0;
+  partial->numshards = 0;
+  partial->seqids = gt_str_array_new();
+  agn_comp_evaluation_init(&partial->eval);
+  return partial;
+}
+
+PePartial *pe_partial_read(const char *filename, GtError *error)
+{
+  FILE *instream = fopen(filename, "rb");
+  if(instream == NULL)
+  {
+    gt_error_set(error, "could not open partial results file '%s'", filename);
+    return NULL;
+  }
+
+  // The size of the statistics guards against files written by an
+  // incompatible build
+  char magic[sizeof(PE_PARTIAL_MAGIC)];
+  GtUword evalsize = 0;
+  bool success = fread(magic, 1, strlen(PE_PARTIAL_MAGIC), instream) ==
+                 strlen(PE_PARTIAL_MAGIC) &&
+                 strncmp(magic, PE_PARTIAL_MAGIC,
+                         strlen(PE_PARTIAL_MAGIC)) == 0 &&
+                 pe_partial_read_uword(instream, &evalsize) &&
+                 evalsize == sizeof(AgnCompEvaluation);
+  if(!success)
+  {
+    gt_error_set(error, "'%s' is not a partial results file written by this "
+                 "version of ParsEval", filename);
+    fclose(instream);
+    return NULL;
+  }
+
+  PePartial *partial = pe_partial_new();
+  GtUword numseqids = 0, i;
+  success = pe_partial_read_uword(instream, &partial->shard) &&
+            pe_partial_read_uword(instream, &partial->numshards) &&
+            partial->shard >= 1 && partial->shard <= partial->numshards &&
+            pe_partial_read_string(instream, partial->refrfile) &&
+            pe_partial_read_string(instream, partial->predfile) &&
+            pe_partial_read_string(instream, partial->refrlabel) &&
+            pe_partial_read_string(instream, partial->predlabel) &&
+            pe_partial_read_string(instream, partial->settings) &&
+            pe_partial_read_uword(instream, &numseqids);
+  GtStr *seqid = gt_str_new();
+  for(i = 0; success && i < numseqids; i++)
+  {
+    success = pe_partial_read_string(instream, seqid);
+    gt_str_array_add(partial->seqids, seqid);
+  }
+  gt_str_delete(seqid);
+  success = success && fread(&partial->eval, sizeof(AgnCompEvaluation), 1,
+                             instream) == 1;
+  fclose(instream);
+  if(!success)
+  {
+    gt_error_set(error, "partial results file '%s' is truncated or corrupt",
+                 filename);
+    pe_partial_delete(partial);
+    return NULL;
+  }
+  return partial;
+}
+
+static bool pe_partial_read_string(FILE *instream, GtStr *str)
+{
+  GtUword length;
+  gt_str_reset(str);
+  if(!pe_partial_read_uword(instream, &length))
+    return false;
+
+  char buffer[1024];
+  while(length > 0)
+  {
+    size_t chunk = length < sizeof(buffer) ? length : sizeof(buffer);
+    if(fread(buffer, 1, chunk, instream) != chunk)
+      return false;
+    gt_str_append_cstr_nt(str, buffer, chunk);
+    length -= chunk;
+  }
+  return true;
+}
+
+static bool pe_partial_read_uword(FILE *instream, GtUword *value)
+{
+  return fread(value, sizeof(GtUword), 1, instream) == 1;
+}
+
+static void pe_partial_settings(PeOptions *options, GtStr *settings)
+{
+  AgnLocusBudget *budget = &options->budget;
+  AgnCompareFilters *filters = &options->filters;
+  char buffer[128];
+  GtUword i;
+
+  gt_str_reset(settings);
+  snprintf(buffer, sizeof(buffer),
+           "maxtime=%.17g;maxcliques=%lu;maxmemory=%lu;filters=",
+           budget->max_seconds, budget->max_cliques, budget->max_vector_bytes);
+  gt_str_append_cstr(settings, buffer);
+
+  // Only active filters are compiled, in a fixed order, so equivalent filter
+  // files give the same description
+  gt_assert(filters->compiled);
+  for(i = 0; i < filters->numcriteria; i++)
+  {
+    AgnFilterCriterion *criterion = filters->criteria + i;
+    snprintf(buffer, sizeof(buffer), "%s%d%c%lu", i > 0 ? "," : "",
+             (int)criterion->property, criterion->isupper ? '<' : '>',
+             criterion->bound);
+    gt_str_append_cstr(settings, buffer);
+  }
+}
+
+int pe_partial_write(FILE *outstream, PeOptions *options, GtStrArray *seqids,
+                     AgnCompEvaluation *eval, GtError *error)
+{
+  fwrite(PE_PARTIAL_MAGIC, 1, strlen(PE_PARTIAL_MAGIC), outstream);
+  pe_partial_write_uword(outstream, sizeof(AgnCompEvaluation));
+  pe_partial_write_uword(outstream, options->shard);
+  pe_partial_write_uword(outstream, options->numshards);
+  pe_partial_write_string(outstream, options->refrfile);
+  pe_partial_write_string(outstream, options->predfile);
+  pe_partial_write_string(outstream, options->refrlabel);
+  pe_partial_write_string(outstream, options->predlabel);
+  GtStr *settings = gt_str_new();
+  pe_partial_settings(options, settings);
+  pe_partial_write_string(outstream, gt_str_get(settings));
+  gt_str_delete(settings);
+
+  GtUword i;
+  pe_partial_write_uword(outstream, gt_str_array_size(seqids));
+  for(i = 0; i < gt_str_array_size(seqids); i++)
+    pe_partial_write_string(outstream, gt_str_array_get(seqids, i));
+  fwrite(eval, sizeof(AgnCompEvaluation), 1, outstream);
+
+  if(fflush(outstream) != 0 || ferror(outstream))
+  {
+    gt_error_set(error, "could not write partial results to '%s'",
+                 options->outfilename);
+    return -1;
+  }
+  return 0;
+}
+
+static void pe_partial_write_string(FILE *outstream, const char *str)
+{
+  GtUword length = strlen(str);
+  pe_partial_write_uword(outstream, length);
+  fwrite(str, 1, length, outstream);
+}
+
+static void pe_partial_write_uword(FILE *outstream, GtUword value)
+{
+  fwrite(&value, sizeof(GtUword), 1, outstream);
+}
@@ -9,19 +9,27 @@ int pe_parse_options(int argc, char * const argv[], PeOptions *options)
 {
   int opt = 0;
   int optindex = 0;
-  const char *optstr = "a:c:df:ghkmn:o:pr:t:svwx:y:";
+  const char *optstr = "a:b:c:defi:ghj:kl:mn:o:pq:r:t:svwx:y:";
   const struct option parseval_options[] =
   {
     { "datashare",  required_argument, NULL, 'a' },
+    { "maxmemory",  required_argument, NULL, 'b' },
+    { "maxcliques", required_argument, NULL, 'c' },
     { "complimit",  required_argument, NULL, 'c' },
     { "debug",      no_argument,       NULL, 'd' },
+    { "fast",       no_argument,       NULL, 'e' },
     { "outformat",  required_argument, NULL, 'f' },
     { "printgff3",  no_argument,       NULL, 'g' },
     { "help",       no_argument,       NULL, 'h' },
+    { "maxtime",    required_argument, NULL, 'i' },
+    { "shard",      required_argument, NULL, 'j' },
     { "makefilter", no_argument,       NULL, 'k' },
+    { "seqids",     required_argument, NULL, 'l' },
     { "vectors",    no_argument,       NULL, 'm' },
+    { "procs",      required_argument, NULL, 'n' },
     { "outfile",    required_argument, NULL, 'o' },
     { "png",        no_argument,       NULL, 'p' },
+    { "profile",    required_argument, NULL, 'q' },
     { "filterfile", required_argument, NULL, 'r' },
     { "summary",    no_argument,       NULL, 's' },
     { "maxtrans",   required_argument, NULL, 't' },
@@ -43,11 +51,21 @@ int pe_parse_options(int argc, char * const argv[], PeOptions *options)
         options->data_path = optarg;
         break;
 
+      case 'b':
+        if(sscanf(optarg, "%lu", &options->budget.max_vector_bytes) != 1)
+        {
+          fprintf(stderr, "error: could not convert memory limit '%s' to an "
+                  "integer\n", optarg);
+          exit(1);
+        }
+        options->budget.max_vector_bytes *= 1024 * 1024;
+        break;
+
       case 'c':
-        if( sscanf(optarg, "%d", &options->complimit) == EOF )
+        if(sscanf(optarg, "%lu", &options->budget.max_cliques) != 1)
         {
-          fprintf(stderr, "error: could not convert comparison limit '%s' to "
-                  "an integer", optarg);
+          fprintf(stderr, "error: could not convert clique limit '%s' to an "
+                  "integer\n", optarg);
           exit(1);
         }
         break;
@@ -56,6 +74,10 @@ int pe_parse_options(int argc, char * const argv[], PeOptions *options)
         options->debug = true;
         break;
 
+      case 'e':
+        options->fast = true;
+        break;
+
       case 'f':
         if( strcmp(optarg,  "csv") != 0 &&
             strcmp(optarg, "text") != 0 &&
@@ -78,14 +100,47 @@ int pe_parse_options(int argc, char * const argv[], PeOptions *options)
         exit(0);
         break;
 
+      case 'i':
+        if(sscanf(optarg, "%lf", &options->budget.max_seconds) != 1 ||
+           options->budget.max_seconds < 0.0)
+        {
+          fprintf(stderr, "error: invalid time limit '%s'\n", optarg);
+          exit(1);
+        }
+        break;
+
+      case 'j':
+        if(sscanf(optarg, "%lu/%lu", &options->shard,
+                  &options->numshards) != 2 ||
+           options->shard < 1 || options->shard > options->numshards)
+        {
+          fprintf(stderr, "error: invalid shard '%s'; expected i/N with "
+                  "1 <= i <= N\n", optarg);
+          exit(1);
+        }
+        break;
+
       case 'k':
         makefilter = true;
         break;
 
+      case 'l':
+        options->seqidsfile = optarg;
+        break;
+
       case 'm':
         options->vectors = true;
         break;
 
+      case 'n':
+        if(sscanf(optarg, "%lu", &options->procs) != 1 || options->procs == 0)
+        {
+          fprintf(stderr, "error: invalid number of processes '%s'\n",
+                  optarg);
+          exit(1);
+        }
+        break;
+
       case 'o':
         options->outfilename = optarg;
         break;
@@ -99,6 +154,10 @@ int pe_parse_options(int argc, char * const argv[], PeOptions *options)
 #endif
         break;
 
+      case 'q':
+        options->profilefile = optarg;
+        break;
+
       case 'r':
         options->usefilter = true;
         options->filterfile = optarg;
@@ -174,14 +233,51 @@ int pe_parse_options(int argc, char * const argv[], PeOptions *options)
     exit(0);
   }
 
-  if(argc - optind != 2)
+  if(argc - optind < 2)
   {
-    fprintf( stderr, "error: must provide 2 (and only 2) input files, you provided %d\n\n",
-             argc - optind );
+    fprintf( stderr, "error: must provide a reference and at least one "
+             "prediction, you provided %d input files\n\n", argc - optind );
     pe_print_usage();
     exit(1);
   }
 
+  // Partial results are written in binary form to be merged later
+  if(options->numshards > 0 || options->seqidsfile != NULL)
+  {
+    if(options->numshards == 0)
+    {
+      options->shard = 1;
+      options->numshards = 1;
+    }
+    if(strcmp(options->outfmt, "text") != 0 || argc - optind != 2)
+    {
+      fputs("error: partial results require text output and a single "
+            "prediction\n\n", stderr);
+      pe_print_usage();
+      exit(1);
+    }
+    options->summary_only = true;
+  }
+
+  // Several predictions are compared side by side in a single summary
+  options->numpreds = argc - optind - 1;
+  if(options->numpreds > 1)
+  {
+    if(strcmp(options->outfmt, "text") != 0)
+    {
+      fputs("error: comparing multiple predictions requires text output\n\n",
+            stderr);
+      pe_print_usage();
+      exit(1);
+    }
+    if(!options->summary_only)
+    {
+      fputs("warning: comparing multiple predictions; only printing summary "
+            "statistics\n", stderr);
+      options->summary_only = true;
+    }
+  }
+
   if(strcmp(options->outfilename, "STDOUT") != 0)
   {
     if(strcmp(options->outfmt, "html") == 0)
@@ -298,22 +394,36 @@ int pe_parse_options(int argc, char * const argv[], PeOptions *options)
       options->filters.MaxPredictionTranscriptModels = options->trans_per_locus;
     }
   }
+  agn_compare_filters_compile(&options->filters);
 
   options->refrfile = argv[optind];
   options->predfile = argv[optind + 1];
+  options->predfiles = (const char **)argv + optind + 1;
   return optind;
 }
 
 void pe_print_usage()
 {
-  fprintf(stderr, "Usage: parseval [options] reference prediction\n"
+  fprintf(stderr, "Usage: parseval [options] reference prediction [pred2 ...]\n"
+"  Given several predictions, the reference is loaded once and compared to\n"
+"  each prediction in turn; summary statistics for all predictions are\n"
+"  printed side by side (text output only)\n"
 "  Options:\n"
 "    -a|--datashare: STRING      Location from which to copy shared data for\n"
 "                                HTML output (if `make install' has not yet\n"
 "                                been run)\n"
-"    -c|--complimit: INT         Maximum number of comparisons per locus; set\n"
-"                                to 0 for no limit (default=512)\n"
+"    -b|--maxmemory: INT         Maximum memory, in MB, allocated for model\n"
+"                                vectors when analyzing a single locus; set\n"
+"                                to 0 for no limit (default=1024)\n"
+"    -c|--maxcliques: INT        Maximum number of transcript cliques\n"
+"                                enumerated from each annotation at a single\n"
+"                                locus; set to 0 for no limit (default=512);\n"
+"                                --complimit is accepted as an alias\n"
 "    -d|--debug:                 Print debugging messages\n"
+"    -e|--fast:                  Read input with AEGeAn's own GFF3 reader,\n"
+"                                which is faster than the default GenomeTools\n"
+"                                parser but keeps only the ID, Parent, and\n"
+"                                Name attributes\n"
 "    -f|--outformat: STRING      Indicate desired output format; possible\n"
 "                                options: 'csv', 'text', or 'html'\n"
 "                                (default='text'); in 'text' or 'csv' mode,\n"
@@ -322,13 +432,38 @@ void pe_print_usage()
 "    -g|--printgff3:             Include GFF3 output corresponding to each\n"
 "                                comparison\n"
 "    -h|--help:                  Print help message and exit\n"
+"    -i|--maxtime: SECONDS       Maximum time spent analyzing a single locus;\n"
+"                                set to 0 for no limit (default=0); results\n"
+"                                with a time limit depend on machine speed\n"
+"                                and load, and may differ between runs; a\n"
+"                                locus exceeding any of these limits is\n"
+"                                analyzed in degraded mode, considering only\n"
+"                                the longest transcript of each gene, and\n"
+"                                flagged in the report\n"
+"    -j|--shard: i/N             Analyze only the i-th of N shards of the\n"
+"                                sequences (1 <= i <= N), assigned in turn in\n"
+"                                sorted order, and write the partial summary\n"
+"                                to the output file in a binary format; use\n"
+"                                parseval-merge to combine the partial\n"
+"                                summaries of all N shards\n"
 "    -k|--makefilter             Create a default configuration file for\n"
 "                                filtering reported results\n"
+"    -l|--seqids: FILENAME       Analyze only the sequences listed in the\n"
+"                                given file (one per line); like --shard,\n"
+"                                writes a binary partial summary\n"
 "    -m|--vectors:               Print model vectors in output file\n"
+"    -n|--procs: INT             Number of processes with which to analyze\n"
+"                                loci; each sequence is analyzed in one of\n"
+"                                the processes, and output is the same as\n"
+"                                with a single process (default=1)\n"
 "    -o|--outfile: FILENAME      File/directory to which output will be\n"
 "                                written; default is the terminal (STDOUT)\n"
 "    -p|--png:                   Generate individual PNG graphics for each\n"
 "                                gene locus\n"
+"    -q|--profile: FILENAME      Write the time spent in each stage of the\n"
+"                                analysis of each locus to the given file,\n"
+"                                as tab-separated values, and print the\n"
+"                                slowest loci when done\n"
 "    -r|--filterfile: STRING     Use the indicated configuration file to\n"
 "                                filter reported results;\n"
 "    -s|--summary:               Only print summary statistics, do not print\n"
@@ -349,7 +484,9 @@ void pe_set_option_defaults(PeOptions *options)
   options->outfilename = "STDOUT";
   options->gff3 = false;
   options->verbose = false;
-  options->complimit = 512;
+  agn_locus_budget_init(&options->budget);
+  options->budget.max_cliques = 512;
+  options->budget.max_vector_bytes = 1024 * 1024 * 1024UL;
   options->summary_only = false;
   options->vectors = false;
   options->locus_graphics = false;
@@ -362,6 +499,15 @@ void pe_set_option_defaults(PeOptions *options)
   options->trans_per_locus = 32;
   options->refrlabel = "";
   options->predlabel = "";
+  options->predfiles = NULL;
+  options->numpreds = 0;
+  options->fast = false;
+  options->shard = 0;
+  options->numshards = 0;
+  options->seqidsfile = NULL;
+  options->procs = 1;
+  options->profilefile = NULL;
+  options->profile = NULL;
 }
 
 void pe_option_print(PeOptions *options, FILE *outstream)
@@ -371,7 +517,9 @@ void pe_option_print(PeOptions *options, FILE *outstream)
   fprintf(outstream, "outfilename=%s\n", options->outfilename);
   fprintf(outstream, "gff3=%d\n", options->gff3);
   fprintf(outstream, "verbose=%d\n", options->verbose);
-  fprintf(outstream, "complimit=%d\n", options->complimit);
+  fprintf(outstream, "maxtime=%.1lf\n", options->budget.max_seconds);
+  fprintf(outstream, "maxcliques=%lu\n", options->budget.max_cliques);
+  fprintf(outstream, "maxmemory=%lu\n", options->budget.max_vector_bytes);
   fprintf(outstream, "summary_only=%d\n", options->summary_only);
   fprintf(outstream, "vectors=%d\n", options->vectors);
   fprintf(outstream, "locus_graphics=%d\n", options->locus_graphics);
@@ -383,4 +531,10 @@ void pe_option_print(PeOptions *options, FILE *outstream)
   fprintf(outstream, "trans_per_locus=%d\n", options->trans_per_locus);
   fprintf(outstream, "refrlabel=%s\n", options->refrlabel);
   fprintf(outstream, "predlabel=%s\n", options->predlabel);
+  fprintf(outstream, "numpreds=%d\n", options->numpreds);
+  fprintf(outstream, "fast=%d\n", options->fast);
+  fprintf(outstream, "shard=%lu/%lu\n", options->shard, options->numshards);
+  fprintf(outstream, "seqidsfile=%s\n",
+          options->seqidsfile == NULL ? "" : options->seqidsfile);
+  fprintf(outstream, "procs=%lu\n", options->procs);
 }
@@ -1,15 +1,148 @@
+#include <ctype.h>
+#include <math.h>
+#include "AgnProcessPool.h"
+#include "AgnUtils.h"
 #include "PeProcedure.h"
 #include "PeReports.h"
 
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+// Seconds between progress reports in verbose mode
+#define PE_PROGRESS_INTERVAL 10.0
+
+// Progress of a comparative analysis, measured by the predicted cost of each
+// sequence (the sum of the estimated costs of its loci)
+typedef struct
+{
+  GtStrArray *seqids;
+  double *costs;
+  double totalcost;
+  double start;
+  double lastreport;
+} PeProgress;
+
+// Data shared by the worker processes of a parallel comparative analysis
+typedef struct
+{
+  AgnLocusIndex *locusindex;
+  GtStrArray *seqids;
+  GtArray *seqfiles;
+  GtArray *loci;
+  PeOptions *options;
+  PeProgress *progress;
+} PeParallelData;
+
+// Predicted cost of a sequence, for scheduling
+typedef struct
+{
+  double cost;
+  GtUword seqindex;
+} PeSequenceCost;
+
+// Result of analyzing a single sequence in a worker process
+typedef struct
+{
+  AgnCompEvaluation eval;
+  double seconds;
+} PeSequenceResult;
+
+
 //------------------------------------------------------------------------------
 // Prototype(s) for private function(s)
 //------------------------------------------------------------------------------
 
+/**
+ * @function Aggregate the comparison statistics of each locus of a sequence
+ * into ``seqeval``, printing a summary of each locus to the sequence's HTML
+ * file if necessary.
+ */
+static void pe_aggregate_sequence(AgnCompEvaluation *seqeval, GtArray *seqloci,
+                                  FILE *seqfile, GtHashmap *comp_evals,
+                                  GtHashmap *locus_summaries,
+                                  PeOptions *options);
+
+/**
+ * @function Perform comparative analysis of each locus of the given sequence,
+ * storing locus-level statistics in ``comp_evals`` and ``locus_summaries``.
+ * Returns 0 on success, or -1 after reporting any errors.
+ */
+static int pe_analyze_sequence(AgnLocusIndex *locusindex, const char *seqid,
+                               GtArray *seqloci, FILE *seqfile,
+                               GtHashmap *comp_evals,
+                               GtHashmap *locus_summaries, PeOptions *options,
+                               AgnLogger *logger);
+
 /**
  * @function FIXME
  */
 static void pe_check_filehandle_risk(GtUword numseqids);
 
+/**
+ * @function Compare two sequences by predicted cost, for sorting the most
+ * expensive first.
+ */
+static int pe_compare_cost(const void *p1, const void *p2);
+
+/**
+ * @function Collect the loci of each of the given sequences from the locus
+ * index, in the same order as the sequence IDs.
+ */
+static GtArray *pe_collect_loci(AgnLocusIndex *locusindex, GtStrArray *seqids,
+                                AgnLogger *logger);
+
+/**
+ * @function Predict the cost of analyzing each sequence from the estimated
+ * cost of each of its loci (see :c:func:`agn_gene_locus_estimate_cost`). Must
+ * be called before the loci are analyzed.
+ */
+static void pe_estimate_costs(PeProgress *progress, GtStrArray *seqids,
+                              GtArray *loci);
+
+/**
+ * @function Report the progress of a parallel analysis.
+ */
+static void pe_parallel_progress(AgnProcessPool *pool, void *data);
+
+/**
+ * @function Analyze and aggregate a single sequence in a worker process, with
+ * the sequence-level statistics and the time taken as the task's result.
+ */
+static int pe_parallel_task(GtUword task, FILE **streams, void *result,
+                            void *data);
+
+/**
+ * @function Print the number of sequences analyzed so far and an estimate of
+ * the time remaining, based on the predicted cost of the sequences analyzed so
+ * far and the time they took.
+ */
+static void pe_print_progress(PeProgress *progress, GtUword numdone,
+                              double donecost);
+
+/**
+ * @function Compare the predicted cost of each sequence with the time its
+ * analysis actually took, so that the cost model can be tuned: each sequence
+ * is reported in debug mode, and the overall fit in verbose mode.
+ */
+static void pe_report_costs(PeProgress *progress, const double *seconds,
+                            PeOptions *options);
+
+/**
+ * @function Report how often clique fingerprints allowed comparisons to be
+ * skipped, in verbose mode.
+ */
+static void pe_report_shortcuts(AgnCompEvaluation *overall_eval,
+                                PeOptions *options);
+
+/**
+ * @function Select the sequences to be analyzed in this run: those of the
+ * shard given with ``--shard`` and, if a ``--seqids`` file was given, those
+ * listed in it. Returns a new array, in the same order as ``seqids``.
+ */
+static GtStrArray *pe_select_seqids(GtStrArray *seqids, PeOptions *options,
+                                    AgnLogger *logger);
+
 
 //------------------------------------------------------------------------------
 // Method/function implementations
@@ -31,30 +164,16 @@ void pe_aggregate_results(AgnCompEvaluation *overall_eval,
   {
     FILE *seqfile = *(FILE **)gt_array_get(seqfiles, i);
     AgnCompEvaluation seqeval;
-    agn_comp_evaluation_init(&seqeval);
-
-    int j;
     GtArray *seqloci = *(GtArray **)gt_array_get(loci, i);
-    for(j = 0; j < gt_array_size(seqloci); j++)
-    {
-      AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(seqloci, j);
-      AgnCompEvaluation *eval = gt_hashmap_get(comp_evals, locus);
-      agn_comp_evaluation_combine(&seqeval, eval);
-      agn_comp_evaluation_combine(overall_eval, eval);
-      AgnGeneLocusSummary *locsum = gt_hashmap_get(locus_summaries, locus);
-      // FIXME Should this block be placed elsewhere?
-      if(strcmp(options->outfmt, "html") == 0 && !options->summary_only)
-      {
-        pe_print_locus_to_seqfile(seqfile, locsum->start, locsum->end,
-                                  locsum->length, locsum->refrtrans,
-                                  locsum->predtrans, &locsum->counts);
-      }
-    }
+    pe_aggregate_sequence(&seqeval, seqloci, seqfile, comp_evals,
+                          locus_summaries, options);
+    agn_comp_evaluation_combine(overall_eval, &seqeval);
     gt_array_add(seqlevel_evals, seqeval);
     gt_array_delete(seqloci);
   }
 
   *seqlevel_evalsp = seqlevel_evals;
+  pe_report_shortcuts(overall_eval, options);
 
   gt_timer_stop(timer);
   gt_timer_show_formatted(timer, "[ParsEval] Finished aggregating locus-"
@@ -62,6 +181,79 @@ void pe_aggregate_results(AgnCompEvaluation *overall_eval,
   gt_timer_delete(timer);
 }
 
+static void pe_aggregate_sequence(AgnCompEvaluation *seqeval, GtArray *seqloci,
+                                  FILE *seqfile, GtHashmap *comp_evals,
+                                  GtHashmap *locus_summaries,
+                                  PeOptions *options)
+{
+  agn_comp_evaluation_init(seqeval);
+  GtUword j;
+  for(j = 0; j < gt_array_size(seqloci); j++)
+  {
+    AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(seqloci, j);
+    AgnCompEvaluation *eval = gt_hashmap_get(comp_evals, locus);
+    agn_comp_evaluation_combine(seqeval, eval);
+    AgnGeneLocusSummary *locsum = gt_hashmap_get(locus_summaries, locus);
+    // FIXME Should this block be placed elsewhere?
+    if(strcmp(options->outfmt, "html") == 0 && !options->summary_only)
+    {
+      pe_print_locus_to_seqfile(seqfile, locsum->start, locsum->end,
+                                locsum->length, locsum->refrtrans,
+                                locsum->predtrans, &locsum->counts);
+    }
+  }
+}
+
+static int pe_analyze_sequence(AgnLocusIndex *locusindex, const char *seqid,
+                               GtArray *seqloci, FILE *seqfile,
+                               GtHashmap *comp_evals,
+                               GtHashmap *locus_summaries, PeOptions *options,
+                               AgnLogger *logger)
+{
+  PeAnalysisData analysis_data;
+  analysis_data.seqfile = seqfile;
+  analysis_data.options = options;
+
+  GtUword j;
+  for(j = 0; j < gt_array_size(seqloci); j++)
+  {
+    AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(seqloci, j);
+    AgnCompEvaluation *compeval = gt_malloc( sizeof(AgnCompEvaluation) );
+    agn_comp_evaluation_init(compeval);
+    gt_hashmap_add(comp_evals, locus, compeval);
+    AgnGeneLocusSummary *locsum = gt_malloc( sizeof(AgnGeneLocusSummary) );
+    agn_gene_locus_summary_init(locsum);
+    gt_hashmap_add(locus_summaries, locus, locsum);
+  }
+  analysis_data.comp_evals = comp_evals;
+  analysis_data.locus_summaries = locus_summaries;
+
+  agn_locus_index_comparative_analysis(locusindex, seqid,
+                                   (AgnLocusIndexVisitFunc)pe_pre_analysis,
+                                   (AgnLocusIndexVisitFunc)pe_post_analysis,
+                                   &analysis_data, logger);
+  if(options->debug)
+    agn_logger_print_status(logger, stderr, "comparative analysis");
+  if(agn_logger_has_error(logger))
+  {
+    agn_logger_print_error(logger, stderr, "issues with comparative analysis "
+                           "of sequence '%s'", seqid);
+    return -1;
+  }
+  return 0;
+}
+
+static int pe_compare_cost(const void *p1, const void *p2)
+{
+  const PeSequenceCost *seq1 = p1;
+  const PeSequenceCost *seq2 = p2;
+  if(seq1->cost != seq2->cost)
+    return seq1->cost > seq2->cost ? -1 : 1;
+  if(seq1->seqindex != seq2->seqindex)
+    return seq1->seqindex < seq2->seqindex ? -1 : 1;
+  return 0;
+}
+
 static void pe_check_filehandle_risk(GtUword numseqids)
 {
   char *cmd = "ulimit -a | perl -ne 'if(m/\\(-n\\) (\\d+)/){ print $1 }'";
@@ -79,6 +271,22 @@ static void pe_check_filehandle_risk(GtUword numseqids)
   }
 }
 
+static GtArray *pe_collect_loci(AgnLocusIndex *locusindex, GtStrArray *seqids,
+                                AgnLogger *logger)
+{
+  GtArray *loci = gt_array_new( sizeof(GtArray *) );
+  GtUword i;
+  for(i = 0; i < gt_str_array_size(seqids); i++)
+  {
+    const char *seqid = gt_str_array_get(seqids, i);
+    pe_seqid_check(seqid, logger);
+
+    GtArray *seq_loci = agn_locus_index_get(locusindex, seqid);
+    gt_array_add(loci, seq_loci);
+  }
+  return loci;
+}
+
 void pe_comparative_analysis(AgnLocusIndex *locusindex, GtHashmap **comp_evalsp,
                              GtHashmap **locus_summariesp, GtStrArray *seqids,
                              GtArray *seqfiles, GtArray *loci,
@@ -94,42 +302,33 @@ void pe_comparative_analysis(AgnLocusIndex *locusindex, GtHashmap **comp_evalsp,
   locus_summaries = gt_hashmap_new(GT_HASH_DIRECT, NULL, (GtFree)gt_free_mem);
   comp_evals = gt_hashmap_new(GT_HASH_DIRECT, NULL, (GtFree)gt_free_mem);
 
-  int i, j;
+  PeProgress progress;
+  pe_estimate_costs(&progress, seqids, loci);
+  double *seconds = gt_calloc(gt_str_array_size(seqids) + 1, sizeof(double));
+  double donecost = 0.0;
+  int i;
   for(i = 0; i < gt_str_array_size(seqids); i++)
   {
     const char *seqid = gt_str_array_get(seqids, i);
     GtArray *seqloci = *(GtArray **)gt_array_get(loci, i);
-    PeAnalysisData analysis_data;
-    if(!options->summary_only)
-      analysis_data.seqfile = *(FILE **)gt_array_get(seqfiles, i);
-    analysis_data.options = options;
-
-    for(j = 0; j < gt_array_size(seqloci); j++)
+    FILE *seqfile = *(FILE **)gt_array_get(seqfiles, i);
+    double seqstart = agn_wallclock();
+    if(pe_analyze_sequence(locusindex, seqid, seqloci, seqfile, comp_evals,
+                           locus_summaries, options, logger))
     {
-      AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(seqloci, j);
-      AgnCompEvaluation *compeval = gt_malloc( sizeof(AgnCompEvaluation) );
-      agn_comp_evaluation_init(compeval);
-      gt_hashmap_add(comp_evals, locus, compeval);
-      AgnGeneLocusSummary *locsum = gt_malloc( sizeof(AgnGeneLocusSummary) );
-      agn_gene_locus_summary_init(locsum);
-      gt_hashmap_add(locus_summaries, locus, locsum);
+      exit(1);
     }
-    analysis_data.comp_evals = comp_evals;
-    analysis_data.locus_summaries = locus_summaries;
-
-    agn_locus_index_comparative_analysis(locusindex, seqid,
-                                     (AgnLocusIndexVisitFunc)pe_pre_analysis,
-                                     (AgnLocusIndexVisitFunc)pe_post_analysis,
-                                     &analysis_data, logger);
-    if(options->debug)
-      agn_logger_print_status(logger, stderr, "comparative analysis");
-    if(agn_logger_has_error(logger))
+    seconds[i] = agn_wallclock() - seqstart;
+    donecost += progress.costs[i];
+    if(options->verbose &&
+       seqstart + seconds[i] - progress.lastreport >= PE_PROGRESS_INTERVAL)
     {
-      agn_logger_print_error(logger, stderr, "issues with comparative analysis "
-                             "of sequence '%s'", seqid);
-      exit(1);
+      pe_print_progress(&progress, i + 1, donecost);
     }
   }
+  pe_report_costs(&progress, seconds, options);
+  gt_free(progress.costs);
+  gt_free(seconds);
 
   *comp_evalsp = comp_evals;
   *locus_summariesp = locus_summaries;
@@ -141,6 +340,27 @@ void pe_comparative_analysis(AgnLocusIndex *locusindex, GtHashmap **comp_evalsp,
   gt_timer_delete(timer);
 }
 
+static void pe_estimate_costs(PeProgress *progress, GtStrArray *seqids,
+                              GtArray *loci)
+{
+  GtUword numseqs = gt_str_array_size(seqids), i, j;
+  progress->seqids = seqids;
+  progress->costs = gt_calloc(numseqs + 1, sizeof(double));
+  progress->totalcost = 0.0;
+  for(i = 0; i < numseqs; i++)
+  {
+    GtArray *seqloci = *(GtArray **)gt_array_get(loci, i);
+    for(j = 0; j < gt_array_size(seqloci); j++)
+    {
+      AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(seqloci, j);
+      progress->costs[i] += agn_gene_locus_estimate_cost(locus);
+    }
+    progress->totalcost += progress->costs[i];
+  }
+  progress->start = agn_wallclock();
+  progress->lastreport = progress->start;
+}
+
 GtUword pe_load_and_parse_loci(AgnLocusIndex **locusindexp, GtArray **locip,
                                GtStrArray **seqidsp, PeOptions *options,
                                AgnLogger *logger)
@@ -151,23 +371,36 @@ GtUword pe_load_and_parse_loci(AgnLocusIndex **locusindexp, GtArray **locip,
 
   // Load loci into memory
   AgnLocusIndex *locusindex = agn_locus_index_new(false);
+  int flags = options->fast ? AGN_GFF3_MAPPED : AGN_GFF3_DEFAULT;
   GtUword total = agn_locus_index_parse_pairwise_disk(locusindex,
-                            options->refrfile, options->predfile,
+                            options->refrfile, options->predfile, flags,
                             &options->filters, logger);
 
   // Collect IDs of all sequences annotated by input files
-  GtStrArray *seqids = agn_locus_index_seqids(locusindex);
+  GtStrArray *allseqids = agn_locus_index_seqids(locusindex);
+  GtStrArray *seqids = pe_select_seqids(allseqids, options, logger);
   pe_check_filehandle_risk(gt_str_array_size(seqids));
-  GtArray *loci = gt_array_new( sizeof(GtArray *) );
-  int i;
-  for(i = 0; i < gt_str_array_size(seqids); i++)
-  {
-    const char *seqid = gt_str_array_get(seqids, i);
-    pe_seqid_check(seqid, logger);
+  GtArray *loci = pe_collect_loci(locusindex, seqids, logger);
 
-    GtArray *seq_loci = agn_locus_index_get(locusindex, seqid);
-    gt_array_sort(seq_loci,(GtCompare)agn_gene_locus_array_compare);
-    gt_array_add(loci, seq_loci);
+  // Loci of sequences outside this shard are not analyzed
+  GtUword i, j = 0;
+  for(i = 0; i < gt_str_array_size(allseqids); i++)
+  {
+    const char *seqid = gt_str_array_get(allseqids, i);
+    if(j < gt_str_array_size(seqids) &&
+       strcmp(seqid, gt_str_array_get(seqids, j)) == 0)
+    {
+      j++;
+      continue;
+    }
+    GtArray *seqloci = agn_locus_index_get(locusindex, seqid);
+    total -= gt_array_size(seqloci);
+    while(gt_array_size(seqloci) > 0)
+    {
+      AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_pop(seqloci);
+      agn_gene_locus_delete(locus);
+    }
+    gt_array_delete(seqloci);
   }
 
   *locusindexp = locusindex;
@@ -181,9 +414,250 @@ GtUword pe_load_and_parse_loci(AgnLocusIndex **locusindexp, GtArray **locip,
   return total;
 }
 
+GtArray *pe_multi_comparative_analysis(PeOptions *options, AgnLogger *logger)
+{
+  GtTimer *timer = gt_timer_new();
+  gt_timer_start(timer);
+  fprintf(stderr, "[ParsEval] Begin comparing %d predictions\n",
+          options->numpreds);
+
+  // The reference is loaded once and its genes are shared by the loci of
+  // every prediction
+  int flags = options->fast ? AGN_GFF3_MAPPED : AGN_GFF3_DEFAULT;
+  GtFeatureIndex *refrfeats = agn_import_canonical(1, &options->refrfile,
+                                                   flags, logger);
+  if(agn_logger_has_error(logger))
+  {
+    gt_feature_index_delete(refrfeats);
+    gt_timer_delete(timer);
+    return NULL;
+  }
+
+  GtArray *evals = gt_array_new( sizeof(AgnCompEvaluation) );
+  int i;
+  for(i = 0; i < options->numpreds; i++)
+  {
+    options->predfile = options->predfiles[i];
+    fprintf(stderr, "[ParsEval] Comparing prediction %d: %s\n", i + 1,
+            options->predfile);
+    GtFeatureIndex *predfeats = agn_import_canonical(1, &options->predfile,
+                                                     flags, logger);
+    AgnLocusIndex *locusindex = agn_locus_index_new(false);
+    GtUword totalloci = 0;
+    if(!agn_logger_has_error(logger))
+    {
+      totalloci = agn_locus_index_parse_pairwise_memory(locusindex, refrfeats,
+                                                        predfeats,
+                                                        &options->filters,
+                                                        logger);
+    }
+    if(agn_logger_has_error(logger))
+    {
+      agn_locus_index_delete(locusindex);
+      gt_feature_index_delete(predfeats);
+      gt_feature_index_delete(refrfeats);
+      gt_array_delete(evals);
+      gt_timer_delete(timer);
+      return NULL;
+    }
+
+    AgnCompEvaluation overall_eval;
+    agn_comp_evaluation_init(&overall_eval);
+    if(totalloci == 0)
+    {
+      fprintf(stderr, "[ParsEval] Warning: found no loci to analyze for "
+              "prediction '%s'\n", options->predfile);
+    }
+    else
+    {
+      GtHashmap *comp_evals, *locus_summaries;
+      GtArray *seqlevel_evals;
+      GtStrArray *seqids = agn_locus_index_seqids(locusindex);
+      GtArray *loci = pe_collect_loci(locusindex, seqids, logger);
+      GtArray *seqfiles = pe_prep_output(seqids, options);
+      if(options->procs > 1)
+      {
+        pe_parallel_analysis(locusindex, &overall_eval, &seqlevel_evals,
+                             seqids, seqfiles, loci, options);
+      }
+      else
+      {
+        pe_comparative_analysis(locusindex, &comp_evals, &locus_summaries,
+                                seqids, seqfiles, loci, options);
+        pe_aggregate_results(&overall_eval, &seqlevel_evals, loci, seqfiles,
+                             comp_evals, locus_summaries, options);
+        gt_hashmap_delete(comp_evals);
+        gt_hashmap_delete(locus_summaries);
+      }
+      gt_array_delete(seqfiles);
+      gt_array_delete(loci);
+      gt_array_delete(seqlevel_evals);
+    }
+    gt_array_add(evals, overall_eval);
+
+    agn_locus_index_delete(locusindex);
+    gt_feature_index_delete(predfeats);
+  }
+  gt_feature_index_delete(refrfeats);
+
+  gt_timer_stop(timer);
+  gt_timer_show_formatted(timer, "[ParsEval] Finished comparing predictions "
+                          "(%ld.%06ld seconds)\n", stderr);
+  gt_timer_delete(timer);
+  return evals;
+}
+
+void pe_parallel_analysis(AgnLocusIndex *locusindex,
+                          AgnCompEvaluation *overall_eval,
+                          GtArray **seqlevel_evalsp, GtStrArray *seqids,
+                          GtArray *seqfiles, GtArray *loci, PeOptions *options)
+{
+  GtTimer *timer = gt_timer_new();
+  gt_timer_start(timer);
+  fprintf(stderr, "[ParsEval] Begin comparative analysis (%lu processes)\n",
+          options->procs);
+
+  // Each sequence is analyzed and aggregated in a worker process; locus
+  // reports are written by the workers to the files of each sequence. The
+  // sequences predicted to be most expensive are started first, so that no
+  // single large sequence is left running alone at the end.
+  GtUword numseqs = gt_str_array_size(seqids), i, j;
+  PeProgress progress;
+  pe_estimate_costs(&progress, seqids, loci);
+  PeSequenceCost *schedule = gt_malloc( (numseqs + 1) *
+                                        sizeof(PeSequenceCost) );
+  for(i = 0; i < numseqs; i++)
+  {
+    schedule[i].cost = progress.costs[i];
+    schedule[i].seqindex = i;
+  }
+  qsort(schedule, numseqs, sizeof(PeSequenceCost), pe_compare_cost);
+  GtUword *order = gt_malloc( (numseqs + 1) * sizeof(GtUword) );
+  for(i = 0; i < numseqs; i++)
+    order[i] = schedule[i].seqindex;
+  gt_free(schedule);
+
+  PeParallelData data = { locusindex, seqids, seqfiles, loci, options,
+                          &progress };
+  AgnProcessPool *pool = agn_process_pool_new(options->procs, numseqs, 0,
+                                              sizeof(PeSequenceResult));
+  if(options->verbose)
+  {
+    agn_process_pool_set_progress(pool, pe_parallel_progress, &data,
+                                  PE_PROGRESS_INTERVAL);
+  }
+  GtError *error = gt_error_new();
+  if(agn_process_pool_run(pool, order, pe_parallel_task, &data, error))
+  {
+    fprintf(stderr, "[ParsEval] error: comparative analysis: %s\n",
+            gt_error_get(error));
+    exit(1);
+  }
+  gt_error_delete(error);
+
+  agn_comp_evaluation_init(overall_eval);
+  GtArray *seqlevel_evals = gt_array_new( sizeof(AgnCompEvaluation) );
+  double *seconds = gt_calloc(numseqs + 1, sizeof(double));
+  for(i = 0; i < numseqs; i++)
+  {
+    PeSequenceResult *result = agn_process_pool_result(pool, i);
+    agn_comp_evaluation_combine(overall_eval, &result->eval);
+    gt_array_add(seqlevel_evals, result->eval);
+    seconds[i] = result->seconds;
+
+    // Loci were analyzed (and freed) in the workers' copies of memory only
+    GtArray *seqloci = *(GtArray **)gt_array_get(loci, i);
+    for(j = 0; j < gt_array_size(seqloci); j++)
+      agn_gene_locus_delete(*(AgnGeneLocus **)gt_array_get(seqloci, j));
+    gt_array_delete(seqloci);
+  }
+  agn_process_pool_delete(pool);
+  *seqlevel_evalsp = seqlevel_evals;
+  pe_report_costs(&progress, seconds, options);
+  pe_report_shortcuts(overall_eval, options);
+  gt_free(progress.costs);
+  gt_free(seconds);
+  gt_free(order);
+
+  gt_timer_stop(timer);
+  gt_timer_show_formatted(timer, "[ParsEval] Finished comparative "
+                          "analysis (%ld.%06ld seconds)\n", stderr);
+  gt_timer_delete(timer);
+}
+
+static void pe_parallel_progress(AgnProcessPool *pool, void *data)
+{
+  PeParallelData *pdata = data;
+  GtUword numdone = 0, i;
+  double donecost = 0.0;
+  for(i = 0; i < gt_str_array_size(pdata->seqids); i++)
+  {
+    if(agn_process_pool_task_done(pool, i))
+    {
+      numdone++;
+      donecost += pdata->progress->costs[i];
+    }
+  }
+  pe_print_progress(pdata->progress, numdone, donecost);
+}
+
+static int pe_parallel_task(GtUword task, FILE **streams, void *result,
+                            void *data)
+{
+  PeParallelData *pdata = data;
+  PeSequenceResult *seqresult = result;
+  double start = agn_wallclock();
+  const char *seqid = gt_str_array_get(pdata->seqids, task);
+  GtArray *seqloci = *(GtArray **)gt_array_get(pdata->loci, task);
+  FILE *seqfile = *(FILE **)gt_array_get(pdata->seqfiles, task);
+  GtHashmap *comp_evals = gt_hashmap_new(GT_HASH_DIRECT, NULL,
+                                         (GtFree)gt_free_mem);
+  GtHashmap *locus_summaries = gt_hashmap_new(GT_HASH_DIRECT, NULL,
+                                              (GtFree)gt_free_mem);
+  AgnLogger *logger = agn_logger_new();
+  int status = pe_analyze_sequence(pdata->locusindex, seqid, seqloci, seqfile,
+                                   comp_evals, locus_summaries, pdata->options,
+                                   logger);
+  if(status == 0)
+  {
+    pe_aggregate_sequence(&seqresult->eval, seqloci, seqfile, comp_evals,
+                          locus_summaries, pdata->options);
+    if(seqfile != NULL)
+      fflush(seqfile);
+  }
+  agn_logger_delete(logger);
+  gt_hashmap_delete(comp_evals);
+  gt_hashmap_delete(locus_summaries);
+  seqresult->seconds = agn_wallclock() - start;
+  return status;
+}
+
 void pe_post_analysis(AgnGeneLocus *locus, PeAnalysisData *data)
 {
+  double reportstart = agn_wallclock();
+  if(data->options->debug)
+  {
+    fprintf(stderr, "debug: locus %s[%lu, %lu] predicted cost %.1lf, analyzed "
+            "in %.6lf seconds\n", agn_gene_locus_get_seqid(locus),
+            agn_gene_locus_get_start(locus), agn_gene_locus_get_end(locus),
+            data->locus_cost, agn_wallclock() - data->locus_start);
+  }
+
   AgnCompEvaluation *compeval = gt_hashmap_get(data->comp_evals, locus);
+  int overbudget = agn_gene_locus_budget_exceeded(locus);
+  if(overbudget)
+  {
+    compeval->counts.degraded_loci++;
+    if(data->options->verbose || data->options->debug)
+    {
+      fprintf(stderr, "warning: locus %s[%lu, %lu] exceeded its %s budget, "
+              "analyzed in degraded mode\n", agn_gene_locus_get_seqid(locus),
+              agn_gene_locus_get_start(locus), agn_gene_locus_get_end(locus),
+              overbudget & AGN_LOCUS_OVER_TIME    ? "time" :
+              overbudget & AGN_LOCUS_OVER_CLIQUES ? "clique" : "memory");
+    }
+  }
+
   GtArray *pairs = agn_gene_locus_pairs_to_report(locus);
   if(gt_array_size(pairs) > 0)
     agn_gene_locus_aggregate_results(locus, compeval);
@@ -220,37 +694,37 @@ void pe_post_analysis(AgnGeneLocus *locus, PeAnalysisData *data)
 #endif
   }
 
+  if(data->options->profile != NULL)
+  {
+    double now = agn_wallclock();
+    pe_print_locus_profile(locus, now - reportstart, now - data->locus_start,
+                           data->options->profile);
+  }
   agn_gene_locus_delete(locus);
 }
 
 void pe_pre_analysis(AgnGeneLocus *locus, PeAnalysisData *data)
 {
-  GtUword npairs = agn_gene_locus_num_clique_pairs(locus);
-  if(data->options->complimit != 0 && npairs > data->options->complimit)
-  {
-    if(data->options->debug)
-    {
-      fprintf(stderr, "debug: locus %s[%lu, %lu] contains %lu transcript (or "
-              "transcript clique) pairs, exceeds the limit of %d, moving on\n",
-              agn_gene_locus_get_seqid(locus), agn_gene_locus_get_start(locus),
-              agn_gene_locus_get_end(locus), npairs, data->options->complimit);
-    }
-  }
-  else
-  {
-    AgnCompEvaluation *compeval = gt_hashmap_get(data->comp_evals, locus);
-    compeval->counts.num_loci++;
-    compeval->counts.refr_genes += agn_gene_locus_num_refr_genes(locus);
-    compeval->counts.pred_genes += agn_gene_locus_num_pred_genes(locus);
-    GtUword rt = agn_gene_locus_num_refr_transcripts(locus);
-    GtUword pt = agn_gene_locus_num_pred_transcripts(locus);
-    compeval->counts.refr_transcripts += rt;
-    compeval->counts.pred_transcripts += pt;
-    if(agn_gene_locus_num_refr_genes(locus) == 0)
-      compeval->counts.unique_pred++;
-    else if(agn_gene_locus_num_pred_genes(locus) == 0)
-      compeval->counts.unique_refr++;
-  }
+  if(data->options->debug)
+    data->locus_cost = agn_gene_locus_estimate_cost(locus);
+  if(data->options->debug || data->options->profile != NULL)
+    data->locus_start = agn_wallclock();
+
+  agn_gene_locus_set_budget(locus, &data->options->budget);
+  agn_gene_locus_set_profiling(locus, data->options->profile != NULL);
+
+  AgnCompEvaluation *compeval = gt_hashmap_get(data->comp_evals, locus);
+  compeval->counts.num_loci++;
+  compeval->counts.refr_genes += agn_gene_locus_num_refr_genes(locus);
+  compeval->counts.pred_genes += agn_gene_locus_num_pred_genes(locus);
+  GtUword rt = agn_gene_locus_num_refr_transcripts(locus);
+  GtUword pt = agn_gene_locus_num_pred_transcripts(locus);
+  compeval->counts.refr_transcripts += rt;
+  compeval->counts.pred_transcripts += pt;
+  if(agn_gene_locus_num_refr_genes(locus) == 0)
+    compeval->counts.unique_pred++;
+  else if(agn_gene_locus_num_pred_genes(locus) == 0)
+    compeval->counts.unique_refr++;
 }
 
 GtArray *pe_prep_output(GtStrArray *seqids, PeOptions *options)
@@ -371,3 +845,123 @@ void pe_print_combine_output(GtStrArray *seqids, GtArray *seqfiles,
 
   gt_timer_delete(timer);
 }
+
+static void pe_print_progress(PeProgress *progress, GtUword numdone,
+                              double donecost)
+{
+  double now = agn_wallclock();
+  double elapsed = now - progress->start;
+  double fraction = progress->totalcost > 0.0 ?
+                    donecost / progress->totalcost : 0.0;
+  fprintf(stderr, "[ParsEval] Analyzed %lu of %lu sequences (%.1lf%% of "
+          "predicted cost) in %.0lf seconds", numdone,
+          gt_str_array_size(progress->seqids), fraction * 100.0, elapsed);
+  if(donecost > 0.0)
+  {
+    double remaining = elapsed * (progress->totalcost - donecost) / donecost;
+    fprintf(stderr, "; about %.0lf seconds remaining", remaining);
+  }
+  fputc('\n', stderr);
+  progress->lastreport = now;
+}
+
+static void pe_report_costs(PeProgress *progress, const double *seconds,
+                            PeOptions *options)
+{
+  GtUword numseqs = gt_str_array_size(progress->seqids), i;
+  double sumcost = 0.0, sumtime = 0.0, sumcost2 = 0.0, sumtime2 = 0.0;
+  double sumproduct = 0.0;
+  for(i = 0; i < numseqs; i++)
+  {
+    double cost = progress->costs[i];
+    if(options->debug)
+    {
+      fprintf(stderr, "debug: sequence '%s' predicted cost %.1lf, analyzed "
+              "in %.6lf seconds\n", gt_str_array_get(progress->seqids, i),
+              cost, seconds[i]);
+    }
+    sumcost += cost;
+    sumtime += seconds[i];
+    sumcost2 += cost * cost;
+    sumtime2 += seconds[i] * seconds[i];
+    sumproduct += cost * seconds[i];
+  }
+  if(!options->verbose || numseqs < 2 || sumcost == 0.0)
+    return;
+
+  // Correlation between predicted cost and time taken, over all sequences
+  double covariance = numseqs * sumproduct - sumcost * sumtime;
+  double varcost = numseqs * sumcost2 - sumcost * sumcost;
+  double vartime = numseqs * sumtime2 - sumtime * sumtime;
+  double correlation = varcost > 0.0 && vartime > 0.0 ?
+                       covariance / sqrt(varcost * vartime) : 0.0;
+  fprintf(stderr, "[ParsEval] Cost model: %.3lg seconds per unit of predicted "
+          "cost, correlation with time taken %.3lf over %lu sequences\n",
+          sumtime / sumcost, correlation, numseqs);
+}
+
+static void pe_report_shortcuts(AgnCompEvaluation *overall_eval,
+                                PeOptions *options)
+{
+  AgnCompSummary *counts = &overall_eval->counts;
+  if(options->verbose && counts->pairs_analyzed > 0)
+  {
+    double analyzed = (double)counts->pairs_analyzed;
+    fprintf(stderr, "[ParsEval] Analyzed %lu clique pairs; fingerprint "
+            "shortcuts: %lu exact (%.1f%%), %lu CDS only (%.1f%%)\n",
+            counts->pairs_analyzed,
+            counts->exact_shortcuts, counts->exact_shortcuts/analyzed * 100.0,
+            counts->cds_shortcuts,   counts->cds_shortcuts/analyzed * 100.0);
+  }
+}
+
+static GtStrArray *pe_select_seqids(GtStrArray *seqids, PeOptions *options,
+                                    AgnLogger *logger)
+{
+  GtHashmap *listed = NULL;
+  if(options->seqidsfile != NULL)
+  {
+    listed = gt_hashmap_new(GT_HASH_STRING, gt_free_func, NULL);
+    FILE *seqidsfile = agn_fopen(options->seqidsfile, "r", stderr);
+    char *line = NULL;
+    size_t linesize = 0;
+    ssize_t length;
+    while((length = getline(&line, &linesize, seqidsfile)) != -1)
+    {
+      while(length > 0 && isspace(line[length - 1]))
+        line[--length] = '\0';
+      if(length == 0 || line[0] == '#' || gt_hashmap_get(listed, line) != NULL)
+        continue;
+      char *seqid = gt_cstr_dup(line);
+      gt_hashmap_add(listed, seqid, seqid);
+    }
+    free(line);
+    fclose(seqidsfile);
+  }
+
+  // Sequences are assigned to shards in turn, in sorted order
+  GtStrArray *selected = gt_str_array_new();
+  GtUword i, count = 0;
+  for(i = 0; i < gt_str_array_size(seqids); i++)
+  {
+    const char *seqid = gt_str_array_get(seqids, i);
+    if(listed != NULL && gt_hashmap_get(listed, seqid) == NULL)
+      continue;
+    if(options->numshards == 0 ||
+       count++ % options->numshards == options->shard - 1)
+    {
+      gt_str_array_add_cstr(selected, seqid);
+    }
+  }
+  if(listed != NULL)
+    gt_hashmap_delete(listed);
+
+  if(options->numshards > 0)
+  {
+    agn_logger_log_status(logger, "shard %lu/%lu: analyzing %lu of %lu "
+                          "sequences", options->shard, options->numshards,
+                          gt_str_array_size(selected),
+                          gt_str_array_size(seqids));
+  }
+  return selected;
+}
@@ -19,12 +19,58 @@
 static void pe_feature_node_get_trimmed_id(const char *fid, char * buffer,
                                            size_t maxlength);
 
+/**
+ * @function Calculate derived statistics (sensitivity, specificity, etc) from
+ * the counts aggregated in the given evaluation.
+ */
+static void pe_comp_evaluation_resolve(AgnCompEvaluation *eval);
+
+/**
+ * @function Format each row of the side-by-side summary for the given
+ * evaluation, writing one value per row to ``cells``.
+ */
+static void pe_multi_summary_cells(AgnCompEvaluation *eval,
+                                   char cells[][PE_MULTI_CELL_LENGTH]);
+
 /**
  * @function Callback function for printing IDs for all transcripts belonging to
  * a transcript clique.
  */
 static void pe_print_transcript_id(GtFeatureNode *transcript, void *outstream);
 
+// One line of the per-locus profile, as needed for the summary of the slowest
+// loci
+typedef struct
+{
+  char seqid[256];
+  GtUword start;
+  GtUword end;
+  GtUword pairs;
+  int degraded;
+  double seconds[5];
+} PeProfileRecord;
+
+// Row labels of the side-by-side summary; blank labels separate sections
+static const char *pe_multi_summary_rows[] =
+{
+  "Gene loci", "  shared", "  unique to reference", "  unique to prediction",
+  "Prediction genes", "Prediction transcripts", "",
+  "Total comparisons", "  perfect matches", "  mislabeled UTRs",
+  "  CDS structure matches", "  exon structure matches",
+  "  UTR structure matches", "  non-matches", "",
+  "CDS structure Sn", "CDS structure Sp", "CDS structure F1",
+  "CDS structure AED", "Exon structure Sn", "Exon structure Sp",
+  "Exon structure F1", "Exon structure AED", "UTR structure Sn",
+  "UTR structure Sp", "UTR structure F1", "UTR structure AED", "",
+  "CDS nucleotide MC", "CDS nucleotide CC", "CDS nucleotide Sn",
+  "CDS nucleotide Sp", "CDS nucleotide F1", "CDS nucleotide AED",
+  "UTR nucleotide MC", "UTR nucleotide CC", "UTR nucleotide Sn",
+  "UTR nucleotide Sp", "UTR nucleotide F1", "UTR nucleotide AED",
+  "Overall identity",
+};
+#define PE_MULTI_SUMMARY_ROWS \
+        (sizeof(pe_multi_summary_rows) / sizeof(pe_multi_summary_rows[0]))
+
 
 //------------------------------------------------------------------------------
 // Method/function implementations
@@ -72,6 +118,30 @@ void pe_gene_locus_get_png_filename(AgnGeneLocus *locus, char *buffer,
            agn_gene_locus_get_start(locus), agn_gene_locus_get_end(locus) );
 }
 
+FILE *pe_profile_open(const char *filename)
+{
+  FILE *profile = fopen(filename, "w");
+  if(profile == NULL)
+  {
+    fprintf(stderr, "[ParsEval] error: cannot open profile '%s'\n", filename);
+    exit(1);
+  }
+  fputs("seqid\tstart\tend\tlength\trefr_transcripts\tpred_transcripts\t"
+        "refr_cliques\tpred_cliques\tpairs\tvector_bytes\tdegraded\t"
+        "clique_seconds\tvector_seconds\tpair_seconds\treport_seconds\t"
+        "total_seconds\n", profile);
+  fclose(profile);
+
+  profile = fopen(filename, "a");
+  if(profile == NULL)
+  {
+    fprintf(stderr, "[ParsEval] error: cannot open profile '%s'\n", filename);
+    exit(1);
+  }
+  setvbuf(profile, NULL, _IOLBF, 0);
+  return profile;
+}
+
 char *pe_get_start_time()
 {
   time_t start_time;
@@ -178,16 +248,15 @@ void pe_gene_locus_print_results(AgnGeneLocus *locus, FILE *outstream,
     fprintf(outstream, "     |  No comparisons were performed for this locus\n");
     fprintf(outstream, "     |\n");
   }
-  else if(options->complimit != 0 && npairs > options->complimit)
-  {
-    fprintf( outstream, "     |\n" );
-    fprintf( outstream, "     |  No comparisons were performed for this locus. The number "
-             "of transcript clique pairs (%lu) exceeds the limit of %d.\n",
-             npairs, options->complimit );
-    fprintf( outstream, "     |\n" );
-  }
   else
   {
+    if(agn_gene_locus_budget_exceeded(locus))
+    {
+      fprintf( outstream, "     |\n" );
+      fprintf( outstream, "     |  This locus exceeded its analysis budget and was analyzed in "
+               "degraded mode: only the longest transcript of each gene was compared.\n" );
+      fprintf( outstream, "     |\n" );
+    }
     GtUword k;
     GtArray *reported_pairs = agn_gene_locus_pairs_to_report(locus);
     GtUword pairs_to_report = gt_array_size(reported_pairs);
@@ -424,10 +493,7 @@ void pe_gene_locus_print_results_csv(AgnGeneLocus *locus, FILE *outstream, PeOpt
   for(i = 0; i < pairs_to_report; i++)
   {
     AgnCliquePair *pair = *(AgnCliquePair **)gt_array_get(reported_pairs, i);
-    GtUword npairs = agn_gene_locus_num_clique_pairs(locus);
-
-    if( !(options->complimit != 0 && npairs > options->complimit) &&
-        agn_clique_pair_needs_comparison(pair) )
+    if(agn_clique_pair_needs_comparison(pair))
     {
       GtUword j;
       GtArray *refr_ids = agn_gene_locus_refr_transcript_ids(locus);
@@ -532,39 +598,36 @@ void pe_gene_locus_print_results_html(AgnGeneLocus *locus, PeOptions *options)
            agn_gene_locus_get_end(locus) );
 
   GtUword npairs = agn_gene_locus_num_clique_pairs(locus);
-  if(options->complimit == 0 || npairs <= options->complimit)
+  fputs( "    <script type=\"text/javascript\""
+         " src=\"../vendor/mootools-core-1.3.2-full-nocompat-yc.js\"></script>\n"
+         "    <script type=\"text/javascript\" src=\"../vendor/mootools-more-1.3.2.1.js\"></script>\n"
+         "    <script type=\"text/javascript\">\n"
+         "window.addEvent('domready', function() {\n"
+         "  var status =\n"
+         "  {\n"
+         "    'true': \"(hide details)\",\n"
+         "    'false': \"(show details)\",\n"
+         "  }\n",
+         outstream);
+  GtUword i;
+  GtArray *reported_pairs = agn_gene_locus_pairs_to_report(locus);
+  for(i = 0; i < gt_array_size(reported_pairs); i++)
   {
-    fputs( "    <script type=\"text/javascript\""
-           " src=\"../vendor/mootools-core-1.3.2-full-nocompat-yc.js\"></script>\n"
-           "    <script type=\"text/javascript\" src=\"../vendor/mootools-more-1.3.2.1.js\"></script>\n"
-           "    <script type=\"text/javascript\">\n"
-           "window.addEvent('domready', function() {\n"
-           "  var status =\n"
-           "  {\n"
-           "    'true': \"(hide details)\",\n"
-           "    'false': \"(show details)\",\n"
-           "  }\n",
-           outstream);
-    GtUword i;
-    GtArray *reported_pairs = agn_gene_locus_pairs_to_report(locus);
-    for(i = 0; i < gt_array_size(reported_pairs); i++)
-    {
-      fprintf( outstream,
-               "  var compareWrapper%lu = new Fx.Slide('compare_wrapper_%lu');\n"
-               "  compareWrapper%lu.hide();\n"
-               "  $('toggle_compare_%lu').addEvent('click', function(event){\n"
-               "    event.stop();\n"
-               "    compareWrapper%lu.toggle();\n"
-               "  });\n"
-               "  compareWrapper%lu.addEvent('complete', function() {\n"
-               "    $('toggle_compare_%lu').set('text', status[compareWrapper%lu.open]);\n"
-               "  });\n",
-               i, i, i, i, i, i, i, i);
-    }
-    fputs( "});\n"
-           "    </script>\n",
-           outstream);
+    fprintf( outstream,
+             "  var compareWrapper%lu = new Fx.Slide('compare_wrapper_%lu');\n"
+             "  compareWrapper%lu.hide();\n"
+             "  $('toggle_compare_%lu').addEvent('click', function(event){\n"
+             "    event.stop();\n"
+             "    compareWrapper%lu.toggle();\n"
+             "  });\n"
+             "  compareWrapper%lu.addEvent('complete', function() {\n"
+             "    $('toggle_compare_%lu').set('text', status[compareWrapper%lu.open]);\n"
+             "  });\n",
+             i, i, i, i, i, i, i, i);
   }
+  fputs( "});\n"
+         "    </script>\n",
+         outstream);
 
   fprintf( outstream,
            "  </head>\n"
@@ -581,7 +644,6 @@ void pe_gene_locus_print_results_html(AgnGeneLocus *locus, PeOptions *options)
          outstream );
   GtArray *refr_genes = agn_gene_locus_refr_gene_ids(locus);
   GtArray *pred_genes = agn_gene_locus_pred_gene_ids(locus);
-  GtUword i;
   for(i = 0; i < gt_array_size(refr_genes) || i < gt_array_size(pred_genes); i++)
   {
     fputs("        <tr>", outstream);
@@ -687,15 +749,15 @@ void pe_gene_locus_print_results_html(AgnGeneLocus *locus, PeOptions *options)
   {
     // ???
   }
-  else if(options->complimit != 0 && npairs > options->complimit)
-  {
-    fprintf(outstream, "      <p>No comparisons were performed for this locus. The number "
-            "of transcript clique pairs (%lu) exceeds the limit of %d.</p>\n\n",
-            npairs, options->complimit );
-  }
   else
   {
     fputs("      <h2 class=\"bottomspace\">Comparisons</h2>\n", outstream);
+    if(agn_gene_locus_budget_exceeded(locus))
+    {
+      fputs("      <p>This locus exceeded its analysis budget and was analyzed in "
+            "degraded mode: only the longest transcript of each gene was "
+            "compared.</p>\n\n", outstream);
+    }
 
     GtUword k;
     GtArray *reported_pairs = agn_gene_locus_pairs_to_report(locus);
@@ -1034,6 +1096,79 @@ void pe_print_locus_to_seqfile(FILE *seqfile, GtUword start, GtUword end,
                     "        </tr>\n" );
 }
 
+void pe_print_locus_profile(AgnGeneLocus *locus, double report_seconds,
+                            double total_seconds, FILE *outstream)
+{
+  AgnLocusProfile profile = agn_gene_locus_get_profile(locus);
+  fprintf(outstream, "%s\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%d\t"
+          "%.6lf\t%.6lf\t%.6lf\t%.6lf\t%.6lf\n",
+          agn_gene_locus_get_seqid(locus), agn_gene_locus_get_start(locus),
+          agn_gene_locus_get_end(locus), agn_gene_locus_get_length(locus),
+          agn_gene_locus_num_refr_transcripts(locus),
+          agn_gene_locus_num_pred_transcripts(locus), profile.refr_cliques,
+          profile.pred_cliques, profile.pairs, profile.vector_bytes,
+          agn_gene_locus_budget_exceeded(locus), profile.clique_seconds,
+          profile.vector_seconds, profile.pair_seconds, report_seconds,
+          total_seconds);
+}
+
+void pe_print_profile_summary(const char *filename, GtUword numloci,
+                              FILE *outstream)
+{
+  FILE *instream = fopen(filename, "r");
+  if(instream == NULL || numloci == 0)
+  {
+    if(instream == NULL)
+      fprintf(stderr, "[ParsEval] error: cannot read profile '%s'\n", filename);
+    return;
+  }
+
+  // Keep the slowest loci seen so far, slowest first; the header line does not
+  // parse and is skipped
+  PeProfileRecord *slowest = gt_calloc(numloci, sizeof(PeProfileRecord));
+  GtUword count = 0, i;
+  char line[1024];
+  while(fgets(line, sizeof(line), instream) != NULL)
+  {
+    PeProfileRecord rec;
+    int n = sscanf(line, "%255s %lu %lu %*u %*u %*u %*u %*u %lu %*u %d %lf %lf "
+                   "%lf %lf %lf", rec.seqid, &rec.start, &rec.end, &rec.pairs,
+                   &rec.degraded, &rec.seconds[0], &rec.seconds[1],
+                   &rec.seconds[2], &rec.seconds[3], &rec.seconds[4]);
+    if(n != 10)
+      continue;
+    if(count < numloci)
+      count++;
+    else if(rec.seconds[4] <= slowest[count - 1].seconds[4])
+      continue;
+    for(i = count - 1; i > 0 && slowest[i-1].seconds[4] < rec.seconds[4]; i--)
+      slowest[i] = slowest[i-1];
+    slowest[i] = rec;
+  }
+  fclose(instream);
+
+  if(count > 0)
+  {
+    fprintf(outstream, "[ParsEval] Slowest loci (full profile in '%s')\n",
+            filename);
+    fprintf(outstream, "    %-32s %10s %10s %10s %10s %10s %8s\n", "locus",
+            "total", "cliques", "vectors", "pairs", "report", "#pairs");
+  }
+  for(i = 0; i < count; i++)
+  {
+    char locus[512];
+    sprintf(locus, "%s[%lu, %lu]%s", slowest[i].seqid, slowest[i].start,
+            slowest[i].end, slowest[i].degraded ? "*" : "");
+    fprintf(outstream, "    %-32s %10.3lf %10.3lf %10.3lf %10.3lf %10.3lf "
+            "%8lu\n", locus, slowest[i].seconds[4], slowest[i].seconds[0],
+            slowest[i].seconds[1], slowest[i].seconds[2], slowest[i].seconds[3],
+            slowest[i].pairs);
+  }
+  if(count > 0)
+    fputs("    (times in seconds; * analyzed in degraded mode)\n", outstream);
+  gt_free(slowest);
+}
+
 void pe_print_seqfile_header(FILE *outstream, const char *seqid)
 {
   fprintf( outstream,
@@ -1092,21 +1227,84 @@ void pe_print_seqfile_footer(FILE *outstream)
   fputs("</html>\n", outstream);
 }
 
+static void pe_comp_evaluation_resolve(AgnCompEvaluation *eval)
+{
+  // Calculate nucleotide-level statistics
+  agn_comp_stats_scaled_resolve(&eval->stats.cds_nuc_stats);
+  agn_comp_stats_scaled_resolve(&eval->stats.utr_nuc_stats);
+  eval->stats.overall_identity = (double)eval->stats.overall_matches /
+                                 (double)eval->stats.overall_length;
+
+  // Calculate structure-level statistics
+  agn_comp_stats_binary_resolve(&eval->stats.cds_struc_stats);
+  agn_comp_stats_binary_resolve(&eval->stats.exon_struc_stats);
+  agn_comp_stats_binary_resolve(&eval->stats.utr_struc_stats);
+}
+
+static void pe_multi_summary_cells(AgnCompEvaluation *eval,
+                                   char cells[][PE_MULTI_CELL_LENGTH])
+{
+  AgnCompSummary *counts = &eval->counts;
+  AgnComparison *stats = &eval->stats;
+  GtUword shared = counts->num_loci - counts->unique_refr - counts->unique_pred;
+  int i = 0;
+
+  sprintf(cells[i++], "%lu", counts->num_loci);
+  sprintf(cells[i++], "%lu", shared);
+  sprintf(cells[i++], "%u", counts->unique_refr);
+  sprintf(cells[i++], "%u", counts->unique_pred);
+  sprintf(cells[i++], "%lu", counts->pred_genes);
+  sprintf(cells[i++], "%lu", counts->pred_transcripts);
+  cells[i++][0] = '\0';
+
+  unsigned int matches[] = { counts->num_perfect, counts->num_mislabeled,
+                             counts->num_cds_match, counts->num_exon_match,
+                             counts->num_utr_match, counts->non_match };
+  GtUword j;
+  sprintf(cells[i++], "%u", counts->num_comparisons);
+  for(j = 0; j < sizeof(matches) / sizeof(matches[0]); j++)
+  {
+    double perc = counts->num_comparisons == 0 ? 0.0 :
+                  (double)matches[j] / (double)counts->num_comparisons * 100.0;
+    sprintf(cells[i++], "%u (%.1f%%)", matches[j], perc);
+  }
+  cells[i++][0] = '\0';
+
+  AgnCompStatsBinary *struc[] = { &stats->cds_struc_stats,
+                                  &stats->exon_struc_stats,
+                                  &stats->utr_struc_stats };
+  for(j = 0; j < 3; j++)
+  {
+    strcpy(cells[i++], struc[j]->sns);
+    strcpy(cells[i++], struc[j]->sps);
+    strcpy(cells[i++], struc[j]->f1s);
+    strcpy(cells[i++], struc[j]->eds);
+  }
+  cells[i++][0] = '\0';
+
+  AgnCompStatsScaled *nuc[] = { &stats->cds_nuc_stats, &stats->utr_nuc_stats };
+  for(j = 0; j < 2; j++)
+  {
+    strcpy(cells[i++], nuc[j]->mcs);
+    strcpy(cells[i++], nuc[j]->ccs);
+    strcpy(cells[i++], nuc[j]->sns);
+    strcpy(cells[i++], nuc[j]->sps);
+    strcpy(cells[i++], nuc[j]->f1s);
+    strcpy(cells[i++], nuc[j]->eds);
+  }
+  if(stats->overall_length == 0)
+    strcpy(cells[i++], "--");
+  else
+    sprintf(cells[i++], "%.3lf", stats->overall_identity);
+  gt_assert(i == PE_MULTI_SUMMARY_ROWS);
+}
+
 void pe_print_summary(const char *start_time, int argc, char * const argv[],
                       GtStrArray *seqids, AgnCompEvaluation *summary_data,
                       GtArray *seq_summary_data, FILE *outstream,
                       PeOptions *options)
 {
-  // Calculate nucleotide-level statistics
-  agn_comp_stats_scaled_resolve(&summary_data->stats.cds_nuc_stats);
-  agn_comp_stats_scaled_resolve(&summary_data->stats.utr_nuc_stats);
-  summary_data->stats.overall_identity = (double)summary_data->stats.overall_matches /
-                                    (double)summary_data->stats.overall_length;
-
-  // Calculate structure-level statistics
-  agn_comp_stats_binary_resolve(&summary_data->stats.cds_struc_stats);
-  agn_comp_stats_binary_resolve(&summary_data->stats.exon_struc_stats);
-  agn_comp_stats_binary_resolve(&summary_data->stats.utr_struc_stats);
+  pe_comp_evaluation_resolve(summary_data);
 
   if(strcmp(options->outfmt, "html") == 0)
   {
@@ -1155,8 +1353,14 @@ void pe_print_summary(const char *start_time, int argc, char * const argv[],
            summary_data->counts.num_loci - summary_data->counts.unique_refr - summary_data->counts.unique_pred );
   fprintf( outstream, "    unique to reference....................%d\n",
            summary_data->counts.unique_refr );
-  fprintf( outstream, "    unique to prediction...................%d\n\n",
+  fprintf( outstream, "    unique to prediction...................%d\n",
            summary_data->counts.unique_pred );
+  if(summary_data->counts.degraded_loci > 0)
+  {
+    fprintf( outstream, "    analyzed in degraded mode..............%lu\n",
+             summary_data->counts.degraded_loci );
+  }
+  fputs("\n", outstream);
 
   fprintf( outstream, "  Reference annotations\n" );
   fprintf( outstream, "    genes..................................%lu\n",
@@ -1428,6 +1632,68 @@ void pe_print_summary(const char *start_time, int argc, char * const argv[],
   fprintf(outstream, "\n\n\n");
 }
 
+void pe_print_summary_multi(const char *start_time, int argc,
+                            char * const argv[], GtArray *evals,
+                            FILE *outstream, PeOptions *options)
+{
+  GtUword numpreds = gt_array_size(evals);
+  char (*cells)[PE_MULTI_SUMMARY_ROWS][PE_MULTI_CELL_LENGTH];
+  cells = gt_malloc( numpreds * sizeof(*cells) );
+  GtUword i, j;
+  for(i = 0; i < numpreds; i++)
+  {
+    AgnCompEvaluation *eval = gt_array_get(evals, i);
+    pe_comp_evaluation_resolve(eval);
+    pe_multi_summary_cells(eval, cells[i]);
+  }
+
+  fprintf( outstream,
+           "============================================================\n");
+  fprintf( outstream, "========== ParsEval Summary\n");
+  fprintf( outstream,
+           "============================================================\n");
+  fprintf(outstream, "Started:                %s\n", start_time);
+  if(strcmp(options->refrlabel, "") != 0)
+    fprintf(outstream, "Reference annotations:  %s\n", options->refrlabel);
+  else
+    fprintf(outstream, "Reference annotations:  %s\n", options->refrfile);
+  for(i = 0; i < numpreds; i++)
+  {
+    fprintf(outstream, "Prediction [%lu]:         %s\n", i + 1,
+            options->predfiles[i]);
+  }
+  fprintf(outstream, "Executing command:      ");
+  int x;
+  for(x = 0; x < argc; x++)
+  {
+    fprintf(outstream, "%s ", argv[x]);
+  }
+  fprintf(outstream, "\n\n");
+
+  fprintf(outstream, "  %-28s", "");
+  for(i = 0; i < numpreds; i++)
+  {
+    char column[32];
+    sprintf(column, "[%lu]", i + 1);
+    fprintf(outstream, " %16s", column);
+  }
+  fputs("\n", outstream);
+  for(j = 0; j < PE_MULTI_SUMMARY_ROWS; j++)
+  {
+    if(pe_multi_summary_rows[j][0] == '\0')
+    {
+      fputs("\n", outstream);
+      continue;
+    }
+    fprintf(outstream, "  %-28s", pe_multi_summary_rows[j]);
+    for(i = 0; i < numpreds; i++)
+      fprintf(outstream, " %16s", cells[i][j]);
+    fputs("\n", outstream);
+  }
+  fprintf(outstream, "\n\n\n");
+  gt_free(cells);
+}
+
 void pe_print_summary_html(const char *start_time, int argc,
                            char * const argv[], GtStrArray *seqids,
                            AgnCompEvaluation *summary_data,
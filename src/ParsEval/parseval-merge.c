@@ -0,0 +1,154 @@
+#include <getopt.h>
+#include <string.h>
+#include "AgnUtils.h"
+#include "PeMerge.h"
+#include "PeOptions.h"
+#include "PeReports.h"
+
+typedef struct
+{
+  FILE *outstream;
+  const char *outfilename;
+  char **partialfiles;
+  int numfiles;
+} PeMergeOptions;
+
+/**
+ * Print the usage statement for parseval-merge
+ *
+ * @param[out] outstream    stream to which the statement will be written
+ */
+void print_usage(FILE *outstream)
+{
+  fputs("Usage: parseval-merge [options] partial1 [partial2 ...]\n"
+"  Combine the partial results written by 'parseval --shard' (or\n"
+"  'parseval --seqids') and print the summary that a single ParsEval run over\n"
+"  all sequences would print.\n"
+"  Options:\n"
+"     -h|--help               print this help message and exit\n"
+"     -o|--outfile: STRING    name of file to which the summary will be\n"
+"                             written; default is terminal (stdout)\n",
+        outstream);
+}
+
+int pe_merge_parse_options(int argc, char * const *argv,
+                           PeMergeOptions *options)
+{
+  int opt = 0;
+  int optindex = 0;
+  const char *optstr = "ho:";
+  const struct option init_options[] =
+  {
+    { "help",        no_argument,       NULL, 'h' },
+    { "outfile",     required_argument, NULL, 'o' },
+    { NULL,          no_argument,       NULL, 0 },
+  };
+
+  for(opt = getopt_long(argc, argv, optstr, init_options, &optindex);
+      opt != -1;
+      opt = getopt_long(argc, argv, optstr, init_options, &optindex))
+  {
+    switch(opt)
+    {
+      case 'h':
+        print_usage(stdout);
+        return -1;
+        break;
+
+      case 'o':
+        options->outfilename = optarg;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  options->numfiles = argc - optind;
+  if(options->numfiles < 1)
+  {
+    fprintf(stderr, "[ParsEvalMerge] error: must provide 1 or more partial "
+            "results files to merge\n\n");
+    print_usage(stderr);
+    return 1;
+  }
+  options->partialfiles = (char **)argv + optind;
+
+  if(options->outfilename != NULL)
+    options->outstream = agn_fopen(options->outfilename, "w", stderr);
+
+  return 0;
+}
+
+// Main method
+int main(int argc, char * const *argv)
+{
+  gt_lib_init();
+  PeMergeOptions mergeoptions = { stdout, NULL, NULL, 0 };
+  int code = pe_merge_parse_options(argc, argv, &mergeoptions);
+  if(code)
+  {
+    if(code < 1)
+      return 0;
+    else
+      return code;
+  }
+
+  // Load and combine partial results
+  GtError *error = gt_error_new();
+  GtArray *partials = gt_array_new( sizeof(PePartial *) );
+  PePartial *merged = NULL;
+  int i;
+  for(i = 0; i < mergeoptions.numfiles; i++)
+  {
+    PePartial *partial = pe_partial_read(mergeoptions.partialfiles[i], error);
+    if(partial == NULL)
+      break;
+    gt_array_add(partials, partial);
+  }
+  if(!gt_error_is_set(error))
+    merged = pe_partial_merge(partials, error);
+  if(merged == NULL)
+  {
+    fprintf(stderr, "[ParsEvalMerge] error: %s\n", gt_error_get(error));
+    code = EXIT_FAILURE;
+  }
+  else
+  {
+    // Summary printing relies on ParsEval's options
+    PeOptions options;
+    pe_set_option_defaults(&options);
+    options.outfile = mergeoptions.outstream;
+    options.summary_only = true;
+    options.refrfile = gt_str_get(merged->refrfile);
+    options.predfile = gt_str_get(merged->predfile);
+    options.refrlabel = gt_str_get(merged->refrlabel);
+    options.predlabel = gt_str_get(merged->predlabel);
+
+    char *start_time_str = pe_get_start_time();
+    GtArray *seqlevel_evals = gt_array_new( sizeof(AgnCompEvaluation) );
+    pe_print_summary(start_time_str, argc, argv, merged->seqids,
+                     &merged->eval, seqlevel_evals, options.outfile, &options);
+    gt_array_delete(seqlevel_evals);
+    gt_free(start_time_str);
+    pe_partial_delete(merged);
+  }
+
+  // Clean up
+  while(gt_array_size(partials) > 0)
+  {
+    PePartial *partial = *(PePartial **)gt_array_pop(partials);
+    pe_partial_delete(partial);
+  }
+  gt_array_delete(partials);
+  gt_error_delete(error);
+  if(mergeoptions.outstream != stdout)
+    fclose(mergeoptions.outstream);
+  if(gt_lib_clean() != 0)
+  {
+    fputs("error: issue cleaning GenomeTools library\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  return code;
+}
@@ -2,6 +2,7 @@
 #include "AgnLocusIndex.h"
 #include "AgnGeneLocus.h"
 #include "AgnUtils.h"
+#include "PeMerge.h"
 #include "PeProcedure.h"
 #include "PeReports.h"
 
@@ -24,8 +25,43 @@ int main(int argc, char * const argv[])
     return EXIT_FAILURE;
   }
 
-  // Load data into memory
+  if(options.profilefile != NULL)
+    options.profile = pe_profile_open(options.profilefile);
+
+  // Compare several predictions against a single copy of the reference
   AgnLogger *logger = agn_logger_new();
+  if(options.numpreds > 1)
+  {
+    GtArray *evals = pe_multi_comparative_analysis(&options, logger);
+    bool haderror = agn_logger_print_all(logger, stderr, NULL);
+    if(haderror || evals == NULL) return EXIT_FAILURE;
+    pe_print_summary_multi(start_time_str, argc, argv, evals, options.outfile,
+                           &options);
+    if(options.outfile != stdout)
+      fclose(options.outfile);
+    if(options.profile != NULL)
+    {
+      fclose(options.profile);
+      pe_print_profile_summary(options.profilefile, PE_PROFILE_TOP_LOCI,
+                               stderr);
+    }
+
+    gt_timer_stop(timer);
+    gt_timer_show_formatted(timer, "[ParsEval] ParsEval complete! (total "
+                            "runtime: %ld.%06ld seconds)\n\n", stderr );
+    gt_array_delete(evals);
+    gt_free(start_time_str);
+    agn_logger_delete(logger);
+    gt_timer_delete(timer);
+    if(gt_lib_clean() != 0)
+    {
+      fputs("error: issue cleaning GenomeTools library\n", stderr);
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  // Load data into memory
   AgnLocusIndex *locusindex;
   GtArray *loci;
   GtStrArray *seqids;
@@ -34,8 +70,9 @@ int main(int argc, char * const argv[])
   bool haderror = agn_logger_print_all(logger, stderr, NULL);
   if(haderror) return EXIT_FAILURE;
 
-  // Main comparison procedure
-  if(totalloci == 0)
+  // Main comparison procedure; a shard writes its partial results even if it
+  // has no loci, so that the merged results are complete
+  if(totalloci == 0 && options.numshards == 0)
   {
     fprintf(stderr, "[ParsEval] Warning: found no loci to analyze\n");
     fclose(options.outfile);
@@ -48,27 +85,55 @@ int main(int argc, char * const argv[])
     GtArray *         seqlevel_evals;
 
     GtArray *seqfiles = pe_prep_output(seqids, &options);
-    pe_comparative_analysis(locusindex, &comp_evals, &locus_summaries, seqids,
-                            seqfiles,loci, &options);
-    pe_aggregate_results(&overall_eval, &seqlevel_evals, loci, seqfiles,
-                         comp_evals, locus_summaries, &options);
-    pe_print_summary(start_time_str, argc, argv, seqids, &overall_eval,
-                     seqlevel_evals, options.outfile, &options);
+    if(options.procs > 1)
+    {
+      pe_parallel_analysis(locusindex, &overall_eval, &seqlevel_evals, seqids,
+                           seqfiles, loci, &options);
+    }
+    else
+    {
+      pe_comparative_analysis(locusindex, &comp_evals, &locus_summaries,
+                              seqids, seqfiles,loci, &options);
+      pe_aggregate_results(&overall_eval, &seqlevel_evals, loci, seqfiles,
+                           comp_evals, locus_summaries, &options);
+      gt_hashmap_delete(comp_evals);
+      gt_hashmap_delete(locus_summaries);
+    }
+    if(options.numshards > 0)
+    {
+      GtError *error = gt_error_new();
+      if(pe_partial_write(options.outfile, &options, seqids, &overall_eval,
+                          error))
+      {
+        fprintf(stderr, "[ParsEval] error: %s\n", gt_error_get(error));
+        return EXIT_FAILURE;
+      }
+      gt_error_delete(error);
+    }
+    else
+    {
+      pe_print_summary(start_time_str, argc, argv, seqids, &overall_eval,
+                       seqlevel_evals, options.outfile, &options);
+    }
     pe_print_combine_output(seqids, seqfiles, &options);
 
     gt_array_delete(seqfiles);
-    gt_hashmap_delete(comp_evals);
-    gt_hashmap_delete(locus_summaries);
     gt_array_delete(seqlevel_evals);
   }
 
   // All done!
+  if(options.profile != NULL)
+  {
+    fclose(options.profile);
+    pe_print_profile_summary(options.profilefile, PE_PROFILE_TOP_LOCI, stderr);
+  }
   gt_timer_stop(timer);
   gt_timer_show_formatted(timer, "[ParsEval] ParsEval complete! (total runtime:"
                           " %ld.%06ld seconds)\n\n", stderr );
 
   // Free up memory
   gt_array_delete(loci);
+  gt_str_array_delete(seqids);
   gt_free(start_time_str);
   agn_logger_delete(logger);
   agn_locus_index_delete(locusindex);
@@ -1,15 +1,27 @@
 #include <getopt.h>
 #include <string.h>
+#include "AgnBgzf.h"
 #include "AgnCanonGeneStream.h"
 #include "AgnFilterStream.h"
 #include "AgnGtExtensions.h"
+#include "AgnParallelStream.h"
+#include "AgnRegionIndex.h"
 #include "AgnUtils.h"
 
+// Number of genes that may be in flight per worker thread
+#define CANON_GFF3_JOBS_PER_THREAD 64
+
 typedef struct
 {
   FILE *outstream;
+  const char *outfilename;
+  AgnBgzfWriter *bgzf;
+  bool index;
+  GtUword maxmsgs;
   GtStr *source;
+  GtUword numthreads;
   bool read_stdin;
+  bool sorted;
   char **gff3files;
   int numfiles;
 } CanonGFF3Options;
@@ -24,11 +36,29 @@ void print_usage(FILE *outstream)
   fputs("Usage: canon-gff3 [options] gff3file1 [gff3file2 ...]\n"
 "  Options:\n"
 "     -h|--help               print this help message and exit\n"
+"     -m|--maxmsgs: INT       report at most this many status or warning\n"
+"                             messages of each kind; default is 100; set to\n"
+"                             0 to report all messages\n"
 "     -o|--outfile: STRING    name of file to which GFF3 data will be\n"
-"                             written; default is terminal (stdout)\n"
+"                             written; default is terminal (stdout); output\n"
+"                             is BGZF compressed if the name ends in .gz,\n"
+"                             using the number of threads given by -p\n"
+"     -p|--threads: INT       number of threads with which to process genes;\n"
+"                             input is parsed by a separate thread and output\n"
+"                             is written in input order; default is 1 (no\n"
+"                             separate threads); not available when\n"
+"                             GT_MEM_BOOKKEEPING=on\n"
+"     -r|--sorted             input is sorted, with ### separating genes;\n"
+"                             genes are processed as soon as they are read,\n"
+"                             and processing stops at the first feature out\n"
+"                             of order\n"
 "     -s|--source: STRING     reset the source of each feature to the given\n"
 "                             value\n"
-"     -t|--stdin              read input from terminal (stdin)\n",
+"     -t|--stdin              read input from terminal (stdin)\n"
+"     -x|--index              sort the output and write a coordinate index\n"
+"                             alongside it, for use with AgnRegionReader;\n"
+"                             requires BGZF output, and the index is written\n"
+"                             to the output file name plus '.agi'\n",
         outstream);
 }
 
@@ -37,13 +67,17 @@ int canon_gff3_parse_options(int argc, char * const *argv,
 {
   int opt = 0;
   int optindex = 0;
-  const char *optstr = "hko:s:t";
+  const char *optstr = "hkm:o:p:rs:tx";
   const struct option init_options[] =
   {
     { "help",        no_argument,       NULL, 'h' },
+    { "maxmsgs",     required_argument, NULL, 'm' },
     { "outfile",     required_argument, NULL, 'o' },
+    { "threads",     required_argument, NULL, 'p' },
+    { "sorted",      no_argument,       NULL, 'r' },
     { "source",      required_argument, NULL, 's' },
     { "stdin",       no_argument,       NULL, 't' },
+    { "index",       no_argument,       NULL, 'x' },
     { NULL,          no_argument,       NULL, 0 },
   };
 
@@ -58,8 +92,35 @@ int canon_gff3_parse_options(int argc, char * const *argv,
         return -1;
         break;
 
+      case 'm':
+        if(sscanf(optarg, "%lu", &options->maxmsgs) == EOF)
+        {
+          fprintf(stderr, "[CanonGFF3] error: could not convert max messages "
+                  "'%s' to an integer\n", optarg);
+          return 1;
+        }
+        break;
+
       case 'o':
-        options->outstream = agn_fopen(optarg, "w", stderr);
+        options->outfilename = optarg;
+        break;
+
+      case 'p':
+      {
+        char *end;
+        options->numthreads = strtoul(optarg, &end, 10);
+        if(*optarg < '0' || *optarg > '9' || *end != '\0' ||
+           options->numthreads == 0)
+        {
+          fprintf(stderr, "[CanonGFF3] error: number of threads must be a "
+                  "positive integer, not '%s'\n", optarg);
+          return 1;
+        }
+        break;
+      }
+
+      case 'r':
+        options->sorted = true;
         break;
 
       case 's':
@@ -70,6 +131,10 @@ int canon_gff3_parse_options(int argc, char * const *argv,
         options->read_stdin = true;
         break;
 
+      case 'x':
+        options->index = true;
+        break;
+
       default:
         break;
     }
@@ -97,6 +162,43 @@ int canon_gff3_parse_options(int argc, char * const *argv,
     }
   }
 
+  // GenomeTools' memory bookkeeping is not thread safe; see AgnParallelStream
+  const char *bookkeeping = getenv("GT_MEM_BOOKKEEPING");
+  if(options->numthreads > 1 && bookkeeping != NULL &&
+     strcmp(bookkeeping, "on") == 0)
+  {
+    fprintf(stderr, "[CanonGFF3] error: -p/--threads cannot be used with "
+            "GT_MEM_BOOKKEEPING=on\n");
+    return 1;
+  }
+
+  // Compression threads are only known once all options have been parsed
+  if(options->outfilename != NULL)
+  {
+    if(agn_bgzf_has_extension(options->outfilename))
+    {
+      GtError *error = gt_error_new();
+      options->bgzf = agn_bgzf_writer_new(options->outfilename,
+                                          options->numthreads, error);
+      if(options->bgzf == NULL)
+      {
+        fprintf(stderr, "[CanonGFF3] error: %s\n", gt_error_get(error));
+        gt_error_delete(error);
+        return 1;
+      }
+      gt_error_delete(error);
+      options->outstream = agn_bgzf_writer_stream(options->bgzf);
+    }
+    else
+      options->outstream = agn_fopen(options->outfilename, "w", stderr);
+  }
+  if(options->index && options->bgzf == NULL)
+  {
+    fprintf(stderr, "[CanonGFF3] error: indexing requires BGZF output; provide "
+            "an output file name ending in .gz\n");
+    return 1;
+  }
+
   // Create a char ** of the GFF3 filenames
   int x;
   if(options->numfiles > 0)
@@ -111,12 +213,26 @@ int canon_gff3_parse_options(int argc, char * const *argv,
   return 0;
 }
 
+/**
+ * Build the gene processing chain for each worker thread.
+ *
+ * @param[in] in_stream    input to the chain
+ * @param[in] data         the logger
+ * @returns                a canonical gene stream
+ */
+GtNodeStream *canon_gff3_chain(GtNodeStream *in_stream, void *data)
+{
+  AgnLogger *logger = data;
+  return agn_canon_gene_stream_new(in_stream, logger);
+}
+
 // Main method
 int main(int argc, char * const *argv)
 {
   // Options
   gt_lib_init();
-  CanonGFF3Options options = { stdout, NULL, false, NULL, 0 };
+  CanonGFF3Options options = { stdout, NULL, NULL, false, 100, NULL, 1, false,
+                                false, NULL, 0 };
   int code = canon_gff3_parse_options(argc, argv, &options);
   if(code)
   {
@@ -127,22 +243,44 @@ int main(int argc, char * const *argv)
   }
 
   // Create input and output streams to load, process, and write the data
-  AgnLogger *logger = agn_logger_new();
+  AgnLogger *logger = agn_logger_new_streaming(stderr, options.maxmsgs);
   GtFile *outfile = gt_file_new_from_fileptr(options.outstream);
 
   GtNodeStream *gff3in;
-  gff3in = gt_gff3_in_stream_new_unsorted(options.numfiles,
-                                          (const char **)options.gff3files);
-  gt_gff3_in_stream_check_id_attributes((GtGFF3InStream *)gff3in);
-  gt_gff3_in_stream_enable_tidy_mode((GtGFF3InStream *)gff3in);
-  GtNodeStream *cgstream = agn_canon_gene_stream_new(gff3in, logger);
-  GtNodeStream *nextstream = cgstream, *ssstream;
+  gff3in = agn_gff3_in_stream_new(options.numfiles,
+                                  (const char **)options.gff3files,
+                                  options.sorted ? AGN_GFF3_SORTED
+                                                 : AGN_GFF3_DEFAULT);
+  GtNodeStream *cgstream;
+  if(options.numthreads > 1)
+  {
+    GtUword queuesize = options.numthreads * CANON_GFF3_JOBS_PER_THREAD;
+    cgstream = agn_parallel_stream_new(gff3in, options.numthreads, queuesize,
+                                       canon_gff3_chain, logger,
+                                       agn_canon_gene_stream_created_types());
+  }
+  else
+    cgstream = agn_canon_gene_stream_new(gff3in, logger);
+  GtNodeStream *nextstream = cgstream, *ssstream, *sortstream = NULL;
   if(options.source != NULL)
   {
     GtNodeVisitor *ssv = gt_set_source_visitor_new(options.source);
     ssstream = gt_visitor_stream_new(cgstream, ssv);
     nextstream = ssstream;
   }
+
+  // The index requires sorted output; sorted input is already in order
+  AgnRegionIndex *regionindex = NULL;
+  if(options.index)
+  {
+    if(!options.sorted)
+    {
+      sortstream = gt_sort_stream_new(nextstream);
+      nextstream = sortstream;
+    }
+    regionindex = agn_region_index_new();
+    agn_region_index_attach(regionindex, options.bgzf);
+  }
   GtNodeStream *gff3out  = gt_gff3_out_stream_new(nextstream, outfile);
   gt_gff3_out_stream_retain_id_attributes((GtGFF3OutStream *)gff3out);
 
@@ -150,23 +288,55 @@ int main(int argc, char * const *argv)
   int result = gt_node_stream_pull(gff3out, error);
   if(result == -1)
   {
-    fprintf(stderr, "error processing node stream: %s", gt_error_get(error));
+    fprintf(stderr, "[CanonGFF3] error processing node stream: %s\n",
+            gt_error_get(error));
+    code = EXIT_FAILURE;
   }
   gt_node_stream_delete(gff3in);
   gt_node_stream_delete(cgstream);
   if(options.source != NULL)
     gt_node_stream_delete(ssstream);
+  if(sortstream != NULL)
+    gt_node_stream_delete(sortstream);
   gt_node_stream_delete(gff3out);
   gt_file_delete_without_handle(outfile);
   gt_error_delete(error);
 
   bool haderror = agn_logger_print_all(logger, stderr, "[CanonGFF3] processing "
                                        "annotation data");
-  if(haderror) return EXIT_FAILURE;
+  if(haderror)
+    code = EXIT_FAILURE;
   agn_logger_delete(logger);
 
-  // Clean up
-  fclose(options.outstream);
+  // Clean up; compressed output is finished even after an error, so that the
+  // records written so far form a valid file, but it is not indexed
+  if(options.bgzf != NULL)
+  {
+    error = gt_error_new();
+    if(agn_bgzf_writer_finish(options.bgzf, error))
+    {
+      fprintf(stderr, "[CanonGFF3] error: %s\n", gt_error_get(error));
+      code = EXIT_FAILURE;
+    }
+    else if(regionindex != NULL && code == 0)
+    {
+      GtStr *indexfile = gt_str_new_cstr(options.outfilename);
+      gt_str_append_cstr(indexfile, AGN_REGION_INDEX_SUFFIX);
+      if(agn_region_index_write(regionindex, gt_str_get(indexfile),
+                                options.bgzf, error))
+      {
+        fprintf(stderr, "[CanonGFF3] error: %s\n", gt_error_get(error));
+        code = EXIT_FAILURE;
+      }
+      gt_str_delete(indexfile);
+    }
+    gt_error_delete(error);
+    agn_bgzf_writer_delete(options.bgzf);
+  }
+  else
+    fclose(options.outstream);
+  if(regionindex != NULL)
+    agn_region_index_delete(regionindex);
   if(options.source != NULL)
     gt_str_delete(options.source);
   if(options.numfiles > 0)
@@ -182,5 +352,5 @@ int main(int argc, char * const *argv)
     return EXIT_FAILURE;
   }
 
-  return EXIT_SUCCESS;
+  return code;
 }
@@ -0,0 +1,1101 @@
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "AgnBgzf.h"
+
+// Largest compressed block, and the most uncompressed data placed in a block;
+// the latter leaves room for incompressible data to be stored uncompressed
+#define BGZF_MAX_BLOCK_SIZE   65536
+#define BGZF_MAX_DATA_SIZE    65280
+#define BGZF_HEADER_SIZE      18
+#define BGZF_FOOTER_SIZE      8
+
+// Number of blocks handed to each worker thread per batch when compressing
+#define BGZF_BLOCKS_PER_THREAD 16
+
+// Empty block marking the end of a BGZF file
+static const unsigned char bgzf_eof_block[28] =
+{
+  0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00,
+  0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00
+};
+
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+/**
+ * A single block of compressed input, along with the location of its
+ * decompressed data in the output buffer.
+ */
+typedef struct
+{
+  const unsigned char *data;
+  GtUword datasize;
+  unsigned long crc;
+  char *out;
+  GtUword outsize;
+} BgzfInflateBlock;
+
+/**
+ * A contiguous range of input blocks decompressed by a single thread.
+ */
+typedef struct
+{
+  BgzfInflateBlock *blocks;
+  GtUword numblocks;
+  bool success;
+  pthread_t thread;
+} BgzfInflateJob;
+
+/**
+ * A single block of uncompressed output, along with its compressed form.
+ */
+typedef struct
+{
+  char *data;
+  GtUword datasize;
+  unsigned char *block;
+  GtUword blocksize;
+} BgzfDeflateBlock;
+
+/**
+ * The blocks of a batch compressed by a single thread: every ``step``-th
+ * block, starting with block ``first``.
+ */
+typedef struct
+{
+  BgzfDeflateBlock *blocks;
+  GtUword numblocks;
+  GtUword first;
+  GtUword step;
+  bool success;
+  pthread_t thread;
+} BgzfDeflateJob;
+
+struct AgnBgzfReader
+{
+  char *filename;
+  FILE *file;
+  z_stream zs;
+  unsigned char *block;
+  char *data;
+  GtUword datasize;
+  GtUword datapos;
+  GtUword blockoffset;
+  GtUword nextoffset;
+};
+
+struct AgnBgzfWriter
+{
+  char *filename;
+  FILE *outfile;
+  FILE *stream;
+  int readfd;
+  GtUword numthreads;
+  pthread_t compressor;
+  bool running;
+  bool finished;
+  int errnum;
+  bool deflatefailed;
+
+  // Compressed offset of each block written, for virtual offsets
+  GtArray *blockoffsets;
+  GtUword compressedsize;
+
+  // Lines passed to the line function, along with any incomplete line at the
+  // end of the data read so far
+  AgnBgzfLineFunc linefunc;
+  void *linedata;
+  GtStr *partial;
+  GtUword partialoffset;
+  GtUword scanoffset;
+};
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+/**
+ * Compress a single block of data into the BGZF format.
+ *
+ * @param[in] zs       a raw deflate stream, reset before use
+ * @param[in] block    the block
+ * @returns            true on success, false otherwise
+ */
+static bool bgzf_deflate_block(z_stream *zs, BgzfDeflateBlock *block);
+
+/**
+ * Thread function compressing a subset of the blocks in a batch.
+ *
+ * @param[in] data    the job
+ * @returns           NULL
+ */
+static void *bgzf_deflate_job(void *data);
+
+/**
+ * Decompress a single BGZF block, checking its size and checksum.
+ *
+ * @param[in] zs       a raw inflate stream, reset before use
+ * @param[in] block    the block
+ * @returns            true on success, false otherwise
+ */
+static bool bgzf_inflate_block(z_stream *zs, BgzfInflateBlock *block);
+
+/**
+ * Thread function decompressing a contiguous range of blocks.
+ *
+ * @param[in] data    the job
+ * @returns           NULL
+ */
+static void *bgzf_inflate_job(void *data);
+
+/**
+ * Decompress gzip data that is not in the BGZF format, one member at a time.
+ *
+ * @param[in]  data         the compressed data
+ * @param[in]  length       length of the compressed data
+ * @param[out] outlength    length of the decompressed data
+ * @param[out] error        error object
+ * @returns                 the decompressed data, or NULL on error
+ */
+static char *bgzf_inflate_serial(const char *data, GtUword length,
+                                 GtUword *outlength, GtError *error);
+
+/**
+ * Read a little-endian 16-bit integer.
+ *
+ * @param[in] data    the data
+ * @returns           the integer
+ */
+static GtUword bgzf_read_le16(const unsigned char *data);
+
+/**
+ * Read a little-endian 32-bit integer.
+ *
+ * @param[in] data    the data
+ * @returns           the integer
+ */
+static unsigned long bgzf_read_le32(const unsigned char *data);
+
+/**
+ * Split gzip data into BGZF blocks. This only reads the block headers and
+ * footers, so it is cheap compared to decompressing the data.
+ *
+ * @param[in] data      the compressed data
+ * @param[in] length    length of the compressed data
+ * @returns             an array of blocks (with output locations unset), or
+ *                      NULL if the data is not entirely made up of BGZF
+ *                      blocks
+ */
+static GtArray *bgzf_scan_blocks(const char *data, GtUword length);
+
+/**
+ * Read and decompress the next block of a BGZF file.
+ *
+ * @param[in]  reader    the reader
+ * @param[out] error     error object
+ * @returns              1 if a block was read, 0 at the end of the file, -1
+ *                       on error (error object is set)
+ */
+static int bgzf_reader_read_block(AgnBgzfReader *reader, GtError *error);
+
+/**
+ * Resolve the number of threads to use, where 0 means one per processor.
+ *
+ * @param[in] numthreads    the requested number of threads
+ * @returns                 the number of threads to use
+ */
+static GtUword bgzf_thread_count(GtUword numthreads);
+
+/**
+ * Write a little-endian 16-bit integer.
+ *
+ * @param[out] data     location to which the integer is written
+ * @param[in]  value    the integer
+ */
+static void bgzf_write_le16(unsigned char *data, GtUword value);
+
+/**
+ * Write a little-endian 32-bit integer.
+ *
+ * @param[out] data     location to which the integer is written
+ * @param[in]  value    the integer
+ */
+static void bgzf_write_le32(unsigned char *data, unsigned long value);
+
+/**
+ * Thread function run in the background for the lifetime of the writer. It
+ * reads uncompressed data from the writer's pipe a batch at a time, has the
+ * batch compressed by worker threads while it reads the next batch, and
+ * writes the compressed blocks to the output file in order.
+ *
+ * @param[in] data    the writer
+ * @returns           NULL
+ */
+static void *bgzf_writer_compress(void *data);
+
+/**
+ * Read data from the writer's pipe into a batch of blocks, filling each block
+ * before moving to the next. Every block but the last in the file is filled
+ * completely, so the block holding a given uncompressed offset can be
+ * computed directly.
+ *
+ * @param[in] writer       the writer
+ * @param[in] blocks       the batch
+ * @param[in] numblocks    number of blocks in the batch
+ * @returns                number of blocks holding data (the batch is only
+ *                         partially filled at the end of the input)
+ */
+static GtUword bgzf_writer_fill(AgnBgzfWriter *writer,
+                                BgzfDeflateBlock *blocks, GtUword numblocks);
+
+/**
+ * Pass each complete line in a batch of blocks to the writer's line function,
+ * holding back any incomplete line at the end of the batch.
+ *
+ * @param[in] writer       the writer
+ * @param[in] blocks       the batch
+ * @param[in] numblocks    number of blocks holding data
+ */
+static void bgzf_writer_scan(AgnBgzfWriter *writer, BgzfDeflateBlock *blocks,
+                             GtUword numblocks);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+bool agn_bgzf_has_extension(const char *filename)
+{
+  GtUword length = strlen(filename);
+  return (length > 3 && strcmp(filename + length - 3, ".gz") == 0) ||
+         (length > 4 && strcmp(filename + length - 4, ".bgz") == 0);
+}
+
+char *agn_bgzf_inflate(const char *data, GtUword length, GtUword numthreads,
+                       GtUword *outlength, GtError *error)
+{
+  GtArray *blocks = bgzf_scan_blocks(data, length);
+  if(blocks == NULL)
+    return bgzf_inflate_serial(data, length, outlength, error);
+
+  // Block footers give the size of each block's decompressed data, so every
+  // block can be decompressed directly into its place in the output
+  GtUword i, numblocks = gt_array_size(blocks);
+  BgzfInflateBlock *blockarray = gt_array_get_space(blocks);
+  *outlength = 0;
+  for(i = 0; i < numblocks; i++)
+    *outlength += blockarray[i].outsize;
+  char *out = gt_malloc(*outlength + 1);
+  char *outpos = out;
+  for(i = 0; i < numblocks; i++)
+  {
+    blockarray[i].out = outpos;
+    outpos += blockarray[i].outsize;
+  }
+
+  numthreads = bgzf_thread_count(numthreads);
+  if(numthreads > numblocks)
+    numthreads = numblocks > 0 ? numblocks : 1;
+  BgzfInflateJob *jobs = gt_malloc(numthreads * sizeof(BgzfInflateJob));
+  GtUword started, first = 0;
+  for(i = 0; i < numthreads; i++)
+  {
+    GtUword last = numblocks * (i + 1) / numthreads;
+    jobs[i].blocks = blockarray + first;
+    jobs[i].numblocks = last - first;
+    jobs[i].success = false;
+    first = last;
+  }
+  for(started = 1; started < numthreads; started++)
+  {
+    BgzfInflateJob *job = jobs + started;
+    if(pthread_create(&job->thread, NULL, bgzf_inflate_job, job))
+      break;
+  }
+
+  // The calling thread handles the first range itself, along with any ranges
+  // for which a thread could not be created
+  bgzf_inflate_job(jobs);
+  for(i = 1; i < numthreads; i++)
+  {
+    if(i < started)
+      pthread_join(jobs[i].thread, NULL);
+    else
+      bgzf_inflate_job(jobs + i);
+  }
+
+  bool success = true;
+  for(i = 0; i < numthreads; i++)
+    success = success && jobs[i].success;
+  gt_free(jobs);
+  gt_array_delete(blocks);
+  if(!success)
+  {
+    gt_error_set(error, "invalid or corrupted BGZF data");
+    gt_free(out);
+    return NULL;
+  }
+  return out;
+}
+
+bool agn_bgzf_is_gzip(const char *data, GtUword length)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  return length >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b;
+}
+
+void agn_bgzf_reader_delete(AgnBgzfReader *reader)
+{
+  inflateEnd(&reader->zs);
+  fclose(reader->file);
+  gt_free(reader->filename);
+  gt_free(reader->block);
+  gt_free(reader->data);
+  gt_free(reader);
+}
+
+int agn_bgzf_reader_getline(AgnBgzfReader *reader, GtStr *line,
+                            GtError *error)
+{
+  gt_str_reset(line);
+  while(1)
+  {
+    if(reader->datapos == reader->datasize)
+    {
+      int status = bgzf_reader_read_block(reader, error);
+      if(status < 0)
+        return -1;
+      if(status == 0)
+        return gt_str_length(line) > 0 ? 1 : 0;
+      continue;
+    }
+
+    const char *start = reader->data + reader->datapos;
+    GtUword available = reader->datasize - reader->datapos;
+    const char *newline = memchr(start, '\n', available);
+    if(newline == NULL)
+    {
+      gt_str_append_cstr_nt(line, start, available);
+      reader->datapos = reader->datasize;
+      continue;
+    }
+
+    gt_str_append_cstr_nt(line, start, newline - start);
+    reader->datapos += newline - start + 1;
+    GtUword length = gt_str_length(line);
+    if(length > 0 && gt_str_get(line)[length - 1] == '\r')
+      gt_str_set_length(line, length - 1);
+    return 1;
+  }
+}
+
+AgnBgzfReader *agn_bgzf_reader_new(const char *filename, GtError *error)
+{
+  FILE *file = fopen(filename, "rb");
+  if(file == NULL)
+  {
+    gt_error_set(error, "could not open file \"%s\": %s", filename,
+                 strerror(errno));
+    return NULL;
+  }
+
+  AgnBgzfReader *reader = gt_malloc( sizeof(AgnBgzfReader) );
+  reader->filename = gt_cstr_dup(filename);
+  reader->file = file;
+  memset(&reader->zs, 0, sizeof(z_stream));
+  inflateInit2(&reader->zs, -15);
+  reader->block = gt_malloc(BGZF_MAX_BLOCK_SIZE);
+  reader->data = gt_malloc(BGZF_MAX_BLOCK_SIZE);
+  reader->datasize = 0;
+  reader->datapos = 0;
+  reader->blockoffset = 0;
+  reader->nextoffset = 0;
+  return reader;
+}
+
+int agn_bgzf_reader_seek(AgnBgzfReader *reader, GtUword voffset,
+                         GtError *error)
+{
+  GtUword blockoffset = voffset >> 16, datapos = voffset & 0xffff;
+  if(fseeko(reader->file, blockoffset, SEEK_SET) != 0)
+  {
+    gt_error_set(error, "could not seek in file \"%s\": %s",
+                 reader->filename, strerror(errno));
+    return -1;
+  }
+  reader->nextoffset = blockoffset;
+  reader->datasize = 0;
+  reader->datapos = 0;
+
+  int status = bgzf_reader_read_block(reader, error);
+  if(status < 0)
+    return -1;
+  if(datapos > reader->datasize)
+  {
+    gt_error_set(error, "file \"%s\": invalid virtual offset %lu",
+                 reader->filename, voffset);
+    return -1;
+  }
+  reader->datapos = datapos;
+  return 0;
+}
+
+GtUword agn_bgzf_reader_tell(AgnBgzfReader *reader)
+{
+  return (reader->blockoffset << 16) | reader->datapos;
+}
+
+void agn_bgzf_writer_delete(AgnBgzfWriter *writer)
+{
+  if(!writer->finished)
+  {
+    GtError *error = gt_error_new();
+    agn_bgzf_writer_finish(writer, error);
+    gt_error_delete(error);
+  }
+  gt_free(writer->filename);
+  gt_array_delete(writer->blockoffsets);
+  gt_str_delete(writer->partial);
+  gt_free(writer);
+}
+
+int agn_bgzf_writer_finish(AgnBgzfWriter *writer, GtError *error)
+{
+  if(writer->finished)
+    return 0;
+  writer->finished = true;
+
+  // Closing the write end of the pipe signals the end of the input
+  if(fclose(writer->stream) != 0 && writer->errnum == 0)
+    writer->errnum = errno;
+  writer->stream = NULL;
+  if(writer->running)
+    pthread_join(writer->compressor, NULL);
+  writer->running = false;
+  close(writer->readfd);
+
+  if(writer->errnum == 0 && !writer->deflatefailed &&
+     fwrite(bgzf_eof_block, 1, sizeof(bgzf_eof_block), writer->outfile) !=
+     sizeof(bgzf_eof_block))
+  {
+    writer->errnum = errno;
+  }
+  if(fclose(writer->outfile) != 0 && writer->errnum == 0)
+    writer->errnum = errno;
+  writer->outfile = NULL;
+
+  if(writer->deflatefailed)
+  {
+    gt_error_set(error, "could not compress data for file \"%s\"",
+                 writer->filename);
+    return -1;
+  }
+  if(writer->errnum != 0)
+  {
+    gt_error_set(error, "could not write file \"%s\": %s", writer->filename,
+                 strerror(writer->errnum));
+    return -1;
+  }
+  return 0;
+}
+
+AgnBgzfWriter *agn_bgzf_writer_new(const char *filename, GtUword numthreads,
+                                   GtError *error)
+{
+  FILE *outfile = fopen(filename, "wb");
+  if(outfile == NULL)
+  {
+    gt_error_set(error, "could not open file \"%s\": %s", filename,
+                 strerror(errno));
+    return NULL;
+  }
+
+  int fds[2];
+  if(pipe(fds) != 0)
+  {
+    gt_error_set(error, "could not create pipe for file \"%s\": %s", filename,
+                 strerror(errno));
+    fclose(outfile);
+    return NULL;
+  }
+
+  AgnBgzfWriter *writer = gt_malloc( sizeof(AgnBgzfWriter) );
+  writer->filename = gt_cstr_dup(filename);
+  writer->outfile = outfile;
+  writer->stream = fdopen(fds[1], "w");
+  writer->readfd = fds[0];
+  writer->numthreads = bgzf_thread_count(numthreads);
+  writer->running = false;
+  writer->finished = false;
+  writer->errnum = 0;
+  writer->deflatefailed = false;
+  writer->blockoffsets = gt_array_new( sizeof(GtUword) );
+  writer->compressedsize = 0;
+  writer->linefunc = NULL;
+  writer->linedata = NULL;
+  writer->partial = gt_str_new();
+  writer->partialoffset = 0;
+  writer->scanoffset = 0;
+
+  if(pthread_create(&writer->compressor, NULL, bgzf_writer_compress, writer))
+  {
+    gt_error_set(error, "could not create compression thread for file \"%s\"",
+                 filename);
+    agn_bgzf_writer_delete(writer);
+    return NULL;
+  }
+  writer->running = true;
+  return writer;
+}
+
+void agn_bgzf_writer_set_line_func(AgnBgzfWriter *writer,
+                                   AgnBgzfLineFunc linefunc, void *linedata)
+{
+  writer->linefunc = linefunc;
+  writer->linedata = linedata;
+}
+
+FILE *agn_bgzf_writer_stream(AgnBgzfWriter *writer)
+{
+  return writer->stream;
+}
+
+GtUword agn_bgzf_writer_virtual_offset(AgnBgzfWriter *writer,
+                                       GtUword uoffset)
+{
+  gt_assert(writer->finished);
+  GtUword blockindex = uoffset / BGZF_MAX_DATA_SIZE;
+  GtUword blockoffset = writer->compressedsize;
+  if(blockindex < gt_array_size(writer->blockoffsets))
+    blockoffset = *(GtUword *)gt_array_get(writer->blockoffsets, blockindex);
+  return (blockoffset << 16) | (uoffset % BGZF_MAX_DATA_SIZE);
+}
+
+static bool bgzf_deflate_block(z_stream *zs, BgzfDeflateBlock *block)
+{
+  GtUword maxsize = BGZF_MAX_BLOCK_SIZE - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE;
+  if(deflateReset(zs) != Z_OK)
+    return false;
+  zs->next_in = (Bytef *)block->data;
+  zs->avail_in = block->datasize;
+  zs->next_out = block->block + BGZF_HEADER_SIZE;
+  zs->avail_out = maxsize;
+  int status = deflate(zs, Z_FINISH);
+  GtUword compressedsize = zs->total_out;
+
+  // Data that does not compress is stored as is, which always fits
+  if(status != Z_STREAM_END)
+  {
+    z_stream stored;
+    memset(&stored, 0, sizeof(z_stream));
+    if(deflateInit2(&stored, Z_NO_COMPRESSION, Z_DEFLATED, -15, 8,
+                    Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      return false;
+    }
+    stored.next_in = (Bytef *)block->data;
+    stored.avail_in = block->datasize;
+    stored.next_out = block->block + BGZF_HEADER_SIZE;
+    stored.avail_out = maxsize;
+    status = deflate(&stored, Z_FINISH);
+    compressedsize = stored.total_out;
+    deflateEnd(&stored);
+    if(status != Z_STREAM_END)
+      return false;
+  }
+
+  unsigned char *header = block->block;
+  header[0] = 0x1f;
+  header[1] = 0x8b;
+  header[2] = 0x08;
+  header[3] = 0x04;
+  memset(header + 4, 0, 5);
+  header[9] = 0xff;
+  bgzf_write_le16(header + 10, 6);
+  header[12] = 'B';
+  header[13] = 'C';
+  bgzf_write_le16(header + 14, 2);
+  block->blocksize = BGZF_HEADER_SIZE + compressedsize + BGZF_FOOTER_SIZE;
+  bgzf_write_le16(header + 16, block->blocksize - 1);
+
+  unsigned char *footer = header + BGZF_HEADER_SIZE + compressedsize;
+  unsigned long crc = crc32(crc32(0L, Z_NULL, 0), (Bytef *)block->data,
+                            block->datasize);
+  bgzf_write_le32(footer, crc);
+  bgzf_write_le32(footer + 4, block->datasize);
+  return true;
+}
+
+static void *bgzf_deflate_job(void *data)
+{
+  BgzfDeflateJob *job = data;
+  z_stream zs;
+  memset(&zs, 0, sizeof(z_stream));
+  job->success = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+                              Z_DEFAULT_STRATEGY) == Z_OK;
+  if(!job->success)
+    return NULL;
+
+  GtUword i;
+  for(i = job->first; i < job->numblocks && job->success; i += job->step)
+    job->success = bgzf_deflate_block(&zs, job->blocks + i);
+  deflateEnd(&zs);
+  return NULL;
+}
+
+static bool bgzf_inflate_block(z_stream *zs, BgzfInflateBlock *block)
+{
+  if(inflateReset(zs) != Z_OK)
+    return false;
+  zs->next_in = (Bytef *)block->data;
+  zs->avail_in = block->datasize;
+  zs->next_out = (Bytef *)block->out;
+  zs->avail_out = block->outsize;
+  if(inflate(zs, Z_FINISH) != Z_STREAM_END || zs->total_out != block->outsize)
+    return false;
+
+  unsigned long crc = crc32(crc32(0L, Z_NULL, 0), (Bytef *)block->out,
+                            block->outsize);
+  return crc == block->crc;
+}
+
+static void *bgzf_inflate_job(void *data)
+{
+  BgzfInflateJob *job = data;
+  z_stream zs;
+  memset(&zs, 0, sizeof(z_stream));
+  job->success = inflateInit2(&zs, -15) == Z_OK;
+  if(!job->success)
+    return NULL;
+
+  GtUword i;
+  for(i = 0; i < job->numblocks && job->success; i++)
+    job->success = bgzf_inflate_block(&zs, job->blocks + i);
+  inflateEnd(&zs);
+  return NULL;
+}
+
+static char *bgzf_inflate_serial(const char *data, GtUword length,
+                                 GtUword *outlength, GtError *error)
+{
+  z_stream zs;
+  memset(&zs, 0, sizeof(z_stream));
+  if(inflateInit2(&zs, 15 + 16) != Z_OK)
+  {
+    gt_error_set(error, "could not initialize gzip decompression");
+    return NULL;
+  }
+
+  GtUword capacity = length * 4 + BGZF_MAX_BLOCK_SIZE;
+  GtUword consumed = 0;
+  char *out = gt_malloc(capacity);
+  *outlength = 0;
+  while(1)
+  {
+    // zlib counts bytes with 32-bit integers, so large inputs and outputs are
+    // handed over in pieces
+    if(zs.avail_in == 0)
+    {
+      GtUword chunk = length - consumed;
+      if(chunk > UINT_MAX)
+        chunk = UINT_MAX;
+      zs.next_in = (Bytef *)data + consumed;
+      zs.avail_in = chunk;
+      consumed += chunk;
+    }
+    if(*outlength + 1 >= capacity)
+    {
+      capacity *= 2;
+      out = gt_realloc(out, capacity);
+    }
+    GtUword space = capacity - *outlength - 1;
+    if(space > UINT_MAX)
+      space = UINT_MAX;
+    zs.next_out = (Bytef *)out + *outlength;
+    zs.avail_out = space;
+
+    int status = inflate(&zs, Z_NO_FLUSH);
+    *outlength += space - zs.avail_out;
+    if(status == Z_STREAM_END)
+    {
+      // Concatenated gzip files hold several members
+      if(zs.avail_in == 0 && consumed == length)
+        break;
+      inflateReset(&zs);
+    }
+    else if(status != Z_OK)
+    {
+      gt_error_set(error, "invalid or truncated gzip data");
+      inflateEnd(&zs);
+      gt_free(out);
+      return NULL;
+    }
+  }
+
+  inflateEnd(&zs);
+  return out;
+}
+
+static GtUword bgzf_read_le16(const unsigned char *data)
+{
+  return data[0] | ((GtUword)data[1] << 8);
+}
+
+static unsigned long bgzf_read_le32(const unsigned char *data)
+{
+  return data[0] | ((unsigned long)data[1] << 8) |
+         ((unsigned long)data[2] << 16) | ((unsigned long)data[3] << 24);
+}
+
+static GtArray *bgzf_scan_blocks(const char *data, GtUword length)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  GtArray *blocks = gt_array_new( sizeof(BgzfInflateBlock) );
+  GtUword offset = 0;
+  while(offset < length)
+  {
+    // BGZF headers have only the extra field flag set, and the extra field
+    // includes a 'BC' subfield holding the size of the block
+    const unsigned char *header = bytes + offset;
+    if(length - offset < BGZF_HEADER_SIZE || header[0] != 0x1f ||
+       header[1] != 0x8b || header[2] != 0x08 || header[3] != 0x04)
+    {
+      gt_array_delete(blocks);
+      return NULL;
+    }
+
+    GtUword extralength = bgzf_read_le16(header + 10);
+    GtUword headersize = 12 + extralength, blocksize = 0, i;
+    for(i = 12; i + 4 <= headersize && headersize <= length - offset;)
+    {
+      GtUword sublength = bgzf_read_le16(header + i + 2);
+      if(header[i] == 'B' && header[i + 1] == 'C' && sublength == 2)
+        blocksize = bgzf_read_le16(header + i + 4) + 1;
+      i += 4 + sublength;
+    }
+    if(blocksize < headersize + BGZF_FOOTER_SIZE ||
+       blocksize > length - offset)
+    {
+      gt_array_delete(blocks);
+      return NULL;
+    }
+
+    BgzfInflateBlock block;
+    const unsigned char *footer = header + blocksize - BGZF_FOOTER_SIZE;
+    block.data = header + headersize;
+    block.datasize = blocksize - headersize - BGZF_FOOTER_SIZE;
+    block.crc = bgzf_read_le32(footer);
+    block.out = NULL;
+    block.outsize = bgzf_read_le32(footer + 4);
+    gt_array_add(blocks, block);
+    offset += blocksize;
+  }
+  return blocks;
+}
+
+static int bgzf_reader_read_block(AgnBgzfReader *reader, GtError *error)
+{
+  size_t bytesread = fread(reader->block, 1, BGZF_HEADER_SIZE, reader->file);
+  if(bytesread == 0 && feof(reader->file))
+  {
+    reader->datasize = 0;
+    reader->datapos = 0;
+    return 0;
+  }
+
+  unsigned char *header = reader->block;
+  GtUword blocksize = bgzf_read_le16(header + 16) + 1;
+  if(bytesread != BGZF_HEADER_SIZE || header[0] != 0x1f || header[1] != 0x8b ||
+     header[3] != 0x04 || header[12] != 'B' || header[13] != 'C' ||
+     blocksize < BGZF_HEADER_SIZE + BGZF_FOOTER_SIZE)
+  {
+    gt_error_set(error, "file \"%s\": invalid BGZF block at offset %lu",
+                 reader->filename, reader->nextoffset);
+    return -1;
+  }
+  if(fread(reader->block + BGZF_HEADER_SIZE, 1, blocksize - BGZF_HEADER_SIZE,
+           reader->file) != blocksize - BGZF_HEADER_SIZE)
+  {
+    gt_error_set(error, "file \"%s\": truncated BGZF block at offset %lu",
+                 reader->filename, reader->nextoffset);
+    return -1;
+  }
+
+  BgzfInflateBlock block;
+  const unsigned char *footer = header + blocksize - BGZF_FOOTER_SIZE;
+  block.data = header + BGZF_HEADER_SIZE;
+  block.datasize = blocksize - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE;
+  block.crc = bgzf_read_le32(footer);
+  block.out = reader->data;
+  block.outsize = bgzf_read_le32(footer + 4);
+  if(block.outsize > BGZF_MAX_BLOCK_SIZE ||
+     !bgzf_inflate_block(&reader->zs, &block))
+  {
+    gt_error_set(error, "file \"%s\": corrupted BGZF block at offset %lu",
+                 reader->filename, reader->nextoffset);
+    return -1;
+  }
+
+  reader->blockoffset = reader->nextoffset;
+  reader->nextoffset += blocksize;
+  reader->datasize = block.outsize;
+  reader->datapos = 0;
+  return 1;
+}
+
+static GtUword bgzf_thread_count(GtUword numthreads)
+{
+  if(numthreads > 0)
+    return numthreads;
+  long numprocs = sysconf(_SC_NPROCESSORS_ONLN);
+  return numprocs > 0 ? numprocs : 1;
+}
+
+static void bgzf_write_le16(unsigned char *data, GtUword value)
+{
+  data[0] = value & 0xff;
+  data[1] = (value >> 8) & 0xff;
+}
+
+static void bgzf_write_le32(unsigned char *data, unsigned long value)
+{
+  data[0] = value & 0xff;
+  data[1] = (value >> 8) & 0xff;
+  data[2] = (value >> 16) & 0xff;
+  data[3] = (value >> 24) & 0xff;
+}
+
+static void *bgzf_writer_compress(void *data)
+{
+  AgnBgzfWriter *writer = data;
+  GtUword batchsize = writer->numthreads * BGZF_BLOCKS_PER_THREAD;
+  BgzfDeflateBlock *batches[2];
+  GtUword counts[2], i, j;
+  for(i = 0; i < 2; i++)
+  {
+    batches[i] = gt_malloc(batchsize * sizeof(BgzfDeflateBlock));
+    for(j = 0; j < batchsize; j++)
+    {
+      batches[i][j].data = gt_malloc(BGZF_MAX_DATA_SIZE);
+      batches[i][j].block = gt_malloc(BGZF_MAX_BLOCK_SIZE);
+    }
+  }
+  BgzfDeflateJob *jobs = gt_malloc(writer->numthreads *
+                                   sizeof(BgzfDeflateJob));
+
+  // Workers compress the current batch while this thread reads the next one
+  int current = 0;
+  counts[current] = bgzf_writer_fill(writer, batches[current], batchsize);
+  bgzf_writer_scan(writer, batches[current], counts[current]);
+  while(counts[current] > 0)
+  {
+    GtUword started;
+    for(i = 0; i < writer->numthreads; i++)
+    {
+      jobs[i].blocks = batches[current];
+      jobs[i].numblocks = counts[current];
+      jobs[i].first = i;
+      jobs[i].step = writer->numthreads;
+      jobs[i].success = false;
+    }
+    for(started = 0; started < writer->numthreads; started++)
+    {
+      BgzfDeflateJob *job = jobs + started;
+      if(pthread_create(&job->thread, NULL, bgzf_deflate_job, job))
+        break;
+    }
+    counts[!current] = bgzf_writer_fill(writer, batches[!current], batchsize);
+    bgzf_writer_scan(writer, batches[!current], counts[!current]);
+    for(i = 0; i < writer->numthreads; i++)
+    {
+      if(i < started)
+        pthread_join(jobs[i].thread, NULL);
+      else
+        bgzf_deflate_job(jobs + i);
+      writer->deflatefailed = writer->deflatefailed || !jobs[i].success;
+    }
+
+    // After an error, keep draining the pipe so the producer never blocks
+    for(i = 0; i < counts[current]; i++)
+    {
+      BgzfDeflateBlock *block = batches[current] + i;
+      if(writer->errnum != 0 || writer->deflatefailed)
+        break;
+      if(fwrite(block->block, 1, block->blocksize, writer->outfile) !=
+         block->blocksize)
+      {
+        writer->errnum = errno;
+      }
+      gt_array_add(writer->blockoffsets, writer->compressedsize);
+      writer->compressedsize += block->blocksize;
+    }
+    current = !current;
+  }
+
+  // A final line without a newline
+  if(writer->linefunc != NULL && gt_str_length(writer->partial) > 0)
+  {
+    writer->linefunc(gt_str_get(writer->partial),
+                     gt_str_length(writer->partial), writer->partialoffset,
+                     writer->linedata);
+  }
+
+  for(i = 0; i < 2; i++)
+  {
+    for(j = 0; j < batchsize; j++)
+    {
+      gt_free(batches[i][j].data);
+      gt_free(batches[i][j].block);
+    }
+    gt_free(batches[i]);
+  }
+  gt_free(jobs);
+  return NULL;
+}
+
+static GtUword bgzf_writer_fill(AgnBgzfWriter *writer,
+                                BgzfDeflateBlock *blocks, GtUword numblocks)
+{
+  GtUword i;
+  for(i = 0; i < numblocks; i++)
+  {
+    BgzfDeflateBlock *block = blocks + i;
+    block->datasize = 0;
+    while(block->datasize < BGZF_MAX_DATA_SIZE)
+    {
+      ssize_t bytesread = read(writer->readfd, block->data + block->datasize,
+                               BGZF_MAX_DATA_SIZE - block->datasize);
+      if(bytesread < 0 && errno == EINTR)
+        continue;
+      if(bytesread < 0 && writer->errnum == 0)
+        writer->errnum = errno;
+      if(bytesread <= 0)
+        return block->datasize > 0 ? i + 1 : i;
+      block->datasize += bytesread;
+    }
+  }
+  return numblocks;
+}
+
+static void bgzf_writer_scan(AgnBgzfWriter *writer, BgzfDeflateBlock *blocks,
+                             GtUword numblocks)
+{
+  if(writer->linefunc == NULL)
+    return;
+
+  GtUword i;
+  for(i = 0; i < numblocks; i++)
+  {
+    const char *data = blocks[i].data, *end = data + blocks[i].datasize;
+    while(data < end)
+    {
+      const char *newline = memchr(data, '\n', end - data);
+      if(newline == NULL)
+      {
+        if(gt_str_length(writer->partial) == 0)
+          writer->partialoffset = writer->scanoffset;
+        gt_str_append_cstr_nt(writer->partial, data, end - data);
+        writer->scanoffset += end - data;
+        break;
+      }
+
+      // Lines split across blocks are reassembled first
+      GtUword length = newline - data;
+      if(gt_str_length(writer->partial) > 0)
+      {
+        gt_str_append_cstr_nt(writer->partial, data, length);
+        writer->linefunc(gt_str_get(writer->partial),
+                         gt_str_length(writer->partial),
+                         writer->partialoffset, writer->linedata);
+        gt_str_reset(writer->partial);
+      }
+      else
+        writer->linefunc(data, length, writer->scanoffset, writer->linedata);
+      writer->scanoffset += length + 1;
+      data = newline + 1;
+    }
+  }
+}
+
+bool agn_bgzf_unit_test(AgnUnitTest *test)
+{
+  // Enough data for several blocks
+  GtStr *text = gt_str_new();
+  GtUword i;
+  char line[128];
+  for(i = 0; i < 10000; i++)
+  {
+    sprintf(line, "chr1\tAEGeAn\tgene\t%lu\t%lu\t.\t+\t.\tID=gene%lu\n",
+            i * 1000 + 1, i * 1000 + 500, i);
+    gt_str_append_cstr(text, line);
+  }
+
+  GtError *error = gt_error_new();
+  char filename[] = "/tmp/AgnBgzfTestXXXXXX";
+  int fd = mkstemp(filename);
+  bool roundtrippass = false;
+  if(fd >= 0)
+  {
+    close(fd);
+    AgnBgzfWriter *writer = agn_bgzf_writer_new(filename, 3, error);
+    if(writer != NULL)
+    {
+      fputs(gt_str_get(text), agn_bgzf_writer_stream(writer));
+      int had_err = agn_bgzf_writer_finish(writer, error);
+      agn_bgzf_writer_delete(writer);
+
+      FILE *instream = fopen(filename, "rb");
+      char *data = gt_malloc(gt_str_length(text) * 2);
+      GtUword length = fread(data, 1, gt_str_length(text) * 2, instream);
+      fclose(instream);
+      GtUword outlength;
+      char *out = agn_bgzf_inflate(data, length, 2, &outlength, error);
+      roundtrippass = !had_err && agn_bgzf_is_gzip(data, length) &&
+                      out != NULL && outlength == gt_str_length(text) &&
+                      memcmp(out, gt_str_get(text), outlength) == 0;
+      gt_free(data);
+      gt_free(out);
+    }
+    unlink(filename);
+  }
+  agn_unit_test_result(test, "BGZF round trip", roundtrippass);
+
+  // Plain gzip data, as written by gzip itself, is decompressed serially
+  z_stream zs;
+  memset(&zs, 0, sizeof(z_stream));
+  GtUword capacity = gt_str_length(text) + BGZF_MAX_BLOCK_SIZE;
+  char *data = gt_malloc(capacity);
+  deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+               Z_DEFAULT_STRATEGY);
+  zs.next_in = (Bytef *)gt_str_get(text);
+  zs.avail_in = gt_str_length(text);
+  zs.next_out = (Bytef *)data;
+  zs.avail_out = capacity;
+  deflate(&zs, Z_FINISH);
+  GtUword outlength, length = zs.total_out;
+  deflateEnd(&zs);
+  char *out = agn_bgzf_inflate(data, length, 2, &outlength, error);
+  bool gzippass = out != NULL && outlength == gt_str_length(text) &&
+                  memcmp(out, gt_str_get(text), outlength) == 0;
+  agn_unit_test_result(test, "gzip input", gzippass);
+  gt_free(out);
+
+  // Truncated data should be reported rather than silently accepted
+  out = agn_bgzf_inflate(data, length / 2, 2, &outlength, error);
+  bool truncpass = out == NULL && gt_error_is_set(error);
+  agn_unit_test_result(test, "truncated input", truncpass);
+  gt_free(out);
+  gt_free(data);
+
+  gt_error_delete(error);
+  gt_str_delete(text);
+  return roundtrippass && gzippass && truncpass;
+}
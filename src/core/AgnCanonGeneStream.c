@@ -12,6 +12,7 @@ struct AgnCanonGeneStream
   const GtNodeStream parent_instance;
   GtNodeStream *in_stream;
   GtQueue *streams;
+  AgnTranscriptAnatomy anatomy;
   AgnLogger *logger;
 };
 
@@ -67,6 +68,7 @@ GtNodeStream* agn_canon_gene_stream_new(GtNodeStream *in_stream,
   stream = canon_gene_stream_cast(ns);
   stream->streams = gt_queue_new();
   stream->logger = logger;
+  agn_transcript_anatomy_init(&stream->anatomy);
 
   GtNodeVisitor *icnv = agn_infer_cds_visitor_new(logger);
   GtNodeVisitor *ienv = agn_infer_exons_visitor_new(logger);
@@ -86,6 +88,15 @@ GtNodeStream* agn_canon_gene_stream_new(GtNodeStream *in_stream,
   return ns;
 }
 
+const char **agn_canon_gene_stream_created_types()
+{
+  // Features created by AgnInferCDSVisitor and AgnInferExonsVisitor
+  static const char *types[] = { "CDS", "exon", "five_prime_UTR", "intron",
+                                 "start_codon", "stop_codon", "three_prime_UTR",
+                                 NULL };
+  return types;
+}
+
 static const GtNodeStreamClass *canon_gene_stream_class(void)
 {
   static const GtNodeStreamClass *nsc = NULL;
@@ -119,6 +130,13 @@ static int canon_gene_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
     if(!fn)
       return 0;
 
+    // Genes that exon inference could not handle have already been reported
+    if(gt_feature_node_is_marked(fn))
+    {
+      gt_genome_node_delete(*gn);
+      continue;
+    }
+
     GtUword num_valid_mrnas = 0;
     GtFeatureNode *current;
     GtFeatureNodeIterator *iter = gt_feature_node_iterator_new(fn);
@@ -129,12 +147,10 @@ static int canon_gene_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
     {
       if(agn_gt_feature_node_is_mrna_feature(current))
       {
-        GtArray *cds     = agn_gt_feature_node_children_of_type(current,
-                                            agn_gt_feature_node_is_cds_feature);
-        GtArray *exons   = agn_gt_feature_node_children_of_type(current,
-                                           agn_gt_feature_node_is_exon_feature);
-        GtArray *introns = agn_gt_feature_node_children_of_type(current,
-                                         agn_gt_feature_node_is_intron_feature);
+        agn_gt_feature_node_anatomy(current, &stream->anatomy);
+        GtArray *cds     = stream->anatomy.cds;
+        GtArray *exons   = stream->anatomy.exons;
+        GtArray *introns = stream->anatomy.introns;
 
         bool keepmrna = true;
         if(gt_array_size(cds) < 1)
@@ -157,10 +173,6 @@ static int canon_gene_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
           num_valid_mrnas++;
         else
           gt_queue_add(invalid_mrnas, current);
-
-        gt_array_delete(cds);
-        gt_array_delete(exons);
-        gt_array_delete(introns);
       }
     }
     gt_feature_node_iterator_delete(iter);
@@ -182,4 +194,5 @@ static void canon_gene_stream_free(GtNodeStream *ns)
     gt_node_stream_delete(s);
   }
   gt_queue_delete(stream->streams);
+  agn_transcript_anatomy_free(&stream->anatomy);
 }
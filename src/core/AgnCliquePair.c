@@ -17,6 +17,7 @@ struct AgnCliquePair
   char *refr_vector;
   char *pred_vector;
   AgnComparison stats;
+  AgnCliquePairShortcut shortcut;
 };
 
 typedef struct
@@ -34,6 +35,15 @@ typedef struct
   AgnCompStatsBinary *stats;
 } StructuralData;
 
+typedef struct
+{
+  GtUword cds_length;
+  GtUword utr_length;
+  GtUword cds_segments;
+  GtUword exon_segments;
+  GtUword utr_segments;
+} SegmentSummary;
+
 
 //----------------------------------------------------------------------------//
 // Prototypes for private method(s)
@@ -57,6 +67,14 @@ static void clique_pair_add_transcript_to_vector(GtFeatureNode *transcript,
  */
 static void clique_pair_calc_struct_stats(StructuralData *dat);
 
+/**
+ * Fill in the CDS statistics for a pair whose cliques have identical CDS
+ * structure, without consulting the model vectors.
+ *
+ * @param[out] pair    the clique pair
+ */
+static void clique_pair_cds_match_stats(AgnCliquePair *pair);
+
 /**
  * Initialize the data structure used to store start and end coordinates for
  * reference and prediction structures (exons, CDS segments, or UTR segments)
@@ -68,6 +86,25 @@ static void clique_pair_calc_struct_stats(StructuralData *dat);
 static void clique_pair_init_struct_dat(StructuralData *dat,
                                         AgnCompStatsBinary *stats);
 
+/**
+ * Fill in the statistics for a pair whose cliques have identical structure,
+ * without building or consulting the model vectors.
+ *
+ * @param[out] pair    the clique pair
+ */
+static void clique_pair_perfect_match_stats(AgnCliquePair *pair);
+
+/**
+ * Tally lengths and the number of contiguous CDS, exon, and UTR segments from
+ * a sorted list of non-overlapping clique segments. Adjacent segments of the
+ * same class are counted once, just as they would be in a model vector.
+ *
+ * @param[in]  segments    array of AgnCliqueSegment objects
+ * @param[out] summary     the tallies
+ */
+static void clique_pair_summarize_segments(GtArray *segments,
+                                           SegmentSummary *summary);
+
 /**
  * Free the memory previously occupied by the data structure.
  *
@@ -86,6 +123,9 @@ static void clique_pair_term_struct_dat(StructuralData *dat);
 
 void agn_clique_pair_build_model_vectors(AgnCliquePair *pair)
 {
+  if(pair->refr_vector != NULL)
+    return;
+
   int vector_length = agn_clique_pair_length(pair) + 1;
   pair->refr_vector = (char *)gt_malloc(sizeof(char) * (vector_length));
   pair->pred_vector = (char *)gt_malloc(sizeof(char) * (vector_length));
@@ -111,6 +151,19 @@ void agn_clique_pair_comparative_analysis(AgnCliquePair *pair)
 {
   GtUword locus_length = agn_clique_pair_length(pair);
 
+  if(agn_transcript_clique_structure_match(pair->refr_clique,
+                                           pair->pred_clique))
+  {
+    pair->shortcut = AGN_CLIQUE_PAIR_EXACT_SHORTCUT;
+    clique_pair_perfect_match_stats(pair);
+    return;
+  }
+  bool cdsmatch = agn_transcript_clique_cds_match(pair->refr_clique,
+                                                  pair->pred_clique);
+  if(cdsmatch)
+    pair->shortcut = AGN_CLIQUE_PAIR_CDS_SHORTCUT;
+  agn_clique_pair_build_model_vectors(pair);
+
   StructuralData cdsstruct;
   clique_pair_init_struct_dat(&cdsstruct, &pair->stats.cds_struc_stats);
   StructuralData exonstruct;
@@ -122,15 +175,19 @@ void agn_clique_pair_comparative_analysis(AgnCliquePair *pair)
   GtUword i;
   for(i = 0; i < locus_length; i++)
   {
-    // Coding nucleotide counts
-    if(pair->refr_vector[i] == 'C' && pair->pred_vector[i] == 'C')
-      pair->stats.cds_nuc_stats.tp++;
-    else if(pair->refr_vector[i] == 'C' && pair->pred_vector[i] != 'C')
-      pair->stats.cds_nuc_stats.fn++;
-    else if(pair->refr_vector[i] != 'C' && pair->pred_vector[i] == 'C')
-      pair->stats.cds_nuc_stats.fp++;
-    else if(pair->refr_vector[i] != 'C' && pair->pred_vector[i] != 'C')
-      pair->stats.cds_nuc_stats.tn++;
+    // Coding nucleotide counts (computed directly from the cliques if the CDS
+    // structures are known to be identical)
+    if(!cdsmatch)
+    {
+      if(pair->refr_vector[i] == 'C' && pair->pred_vector[i] == 'C')
+        pair->stats.cds_nuc_stats.tp++;
+      else if(pair->refr_vector[i] == 'C' && pair->pred_vector[i] != 'C')
+        pair->stats.cds_nuc_stats.fn++;
+      else if(pair->refr_vector[i] != 'C' && pair->pred_vector[i] == 'C')
+        pair->stats.cds_nuc_stats.fp++;
+      else if(pair->refr_vector[i] != 'C' && pair->pred_vector[i] != 'C')
+        pair->stats.cds_nuc_stats.tn++;
+    }
 
     // UTR nucleotide counts
     bool refr_utr = char_is_utric(pair->refr_vector[i]);
@@ -145,7 +202,7 @@ void agn_clique_pair_comparative_analysis(AgnCliquePair *pair)
       pair->stats.overall_matches++;
 
     // CDS structure counts
-    if(pair->refr_vector[i] == 'C')
+    if(!cdsmatch && pair->refr_vector[i] == 'C')
     {
       if(i == 0 || pair->refr_vector[i-1] != 'C')
         gt_array_add(cdsstruct.refrstarts, i);
@@ -153,7 +210,7 @@ void agn_clique_pair_comparative_analysis(AgnCliquePair *pair)
       if(i == locus_length - 1 || pair->refr_vector[i+1] != 'C')
         gt_array_add(cdsstruct.refrends, i);
     }
-    if(pair->pred_vector[i] == 'C')
+    if(!cdsmatch && pair->pred_vector[i] == 'C')
     {
       if(i == 0 || pair->pred_vector[i-1] != 'C')
         gt_array_add(cdsstruct.predstarts, i);
@@ -200,13 +257,19 @@ void agn_clique_pair_comparative_analysis(AgnCliquePair *pair)
   }
 
   // Calculate nucleotide-level statistics from counts
-  agn_comp_stats_scaled_resolve(&pair->stats.cds_nuc_stats);
+  if(cdsmatch)
+    clique_pair_cds_match_stats(pair);
+  else
+    agn_comp_stats_scaled_resolve(&pair->stats.cds_nuc_stats);
   agn_comp_stats_scaled_resolve(&pair->stats.utr_nuc_stats);
   pair->stats.overall_identity = pair->stats.overall_matches /
                                  (double)locus_length;
 
   // Calculate statistics for structure from counts
-  clique_pair_calc_struct_stats(&cdsstruct);
+  if(cdsmatch)
+    clique_pair_term_struct_dat(&cdsstruct);
+  else
+    clique_pair_calc_struct_stats(&cdsstruct);
   clique_pair_calc_struct_stats(&exonstruct);
   clique_pair_calc_struct_stats(&utrstruct);
 }
@@ -347,6 +410,7 @@ AgnTranscriptClique *agn_clique_pair_get_pred_clique(AgnCliquePair *pair)
 
 const char *agn_clique_pair_get_pred_vector(AgnCliquePair *pair)
 {
+  agn_clique_pair_build_model_vectors(pair);
   return pair->pred_vector;
 }
 
@@ -357,9 +421,15 @@ AgnTranscriptClique *agn_clique_pair_get_refr_clique(AgnCliquePair *pair)
 
 const char *agn_clique_pair_get_refr_vector(AgnCliquePair *pair)
 {
+  agn_clique_pair_build_model_vectors(pair);
   return pair->refr_vector;
 }
 
+AgnCliquePairShortcut agn_clique_pair_get_shortcut(AgnCliquePair *pair)
+{
+  return pair->shortcut;
+}
+
 AgnComparison *agn_clique_pair_get_stats(AgnCliquePair *pair)
 {
   return &pair->stats;
@@ -410,6 +480,7 @@ AgnCliquePair* agn_clique_pair_new(const char *seqid,
 
   pair->refr_vector = NULL;
   pair->pred_vector = NULL;
+  pair->shortcut = AGN_CLIQUE_PAIR_NO_SHORTCUT;
 
   return pair;
 }
@@ -558,6 +629,32 @@ bool agn_clique_pair_unit_test(AgnUnitTest *test)
   bool companalypass = agn_clique_pair_classify(pair3) ==
                        AGN_CLIQUE_PAIR_CDS_MATCH;
   agn_unit_test_result(test, "analysis and classification", companalypass);
+  bool cdsshortcutpass = agn_clique_pair_get_shortcut(pair3) ==
+                         AGN_CLIQUE_PAIR_CDS_SHORTCUT;
+  agn_unit_test_result(test, "CDS fingerprint shortcut", cdsshortcutpass);
+
+  AgnTranscriptClique *tcr3copy = agn_transcript_clique_copy(tcr3);
+  AgnCliquePair *pair4 = agn_clique_pair_new("chr8", tcr3, tcr3copy, &lr3);
+  agn_clique_pair_comparative_analysis(pair4);
+  AgnComparison *pair4stats = agn_clique_pair_get_stats(pair4);
+  const char *rv4 = agn_clique_pair_get_refr_vector(pair4);
+  const char *pv4 = agn_clique_pair_get_pred_vector(pair4);
+  GtUword i, cdsnucs = 0;
+  for(i = 0; rv4[i] != '\0'; i++)
+  {
+    if(rv4[i] == 'C')
+      cdsnucs++;
+  }
+  bool exactshortcutpass =
+      agn_clique_pair_get_shortcut(pair4) == AGN_CLIQUE_PAIR_EXACT_SHORTCUT &&
+      agn_clique_pair_classify(pair4) == AGN_CLIQUE_PAIR_PERFECT_MATCH &&
+      strcmp(rv4, pv4) == 0 && pair4stats->cds_nuc_stats.tp == cdsnucs &&
+      pair4stats->cds_struc_stats.correct ==
+          agn_clique_pair_get_stats(pair3)->cds_struc_stats.correct;
+  agn_unit_test_result(test, "exact fingerprint shortcut", exactshortcutpass);
+  agn_clique_pair_delete(pair4);
+  agn_transcript_clique_delete(tcr3copy);
+
   agn_clique_pair_delete(pair3);
   agn_transcript_clique_delete(tcr3);
   agn_transcript_clique_delete(tcp3);
@@ -591,18 +688,18 @@ static void clique_pair_add_transcript_to_vector(GtFeatureNode *transcript,
       fn = gt_feature_node_iterator_next(iter))
   {
     char c;
-    if(agn_gt_feature_node_is_cds_feature(fn))
+    AgnFeatureClass class = agn_gt_feature_node_classify(fn);
+    if(class == AGN_FEATURE_CDS)
       c = 'C';
-    else if(agn_gt_feature_node_is_utr_feature(fn))
+    else if(class & AGN_FEATURE_ANY_UTR)
     {
-      gt_assert(gt_feature_node_has_type(fn, "five_prime_UTR") ||
-                gt_feature_node_has_type(fn, "three_prime_UTR"));
-      if(gt_feature_node_has_type(fn, "five_prime_UTR"))
+      gt_assert(class != AGN_FEATURE_UTR);
+      if(class == AGN_FEATURE_FIVE_PRIME_UTR)
         c = 'F';
       else
         c = 'T';
     }
-    else if(agn_gt_feature_node_is_intron_feature(fn))
+    else if(class == AGN_FEATURE_INTRON)
       c = 'I';
     else
       c = 'G';
@@ -672,6 +769,20 @@ static void clique_pair_calc_struct_stats(StructuralData *dat)
   clique_pair_term_struct_dat(dat);
 }
 
+static void clique_pair_cds_match_stats(AgnCliquePair *pair)
+{
+  SegmentSummary summary;
+  GtArray *segments = agn_transcript_clique_segments(pair->refr_clique);
+  clique_pair_summarize_segments(segments, &summary);
+
+  GtUword locus_length = agn_clique_pair_length(pair);
+  pair->stats.cds_nuc_stats.tp = summary.cds_length;
+  pair->stats.cds_nuc_stats.tn = locus_length - summary.cds_length;
+  agn_comp_stats_scaled_resolve(&pair->stats.cds_nuc_stats);
+  pair->stats.cds_struc_stats.correct = summary.cds_segments;
+  agn_comp_stats_binary_resolve(&pair->stats.cds_struc_stats);
+}
+
 static void clique_pair_init_struct_dat(StructuralData *dat,
                                         AgnCompStatsBinary *stats)
 {
@@ -682,6 +793,69 @@ static void clique_pair_init_struct_dat(StructuralData *dat,
   dat->stats      = stats;
 }
 
+static void clique_pair_perfect_match_stats(AgnCliquePair *pair)
+{
+  SegmentSummary summary;
+  GtArray *segments = agn_transcript_clique_segments(pair->refr_clique);
+  clique_pair_summarize_segments(segments, &summary);
+
+  GtUword locus_length = agn_clique_pair_length(pair);
+  pair->stats.cds_nuc_stats.tp = summary.cds_length;
+  pair->stats.cds_nuc_stats.tn = locus_length - summary.cds_length;
+  pair->stats.utr_nuc_stats.tp = summary.utr_length;
+  pair->stats.utr_nuc_stats.tn = locus_length - summary.utr_length;
+  agn_comp_stats_scaled_resolve(&pair->stats.cds_nuc_stats);
+  agn_comp_stats_scaled_resolve(&pair->stats.utr_nuc_stats);
+  pair->stats.overall_matches = locus_length;
+  pair->stats.overall_identity = 1.0;
+
+  pair->stats.cds_struc_stats.correct  = summary.cds_segments;
+  pair->stats.exon_struc_stats.correct = summary.exon_segments;
+  pair->stats.utr_struc_stats.correct  = summary.utr_segments;
+  agn_comp_stats_binary_resolve(&pair->stats.cds_struc_stats);
+  agn_comp_stats_binary_resolve(&pair->stats.exon_struc_stats);
+  agn_comp_stats_binary_resolve(&pair->stats.utr_struc_stats);
+}
+
+static void clique_pair_summarize_segments(GtArray *segments,
+                                           SegmentSummary *summary)
+{
+  summary->cds_length    = 0;
+  summary->utr_length    = 0;
+  summary->cds_segments  = 0;
+  summary->exon_segments = 0;
+  summary->utr_segments  = 0;
+
+  GtUword i;
+  AgnCliqueSegment *prev = NULL;
+  for(i = 0; i < gt_array_size(segments); i++)
+  {
+    AgnCliqueSegment *segment = gt_array_get(segments, i);
+    GtUword length = gt_range_length(&segment->range);
+    bool adjacent = prev != NULL && prev->range.end + 1 == segment->range.start;
+    char c = segment->type;
+
+    if(c == 'C')
+    {
+      summary->cds_length += length;
+      if(!adjacent || prev->type != 'C')
+        summary->cds_segments++;
+    }
+    if(char_is_utric(c))
+    {
+      summary->utr_length += length;
+      if(!adjacent || !char_is_utric(prev->type))
+        summary->utr_segments++;
+    }
+    if(char_is_exonic(c))
+    {
+      if(!adjacent || !char_is_exonic(prev->type))
+        summary->exon_segments++;
+    }
+    prev = segment;
+  }
+}
+
 static void clique_pair_term_struct_dat(StructuralData *dat)
 {
   gt_array_delete(dat->refrstarts);
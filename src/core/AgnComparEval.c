@@ -3,6 +3,19 @@
 #include <string.h>
 #include "AgnComparEval.h"
 
+/**
+ * Append a criterion to the compiled filter list if the corresponding filter
+ * value is active (non-zero).
+ *
+ * @param[out] filters     the filters being compiled
+ * @param[in]  property    the locus property tested by the criterion
+ * @param[in]  isupper     true if ``bound`` is an upper limit
+ * @param[in]  bound       the filter value
+ */
+static void compare_filters_add_criterion(AgnCompareFilters *filters,
+                                          AgnLocusProperty property,
+                                          bool isupper, GtUword bound);
+
 void agn_comp_evaluation_combine(AgnCompEvaluation *data,
                                  AgnCompEvaluation *data_to_add)
 {
@@ -82,6 +95,10 @@ void agn_comp_summary_combine(AgnCompSummary *s1, AgnCompSummary *s2)
   s1->num_exon_match   += s2->num_exon_match;
   s1->num_utr_match    += s2->num_utr_match;
   s1->non_match        += s2->non_match;
+  s1->pairs_analyzed   += s2->pairs_analyzed;
+  s1->exact_shortcuts  += s2->exact_shortcuts;
+  s1->cds_shortcuts    += s2->cds_shortcuts;
+  s1->degraded_loci    += s2->degraded_loci;
 }
 
 void agn_comp_summary_init(AgnCompSummary *summary)
@@ -100,6 +117,10 @@ void agn_comp_summary_init(AgnCompSummary *summary)
   summary->num_exon_match = 0;
   summary->num_utr_match = 0;
   summary->non_match = 0;
+  summary->pairs_analyzed = 0;
+  summary->exact_shortcuts = 0;
+  summary->cds_shortcuts = 0;
+  summary->degraded_loci = 0;
 }
 
 void agn_comparison_combine(AgnComparison *c1, AgnComparison *c2)
@@ -144,6 +165,82 @@ void agn_comparison_init(AgnComparison *comparison)
   comparison->tolerance        = 0.0;
 }
 
+static void compare_filters_add_criterion(AgnCompareFilters *filters,
+                                          AgnLocusProperty property,
+                                          bool isupper, GtUword bound)
+{
+  if(bound == 0)
+    return;
+
+  gt_assert(filters->numcriteria < AGN_MAX_FILTER_CRITERIA);
+  AgnFilterCriterion *criterion = filters->criteria + filters->numcriteria;
+  criterion->property = property;
+  criterion->isupper = isupper;
+  criterion->bound = bound;
+  filters->numcriteria++;
+}
+
+void agn_compare_filters_compile(AgnCompareFilters *filters)
+{
+  // Criteria are added in the order of the AgnLocusProperty enum, i.e. from
+  // cheapest to most expensive to evaluate.
+  filters->numcriteria = 0;
+  compare_filters_add_criterion(filters, AGN_LOCUS_LENGTH, true,
+                                filters->LocusLengthUpperLimit);
+  compare_filters_add_criterion(filters, AGN_LOCUS_LENGTH, false,
+                                filters->LocusLengthLowerLimit);
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_GENES, false,
+                                filters->MinReferenceGeneModels);
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_GENES, true,
+                                filters->MaxReferenceGeneModels);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_GENES, false,
+                                filters->MinPredictionGeneModels);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_GENES, true,
+                                filters->MaxPredictionGeneModels);
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_TRANSCRIPTS, false,
+                                filters->MinReferenceTranscriptModels);
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_TRANSCRIPTS, true,
+                                filters->MaxReferenceTranscriptModels);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_TRANSCRIPTS, false,
+                                filters->MinPredictionTranscriptModels);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_TRANSCRIPTS, true,
+                                filters->MaxPredictionTranscriptModels);
+
+  // A locus passes a transcripts-per-gene filter if at least one of its genes
+  // satisfies it, so the minimum is tested against the largest per-gene count
+  // and the maximum against the smallest.
+  compare_filters_add_criterion(filters,
+                                AGN_LOCUS_REFR_MOST_TRANSCRIPTS_PER_GENE, false,
+                                filters->MinTranscriptsPerReferenceGeneModel);
+  compare_filters_add_criterion(filters,
+                                AGN_LOCUS_REFR_FEWEST_TRANSCRIPTS_PER_GENE,true,
+                                filters->MaxTranscriptsPerReferenceGeneModel);
+  compare_filters_add_criterion(filters,
+                                AGN_LOCUS_PRED_MOST_TRANSCRIPTS_PER_GENE, false,
+                                filters->MinTranscriptsPerPredictionGeneModel);
+  compare_filters_add_criterion(filters,
+                                AGN_LOCUS_PRED_FEWEST_TRANSCRIPTS_PER_GENE,true,
+                                filters->MaxTranscriptsPerPredictionGeneModel);
+
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_EXONS, false,
+                                filters->MinReferenceExons);
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_EXONS, true,
+                                filters->MaxReferenceExons);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_EXONS, false,
+                                filters->MinPredictionExons);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_EXONS, true,
+                                filters->MaxPredictionExons);
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_CDS_LENGTH, false,
+                                filters->MinReferenceCDSLength);
+  compare_filters_add_criterion(filters, AGN_LOCUS_REFR_CDS_LENGTH, true,
+                                filters->MaxReferenceCDSLength);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_CDS_LENGTH, false,
+                                filters->MinPredictionCDSLength);
+  compare_filters_add_criterion(filters, AGN_LOCUS_PRED_CDS_LENGTH, true,
+                                filters->MaxPredictionCDSLength);
+  filters->compiled = true;
+}
+
 void agn_compare_filters_init(AgnCompareFilters *filters)
 {
   filters->LocusLengthUpperLimit = 0;
@@ -168,6 +265,8 @@ void agn_compare_filters_init(AgnCompareFilters *filters)
   filters->MaxReferenceCDSLength = 0;
   filters->MinPredictionCDSLength = 0;
   filters->MaxPredictionCDSLength = 0;
+  filters->numcriteria = 0;
+  filters->compiled = false;
 }
 
 void agn_compare_filters_parse(AgnCompareFilters *filters, FILE *instream,
@@ -298,6 +397,7 @@ void agn_compare_filters_parse(AgnCompareFilters *filters, FILE *instream,
       }
     }
   }
+  agn_compare_filters_compile(filters);
 }
 
 void agn_comp_stats_binary_init(AgnCompStatsBinary *stats)
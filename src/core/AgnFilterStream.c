@@ -11,8 +11,14 @@ struct AgnFilterStream
   GtNodeStream *in_stream;
   GtQueue *cache;
   GtHashmap *typestokeep;
+  GtHashmap *typecache;
 };
 
+/**
+ * Sentinel stored in the type cache for types that are not kept.
+ */
+static const char filter_stream_skip = 0;
+
 
 //------------------------------------------------------------------------------
 // Prototypes for private functions
@@ -35,6 +41,18 @@ static const GtNodeStreamClass* filter_stream_class(void);
  */
 static void filter_stream_free(GtNodeStream *ns);
 
+/**
+ * Determine whether features of the given type should be kept. GenomeTools
+ * interns feature type strings, so the decision for each distinct type is
+ * cached under the type pointer and the type name is only hashed once.
+ *
+ * @param[in] stream    the node stream
+ * @param[in] type      the feature type
+ * @returns             true if the type is to be kept, false otherwise
+ */
+static bool filter_stream_keep_type(AgnFilterStream *stream,
+                                    const char *type);
+
 /**
  * Pulls nodes from the input stream and feeds them to the output stream if they
  * pass the provided filtering criteria.
@@ -65,6 +83,7 @@ GtNodeStream* agn_filter_stream_new(GtNodeStream *in_stream,
   stream->in_stream = gt_node_stream_ref(in_stream);
   stream->cache = gt_queue_new();
   stream->typestokeep = gt_hashmap_ref(typestokeep);
+  stream->typecache = gt_hashmap_new(GT_HASH_DIRECT, NULL, NULL);
   return ns;
 }
 
@@ -86,6 +105,21 @@ static void filter_stream_free(GtNodeStream *ns)
   gt_node_stream_delete(stream->in_stream);
   gt_queue_delete(stream->cache);
   gt_hashmap_delete(stream->typestokeep);
+  gt_hashmap_delete(stream->typecache);
+}
+
+static bool filter_stream_keep_type(AgnFilterStream *stream,
+                                    const char *type)
+{
+  void *decision = gt_hashmap_get(stream->typecache, type);
+  if(decision == NULL)
+  {
+    decision = gt_hashmap_get(stream->typestokeep, type);
+    if(decision == NULL)
+      decision = (void *)&filter_stream_skip;
+    gt_hashmap_add(stream->typecache, (void *)type, decision);
+  }
+  return decision != &filter_stream_skip;
 }
 
 static int filter_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
@@ -115,24 +149,35 @@ static int filter_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
     if(!fn)
       return 0;
 
+    // Most often only the top-level feature is kept: pass it through as is,
+    // without a round trip through the cache
+    bool keeproot = filter_stream_keep_type(stream,
+                                            gt_feature_node_get_type(fn));
+    if(gt_feature_node_number_of_children(fn) == 0)
+    {
+      if(keeproot)
+        return 0;
+      gt_genome_node_delete(*gn);
+      continue;
+    }
+
     GtFeatureNode *current;
     GtFeatureNodeIterator *iter = gt_feature_node_iterator_new(fn);
+    gt_feature_node_iterator_next(iter); // Skip the top-level feature
     for(current  = gt_feature_node_iterator_next(iter);
         current != NULL;
         current  = gt_feature_node_iterator_next(iter))
     {
-      const char *type = gt_feature_node_get_type(current);
-      bool keepfeature = false;
-      if(gt_hashmap_get(stream->typestokeep, type) != NULL)
-        keepfeature = true;
-
-      if(keepfeature)
+      if(filter_stream_keep_type(stream, gt_feature_node_get_type(current)))
       {
         gt_genome_node_ref((GtGenomeNode *)current);
         gt_queue_add(stream->cache, current);
       }
     }
     gt_feature_node_iterator_delete(iter);
+    if(keeproot)
+      return 0;
+
     gt_genome_node_delete((GtGenomeNode *)fn);
     if(gt_queue_size(stream->cache) > 0)
     {
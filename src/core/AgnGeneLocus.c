@@ -14,10 +14,16 @@ struct AgnGeneLocus
   GtDlist *genes;
   GtHashmap *refr_genes;
   GtHashmap *pred_genes;
+  GtUword refr_gene_count;
+  GtUword pred_gene_count;
   GtArray *reported_pairs;
   GtArray *unique_refr_cliques;
   GtArray *unique_pred_cliques;
   AgnCompEvaluation eval;
+  AgnLocusBudget budget;
+  int budget_status;
+  AgnLocusProfile profile;
+  bool profiling;
 };
 
 
@@ -33,6 +39,47 @@ struct AgnGeneLocus
  */
 static void agn_gene_locus_aggregate_results_internal(AgnGeneLocus *locus);
 
+/**
+ * Compare each clique pair, stopping early if ``bounded`` is true and the
+ * locus' time or model vector budget is exceeded.
+ *
+ * @param[in] locus           the locus
+ * @param[in] clique_pairs    the clique pairs to compare
+ * @param[in] deadline        wall-clock deadline, or 0 for none
+ * @param[in] bounded         whether to enforce the locus' budget
+ * @returns                   0 if all pairs were compared, or the flag of the
+ *                            budget that was exceeded
+ */
+static int agn_gene_locus_analyze_clique_pairs(AgnGeneLocus *locus,
+                                               GtArray *clique_pairs,
+                                               double deadline, bool bounded);
+
+/**
+ * Delete an array of transcript cliques and the cliques it contains.
+ *
+ * @param[in] cliques    the cliques, or NULL
+ */
+static void agn_gene_locus_delete_cliques(GtArray *cliques);
+
+/**
+ * Enumerate the transcript cliques of the reference and of the prediction. In
+ * normal mode, all transcripts are considered, within the locus' budget for
+ * time and number of cliques. In degraded mode, only the transcript with the
+ * longest CDS of each gene is considered, and if those still form too many
+ * cliques, each transcript forms a clique of its own.
+ *
+ * @param[in]  locus       the locus
+ * @param[in]  degraded    whether to enumerate cliques in degraded mode
+ * @param[in]  deadline    wall-clock deadline, or 0 for none
+ * @param[out] refrp       reference cliques, or NULL if there are none
+ * @param[out] predp       prediction cliques, or NULL if there are none
+ * @returns                0 on success, or the flag of the budget that was
+ *                         exceeded (in which case no cliques are returned)
+ */
+static int agn_gene_locus_enumerate_cliques(AgnGeneLocus *locus,
+                                            bool degraded, double deadline,
+                                            GtArray **refrp, GtArray **predp);
+
 /**
  * We use the Bron-Kerbosch algorithm to enumerate maximal cliques of non-
  * overlapping transcripts. This is done separately for the reference
@@ -49,6 +96,55 @@ static GtArray *agn_gene_locus_enumerate_clique_pairs(AgnGeneLocus *locus,
                                                       GtArray *refr_cliques,
                                                       GtArray *pred_cliques);
 
+/**
+ * Estimate the number of transcript cliques that will be enumerated for one
+ * source of annotation. Transcripts are grouped into clusters of overlapping
+ * transcripts; besides a clique for each transcript, there is roughly one
+ * maximal clique for each way of choosing a transcript from every cluster.
+ *
+ * @param[in]  locus       the locus
+ * @param[in]  src         source of annotation
+ * @param[out] numtrans    number of transcripts from the given source
+ * @returns                estimated number of cliques
+ */
+static double agn_gene_locus_estimate_cliques(AgnGeneLocus *locus,
+                                              AgnComparisonSource src,
+                                              GtUword *numtrans);
+
+/**
+ * Compute the values of all locus properties tested by the given filters that
+ * are not known in advance (everything past ``AGN_LOCUS_PRED_GENES``). This
+ * requires a single walk over the genes of the locus, and genes from a source
+ * that no filter refers to are skipped entirely.
+ *
+ * @param[in]  locus      the locus
+ * @param[in]  filters    compiled filtering criteria
+ * @param[out] values     property values, indexed by AgnLocusProperty
+ */
+static void agn_gene_locus_profile(AgnGeneLocus *locus,
+                                   AgnCompareFilters *filters,
+                                   GtUword *values);
+
+/**
+ * Collect the transcript with the longest coding sequence of each gene from
+ * the given source, for analysis in degraded mode.
+ *
+ * @param[in] locus    the locus
+ * @param[in] src      source of annotation
+ * @returns            the transcripts, sorted
+ */
+static GtArray *agn_gene_locus_representative_transcripts(AgnGeneLocus *locus,
+                                                      AgnComparisonSource src);
+
+/**
+ * Read the wall clock if this locus' analysis is being profiled, so that the
+ * difference of two readings is the time elapsed, or zero when not profiling.
+ *
+ * @param[in] locus    the locus
+ * @returns            seconds since an arbitrary point, or 0
+ */
+static double agn_gene_locus_stopwatch(AgnGeneLocus *locus);
+
 /**
  * Update this locus' start and end coordinates based on the gene being merged.
  *
@@ -68,9 +164,15 @@ void agn_gene_locus_add(AgnGeneLocus *locus, GtFeatureNode *gene,
   gt_dlist_add(locus->genes, gt_genome_node_ref((GtGenomeNode *)gene));
   agn_gene_locus_update_range(locus, gene);
   if(source == REFERENCESOURCE)
+  {
     gt_hashmap_add(locus->refr_genes, gene, gene);
+    locus->refr_gene_count++;
+  }
   else if(source == PREDICTIONSOURCE)
+  {
     gt_hashmap_add(locus->pred_genes, gene, gene);
+    locus->pred_gene_count++;
+  }
 }
 
 void agn_gene_locus_aggregate_results(AgnGeneLocus *locus,
@@ -163,6 +265,68 @@ static void agn_gene_locus_aggregate_results_internal(AgnGeneLocus *locus)
   }
 }
 
+static int agn_gene_locus_analyze_clique_pairs(AgnGeneLocus *locus,
+                                               GtArray *clique_pairs,
+                                               double deadline, bool bounded)
+{
+  if(clique_pairs == NULL)
+    return 0;
+
+  // Counts are only recorded once all pairs have been compared
+  GtUword analyzed = 0, exact = 0, cds = 0, vectorbytes = 0, i;
+  for(i = 0; i < gt_array_size(clique_pairs); i++)
+  {
+    if(bounded && deadline > 0.0 && agn_wallclock() > deadline)
+      return AGN_LOCUS_OVER_TIME;
+
+    // When profiling, vectors are built ahead of the comparison (which would
+    // otherwise build them itself) so that their cost can be measured
+    // separately; this repeats the comparison's structure check
+    AgnCliquePair *p = *(AgnCliquePair **)gt_array_get(clique_pairs, i);
+    AgnTranscriptClique *refr = agn_clique_pair_get_refr_clique(p);
+    AgnTranscriptClique *pred = agn_clique_pair_get_pred_clique(p);
+    double start = agn_gene_locus_stopwatch(locus);
+    if(locus->profiling && !agn_transcript_clique_structure_match(refr, pred))
+    {
+      agn_clique_pair_build_model_vectors(p);
+    }
+    double built = agn_gene_locus_stopwatch(locus);
+    agn_clique_pair_comparative_analysis(p);
+    locus->profile.vector_seconds += built - start;
+    locus->profile.pair_seconds += agn_gene_locus_stopwatch(locus) - built;
+
+    analyzed++;
+    AgnCliquePairShortcut shortcut = agn_clique_pair_get_shortcut(p);
+    if(shortcut == AGN_CLIQUE_PAIR_EXACT_SHORTCUT)
+      exact++;
+    else if(shortcut == AGN_CLIQUE_PAIR_CDS_SHORTCUT)
+      cds++;
+
+    // Model vectors are built for every pair but exact matches; the vector
+    // accessors would build them on demand, so they are not used here
+    if(shortcut != AGN_CLIQUE_PAIR_EXACT_SHORTCUT)
+    {
+      vectorbytes += 2 * (agn_clique_pair_length(p) + 1);
+      locus->profile.vector_bytes += 2 * (agn_clique_pair_length(p) + 1);
+    }
+    if(bounded && locus->budget.max_vector_bytes > 0 &&
+       vectorbytes > locus->budget.max_vector_bytes)
+    {
+      return AGN_LOCUS_OVER_MEMORY;
+    }
+  }
+
+  locus->eval.counts.pairs_analyzed += analyzed;
+  locus->eval.counts.exact_shortcuts += exact;
+  locus->eval.counts.cds_shortcuts += cds;
+  return 0;
+}
+
+int agn_gene_locus_budget_exceeded(AgnGeneLocus *locus)
+{
+  return locus->budget_status;
+}
+
 AgnGeneLocus *agn_gene_locus_clone(AgnGeneLocus *locus)
 {
   AgnGeneLocus *newlocus = gt_malloc(sizeof(AgnGeneLocus));
@@ -180,11 +344,17 @@ AgnGeneLocus *agn_gene_locus_clone(AgnGeneLocus *locus)
   }
   newlocus->refr_genes = gt_hashmap_ref(locus->refr_genes);
   newlocus->pred_genes = gt_hashmap_ref(locus->pred_genes);
+  newlocus->refr_gene_count = locus->refr_gene_count;
+  newlocus->pred_gene_count = locus->pred_gene_count;
   newlocus->reported_pairs = gt_array_ref(locus->reported_pairs);
   newlocus->unique_refr_cliques = gt_array_ref(locus->unique_refr_cliques);
   newlocus->unique_pred_cliques = gt_array_ref(locus->unique_pred_cliques);
   agn_comp_evaluation_init(&newlocus->eval);
   agn_comp_evaluation_combine(&newlocus->eval, &locus->eval);
+  newlocus->budget = locus->budget;
+  newlocus->budget_status = locus->budget_status;
+  newlocus->profile = locus->profile;
+  newlocus->profiling = locus->profiling;
 
   return newlocus;
 }
@@ -206,7 +376,7 @@ GtUword agn_gene_locus_cds_length(AgnGeneLocus *locus,
   for(i = 0; i < gt_array_size(transcripts); i++)
   {
     GtFeatureNode *transcript = *(GtFeatureNode **)gt_array_get(transcripts, i);
-    length = agn_gt_feature_node_cds_length(transcript);
+    length += agn_gt_feature_node_cds_length(transcript);
   }
   gt_array_delete(transcripts);
   return length;
@@ -217,34 +387,56 @@ GtArray *agn_gene_locus_comparative_analysis(AgnGeneLocus *locus)
   if(locus->reported_pairs != NULL)
     return locus->reported_pairs;
 
+  double deadline = 0.0;
+  if(locus->budget.max_seconds > 0.0)
+    deadline = agn_wallclock() + locus->budget.max_seconds;
+
   GtArray *refr_cliques = NULL;
   GtArray *pred_cliques = NULL;
-  if(agn_gene_locus_num_refr_transcripts(locus) > 0)
+  GtArray *clique_pairs = NULL;
+  double start = agn_gene_locus_stopwatch(locus);
+  locus->budget_status = agn_gene_locus_enumerate_cliques(locus, false,
+                                                          deadline,
+                                                          &refr_cliques,
+                                                          &pred_cliques);
+  if(locus->budget_status == 0)
   {
-    GtArray *refr_trans = agn_gene_locus_refr_transcripts(locus);
-    refr_cliques = agn_enumerate_feature_cliques(refr_trans);
-    gt_array_delete(refr_trans);
+    clique_pairs = agn_gene_locus_enumerate_clique_pairs(locus, refr_cliques,
+                                                         pred_cliques);
+    locus->profile.clique_seconds += agn_gene_locus_stopwatch(locus) - start;
+    locus->budget_status = agn_gene_locus_analyze_clique_pairs(locus,
+                               clique_pairs, deadline, true);
   }
-  if(agn_gene_locus_num_pred_transcripts(locus) > 0)
+
+  // A locus over budget is analyzed again in degraded mode, which bounds the
+  // number of cliques and clique pairs by the number of genes
+  GtUword i;
+  if(locus->budget_status != 0)
   {
-    GtArray *pred_trans = agn_gene_locus_pred_transcripts(locus);
-    pred_cliques = agn_enumerate_feature_cliques(pred_trans);
-    gt_array_delete(pred_trans);
+    for(i = 0; clique_pairs != NULL && i < gt_array_size(clique_pairs); i++)
+      agn_clique_pair_delete(*(AgnCliquePair **)gt_array_get(clique_pairs, i));
+    if(clique_pairs != NULL)
+      gt_array_delete(clique_pairs);
+    agn_gene_locus_delete_cliques(refr_cliques);
+    agn_gene_locus_delete_cliques(pred_cliques);
+
+    // Enumeration that ran over budget is counted along with the retry
+    if(clique_pairs == NULL)
+      locus->profile.clique_seconds += agn_gene_locus_stopwatch(locus) - start;
+    start = agn_gene_locus_stopwatch(locus);
+    agn_gene_locus_enumerate_cliques(locus, true, 0.0, &refr_cliques,
+                                     &pred_cliques);
+    clique_pairs = agn_gene_locus_enumerate_clique_pairs(locus, refr_cliques,
+                                                         pred_cliques);
+    locus->profile.clique_seconds += agn_gene_locus_stopwatch(locus) - start;
+    agn_gene_locus_analyze_clique_pairs(locus, clique_pairs, 0.0, false);
   }
-
-  GtArray *clique_pairs = agn_gene_locus_enumerate_clique_pairs(locus,
-                              refr_cliques, pred_cliques);
   GtUword num_clique_pairs = 0;
   if(clique_pairs != NULL)
     num_clique_pairs = gt_array_size(clique_pairs);
-
-  GtUword i;
-  for(i = 0; i < num_clique_pairs; i++)
-  {
-    AgnCliquePair *p = *(AgnCliquePair **)gt_array_get(clique_pairs, i);
-    agn_clique_pair_build_model_vectors(p);
-    agn_clique_pair_comparative_analysis(p);
-  }
+  locus->profile.refr_cliques = refr_cliques ? gt_array_size(refr_cliques) : 0;
+  locus->profile.pred_cliques = pred_cliques ? gt_array_size(pred_cliques) : 0;
+  locus->profile.pairs = num_clique_pairs;
   if(clique_pairs != NULL)
     gt_array_sort(clique_pairs,(GtCompare)agn_clique_pair_compare_reverse);
 
@@ -354,6 +546,73 @@ void agn_gene_locus_delete(AgnGeneLocus *locus)
   gt_free(locus);
 }
 
+static void agn_gene_locus_delete_cliques(GtArray *cliques)
+{
+  if(cliques == NULL)
+    return;
+
+  while(gt_array_size(cliques) > 0)
+  {
+    AgnTranscriptClique *clique;
+    clique = *(AgnTranscriptClique **)gt_array_pop(cliques);
+    agn_transcript_clique_delete(clique);
+  }
+  gt_array_delete(cliques);
+}
+
+static int agn_gene_locus_enumerate_cliques(AgnGeneLocus *locus,
+                                            bool degraded, double deadline,
+                                            GtArray **refrp, GtArray **predp)
+{
+  AgnComparisonSource sources[] = { REFERENCESOURCE, PREDICTIONSOURCE };
+  GtArray *cliques[] = { NULL, NULL };
+  GtUword maxcliques = locus->budget.max_cliques;
+  int i, status = 0;
+  for(i = 0; status == 0 && i < 2; i++)
+  {
+    if(agn_gene_locus_transcript_num(locus, sources[i]) == 0)
+      continue;
+
+    GtArray *trans;
+    if(degraded)
+      trans = agn_gene_locus_representative_transcripts(locus, sources[i]);
+    else
+      trans = agn_gene_locus_transcripts(locus, sources[i]);
+    cliques[i] = agn_enumerate_feature_cliques_bounded(trans, maxcliques,
+                                                       deadline);
+    if(cliques[i] == NULL && degraded)
+    {
+      GtUword j;
+      cliques[i] = gt_array_new( sizeof(AgnTranscriptClique *) );
+      for(j = 0; j < gt_array_size(trans); j++)
+      {
+        AgnTranscriptClique *clique = agn_transcript_clique_new();
+        agn_transcript_clique_add(clique,
+                                  *(GtFeatureNode **)gt_array_get(trans, j));
+        gt_array_add(cliques[i], clique);
+      }
+    }
+    else if(cliques[i] == NULL)
+    {
+      if(deadline > 0.0 && agn_wallclock() > deadline)
+        status = AGN_LOCUS_OVER_TIME;
+      else
+        status = AGN_LOCUS_OVER_CLIQUES;
+    }
+    gt_array_delete(trans);
+  }
+
+  if(status != 0)
+  {
+    agn_gene_locus_delete_cliques(cliques[0]);
+    agn_gene_locus_delete_cliques(cliques[1]);
+    cliques[0] = cliques[1] = NULL;
+  }
+  *refrp = cliques[0];
+  *predp = cliques[1];
+  return status;
+}
+
 static GtArray *agn_gene_locus_enumerate_clique_pairs(AgnGeneLocus *locus,
                                                       GtArray *refr_cliques,
                                                       GtArray *pred_cliques)
@@ -380,6 +639,67 @@ static GtArray *agn_gene_locus_enumerate_clique_pairs(AgnGeneLocus *locus,
   return clique_pairs;
 }
 
+static double agn_gene_locus_estimate_cliques(AgnGeneLocus *locus,
+                                              AgnComparisonSource src,
+                                              GtUword *numtrans)
+{
+  GtArray *transcripts = agn_gene_locus_transcripts(locus, src);
+  GtUword n = gt_array_size(transcripts), i;
+  *numtrans = n;
+  if(n == 0)
+  {
+    gt_array_delete(transcripts);
+    return 0.0;
+  }
+
+  GtRange *ranges = gt_malloc( n * sizeof(GtRange) );
+  for(i = 0; i < n; i++)
+  {
+    GtGenomeNode *transcript = *(GtGenomeNode **)gt_array_get(transcripts, i);
+    ranges[i] = gt_genome_node_get_range(transcript);
+  }
+  gt_array_delete(transcripts);
+  qsort(ranges, n, sizeof(GtRange), (GtCompare)gt_range_compare);
+
+  double combinations = 1.0;
+  GtUword clusters = 1, clustersize = 1, clusterend = ranges[0].end;
+  for(i = 1; i < n; i++)
+  {
+    if(ranges[i].start <= clusterend)
+    {
+      clustersize++;
+      if(ranges[i].end > clusterend)
+        clusterend = ranges[i].end;
+    }
+    else
+    {
+      combinations *= clustersize;
+      clusters++;
+      clustersize = 1;
+      clusterend = ranges[i].end;
+    }
+  }
+  combinations *= clustersize;
+  gt_free(ranges);
+
+  return clusters > 1 ? n + combinations : n;
+}
+
+double agn_gene_locus_estimate_cost(AgnGeneLocus *locus)
+{
+  GtUword nrefr, npred;
+  double refrcliques = agn_gene_locus_estimate_cliques(locus, REFERENCESOURCE,
+                                                       &nrefr);
+  double predcliques = agn_gene_locus_estimate_cliques(locus, PREDICTIONSOURCE,
+                                                       &npred);
+
+  // Clique enumeration, then a comparison of each clique pair over the
+  // length of the locus
+  double length = agn_gene_locus_get_length(locus);
+  return refrcliques * nrefr + predcliques * npred +
+         refrcliques * predcliques * (1.0 + length / 1000.0);
+}
+
 GtUword agn_gene_locus_exon_num(AgnGeneLocus *locus, AgnComparisonSource src)
 {
   GtDlistelem *elem;
@@ -416,208 +736,37 @@ bool agn_gene_locus_filter(AgnGeneLocus *locus, AgnCompareFilters *filters)
   if(filters == NULL)
     return false;
 
-  // Ignore all filter configuration settings set to 0
-
-  // Filter by locus length
-  GtUword length = agn_gene_locus_get_length(locus);
-  if(filters->LocusLengthUpperLimit > 0)
-  {
-    if(length > filters->LocusLengthUpperLimit)
-      return true;
-  }
-  if(filters->LocusLengthLowerLimit > 0)
+  AgnCompareFilters compiled;
+  if(!filters->compiled)
   {
-    if(length < filters->LocusLengthLowerLimit)
-      return true;
+    compiled = *filters;
+    agn_compare_filters_compile(&compiled);
+    filters = &compiled;
   }
 
-  // Filter by reference gene models
-  GtUword num_refr_genes = agn_gene_locus_num_refr_genes(locus);
-  if(filters->MinReferenceGeneModels > 0)
-  {
-    if(num_refr_genes < filters->MinReferenceGeneModels)
-      return true;
-  }
-  if(filters->MaxReferenceGeneModels > 0)
-  {
-    if(num_refr_genes > filters->MaxReferenceGeneModels)
-      return true;
-  }
+  // Length and gene counts are known without touching any transcripts; all
+  // other properties are computed together, and only if the cheaper criteria
+  // (which come first in the compiled list) have all passed.
+  GtUword values[AGN_LOCUS_NUM_PROPERTIES];
+  values[AGN_LOCUS_LENGTH]     = agn_gene_locus_get_length(locus);
+  values[AGN_LOCUS_REFR_GENES] = locus->refr_gene_count;
+  values[AGN_LOCUS_PRED_GENES] = locus->pred_gene_count;
+  bool profiled = false;
 
-  // Filter by prediction gene models
-  GtUword num_pred_genes = agn_gene_locus_num_pred_genes(locus);
-  if(filters->MinPredictionGeneModels > 0)
-  {
-    if(num_pred_genes < filters->MinPredictionGeneModels)
-      return true;
-  }
-  if(filters->MaxPredictionGeneModels > 0)
-  {
-    if(num_pred_genes > filters->MaxPredictionGeneModels)
-      return true;
-  }
-
-  // Filter by reference transcript models
-  GtUword nrefr_transcripts = agn_gene_locus_num_refr_transcripts(locus);
-  if(filters->MinReferenceTranscriptModels > 0)
-  {
-    if(nrefr_transcripts < filters->MinReferenceTranscriptModels)
-      return true;
-  }
-  if(filters->MaxReferenceTranscriptModels > 0)
-  {
-    if(nrefr_transcripts > filters->MaxReferenceTranscriptModels)
-      return true;
-  }
-
-  // Filter by prediction transcript models
-  GtUword npred_transcripts = agn_gene_locus_num_pred_transcripts(locus);
-  if(filters->MinPredictionTranscriptModels > 0)
-  {
-    if(npred_transcripts < filters->MinPredictionTranscriptModels)
-      return true;
-  }
-  if(filters->MaxPredictionTranscriptModels > 0)
-  {
-    if(npred_transcripts > filters->MaxPredictionTranscriptModels)
-      return true;
-  }
-
-  // Filter by number of transcripts per gene model
-  GtArray *refr_genes = agn_gene_locus_refr_genes(locus);
-  if(filters->MinTranscriptsPerReferenceGeneModel > 0)
-  {
-    GtUword i;
-    bool success = false;
-    for(i = 0; i < gt_array_size(refr_genes); i++)
-    {
-      GtFeatureNode *gene = gt_array_get(refr_genes, i);
-      if(agn_gt_feature_node_num_transcripts(gene) >=
-         filters->MinTranscriptsPerReferenceGeneModel)
-      {
-        success = true;
-        break;
-      }
-    }
-    if(!success)
-    {
-      gt_array_delete(refr_genes);
-      return true;
-    }
-  }
-  if(filters->MaxTranscriptsPerReferenceGeneModel > 0)
-  {
-    GtUword i;
-    bool success = false;
-    for(i = 0; i < gt_array_size(refr_genes); i++)
-    {
-      GtFeatureNode *gene = gt_array_get(refr_genes, i);
-      if(agn_gt_feature_node_num_transcripts(gene) <=
-         filters->MaxTranscriptsPerReferenceGeneModel)
-      {
-        success = true;
-        break;
-      }
-    }
-    if(!success)
-    {
-      gt_array_delete(refr_genes);
-      return true;
-    }
-  }
-  gt_array_delete(refr_genes);
-  GtArray *pred_genes = agn_gene_locus_pred_genes(locus);
-  if(filters->MinTranscriptsPerPredictionGeneModel > 0)
-  {
-    GtUword i;
-    bool success = false;
-    for(i = 0; i < gt_array_size(pred_genes); i++)
-    {
-      GtFeatureNode *gene = gt_array_get(pred_genes, i);
-      if(agn_gt_feature_node_num_transcripts(gene) >=
-         filters->MinTranscriptsPerPredictionGeneModel)
-      {
-        success = true;
-        break;
-      }
-    }
-    if(!success)
-    {
-      gt_array_delete(pred_genes);
-      return true;
-    }
-  }
-  if(filters->MaxTranscriptsPerPredictionGeneModel > 0)
+  GtUword i;
+  for(i = 0; i < filters->numcriteria; i++)
   {
-    GtUword i;
-    bool success = false;
-    for(i = 0; i < gt_array_size(pred_genes); i++)
+    AgnFilterCriterion *criterion = filters->criteria + i;
+    if(criterion->property > AGN_LOCUS_PRED_GENES && !profiled)
     {
-      GtFeatureNode *gene = gt_array_get(pred_genes, i);
-      if(agn_gt_feature_node_num_transcripts(gene) <=
-         filters->MaxTranscriptsPerPredictionGeneModel)
-      {
-        success = true;
-        break;
-      }
+      agn_gene_locus_profile(locus, filters, values);
+      profiled = true;
     }
-    if(!success)
-    {
-      gt_array_delete(refr_genes);
-      return true;
-    }
-  }
-  gt_array_delete(pred_genes);
 
-  // Filter by reference exons
-  GtUword num_refr_exons = agn_gene_locus_num_refr_exons(locus);
-  if(filters->MinReferenceExons > 0)
-  {
-    if(num_refr_exons < filters->MinReferenceExons)
+    GtUword value = values[criterion->property];
+    if(criterion->isupper && value > criterion->bound)
       return true;
-  }
-  if(filters->MaxReferenceExons > 0)
-  {
-    if(num_refr_exons > filters->MaxReferenceExons)
-      return true;
-  }
-
-  // Filter by prediction exons
-  GtUword num_pred_exons = agn_gene_locus_num_pred_exons(locus);
-  if(filters->MinPredictionExons > 0)
-  {
-    if(num_pred_exons < filters->MinPredictionExons)
-      return true;
-  }
-  if(filters->MaxPredictionExons > 0)
-  {
-    if(num_pred_exons > filters->MaxPredictionExons)
-      return true;
-  }
-
-  // Filter by reference CDS length
-  GtUword refr_cds_length = agn_gene_locus_refr_cds_length(locus);
-  if(filters->MinReferenceCDSLength > 0)
-  {
-    if(refr_cds_length / 3 < filters->MinReferenceCDSLength)
-      return true;
-  }
-  if(filters->MaxReferenceCDSLength > 0)
-  {
-    if(refr_cds_length / 3 > filters->MaxReferenceCDSLength)
-      return true;
-  }
-
-  // Filter by prediction CDS length
-  GtUword pred_cds_length = agn_gene_locus_pred_cds_length(locus);
-  if(filters->MinPredictionCDSLength > 0)
-  {
-    if(pred_cds_length / 3 < filters->MinPredictionCDSLength)
-      return true;
-  }
-  if(filters->MaxPredictionCDSLength > 0)
-  {
-    if(pred_cds_length / 3 > filters->MaxPredictionCDSLength)
+    if(!criterion->isupper && value < criterion->bound)
       return true;
   }
 
@@ -674,24 +823,11 @@ GtArray *agn_gene_locus_gene_ids(AgnGeneLocus *locus, AgnComparisonSource src)
 GtUword agn_gene_locus_gene_num(AgnGeneLocus *locus,
                                       AgnComparisonSource src)
 {
-  GtDlistelem *elem;
-  GtUword count = 0;
-  for(elem = gt_dlist_first(locus->genes);
-      elem != NULL;
-      elem = gt_dlistelem_next(elem))
-  {
-    GtFeatureNode *gene = (GtFeatureNode *)gt_dlistelem_get_data(elem);
-    bool isrefr = gt_hashmap_get(locus->refr_genes, gene) != NULL;
-    bool ispred = gt_hashmap_get(locus->pred_genes, gene) != NULL;
-
-    if(src == DEFAULTSOURCE)
-      count++;
-    else if(src == REFERENCESOURCE && isrefr)
-      count++;
-    else if(src == PREDICTIONSOURCE && ispred)
-      count++;
-  }
-  return count;
+  if(src == REFERENCESOURCE)
+    return locus->refr_gene_count;
+  else if(src == PREDICTIONSOURCE)
+    return locus->pred_gene_count;
+  return gt_dlist_size(locus->genes);
 }
 
 GtUword agn_gene_locus_get_end(AgnGeneLocus *locus)
@@ -704,6 +840,11 @@ GtUword agn_gene_locus_get_length(AgnGeneLocus *locus)
   return gt_range_length(&locus->region.range);
 }
 
+AgnLocusProfile agn_gene_locus_get_profile(AgnGeneLocus *locus)
+{
+  return locus->profile;
+}
+
 const char* agn_gene_locus_get_seqid(AgnGeneLocus *locus)
 {
   return locus->region.seqid;
@@ -734,10 +875,16 @@ AgnGeneLocus* agn_gene_locus_new(const char *seqid)
   locus->genes = gt_dlist_new( (GtCompare)gt_genome_node_cmp );
   locus->refr_genes = gt_hashmap_new(GT_HASH_DIRECT, NULL, NULL);
   locus->pred_genes = gt_hashmap_new(GT_HASH_DIRECT, NULL, NULL);
+  locus->refr_gene_count = 0;
+  locus->pred_gene_count = 0;
   locus->reported_pairs = NULL;
   locus->unique_refr_cliques = NULL;
   locus->unique_pred_cliques = NULL;
   agn_comp_evaluation_init(&locus->eval);
+  agn_locus_budget_init(&locus->budget);
+  locus->budget_status = 0;
+  memset(&locus->profile, 0, sizeof(AgnLocusProfile));
+  locus->profiling = false;
 
   return locus;
 }
@@ -792,14 +939,9 @@ void agn_gene_locus_png_track_selector(GtBlock *block, GtStr *track, void *data)
 
 void agn_gene_locus_print_gene_mapping(AgnGeneLocus *locus, FILE *outstream)
 {
-  GtArray *geneids = agn_gene_locus_get_gene_ids(locus);
-  while(gt_array_size(geneids) > 0)
-  {
-    const char **geneid = gt_array_pop(geneids);
-    fprintf(outstream, "%s\t%s:%lu-%lu\n", *geneid, locus->region.seqid,
-            locus->region.range.start, locus->region.range.end);
-  }
-  gt_array_delete(geneids);
+  AgnIntervalLocus ilocus = { locus->region.range, true, locus };
+  agn_interval_locus_print_gene_mapping(&ilocus, locus->region.seqid,
+                                        outstream);
 }
 
 #ifndef WITHOUT_CAIRO
@@ -901,14 +1043,149 @@ void agn_gene_locus_print_png(AgnGeneLocus *locus,
 void agn_gene_locus_print_transcript_mapping(AgnGeneLocus *locus,
                                              FILE *outstream)
 {
-  GtArray *transids = agn_gene_locus_get_transcript_ids(locus);
-  while(gt_array_size(transids) > 0)
+  AgnIntervalLocus ilocus = { locus->region.range, true, locus };
+  agn_interval_locus_print_transcript_mapping(&ilocus, locus->region.seqid,
+                                              outstream);
+}
+
+static void agn_gene_locus_profile(AgnGeneLocus *locus,
+                                   AgnCompareFilters *filters,
+                                   GtUword *values)
+{
+  bool need_refr = false, need_pred = false;
+  bool need_refr_cds = false, need_pred_cds = false;
+  GtUword i;
+  for(i = 0; i < filters->numcriteria; i++)
   {
-    const char **transid = gt_array_pop(transids);
-    fprintf(outstream, "%s\t%s:%lu-%lu\n", *transid, locus->region.seqid,
-            locus->region.range.start, locus->region.range.end);
+    switch(filters->criteria[i].property)
+    {
+      case AGN_LOCUS_REFR_CDS_LENGTH:
+        need_refr_cds = true;
+        // fall through
+      case AGN_LOCUS_REFR_TRANSCRIPTS:
+      case AGN_LOCUS_REFR_MOST_TRANSCRIPTS_PER_GENE:
+      case AGN_LOCUS_REFR_FEWEST_TRANSCRIPTS_PER_GENE:
+      case AGN_LOCUS_REFR_EXONS:
+        need_refr = true;
+        break;
+
+      case AGN_LOCUS_PRED_CDS_LENGTH:
+        need_pred_cds = true;
+        // fall through
+      case AGN_LOCUS_PRED_TRANSCRIPTS:
+      case AGN_LOCUS_PRED_MOST_TRANSCRIPTS_PER_GENE:
+      case AGN_LOCUS_PRED_FEWEST_TRANSCRIPTS_PER_GENE:
+      case AGN_LOCUS_PRED_EXONS:
+        need_pred = true;
+        break;
+
+      default:
+        break;
+    }
   }
-  gt_array_delete(transids);
+
+  // With no genes, no gene satisfies a transcripts-per-gene criterion: the
+  // initial values below guarantee that both the minimum and maximum fail.
+  for(i = AGN_LOCUS_REFR_TRANSCRIPTS; i < AGN_LOCUS_NUM_PROPERTIES; i++)
+    values[i] = 0;
+  values[AGN_LOCUS_REFR_FEWEST_TRANSCRIPTS_PER_GENE] = GT_UWORD_MAX;
+  values[AGN_LOCUS_PRED_FEWEST_TRANSCRIPTS_PER_GENE] = GT_UWORD_MAX;
+
+  GtUword refr_cds_length = 0, pred_cds_length = 0;
+  GtDlistelem *elem;
+  for(elem = gt_dlist_first(locus->genes);
+      elem != NULL;
+      elem = gt_dlistelem_next(elem))
+  {
+    GtFeatureNode *gene = (GtFeatureNode *)gt_dlistelem_get_data(elem);
+    bool isrefr = need_refr && gt_hashmap_get(locus->refr_genes, gene) != NULL;
+    bool ispred = need_pred && gt_hashmap_get(locus->pred_genes, gene) != NULL;
+    if(!isrefr && !ispred)
+      continue;
+
+    bool need_cds = (isrefr && need_refr_cds) || (ispred && need_pred_cds);
+    GtUword transcripts = 0, exons = 0, cds_length = 0;
+    GtFeatureNodeIterator *iter = gt_feature_node_iterator_new(gene);
+    GtFeatureNode *feature;
+    for(feature = gt_feature_node_iterator_next(iter);
+        feature != NULL;
+        feature = gt_feature_node_iterator_next(iter))
+    {
+      if(agn_gt_feature_node_is_mrna_feature(feature))
+      {
+        transcripts++;
+        if(need_cds)
+          cds_length += agn_gt_feature_node_cds_length(feature);
+      }
+      else if(agn_gt_feature_node_is_exon_feature(feature))
+        exons++;
+    }
+    gt_feature_node_iterator_delete(iter);
+
+    if(isrefr)
+    {
+      values[AGN_LOCUS_REFR_TRANSCRIPTS] += transcripts;
+      values[AGN_LOCUS_REFR_EXONS] += exons;
+      refr_cds_length += cds_length;
+      if(transcripts > values[AGN_LOCUS_REFR_MOST_TRANSCRIPTS_PER_GENE])
+        values[AGN_LOCUS_REFR_MOST_TRANSCRIPTS_PER_GENE] = transcripts;
+      if(transcripts < values[AGN_LOCUS_REFR_FEWEST_TRANSCRIPTS_PER_GENE])
+        values[AGN_LOCUS_REFR_FEWEST_TRANSCRIPTS_PER_GENE] = transcripts;
+    }
+    if(ispred)
+    {
+      values[AGN_LOCUS_PRED_TRANSCRIPTS] += transcripts;
+      values[AGN_LOCUS_PRED_EXONS] += exons;
+      pred_cds_length += cds_length;
+      if(transcripts > values[AGN_LOCUS_PRED_MOST_TRANSCRIPTS_PER_GENE])
+        values[AGN_LOCUS_PRED_MOST_TRANSCRIPTS_PER_GENE] = transcripts;
+      if(transcripts < values[AGN_LOCUS_PRED_FEWEST_TRANSCRIPTS_PER_GENE])
+        values[AGN_LOCUS_PRED_FEWEST_TRANSCRIPTS_PER_GENE] = transcripts;
+    }
+  }
+
+  // CDS length filters are specified in amino acids
+  values[AGN_LOCUS_REFR_CDS_LENGTH] = refr_cds_length / 3;
+  values[AGN_LOCUS_PRED_CDS_LENGTH] = pred_cds_length / 3;
+}
+
+static GtArray *agn_gene_locus_representative_transcripts(AgnGeneLocus *locus,
+                                                       AgnComparisonSource src)
+{
+  GtArray *transcripts = gt_array_new( sizeof(GtFeatureNode *) );
+  GtHashmap *genes = src == REFERENCESOURCE ? locus->refr_genes
+                                            : locus->pred_genes;
+  GtDlistelem *elem;
+  for(elem = gt_dlist_first(locus->genes);
+      elem != NULL;
+      elem = gt_dlistelem_next(elem))
+  {
+    GtFeatureNode *gene = gt_dlistelem_get_data(elem);
+    if(gt_hashmap_get(genes, gene) == NULL)
+      continue;
+
+    GtFeatureNodeIterator *iter = gt_feature_node_iterator_new_direct(gene);
+    GtFeatureNode *feature, *best = NULL;
+    GtUword bestlength = 0;
+    for(feature = gt_feature_node_iterator_next(iter);
+        feature != NULL;
+        feature = gt_feature_node_iterator_next(iter))
+    {
+      if(!agn_gt_feature_node_is_mrna_feature(feature))
+        continue;
+      GtUword length = agn_gt_feature_node_cds_length(feature);
+      if(best == NULL || length > bestlength)
+      {
+        best = feature;
+        bestlength = length;
+      }
+    }
+    gt_feature_node_iterator_delete(iter);
+    if(best != NULL)
+      gt_array_add(transcripts, best);
+  }
+  gt_array_sort(transcripts, (GtCompare)agn_gt_genome_node_compare);
+  return transcripts;
 }
 
 GtRange agn_gene_locus_range(AgnGeneLocus *locus)
@@ -916,6 +1193,16 @@ GtRange agn_gene_locus_range(AgnGeneLocus *locus)
   return locus->region.range;
 }
 
+void agn_gene_locus_set_budget(AgnGeneLocus *locus, AgnLocusBudget *budget)
+{
+  locus->budget = *budget;
+}
+
+void agn_gene_locus_set_profiling(AgnGeneLocus *locus, bool profiling)
+{
+  locus->profiling = profiling;
+}
+
 void agn_gene_locus_set_range(AgnGeneLocus *locus, GtUword start, GtUword end)
 {
   locus->region.range.start = start;
@@ -931,6 +1218,13 @@ double agn_gene_locus_splice_complexity(AgnGeneLocus *locus,
   return sc;
 }
 
+static double agn_gene_locus_stopwatch(AgnGeneLocus *locus)
+{
+  if(!locus->profiling)
+    return 0.0;
+  return agn_wallclock();
+}
+
 void agn_gene_locus_summary_init(AgnGeneLocusSummary *summary)
 {
   summary->start = 0;
@@ -945,56 +1239,8 @@ void agn_gene_locus_summary_init(AgnGeneLocusSummary *summary)
 void agn_gene_locus_to_gff3(AgnGeneLocus *locus, FILE *outstream,
                             const char *source)
 {
-  const char *src = "AEGeAn";
-  if(source != NULL)
-    src = source;
-
-  GtArray *types = gt_array_new( sizeof(const char *) );
-  GtHashmap *countsbytype = gt_hashmap_new(GT_HASH_STRING,
-                                           gt_free_func,
-                                           gt_free_func);
-
-  GtDlistelem *elem;
-  for(elem = gt_dlist_first(locus->genes);
-      elem != NULL;
-      elem = gt_dlistelem_next(elem))
-  {
-    GtFeatureNode *gene = gt_dlistelem_get_data(elem);
-    GtFeatureNodeIterator *iter = gt_feature_node_iterator_new_direct(gene);
-    GtFeatureNode *child;
-    for(child  = gt_feature_node_iterator_next(iter);
-        child != NULL;
-        child  = gt_feature_node_iterator_next(iter))
-    {
-      const char *transtype = gt_feature_node_get_type(child);
-      GtUword *num_of_type = gt_hashmap_get(countsbytype, transtype);
-      if(num_of_type == NULL)
-      {
-        char *type = gt_cstr_dup(transtype);
-        gt_array_add(types, type);
-        num_of_type = gt_malloc( sizeof(GtUword) );
-        (*num_of_type) = 0;
-        gt_hashmap_add(countsbytype, type, num_of_type);
-      }
-      (*num_of_type)++;
-    }
-    gt_feature_node_iterator_delete(iter);
-  }
-
-  fprintf(outstream, "%s\t%s\tlocus\t%lu\t%lu\t.\t.\t.\tgene=%lu",
-          locus->region.seqid, src, locus->region.range.start,
-          locus->region.range.end, gt_dlist_size(locus->genes));
-  while(gt_array_size(types) > 0)
-  {
-    const char **type = gt_array_pop(types);
-    GtUword *num_of_type = gt_hashmap_get(countsbytype, *type);
-    gt_assert(num_of_type);
-    fprintf(outstream, ";%s=%lu", *type, *num_of_type);
-  }
-  fputc('\n', outstream);
-
-  gt_hashmap_delete(countsbytype);
-  gt_array_delete(types);
+  AgnIntervalLocus ilocus = { locus->region.range, true, locus };
+  agn_interval_locus_to_gff3(&ilocus, locus->region.seqid, outstream, source);
 }
 
 GtArray *agn_gene_locus_transcripts(AgnGeneLocus *locus,
@@ -1116,10 +1362,154 @@ bool agn_gene_locus_unit_test(AgnUnitTest *test)
                        agn_gene_locus_num_refr_transcripts(locus) == 0 &&
                        agn_gene_locus_num_pred_transcripts(locus) == 0);
   agn_unit_test_result(test, "mRNA number (EDEN)", transnumpass);
+  agn_gene_locus_delete(locus);
+
+  locus = agn_gene_locus_new(gt_str_get(seqid));
+  agn_gene_locus_add_refr_gene(locus, eden);
+  AgnCompareFilters filters;
+  agn_compare_filters_init(&filters);
+  bool filterpass = !agn_gene_locus_filter(locus, &filters);
+  filters.MaxReferenceGeneModels = 1;
+  filters.MinTranscriptsPerReferenceGeneModel = 3;
+  agn_compare_filters_compile(&filters);
+  filterpass = filterpass && !agn_gene_locus_filter(locus, &filters);
+  filters.MinPredictionGeneModels = 1;
+  agn_compare_filters_compile(&filters);
+  filterpass = filterpass && agn_gene_locus_filter(locus, &filters);
+  filters.MinPredictionGeneModels = 0;
+  filters.MaxTranscriptsPerReferenceGeneModel = 2;
+  agn_compare_filters_compile(&filters);
+  filterpass = filterpass && agn_gene_locus_filter(locus, &filters);
+  agn_unit_test_result(test, "filters (EDEN)", filterpass);
+
+  // EDEN's three isoforms all overlap: three cliques from each source, and
+  // comparisons make up most of the cost once there is a prediction
+  double refrcost = agn_gene_locus_estimate_cost(locus);
+  agn_gene_locus_add_pred_gene(locus, eden);
+  double paircost = agn_gene_locus_estimate_cost(locus);
+  double length = agn_gene_locus_get_length(locus);
+  bool costpass = fabs(refrcost - 9.0) < 1e-9 &&
+                  fabs(paircost - 18.0 - 9.0 * (1.0 + length / 1000.0)) < 1e-9;
+  agn_unit_test_result(test, "cost estimate (EDEN)", costpass);
+  agn_gene_locus_delete(locus);
+
+  // Three cliques from each source exceed the budget, and in degraded mode
+  // only the longest isoforms are compared
+  GtFeatureNode *eden2 = agn_test_data_eden();
+  locus = agn_gene_locus_new(gt_str_get(seqid));
+  agn_gene_locus_add_refr_gene(locus, eden);
+  agn_gene_locus_add_pred_gene(locus, eden2);
+  AgnLocusBudget budget;
+  agn_locus_budget_init(&budget);
+  budget.max_cliques = 2;
+  agn_gene_locus_set_budget(locus, &budget);
+  GtArray *pairs = agn_gene_locus_comparative_analysis(locus);
+  bool budgetpass = agn_gene_locus_budget_exceeded(locus) ==
+                    AGN_LOCUS_OVER_CLIQUES &&
+                    gt_array_size(pairs) == 1;
+  agn_unit_test_result(test, "budget (EDEN)", budgetpass);
 
   gt_genome_node_delete((GtGenomeNode *)eden);
+  gt_genome_node_delete((GtGenomeNode *)eden2);
   agn_gene_locus_delete(locus);
-  return genenumpass && transnumpass;
+  return genenumpass && transnumpass && filterpass && costpass && budgetpass;
+}
+
+void agn_interval_locus_print_gene_mapping(AgnIntervalLocus *ilocus,
+                                           const char *seqid, FILE *outstream)
+{
+  if(ilocus->locus == NULL)
+    return;
+
+  GtArray *geneids = agn_gene_locus_get_gene_ids(ilocus->locus);
+  while(gt_array_size(geneids) > 0)
+  {
+    const char **geneid = gt_array_pop(geneids);
+    fprintf(outstream, "%s\t%s:%lu-%lu\n", *geneid, seqid,
+            ilocus->range.start, ilocus->range.end);
+  }
+  gt_array_delete(geneids);
+}
+
+void agn_interval_locus_print_transcript_mapping(AgnIntervalLocus *ilocus,
+                                                 const char *seqid,
+                                                 FILE *outstream)
+{
+  if(ilocus->locus == NULL)
+    return;
+
+  GtArray *transids = agn_gene_locus_get_transcript_ids(ilocus->locus);
+  while(gt_array_size(transids) > 0)
+  {
+    const char **transid = gt_array_pop(transids);
+    fprintf(outstream, "%s\t%s:%lu-%lu\n", *transid, seqid,
+            ilocus->range.start, ilocus->range.end);
+  }
+  gt_array_delete(transids);
+}
+
+void agn_interval_locus_to_gff3(AgnIntervalLocus *ilocus, const char *seqid,
+                                FILE *outstream, const char *source)
+{
+  const char *src = "AEGeAn";
+  if(source != NULL)
+    src = source;
+
+  GtArray *types = gt_array_new( sizeof(const char *) );
+  GtHashmap *countsbytype = gt_hashmap_new(GT_HASH_STRING,
+                                           gt_free_func,
+                                           gt_free_func);
+
+  // Intergenic iLoci have no genes
+  AgnGeneLocus *locus = ilocus->locus;
+  GtDlistelem *elem;
+  for(elem = locus == NULL ? NULL : gt_dlist_first(locus->genes);
+      elem != NULL;
+      elem = gt_dlistelem_next(elem))
+  {
+    GtFeatureNode *gene = gt_dlistelem_get_data(elem);
+    GtFeatureNodeIterator *iter = gt_feature_node_iterator_new_direct(gene);
+    GtFeatureNode *child;
+    for(child  = gt_feature_node_iterator_next(iter);
+        child != NULL;
+        child  = gt_feature_node_iterator_next(iter))
+    {
+      const char *transtype = gt_feature_node_get_type(child);
+      GtUword *num_of_type = gt_hashmap_get(countsbytype, transtype);
+      if(num_of_type == NULL)
+      {
+        char *type = gt_cstr_dup(transtype);
+        gt_array_add(types, type);
+        num_of_type = gt_malloc( sizeof(GtUword) );
+        (*num_of_type) = 0;
+        gt_hashmap_add(countsbytype, type, num_of_type);
+      }
+      (*num_of_type)++;
+    }
+    gt_feature_node_iterator_delete(iter);
+  }
+
+  fprintf(outstream, "%s\t%s\tlocus\t%lu\t%lu\t.\t.\t.\tgene=%lu", seqid,
+          src, ilocus->range.start, ilocus->range.end,
+          locus == NULL ? 0 : gt_dlist_size(locus->genes));
+  while(gt_array_size(types) > 0)
+  {
+    const char **type = gt_array_pop(types);
+    GtUword *num_of_type = gt_hashmap_get(countsbytype, *type);
+    gt_assert(num_of_type);
+    fprintf(outstream, ";%s=%lu", *type, *num_of_type);
+  }
+  fputc('\n', outstream);
+
+  gt_hashmap_delete(countsbytype);
+  gt_array_delete(types);
+}
+
+void agn_locus_budget_init(AgnLocusBudget *budget)
+{
+  budget->max_seconds = 0.0;
+  budget->max_cliques = 0;
+  budget->max_vector_bytes = 0;
 }
 
 static void agn_gene_locus_update_range(AgnGeneLocus *locus,GtFeatureNode *gene)
@@ -2,6 +2,65 @@
 #include "AgnGtExtensions.h"
 #include "AgnUtils.h"
 
+#define FEATURE_CLASS_SLOTS 256
+#define FEATURE_CLASS_PROBE 16
+#define FEATURE_CLASS_VALID (1u << 31)
+
+/**
+ * Type names recognized for each feature class.
+ */
+typedef struct
+{
+  const char *type;
+  AgnFeatureClass class;
+} FeatureTypeName;
+
+static const FeatureTypeName feature_type_names[] =
+{
+  { "gene",                            AGN_FEATURE_GENE },
+  { "mRNA",                            AGN_FEATURE_MRNA },
+  { "messenger RNA",                   AGN_FEATURE_MRNA },
+  { "messenger_RNA",                   AGN_FEATURE_MRNA },
+  { "exon",                            AGN_FEATURE_EXON },
+  { "intron",                          AGN_FEATURE_INTRON },
+  { "CDS",                             AGN_FEATURE_CDS },
+  { "coding sequence",                 AGN_FEATURE_CDS },
+  { "coding_sequence",                 AGN_FEATURE_CDS },
+  { "UTR",                             AGN_FEATURE_UTR },
+  { "untranslated region",             AGN_FEATURE_UTR },
+  { "untranslated_region",             AGN_FEATURE_UTR },
+  { "5' UTR",                          AGN_FEATURE_FIVE_PRIME_UTR },
+  { "5'UTR",                           AGN_FEATURE_FIVE_PRIME_UTR },
+  { "five prime UTR",                  AGN_FEATURE_FIVE_PRIME_UTR },
+  { "five_prime_UTR",                  AGN_FEATURE_FIVE_PRIME_UTR },
+  { "five prime untranslated region",  AGN_FEATURE_FIVE_PRIME_UTR },
+  { "five_prime_untranslated_region",  AGN_FEATURE_FIVE_PRIME_UTR },
+  { "3' UTR",                          AGN_FEATURE_THREE_PRIME_UTR },
+  { "3'UTR",                           AGN_FEATURE_THREE_PRIME_UTR },
+  { "three prime UTR",                 AGN_FEATURE_THREE_PRIME_UTR },
+  { "three_prime_UTR",                 AGN_FEATURE_THREE_PRIME_UTR },
+  { "three prime untranslated region", AGN_FEATURE_THREE_PRIME_UTR },
+  { "three_prime_untranslated_region", AGN_FEATURE_THREE_PRIME_UTR },
+  { "start_codon",                     AGN_FEATURE_START_CODON },
+  { "start codon",                     AGN_FEATURE_START_CODON },
+  { "initiation codon",                AGN_FEATURE_START_CODON },
+  { "stop_codon",                      AGN_FEATURE_STOP_CODON },
+  { "stop codon",                      AGN_FEATURE_STOP_CODON },
+  // What about 'termination codon'?
+  { NULL,                              AGN_FEATURE_OTHER },
+};
+
+/**
+ * Lookup table mapping type strings to feature classes. GenomeTools interns
+ * feature type strings, so every feature of a given type returns the same
+ * pointer and the table can be keyed on the pointer itself. Slots are claimed
+ * with an atomic compare-and-swap on the key, after which the class is
+ * published with the valid bit set; a reader that finds a key whose class is
+ * not yet published simply classifies the type by name.
+ */
+static const char *feature_class_keys[FEATURE_CLASS_SLOTS];
+static unsigned feature_class_values[FEATURE_CLASS_SLOTS];
+
 GtArray* agn_gt_array_copy(GtArray *source, size_t size)
 {
   GtUword i;
@@ -47,6 +106,61 @@ void agn_gt_feature_index_to_gff3(GtFeatureIndex *index, FILE *outstream)
   gt_str_array_delete(seqids);
 }
 
+void agn_gt_feature_node_anatomy(GtFeatureNode *fn,
+                                 AgnTranscriptAnatomy *anatomy)
+{
+  GtArray *buckets[] = { anatomy->mrnas, anatomy->exons, anatomy->introns,
+                         anatomy->cds, anatomy->utrs, anatomy->starts,
+                         anatomy->stops };
+  GtUword i, numbuckets = sizeof(buckets) / sizeof(GtArray *);
+  for(i = 0; i < numbuckets; i++)
+    gt_array_reset(buckets[i]);
+
+  GtFeatureNodeIterator *iter = gt_feature_node_iterator_new(fn);
+  GtFeatureNode *current;
+  for(current = gt_feature_node_iterator_next(iter);
+      current != NULL;
+      current = gt_feature_node_iterator_next(iter))
+  {
+    AgnFeatureClass class = agn_gt_feature_node_classify(current);
+    if(class & AGN_FEATURE_ANY_UTR)
+    {
+      gt_array_add(anatomy->utrs, current);
+      continue;
+    }
+    switch(class)
+    {
+      case AGN_FEATURE_MRNA:
+        gt_array_add(anatomy->mrnas, current);
+        break;
+      case AGN_FEATURE_EXON:
+        gt_array_add(anatomy->exons, current);
+        break;
+      case AGN_FEATURE_INTRON:
+        gt_array_add(anatomy->introns, current);
+        break;
+      case AGN_FEATURE_CDS:
+        gt_array_add(anatomy->cds, current);
+        break;
+      case AGN_FEATURE_START_CODON:
+        gt_array_add(anatomy->starts, current);
+        break;
+      case AGN_FEATURE_STOP_CODON:
+        gt_array_add(anatomy->stops, current);
+        break;
+      default:
+        break;
+    }
+  }
+  gt_feature_node_iterator_delete(iter);
+
+  for(i = 0; i < numbuckets; i++)
+  {
+    if(gt_array_size(buckets[i]) > 1)
+      gt_array_sort(buckets[i], (GtCompare)agn_gt_genome_node_compare);
+  }
+}
+
 GtUword agn_gt_feature_node_cds_length(GtFeatureNode *transcript)
 {
   GtUword length = 0;
@@ -72,6 +186,45 @@ GtUword agn_gt_feature_node_cds_length(GtFeatureNode *transcript)
   return length;
 }
 
+AgnFeatureClass agn_gt_feature_node_classify(GtFeatureNode *fn)
+{
+  const char *type = gt_feature_node_get_type(fn);
+  GtUword hash = ((GtUword)type >> 4) ^ ((GtUword)type >> 12);
+  GtUword i;
+  for(i = 0; i < FEATURE_CLASS_PROBE; i++)
+  {
+    GtUword slot = (hash + i) % FEATURE_CLASS_SLOTS;
+    const char *key = __atomic_load_n(feature_class_keys + slot,
+                                      __ATOMIC_ACQUIRE);
+    if(key == type)
+    {
+      unsigned value = __atomic_load_n(feature_class_values + slot,
+                                       __ATOMIC_ACQUIRE);
+      if(value & FEATURE_CLASS_VALID)
+        return value & ~FEATURE_CLASS_VALID;
+      break;
+    }
+    if(key == NULL)
+    {
+      AgnFeatureClass class = agn_gt_feature_type_classify(type);
+      const char *empty = NULL;
+      if(__atomic_compare_exchange_n(feature_class_keys + slot, &empty, type,
+                                     false, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE))
+      {
+        __atomic_store_n(feature_class_values + slot,
+                         class | FEATURE_CLASS_VALID, __ATOMIC_RELEASE);
+        return class;
+      }
+      if(empty == type)
+        return class;
+    }
+  }
+
+  // Table is full or the slot is being filled by another thread
+  return agn_gt_feature_type_classify(type);
+}
+
 GtArray *agn_gt_feature_node_children_of_type(GtFeatureNode *fn,
                                          bool (*typetestfunc)(GtFeatureNode *))
 {
@@ -119,64 +272,42 @@ bool agn_gt_feature_node_fix_parent_attribute(GtFeatureNode *feature,
 
 bool agn_gt_feature_node_is_cds_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "CDS") ||
-         gt_feature_node_has_type(feature, "coding sequence") ||
-         gt_feature_node_has_type(feature, "coding_sequence");
+  return agn_gt_feature_node_classify(feature) == AGN_FEATURE_CDS;
 }
 
 bool agn_gt_feature_node_is_exon_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "exon");
+  return agn_gt_feature_node_classify(feature) == AGN_FEATURE_EXON;
 }
 
 bool agn_gt_feature_node_is_gene_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "gene");
+  return agn_gt_feature_node_classify(feature) == AGN_FEATURE_GENE;
 }
 
 bool agn_gt_feature_node_is_intron_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "intron");
+  return agn_gt_feature_node_classify(feature) == AGN_FEATURE_INTRON;
 }
 
 bool agn_gt_feature_node_is_mrna_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "mRNA") ||
-         gt_feature_node_has_type(feature, "messenger RNA") ||
-         gt_feature_node_has_type(feature, "messenger_RNA");
+  return agn_gt_feature_node_classify(feature) == AGN_FEATURE_MRNA;
 }
 
 bool agn_gt_feature_node_is_start_codon_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "start_codon") ||
-         gt_feature_node_has_type(feature, "start codon") ||
-         gt_feature_node_has_type(feature, "initiation codon");
+  return agn_gt_feature_node_classify(feature) == AGN_FEATURE_START_CODON;
 }
 
 bool agn_gt_feature_node_is_stop_codon_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "stop_codon") ||
-         gt_feature_node_has_type(feature, "stop codon");
-         // What about 'termination codon'?
+  return agn_gt_feature_node_classify(feature) == AGN_FEATURE_STOP_CODON;
 }
 
 bool agn_gt_feature_node_is_utr_feature(GtFeatureNode *feature)
 {
-  return gt_feature_node_has_type(feature, "UTR") ||
-         gt_feature_node_has_type(feature, "untranslated region") ||
-         gt_feature_node_has_type(feature, "untranslated_region") ||
-         gt_feature_node_has_type(feature, "5' UTR") ||
-         gt_feature_node_has_type(feature, "5'UTR") ||
-         gt_feature_node_has_type(feature, "five prime UTR") ||
-         gt_feature_node_has_type(feature, "five_prime_UTR") ||
-         gt_feature_node_has_type(feature, "five prime untranslated region") ||
-         gt_feature_node_has_type(feature, "five_prime_untranslated_region") ||
-         gt_feature_node_has_type(feature, "3' UTR") ||
-         gt_feature_node_has_type(feature, "3'UTR") ||
-         gt_feature_node_has_type(feature, "three prime UTR") ||
-         gt_feature_node_has_type(feature, "three_prime_UTR") ||
-         gt_feature_node_has_type(feature, "three prime untranslated region") ||
-         gt_feature_node_has_type(feature, "three_prime_untranslated_region");
+  return (agn_gt_feature_node_classify(feature) & AGN_FEATURE_ANY_UTR) != 0;
 }
 
 GtUword agn_gt_feature_node_num_transcripts(GtFeatureNode *gene)
@@ -322,6 +453,17 @@ void agn_gt_feature_node_to_gff3(GtFeatureNode *feature, FILE *outstream,
   gt_hashmap_delete(printed);
 }
 
+AgnFeatureClass agn_gt_feature_type_classify(const char *type)
+{
+  const FeatureTypeName *name;
+  for(name = feature_type_names; name->type != NULL; name++)
+  {
+    if(strcmp(type, name->type) == 0)
+      return name->class;
+  }
+  return AGN_FEATURE_OTHER;
+}
+
 int agn_gt_genome_node_compare(const void *n1, const void *n2)
 {
   GtGenomeNode *gn1 = *(GtGenomeNode **)n1;
@@ -411,3 +553,25 @@ GtStrArray* agn_gt_str_array_union(GtStrArray *a1, GtStrArray *a2)
   }
   return uniona;
 }
+
+void agn_transcript_anatomy_free(AgnTranscriptAnatomy *anatomy)
+{
+  gt_array_delete(anatomy->mrnas);
+  gt_array_delete(anatomy->exons);
+  gt_array_delete(anatomy->introns);
+  gt_array_delete(anatomy->cds);
+  gt_array_delete(anatomy->utrs);
+  gt_array_delete(anatomy->starts);
+  gt_array_delete(anatomy->stops);
+}
+
+void agn_transcript_anatomy_init(AgnTranscriptAnatomy *anatomy)
+{
+  anatomy->mrnas   = gt_array_new( sizeof(GtFeatureNode *) );
+  anatomy->exons   = gt_array_new( sizeof(GtFeatureNode *) );
+  anatomy->introns = gt_array_new( sizeof(GtFeatureNode *) );
+  anatomy->cds     = gt_array_new( sizeof(GtFeatureNode *) );
+  anatomy->utrs    = gt_array_new( sizeof(GtFeatureNode *) );
+  anatomy->starts  = gt_array_new( sizeof(GtFeatureNode *) );
+  anatomy->stops   = gt_array_new( sizeof(GtFeatureNode *) );
+}
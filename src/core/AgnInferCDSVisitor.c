@@ -16,11 +16,7 @@ struct AgnInferCDSVisitor
 {
   const GtNodeVisitor parent_instance;
   GtFeatureNode *mrna;
-  GtArray *cds;
-  GtArray *utrs;
-  GtArray *exons;
-  GtArray *starts;
-  GtArray *stops;
+  AgnTranscriptAnatomy anatomy;
   GtUword cdscounter;
   AgnLogger *logger;
 };
@@ -40,6 +36,11 @@ struct AgnInferCDSVisitor
  */
 static const GtNodeVisitorClass* agn_infer_cds_visitor_class();
 
+/**
+ * @function Destructor for the class.
+ */
+static void infer_cds_visitor_free(GtNodeVisitor *nv);
+
 /**
  * @function Run unit tests using the basic grape example data.
  */
@@ -100,12 +101,19 @@ static const GtNodeVisitorClass* agn_infer_cds_visitor_class()
   static const GtNodeVisitorClass *nvc = NULL;
   if(!nvc)
   {
-    nvc = gt_node_visitor_class_new(sizeof (AgnInferCDSVisitor), NULL, NULL,
+    nvc = gt_node_visitor_class_new(sizeof (AgnInferCDSVisitor),
+                                    infer_cds_visitor_free, NULL,
                                     visit_feature_node, NULL, NULL, NULL);
   }
   return nvc;
 }
 
+static void infer_cds_visitor_free(GtNodeVisitor *nv)
+{
+  AgnInferCDSVisitor *v = agn_infer_cds_visitor_cast(nv);
+  agn_transcript_anatomy_free(&v->anatomy);
+}
+
 GtNodeVisitor* agn_infer_cds_visitor_new(AgnLogger *logger)
 {
   GtNodeVisitor *nv;
@@ -113,6 +121,7 @@ GtNodeVisitor* agn_infer_cds_visitor_new(AgnLogger *logger)
   AgnInferCDSVisitor *v = agn_infer_cds_visitor_cast(nv);
   v->logger = logger;
   v->cdscounter = 0;
+  agn_transcript_anatomy_init(&v->anatomy);
   return nv;
 }
 
@@ -445,17 +454,8 @@ static int visit_feature_node(GtNodeVisitor *nv, GtFeatureNode *fn,
     if(!agn_gt_feature_node_is_mrna_feature(current))
       continue;
 
-    v->cds    = agn_gt_feature_node_children_of_type(current,
-                                            agn_gt_feature_node_is_cds_feature);
-    v->utrs   = agn_gt_feature_node_children_of_type(current,
-                                            agn_gt_feature_node_is_utr_feature);
-    v->exons  = agn_gt_feature_node_children_of_type(current,
-                                           agn_gt_feature_node_is_exon_feature);
-    v->starts = agn_gt_feature_node_children_of_type(current,
-                                    agn_gt_feature_node_is_start_codon_feature);
-    v->stops  = agn_gt_feature_node_children_of_type(current,
-                                     agn_gt_feature_node_is_stop_codon_feature);
-    v->mrna   = current;
+    v->mrna = current;
+    agn_gt_feature_node_anatomy(current, &v->anatomy);
 
     visit_mrna_infer_cds(v);
     visit_mrna_check_start(v);
@@ -464,11 +464,6 @@ static int visit_feature_node(GtNodeVisitor *nv, GtFeatureNode *fn,
     visit_mrna_check_cds_multi(v);
 
     v->mrna = NULL;
-    gt_array_delete(v->cds);
-    gt_array_delete(v->utrs);
-    gt_array_delete(v->exons);
-    gt_array_delete(v->starts);
-    gt_array_delete(v->stops);
   }
   gt_feature_node_iterator_delete(iter);
 
@@ -477,12 +472,12 @@ static int visit_feature_node(GtNodeVisitor *nv, GtFeatureNode *fn,
 
 static void visit_mrna_check_cds_multi(AgnInferCDSVisitor *v)
 {
-  if(gt_array_size(v->cds) <= 1)
+  if(gt_array_size(v->anatomy.cds) <= 1)
   {
     return;
   }
 
-  GtFeatureNode **firstsegment = gt_array_get(v->cds, 0);
+  GtFeatureNode **firstsegment = gt_array_get(v->anatomy.cds, 0);
   const char *id = gt_feature_node_get_attribute(*firstsegment, "ID");
   if(id == NULL)
   {
@@ -492,9 +487,9 @@ static void visit_mrna_check_cds_multi(AgnInferCDSVisitor *v)
   }
   gt_feature_node_make_multi_representative(*firstsegment);
   GtUword i;
-  for(i = 0; i < gt_array_size(v->cds); i++)
+  for(i = 0; i < gt_array_size(v->anatomy.cds); i++)
   {
-    GtFeatureNode **segment = gt_array_get(v->cds, i);
+    GtFeatureNode **segment = gt_array_get(v->anatomy.cds, i);
     if(!gt_feature_node_is_multi(*segment))
     {
       gt_feature_node_set_multi_representative(*segment, *firstsegment);
@@ -504,7 +499,7 @@ static void visit_mrna_check_cds_multi(AgnInferCDSVisitor *v)
 
 static void visit_mrna_check_start(AgnInferCDSVisitor *v)
 {
-  if(gt_array_size(v->cds) == 0)
+  if(gt_array_size(v->anatomy.cds) == 0)
     return;
 
   const char *mrnaid = gt_feature_node_get_attribute(v->mrna, "ID");
@@ -512,25 +507,25 @@ static void visit_mrna_check_start(AgnInferCDSVisitor *v)
   GtStrand strand = gt_feature_node_get_strand(v->mrna);
 
   GtRange startrange;
-  GtGenomeNode **fiveprimesegment = gt_array_get(v->cds, 0);
+  GtGenomeNode **fiveprimesegment = gt_array_get(v->anatomy.cds, 0);
   startrange = gt_genome_node_get_range(*fiveprimesegment);
   startrange.end = startrange.start + 2;
   if(strand == GT_STRAND_REVERSE)
   {
-    GtUword fiveprimeindex = gt_array_size(v->cds) - 1;
-    fiveprimesegment = gt_array_get(v->cds, fiveprimeindex);
+    GtUword fiveprimeindex = gt_array_size(v->anatomy.cds) - 1;
+    fiveprimesegment = gt_array_get(v->anatomy.cds, fiveprimeindex);
     startrange = gt_genome_node_get_range(*fiveprimesegment);
     startrange.start = startrange.end - 2;
   }
 
-  if(gt_array_size(v->starts) > 1)
+  if(gt_array_size(v->anatomy.starts) > 1)
   {
     agn_logger_log_error(v->logger, "mRNA '%s' (line %u) has %lu start codons",
-                         mrnaid, ln, gt_array_size(v->starts));
+                         mrnaid, ln, gt_array_size(v->anatomy.starts));
   }
-  else if(gt_array_size(v->starts) == 1)
+  else if(gt_array_size(v->anatomy.starts) == 1)
   {
-    GtGenomeNode **codon = gt_array_get(v->starts, 0);
+    GtGenomeNode **codon = gt_array_get(v->anatomy.starts, 0);
     GtRange testrange = gt_genome_node_get_range(*codon);
     if(gt_range_compare(&startrange, &testrange) != 0)
     {
@@ -541,7 +536,7 @@ static void visit_mrna_check_start(AgnInferCDSVisitor *v)
                            mrnaid);
     }
   }
-  else // gt_assert(gt_array_size(v->starts) == 0)
+  else // gt_assert(gt_array_size(v->anatomy.starts) == 0)
   {
     GtStr *seqid = gt_genome_node_get_seqid((GtGenomeNode *)v->mrna);
     GtGenomeNode *codonfeature = gt_feature_node_new(seqid, "start_codon",
@@ -550,13 +545,13 @@ static void visit_mrna_check_start(AgnInferCDSVisitor *v)
                                                      strand);
     GtFeatureNode *cf = (GtFeatureNode *)codonfeature;
     gt_feature_node_add_child(v->mrna, cf);
-    gt_array_add(v->starts, cf);
+    gt_array_add(v->anatomy.starts, cf);
   }
 }
 
 static void visit_mrna_check_stop(AgnInferCDSVisitor *v)
 {
-  if(gt_array_size(v->cds) == 0)
+  if(gt_array_size(v->anatomy.cds) == 0)
     return;
 
   const char *mrnaid = gt_feature_node_get_attribute(v->mrna, "ID");
@@ -564,25 +559,26 @@ static void visit_mrna_check_stop(AgnInferCDSVisitor *v)
   GtStrand strand = gt_feature_node_get_strand(v->mrna);
 
   GtRange stoprange;
-  GtUword threeprimeindex = gt_array_size(v->cds) - 1;
-  GtGenomeNode **threeprimesegment = gt_array_get(v->cds, threeprimeindex);
+  GtUword threeprimeindex = gt_array_size(v->anatomy.cds) - 1;
+  GtGenomeNode **threeprimesegment = gt_array_get(v->anatomy.cds,
+                                                  threeprimeindex);
   stoprange = gt_genome_node_get_range(*threeprimesegment);
   stoprange.start = stoprange.end - 2;
   if(strand == GT_STRAND_REVERSE)
   {
-    threeprimesegment = gt_array_get(v->cds, 0);
+    threeprimesegment = gt_array_get(v->anatomy.cds, 0);
     stoprange = gt_genome_node_get_range(*threeprimesegment);
     stoprange.end = stoprange.start + 2;
   }
 
-  if(gt_array_size(v->stops) > 1)
+  if(gt_array_size(v->anatomy.stops) > 1)
   {
     agn_logger_log_error(v->logger, "mRNA '%s' (line %u) has %lu stop codons",
-                         mrnaid, ln, gt_array_size(v->starts));
+                         mrnaid, ln, gt_array_size(v->anatomy.starts));
   }
-  else if(gt_array_size(v->stops) == 1)
+  else if(gt_array_size(v->anatomy.stops) == 1)
   {
-    GtGenomeNode **codon = gt_array_get(v->stops, 0);
+    GtGenomeNode **codon = gt_array_get(v->anatomy.stops, 0);
     GtRange testrange = gt_genome_node_get_range(*codon);
     if(gt_range_compare(&stoprange, &testrange) != 0)
     {
@@ -593,7 +589,7 @@ static void visit_mrna_check_stop(AgnInferCDSVisitor *v)
                            mrnaid);
     }
   }
-  else // gt_assert(gt_array_size(v->stops) == 0)
+  else // gt_assert(gt_array_size(v->anatomy.stops) == 0)
   {
     GtStr *seqid = gt_genome_node_get_seqid((GtGenomeNode *)v->mrna);
     GtGenomeNode *codonfeature = gt_feature_node_new(seqid, "stop_codon",
@@ -602,7 +598,7 @@ static void visit_mrna_check_stop(AgnInferCDSVisitor *v)
                                                      strand);
     GtFeatureNode *cf = (GtFeatureNode *)codonfeature;
     gt_feature_node_add_child(v->mrna, cf);
-    gt_array_add(v->stops, cf);
+    gt_array_add(v->anatomy.stops, cf);
   }
 }
 
@@ -610,13 +606,13 @@ static void visit_mrna_infer_cds(AgnInferCDSVisitor *v)
 {
   GtFeatureNode **start_codon, **stop_codon;
 
-  bool exonsexplicit    = gt_array_size(v->exons) > 0;
-  bool startcodon_check = gt_array_size(v->starts) == 1 &&
-                          (start_codon = gt_array_get(v->starts, 0)) != NULL;
-  bool stopcodon_check  = gt_array_size(v->stops)  == 1 &&
-                          (stop_codon  = gt_array_get(v->stops,  0)) != NULL;
+  bool exonsexplicit    = gt_array_size(v->anatomy.exons) > 0;
+  bool startcodon_check = gt_array_size(v->anatomy.starts) == 1 &&
+                     (start_codon = gt_array_get(v->anatomy.starts, 0)) != NULL;
+  bool stopcodon_check  = gt_array_size(v->anatomy.stops)  == 1 &&
+                     (stop_codon  = gt_array_get(v->anatomy.stops,  0)) != NULL;
 
-  if(gt_array_size(v->cds) > 0)
+  if(gt_array_size(v->anatomy.cds) > 0)
   {
     return;
   }
@@ -634,9 +630,9 @@ static void visit_mrna_infer_cds(AgnInferCDSVisitor *v)
     right_codon_range = gt_genome_node_get_range(*(GtGenomeNode **)start_codon);
   }
   GtUword i;
-  for(i = 0; i < gt_array_size(v->exons); i++)
+  for(i = 0; i < gt_array_size(v->anatomy.exons); i++)
   {
-    GtFeatureNode *exon = *(GtFeatureNode **)gt_array_get(v->exons, i);
+    GtFeatureNode *exon = *(GtFeatureNode **)gt_array_get(v->anatomy.exons, i);
     GtGenomeNode *exon_gn = (GtGenomeNode *)exon;
     GtRange exon_range = gt_genome_node_get_range(exon_gn);
     GtStrand exon_strand = gt_feature_node_get_strand(exon);
@@ -651,7 +647,7 @@ static void visit_mrna_infer_cds(AgnInferCDSVisitor *v)
       cdsfeat = gt_feature_node_new(gt_genome_node_get_seqid(exon_gn), "CDS",
                                     cdsrange.start, cdsrange.end, exon_strand);
       gt_feature_node_add_child(v->mrna, (GtFeatureNode *)cdsfeat);
-      gt_array_add(v->cds, cdsfeat);
+      gt_array_add(v->anatomy.cds, cdsfeat);
     }
   }
 }
@@ -660,15 +656,15 @@ static void visit_mrna_infer_utrs(AgnInferCDSVisitor *v)
 {
   GtFeatureNode *start_codon, *stop_codon;
 
-  bool exonsexplicit    = gt_array_size(v->exons) > 0;
-  bool cdsexplicit      = gt_array_size(v->cds) > 0;
-  bool startcodon_check = gt_array_size(v->starts) == 1 &&
-                          (start_codon = gt_array_get(v->starts, 0)) != NULL;
-  bool stopcodon_check  = gt_array_size(v->stops)  == 1 &&
-                          (stop_codon  = gt_array_get(v->stops,  0)) != NULL;
+  bool exonsexplicit    = gt_array_size(v->anatomy.exons) > 0;
+  bool cdsexplicit      = gt_array_size(v->anatomy.cds) > 0;
+  bool startcodon_check = gt_array_size(v->anatomy.starts) == 1 &&
+                     (start_codon = gt_array_get(v->anatomy.starts, 0)) != NULL;
+  bool stopcodon_check  = gt_array_size(v->anatomy.stops)  == 1 &&
+                     (stop_codon  = gt_array_get(v->anatomy.stops,  0)) != NULL;
   bool caninferutrs     = exonsexplicit && startcodon_check && stopcodon_check;
 
-  if(gt_array_size(v->utrs) > 0)
+  if(gt_array_size(v->anatomy.utrs) > 0)
   {
     return;
   }
@@ -677,8 +673,8 @@ static void visit_mrna_infer_utrs(AgnInferCDSVisitor *v)
     return;
   }
 
-  GtGenomeNode **leftcodon = gt_array_get(v->starts, 0);
-  GtGenomeNode **rightcodon = gt_array_get(v->stops, 0);
+  GtGenomeNode **leftcodon = gt_array_get(v->anatomy.starts, 0);
+  GtGenomeNode **rightcodon = gt_array_get(v->anatomy.stops, 0);
   GtStrand strand = gt_feature_node_get_strand(v->mrna);
   const char *lefttype  = "five_prime_UTR";
   const char *righttype = "three_prime_UTR";
@@ -694,9 +690,9 @@ static void visit_mrna_infer_utrs(AgnInferCDSVisitor *v)
   GtRange rightrange = gt_genome_node_get_range(*rightcodon);
 
   GtUword i;
-  for(i = 0; i < gt_array_size(v->exons); i++)
+  for(i = 0; i < gt_array_size(v->anatomy.exons); i++)
   {
-    GtGenomeNode **exon = gt_array_get(v->exons, i);
+    GtGenomeNode **exon = gt_array_get(v->anatomy.exons, i);
     GtRange exonrange = gt_genome_node_get_range(*exon);
     if(exonrange.start < leftrange.start)
     {
@@ -714,7 +710,7 @@ static void visit_mrna_infer_utrs(AgnInferCDSVisitor *v)
                                               lefttype, utrrange.start,
                                               utrrange.end, strand);
       gt_feature_node_add_child(v->mrna, (GtFeatureNode *)utr);
-      gt_array_add(v->utrs, utr);
+      gt_array_add(v->anatomy.utrs, utr);
     }
 
     if(exonrange.end > rightrange.end)
@@ -733,7 +729,7 @@ static void visit_mrna_infer_utrs(AgnInferCDSVisitor *v)
                                               righttype, utrrange.start,
                                               utrrange.end, strand);
       gt_feature_node_add_child(v->mrna, (GtFeatureNode *)utr);
-      gt_array_add(v->utrs, utr);
+      gt_array_add(v->anatomy.utrs, utr);
     }
   }
 }
@@ -17,10 +17,10 @@ struct AgnInferExonsVisitor
 {
   const GtNodeVisitor parent_instance;
   GtFeatureNode *gene;
-  GtIntervalTree *exonsbyrange;
-  GtIntervalTree *intronsbyrange;
-  GtArray *exons;
-  GtArray *introns;
+  GtHashmap *exonsbyrange;
+  GtHashmap *intronsbyrange;
+  AgnTranscriptAnatomy geneanatomy;
+  AgnTranscriptAnatomy mrnaanatomy;
   AgnLogger *logger;
 };
 
@@ -34,6 +34,11 @@ struct AgnInferExonsVisitor
  */
 static const GtNodeVisitorClass* agn_infer_exons_visitor_class();
 
+/**
+ * @function Destructor for the class.
+ */
+static void infer_exons_visitor_free(GtNodeVisitor *nv);
+
 /**
  * @function Run unit tests using the basic grape example data.
  */
@@ -55,11 +60,19 @@ static int visit_feature_node(GtNodeVisitor *nv, GtFeatureNode *fn,
 /**
  * @function If an exon with the same coordinates already exists and belongs to
  * another mRNA, associate it with this mRNA as well instead of creating a
- * duplicate feature.
+ * duplicate feature. Features are looked up by exact range in
+ * ``featsbyrange``.
  */
 static bool visit_gene_collapse_feature(AgnInferExonsVisitor *v,
                                         GtFeatureNode *mrna, GtRange *range,
-                                        GtIntervalTree *featsbyrange);
+                                        GtHashmap *featsbyrange);
+
+/**
+ * @function Store a feature in ``featsbyrange`` under its exact range, unless
+ * a feature with the same range is already stored.
+ */
+static void visit_gene_index_feature(GtHashmap *featsbyrange,
+                                     GtFeatureNode *fn);
 
 /**
  * @function Infer exons from CDS and UTR segments if possible.
@@ -73,9 +86,10 @@ static void visit_gene_infer_introns(AgnInferExonsVisitor *v);
 
 
 /**
- * @function Check each mRNA to ensure none of its exons overlap.
+ * @function Check each mRNA to ensure none of its exons overlap. Returns false
+ * (after logging a warning) if any mRNA of the gene has overlapping exons.
  */
-static void visit_mrna_check_overlap(AgnInferExonsVisitor *v);
+static bool visit_mrna_check_overlap(AgnInferExonsVisitor *v);
 
 //----------------------------------------------------------------------------//
 // Method implementations
@@ -87,7 +101,7 @@ static const GtNodeVisitorClass* agn_infer_exons_visitor_class()
   if(!nvc)
   {
     nvc = gt_node_visitor_class_new(sizeof (AgnInferExonsVisitor),
-                                    NULL,
+                                    infer_exons_visitor_free,
                                     NULL,
                                     visit_feature_node,
                                     NULL,
@@ -97,12 +111,25 @@ static const GtNodeVisitorClass* agn_infer_exons_visitor_class()
   return nvc;
 }
 
+static void infer_exons_visitor_free(GtNodeVisitor *nv)
+{
+  AgnInferExonsVisitor *v = agn_infer_exons_visitor_cast(nv);
+  agn_transcript_anatomy_free(&v->geneanatomy);
+  agn_transcript_anatomy_free(&v->mrnaanatomy);
+  gt_hashmap_delete(v->exonsbyrange);
+  gt_hashmap_delete(v->intronsbyrange);
+}
+
 GtNodeVisitor* agn_infer_exons_visitor_new(AgnLogger *logger)
 {
   GtNodeVisitor *nv;
   nv = gt_node_visitor_create(agn_infer_exons_visitor_class());
   AgnInferExonsVisitor *v = agn_infer_exons_visitor_cast(nv);
   v->logger = logger;
+  agn_transcript_anatomy_init(&v->geneanatomy);
+  agn_transcript_anatomy_init(&v->mrnaanatomy);
+  v->exonsbyrange = gt_hashmap_new(GT_HASH_STRING, gt_free_func, NULL);
+  v->intronsbyrange = gt_hashmap_new(GT_HASH_STRING, gt_free_func, NULL);
   return nv;
 }
 
@@ -344,32 +371,26 @@ static int visit_feature_node(GtNodeVisitor *nv, GtFeatureNode *fn,
 
     GtUword i;
     v->gene = current;
-    visit_mrna_check_overlap(v);
+    agn_gt_feature_node_anatomy(current, &v->geneanatomy);
+    if(!visit_mrna_check_overlap(v))
+    {
+      gt_feature_node_mark(current);
+      continue;
+    }
 
-    v->exonsbyrange = gt_interval_tree_new(NULL);
-    v->exons = agn_gt_feature_node_children_of_type(current,
-                                           agn_gt_feature_node_is_exon_feature);
-    for(i = 0; i < gt_array_size(v->exons); i++)
+    gt_hashmap_reset(v->exonsbyrange);
+    gt_hashmap_reset(v->intronsbyrange);
+    for(i = 0; i < gt_array_size(v->geneanatomy.exons); i++)
     {
-      GtGenomeNode **exon = gt_array_get(v->exons, i);
-      GtRange range = gt_genome_node_get_range(*exon);
-      GtIntervalTreeNode *itn = gt_interval_tree_node_new(*exon, range.start,
-                                                          range.end);
-      gt_interval_tree_insert(v->exonsbyrange, itn);
+      GtFeatureNode **exon = gt_array_get(v->geneanatomy.exons, i);
+      visit_gene_index_feature(v->exonsbyrange, *exon);
     }
-    if(gt_array_size(v->exons) == 0)
+    if(gt_array_size(v->geneanatomy.exons) == 0)
       visit_gene_infer_exons(v);
 
-    v->intronsbyrange = gt_interval_tree_new(NULL);
-    v->introns = agn_gt_feature_node_children_of_type(current,
-                                         agn_gt_feature_node_is_intron_feature);
-    if(gt_array_size(v->introns) == 0 && gt_array_size(v->exons) > 1)
+    if(gt_array_size(v->geneanatomy.introns) == 0 &&
+       gt_array_size(v->geneanatomy.exons) > 1)
       visit_gene_infer_introns(v);
-
-    gt_array_delete(v->exons);
-    gt_array_delete(v->introns);
-    gt_interval_tree_delete(v->exonsbyrange);
-    gt_interval_tree_delete(v->intronsbyrange);
   }
   gt_feature_node_iterator_delete(iter);
 
@@ -378,33 +399,33 @@ static int visit_feature_node(GtNodeVisitor *nv, GtFeatureNode *fn,
 
 static bool visit_gene_collapse_feature(AgnInferExonsVisitor *v,
                                         GtFeatureNode *mrna, GtRange *range,
-                                        GtIntervalTree *featsbyrange)
+                                        GtHashmap *featsbyrange)
 {
-  GtArray *overlapping = gt_array_new( sizeof(GtFeatureNode *) );
-  gt_interval_tree_find_all_overlapping(featsbyrange, range->start,
-                                        range->end, overlapping);
-  bool collapsed = false;
-  while(gt_array_size(overlapping) > 0)
-  {
-    GtFeatureNode *fn = *(GtFeatureNode **)gt_array_pop(overlapping);
-    GtRange fnrange = gt_genome_node_get_range((GtGenomeNode *)fn);
-    if(gt_range_compare(range, &fnrange) == 0)
-    {
-      gt_feature_node_add_child(mrna, fn);
-      gt_genome_node_ref((GtGenomeNode *)fn);
-      const char *parentattr = gt_feature_node_get_attribute(fn, "Parent");
-      const char *tid = gt_feature_node_get_attribute(mrna, "ID");
-      char parentstr[1024];
-      strcpy(parentstr, parentattr);
-      sprintf(parentstr + strlen(parentstr), ",%s", tid);
-      gt_feature_node_set_attribute(fn, "Parent", parentstr);
-
-      collapsed = true;
-      break;
-    }
-  }
-  gt_array_delete(overlapping);
-  return collapsed;
+  char rangestr[64];
+  sprintf(rangestr, "%lu-%lu", range->start, range->end);
+  GtFeatureNode *fn = gt_hashmap_get(featsbyrange, rangestr);
+  if(fn == NULL)
+    return false;
+
+  gt_feature_node_add_child(mrna, fn);
+  gt_genome_node_ref((GtGenomeNode *)fn);
+  const char *parentattr = gt_feature_node_get_attribute(fn, "Parent");
+  const char *tid = gt_feature_node_get_attribute(mrna, "ID");
+  char parentstr[1024];
+  strcpy(parentstr, parentattr);
+  sprintf(parentstr + strlen(parentstr), ",%s", tid);
+  gt_feature_node_set_attribute(fn, "Parent", parentstr);
+  return true;
+}
+
+static void visit_gene_index_feature(GtHashmap *featsbyrange,
+                                     GtFeatureNode *fn)
+{
+  char rangestr[64];
+  GtRange range = gt_genome_node_get_range((GtGenomeNode *)fn);
+  sprintf(rangestr, "%lu-%lu", range.start, range.end);
+  if(gt_hashmap_get(featsbyrange, rangestr) == NULL)
+    gt_hashmap_add(featsbyrange, gt_cstr_dup(rangestr), fn);
 }
 
 static void visit_gene_infer_exons(AgnInferExonsVisitor *v)
@@ -420,10 +441,9 @@ static void visit_gene_infer_exons(AgnInferExonsVisitor *v)
 
     const char *mrnaid = gt_feature_node_get_attribute(fn, "ID");
     unsigned int ln = gt_genome_node_get_line_number((GtGenomeNode *)fn);
-    GtArray *cds  = agn_gt_feature_node_children_of_type(fn,
-                                            agn_gt_feature_node_is_cds_feature);
-    GtArray *utrs = agn_gt_feature_node_children_of_type(fn,
-                                            agn_gt_feature_node_is_utr_feature);
+    agn_gt_feature_node_anatomy(fn, &v->mrnaanatomy);
+    GtArray *cds  = v->mrnaanatomy.cds;
+    GtArray *utrs = v->mrnaanatomy.utrs;
 
     bool cds_explicit = gt_array_size(cds) > 0;
     if(!cds_explicit)
@@ -433,35 +453,48 @@ static void visit_gene_infer_exons(AgnInferExonsVisitor *v)
       continue;
     }
 
-    GtUword i,j;
-    GtHashmap *adjacent_utrs = gt_hashmap_new(GT_HASH_DIRECT, NULL, NULL);
+    // CDS and UTR segments are both sorted by start coordinate, so a single
+    // sweep finds every UTR segment adjacent to each CDS segment. UTRs that end
+    // well before the current CDS segment cannot be adjacent to it or to any
+    // later segment and are skipped for good.
+    GtUword i, j, first = 0, numutrs = gt_array_size(utrs);
+    bool *adjacent_utrs = gt_calloc(numutrs > 0 ? numutrs : 1, sizeof (bool));
     GtArray *exons_to_add = gt_array_new( sizeof(GtRange) );
     for(i = 0; i < gt_array_size(cds); i++)
     {
       GtGenomeNode **cdssegment = gt_array_get(cds, i);
       GtRange crange = gt_genome_node_get_range(*cdssegment);
       GtRange erange = crange;
-      for(j = 0; j < gt_array_size(utrs); j++)
+      while(first < numutrs)
+      {
+        GtGenomeNode **utrsegment = gt_array_get(utrs, first);
+        if(gt_genome_node_get_end(*utrsegment) + 1 >= crange.start)
+          break;
+        first++;
+      }
+      for(j = first; j < numutrs; j++)
       {
         GtGenomeNode **utrsegment = gt_array_get(utrs, j);
         GtRange urange = gt_genome_node_get_range(*utrsegment);
+        if(urange.start > crange.end + 1)
+          break;
 
         // If the UTR segment is adjacent to the CDS, merge the ranges
         if(urange.end+1 == crange.start || crange.end+1 == urange.start)
         {
           erange = gt_range_join(&erange, &urange);
-          gt_hashmap_add(adjacent_utrs, utrsegment, utrsegment);
+          adjacent_utrs[j] = true;
         }
       }
       gt_array_add(exons_to_add, erange);
     }
 
     // Now create UTR-only exons
-    for(i = 0; i < gt_array_size(utrs); i++)
+    for(i = 0; i < numutrs; i++)
     {
       GtGenomeNode **utrsegment = gt_array_get(utrs, i);
       GtRange urange = gt_genome_node_get_range(*utrsegment);
-      if(gt_hashmap_get(adjacent_utrs, utrsegment) == NULL)
+      if(!adjacent_utrs[i])
       {
         gt_array_add(exons_to_add, urange);
       }
@@ -485,21 +518,17 @@ static void visit_gene_infer_exons(AgnInferExonsVisitor *v)
       gt_feature_node_add_child(fn, fn_exon);
       if(mrnaid)
         gt_feature_node_add_attribute(fn_exon, "Parent", mrnaid);
-      gt_array_add(v->exons, exon);
-      GtIntervalTreeNode *node = gt_interval_tree_node_new(exon, erange->start,
-                                                           erange->end);
-      gt_interval_tree_insert(v->exonsbyrange, node);
+      gt_array_add(v->geneanatomy.exons, exon);
+      visit_gene_index_feature(v->exonsbyrange, fn_exon);
     }
     gt_array_delete(exons_to_add);
 
-    if(gt_array_size(v->exons) == 0)
+    if(gt_array_size(v->geneanatomy.exons) == 0)
     {
       agn_logger_log_error(v->logger, "unable to infer exons for mRNA '%s'"
                            "(line %u)", mrnaid, ln);
     }
-    gt_array_delete(cds);
-    gt_array_delete(utrs);
-    gt_hashmap_delete(adjacent_utrs);
+    gt_free(adjacent_utrs);
   }
   gt_feature_node_iterator_delete(iter);
 }
@@ -517,13 +546,10 @@ void visit_gene_infer_introns(AgnInferExonsVisitor *v)
 
     const char *mrnaid = gt_feature_node_get_attribute(fn, "ID");
     unsigned int ln = gt_genome_node_get_line_number((GtGenomeNode *)fn);
-    GtArray *exons = agn_gt_feature_node_children_of_type(fn,
-                                           agn_gt_feature_node_is_exon_feature);
+    agn_gt_feature_node_anatomy(fn, &v->mrnaanatomy);
+    GtArray *exons = v->mrnaanatomy.exons;
     if(gt_array_size(exons) < 2)
-    {
-      gt_array_delete(exons);
       continue;
-    }
 
     GtUword i;
     GtArray *introns_to_add = gt_array_new( sizeof(GtRange) );
@@ -538,6 +564,8 @@ void visit_gene_infer_introns(AgnInferExonsVisitor *v)
       {
         agn_logger_log_error(v->logger, "mRNA '%s' (line %u) has directly "
                              "adjacent exons", mrnaid, ln);
+        gt_array_delete(introns_to_add);
+        gt_feature_node_iterator_delete(iter);
         return;
       }
       else
@@ -565,50 +593,49 @@ void visit_gene_infer_introns(AgnInferExonsVisitor *v)
       gt_feature_node_add_child(fn, fn_intron);
       if(mrnaid)
         gt_feature_node_add_attribute(fn_intron, "Parent", mrnaid);
-      gt_array_add(v->introns, fn_intron);
-      GtIntervalTreeNode *node = gt_interval_tree_node_new(intron,irange->start,
-                                                           irange->end);
-      gt_interval_tree_insert(v->intronsbyrange, node);
+      gt_array_add(v->geneanatomy.introns, fn_intron);
+      visit_gene_index_feature(v->intronsbyrange, fn_intron);
     }
     gt_array_delete(introns_to_add);
-    gt_array_delete(exons);
   }
   gt_feature_node_iterator_delete(iter);
 }
 
-static void visit_mrna_check_overlap(AgnInferExonsVisitor *v)
+static bool visit_mrna_check_overlap(AgnInferExonsVisitor *v)
 {
-  GtArray *mrnas = agn_gt_feature_node_children_of_type(v->gene,
-                                           agn_gt_feature_node_is_mrna_feature);
-  while(gt_array_size(mrnas) > 0)
+  GtUword k;
+  GtArray *mrnas = v->geneanatomy.mrnas;
+  for(k = 0; k < gt_array_size(mrnas); k++)
   {
-    GtGenomeNode **mrna = gt_array_pop(mrnas);
+    GtGenomeNode **mrna = gt_array_get(mrnas, k);
     GtFeatureNode *mrnafn = gt_feature_node_cast(*mrna);
-    GtArray *exons = agn_gt_feature_node_children_of_type(mrnafn,
-                                           agn_gt_feature_node_is_exon_feature);
-    GtUword i,j;
+    agn_gt_feature_node_anatomy(mrnafn, &v->mrnaanatomy);
+    GtArray *exons = v->mrnaanatomy.exons;
+
+    // Exons are sorted by start coordinate, so an exon overlaps a previous
+    // one exactly when it starts before the furthest end seen so far.
+    GtUword i, maxend = 0;
     for(i = 0; i < gt_array_size(exons); i++)
     {
-      GtGenomeNode **gni = gt_array_get(exons, i);
-      GtRange rangei = gt_genome_node_get_range(*gni);
-      for(j = i + 1; j < gt_array_size(exons); j++)
+      GtGenomeNode **exon = gt_array_get(exons, i);
+      GtRange range = gt_genome_node_get_range(*exon);
+      if(i > 0 && range.start <= maxend)
       {
-        GtGenomeNode **gnj = gt_array_get(exons, j);
-        GtRange rangej = gt_genome_node_get_range(*gnj);
-        if(gt_range_overlap(&rangei, &rangej))
-        {
-          GtStr *seqid = gt_genome_node_get_seqid(*mrna);
-          GtRange mrnarange = gt_genome_node_get_range(*mrna);
-          fprintf(stderr, "error: mRNA %s:%lu-%lu has overlapping exons",
-                  gt_str_get(seqid), mrnarange.start, mrnarange.end);
-          exit(1);
-        }
+        const char *mrnaid = gt_feature_node_get_attribute(mrnafn, "ID");
+        GtStr *seqid = gt_genome_node_get_seqid(*mrna);
+        GtRange mrnarange = gt_genome_node_get_range(*mrna);
+        const char *geneid = gt_feature_node_get_attribute(v->gene, "ID");
+        agn_logger_log_warning(v->logger, "ignoring gene '%s': mRNA '%s' "
+                               "(%s:%lu-%lu, line %u) has overlapping exons",
+                               geneid, mrnaid, gt_str_get(seqid),
+                               mrnarange.start, mrnarange.end,
+                               gt_genome_node_get_line_number(*mrna));
+        return false;
       }
+      if(range.end > maxend)
+        maxend = range.end;
     }
-
-    gt_array_delete(exons);
   }
 
-  gt_array_delete(mrnas);
+  return true;
 }
-
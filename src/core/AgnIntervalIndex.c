@@ -0,0 +1,453 @@
+#include <stdlib.h>
+#include "AgnIntervalIndex.h"
+
+// Subtrees at or below this level are scanned linearly rather than descended
+#define INTERVAL_INDEX_SCAN_LEVEL 3
+
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+/**
+ * An interval in the sealed index; ``maxend`` is the largest end coordinate in
+ * the subtree rooted at the interval.
+ */
+typedef struct
+{
+  GtUword start;
+  GtUword end;
+  GtUword maxend;
+} IntervalIndexNode;
+
+/**
+ * An interval added to the index but not yet sorted.
+ */
+typedef struct
+{
+  GtRange range;
+  void *value;
+} IntervalIndexEntry;
+
+struct AgnIntervalIndex
+{
+  GtArray *entries;
+  IntervalIndexNode *nodes;
+  GtArray *values;
+  GtUword size;
+  int rootlevel;
+  bool sealed;
+};
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+/**
+ * Compute the maximum end coordinate of each subtree of the implicit tree,
+ * bottom up.
+ *
+ * @param[in] idx    the index
+ * @returns          the level of the root of the tree
+ */
+static int interval_index_build(AgnIntervalIndex *idx);
+
+/**
+ * Hit function used to append each value found to an array.
+ *
+ * @param[in]  query    position of the query (unused)
+ * @param[in]  value    the value
+ * @param[out] data     the array
+ */
+static void interval_index_collect(GtUword query, void *value, void *data);
+
+/**
+ * Compare two unsorted intervals by their ranges.
+ *
+ * @param[in] e1    an interval
+ * @param[in] e2    another interval
+ * @returns         negative, zero, or positive, as for qsort
+ */
+static int interval_index_entry_compare(const void *e1, const void *e2);
+
+/**
+ * Report each interval overlapping a single query.
+ *
+ * @param[in] idx      the index
+ * @param[in] range    the query
+ * @param[in] query    position of the query, passed on to ``func``
+ * @param[in] func     function to which each hit is passed
+ * @param[in] data     data passed to ``func``
+ * @returns            the number of hits
+ */
+static GtUword interval_index_query(AgnIntervalIndex *idx, const GtRange *range,
+                                    GtUword query, AgnIntervalIndexHitFunc func,
+                                    void *data);
+
+/**
+ * Hit function used to count the hits of each query in a batch.
+ *
+ * @param[in]  query    position of the query
+ * @param[in]  value    the value (unused)
+ * @param[out] data     array of counts, one per query
+ */
+static void interval_index_test_count(GtUword query, void *value, void *data);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+void agn_interval_index_add(AgnIntervalIndex *idx, GtRange *range,
+                            void *value)
+{
+  gt_assert(!idx->sealed);
+  IntervalIndexEntry entry = { *range, value };
+  gt_array_add(idx->entries, entry);
+}
+
+void agn_interval_index_delete(AgnIntervalIndex *idx)
+{
+  gt_array_delete(idx->entries);
+  gt_free(idx->nodes);
+  gt_array_delete(idx->values);
+  gt_free(idx);
+}
+
+void agn_interval_index_find(AgnIntervalIndex *idx, GtRange *range,
+                             GtArray *values)
+{
+  gt_assert(idx->sealed && values != NULL);
+  interval_index_query(idx, range, 0, interval_index_collect, values);
+}
+
+GtUword agn_interval_index_find_batch(AgnIntervalIndex *idx,
+                                      const GtRange *queries,
+                                      GtUword numqueries,
+                                      AgnIntervalIndexHitFunc func,
+                                      void *data)
+{
+  gt_assert(idx->sealed);
+  GtUword i, numhits = 0;
+  for(i = 0; i < numqueries; i++)
+    numhits += interval_index_query(idx, queries + i, i, func, data);
+  return numhits;
+}
+
+GtUword agn_interval_index_find_sorted(AgnIntervalIndex *idx,
+                                       const GtRange *queries,
+                                       GtUword numqueries,
+                                       AgnIntervalIndexHitFunc func,
+                                       void *data)
+{
+  gt_assert(idx->sealed);
+  IntervalIndexNode *nodes = idx->nodes;
+  void **values = gt_array_get_space(idx->values);
+  GtUword i, j, n = idx->size, first = 0, laststart = 0, numhits = 0;
+  for(i = 0; i < numqueries; i++)
+  {
+    // Intervals ending before a query starts cannot overlap any later query
+    const GtRange *query = queries + i;
+    if(query->start < laststart)
+      first = 0;
+    laststart = query->start;
+    while(first < n && nodes[first].end < query->start)
+      first++;
+
+    for(j = first; j < n && nodes[j].start <= query->end; j++)
+    {
+      if(query->start <= nodes[j].end)
+      {
+        func(i, values[j], data);
+        numhits++;
+      }
+    }
+  }
+  return numhits;
+}
+
+AgnIntervalIndex *agn_interval_index_new(void)
+{
+  AgnIntervalIndex *idx = gt_malloc( sizeof(AgnIntervalIndex) );
+  idx->entries = gt_array_new( sizeof(IntervalIndexEntry) );
+  idx->nodes = NULL;
+  idx->values = gt_array_new( sizeof(void *) );
+  idx->size = 0;
+  idx->rootlevel = -1;
+  idx->sealed = false;
+  return idx;
+}
+
+void agn_interval_index_seal(AgnIntervalIndex *idx)
+{
+  if(idx->sealed)
+    return;
+
+  gt_array_sort(idx->entries, interval_index_entry_compare);
+  idx->size = gt_array_size(idx->entries);
+  idx->nodes = gt_malloc( (idx->size + 1) * sizeof(IntervalIndexNode) );
+  GtUword i;
+  for(i = 0; i < idx->size; i++)
+  {
+    IntervalIndexEntry *entry = gt_array_get(idx->entries, i);
+    idx->nodes[i].start = entry->range.start;
+    idx->nodes[i].end = entry->range.end;
+    gt_array_add(idx->values, entry->value);
+  }
+  gt_array_delete(idx->entries);
+  idx->entries = NULL;
+
+  idx->rootlevel = interval_index_build(idx);
+  idx->sealed = true;
+}
+
+GtUword agn_interval_index_size(AgnIntervalIndex *idx)
+{
+  if(idx->sealed)
+    return idx->size;
+  return gt_array_size(idx->entries);
+}
+
+bool agn_interval_index_unit_test(AgnUnitTest *test)
+{
+  // Pseudo-random intervals, including many short and a few very long ones
+  AgnIntervalIndex *idx = agn_interval_index_new();
+  GtArray *ranges = gt_array_new( sizeof(GtRange) );
+  GtUword i, j, seed = 42;
+  for(i = 0; i < 5000; i++)
+  {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    GtRange range;
+    range.start = (seed >> 33) % 1000000 + 1;
+    range.end = range.start + (seed >> 20) % (i % 100 == 0 ? 50000 : 2000);
+    gt_array_add(ranges, range);
+  }
+
+  // Values are pointers into the array of ranges, which is not modified after
+  // this point
+  for(i = 0; i < gt_array_size(ranges); i++)
+  {
+    GtRange *range = gt_array_get(ranges, i);
+    agn_interval_index_add(idx, range, range);
+  }
+  agn_interval_index_seal(idx);
+
+  bool sortpass = agn_interval_index_size(idx) == 5000;
+  GtArray *values = agn_interval_index_values(idx);
+  for(i = 1; sortpass && i < gt_array_size(values); i++)
+  {
+    GtRange *r1 = *(GtRange **)gt_array_get(values, i - 1);
+    GtRange *r2 = *(GtRange **)gt_array_get(values, i);
+    sortpass = gt_range_compare(r1, r2) <= 0;
+  }
+  agn_unit_test_result(test, "sorted values", sortpass);
+
+  // Compare each query against a scan of all intervals
+  GtRange queries[200];
+  GtUword expected[200], counts[200];
+  bool findpass = true;
+  GtArray *found = gt_array_new( sizeof(GtRange *) );
+  for(i = 0; i < 200; i++)
+  {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    queries[i].start = (seed >> 33) % 1100000;
+    queries[i].end = queries[i].start + (i % 4 == 0 ? 0 : (seed >> 20) % 20000);
+    expected[i] = 0;
+    counts[i] = 0;
+    for(j = 0; j < gt_array_size(ranges); j++)
+    {
+      if(gt_range_overlap(gt_array_get(ranges, j), queries + i))
+        expected[i]++;
+    }
+
+    gt_array_reset(found);
+    agn_interval_index_find(idx, queries + i, found);
+    findpass = findpass && gt_array_size(found) == expected[i];
+    for(j = 0; findpass && j < gt_array_size(found); j++)
+    {
+      GtRange *range = *(GtRange **)gt_array_get(found, j);
+      findpass = gt_range_overlap(range, queries + i);
+      if(j > 0)
+      {
+        GtRange *prev = *(GtRange **)gt_array_get(found, j - 1);
+        findpass = findpass && gt_range_compare(prev, range) <= 0;
+      }
+    }
+  }
+  gt_array_delete(found);
+  agn_unit_test_result(test, "overlap queries", findpass);
+
+  GtUword numhits = agn_interval_index_find_batch(idx, queries, 200,
+                                                  interval_index_test_count,
+                                                  counts);
+  bool batchpass = true;
+  GtUword totalhits = 0;
+  for(i = 0; i < 200; i++)
+  {
+    batchpass = batchpass && counts[i] == expected[i];
+    totalhits += expected[i];
+  }
+  batchpass = batchpass && numhits == totalhits;
+  agn_unit_test_result(test, "batch queries", batchpass);
+
+  // Merging sorted queries must give the same hits as searching the tree
+  qsort(queries, 200, sizeof(GtRange), (GtCompare)gt_range_compare);
+  GtUword sortedhits = 0;
+  bool sortedpass = true;
+  for(i = 0; i < 200; i++)
+  {
+    counts[i] = 0;
+    expected[i] = agn_interval_index_find_batch(idx, queries + i, 1,
+                                                interval_index_test_count,
+                                                counts + i);
+    counts[i] = 0;
+    sortedhits += expected[i];
+  }
+  numhits = agn_interval_index_find_sorted(idx, queries, 200,
+                                           interval_index_test_count, counts);
+  for(i = 0; i < 200; i++)
+    sortedpass = sortedpass && counts[i] == expected[i];
+  sortedpass = sortedpass && numhits == sortedhits;
+  agn_unit_test_result(test, "sorted batch queries", sortedpass);
+
+  AgnIntervalIndex *empty = agn_interval_index_new();
+  agn_interval_index_seal(empty);
+  GtArray *nothing = gt_array_new( sizeof(void *) );
+  agn_interval_index_find(empty, queries, nothing);
+  bool emptypass = gt_array_size(nothing) == 0 &&
+                   gt_array_size(agn_interval_index_values(empty)) == 0;
+  agn_unit_test_result(test, "empty index", emptypass);
+  gt_array_delete(nothing);
+  agn_interval_index_delete(empty);
+
+  agn_interval_index_delete(idx);
+  gt_array_delete(ranges);
+  return sortpass && findpass && batchpass && sortedpass && emptypass;
+}
+
+GtArray *agn_interval_index_values(AgnIntervalIndex *idx)
+{
+  gt_assert(idx->sealed);
+  return idx->values;
+}
+
+static int interval_index_build(AgnIntervalIndex *idx)
+{
+  IntervalIndexNode *nodes = idx->nodes;
+  GtUword i, n = idx->size, lastnode = 0, lastmax = 0;
+  if(n == 0)
+    return -1;
+
+  // Leaves are the even positions; lastnode tracks the rightmost node at each
+  // level, whose right child may lie beyond the end of the array
+  for(i = 0; i < n; i += 2)
+  {
+    lastnode = i;
+    lastmax = nodes[i].maxend = nodes[i].end;
+  }
+  int level;
+  for(level = 1; (1UL << level) <= n; level++)
+  {
+    GtUword half = 1UL << (level - 1), first = (half << 1) - 1;
+    GtUword step = half << 2;
+    for(i = first; i < n; i += step)
+    {
+      GtUword leftmax = nodes[i - half].maxend;
+      GtUword rightmax = i + half < n ? nodes[i + half].maxend : lastmax;
+      GtUword maxend = nodes[i].end;
+      maxend = leftmax > maxend ? leftmax : maxend;
+      maxend = rightmax > maxend ? rightmax : maxend;
+      nodes[i].maxend = maxend;
+    }
+    lastnode = (lastnode >> level) & 1 ? lastnode - half : lastnode + half;
+    if(lastnode < n && nodes[lastnode].maxend > lastmax)
+      lastmax = nodes[lastnode].maxend;
+  }
+  return level - 1;
+}
+
+static void interval_index_collect(GtUword query, void *value, void *data)
+{
+  GtArray *values = data;
+  gt_array_add(values, value);
+}
+
+static int interval_index_entry_compare(const void *e1, const void *e2)
+{
+  const IntervalIndexEntry *entry1 = e1;
+  const IntervalIndexEntry *entry2 = e2;
+  return gt_range_compare(&entry1->range, &entry2->range);
+}
+
+static GtUword interval_index_query(AgnIntervalIndex *idx, const GtRange *range,
+                                    GtUword query, AgnIntervalIndexHitFunc func,
+                                    void *data)
+{
+  if(idx->rootlevel < 0)
+    return 0;
+
+  // Top-down traversal with an explicit stack; each node is visited before
+  // its right subtree and after its left subtree, so hits are sorted
+  struct { GtUword node; int level; bool leftdone; } stack[64];
+  IntervalIndexNode *nodes = idx->nodes;
+  void **values = gt_array_get_space(idx->values);
+  GtUword n = idx->size, numhits = 0;
+  int top = 0;
+  stack[top].node = (1UL << idx->rootlevel) - 1;
+  stack[top].level = idx->rootlevel;
+  stack[top++].leftdone = false;
+  while(top > 0)
+  {
+    GtUword node = stack[--top].node;
+    int level = stack[top].level;
+    bool leftdone = stack[top].leftdone;
+    if(level <= INTERVAL_INDEX_SCAN_LEVEL)
+    {
+      GtUword i, first = node >> level << level;
+      GtUword last = first + (1UL << (level + 1)) - 1;
+      if(last > n)
+        last = n;
+      for(i = first; i < last && nodes[i].start <= range->end; i++)
+      {
+        if(range->start <= nodes[i].end)
+        {
+          func(query, values[i], data);
+          numhits++;
+        }
+      }
+    }
+    else if(!leftdone)
+    {
+      // The left child may lie beyond the end of the array, in which case its
+      // subtree is only partly populated
+      GtUword left = node - (1UL << (level - 1));
+      stack[top].node = node;
+      stack[top].level = level;
+      stack[top++].leftdone = true;
+      if(left >= n || nodes[left].maxend >= range->start)
+      {
+        stack[top].node = left;
+        stack[top].level = level - 1;
+        stack[top++].leftdone = false;
+      }
+    }
+    else if(node < n && nodes[node].start <= range->end)
+    {
+      if(range->start <= nodes[node].end)
+      {
+        func(query, values[node], data);
+        numhits++;
+      }
+      stack[top].node = node + (1UL << (level - 1));
+      stack[top].level = level - 1;
+      stack[top++].leftdone = false;
+    }
+  }
+  return numhits;
+}
+
+static void interval_index_test_count(GtUword query, void *value, void *data)
+{
+  GtUword *counts = data;
+  counts[query]++;
+}
@@ -1,5 +1,7 @@
+#include <string.h>
 #include "AgnLocusIndex.h"
 #include "AgnGeneLocus.h"
+#include "AgnIntervalIndex.h"
 #include "AgnTestData.h"
 #include "AgnUtils.h"
 
@@ -11,14 +13,55 @@ struct AgnLocusIndex
   GtStrArray *seqids;
   GtHashmap *seqranges;
   GtHashmap *locus_trees;
+  GtHashmap *sealed;
   GtFree locusfreefunc;
 };
 
+/**
+ * State for computing the interval loci of a single sequence in one sweep over
+ * its gene loci, which must be added in order. Each gene locus is held back
+ * until the next one (or the end of the sequence) is known, since the
+ * boundaries of its iLocus depend on the gaps on either side.
+ */
+typedef struct
+{
+  const char *seqid;
+  GtUword delta;
+  bool skipterminal;
+  bool ownsloci;
+  GtUword seqstart;
+  GtUword numloci;
+  GtUword firststart;
+  bool extendfirst;
+  AgnIntervalLocus current;
+  AgnIntervalLocusVisitFunc func;
+  void *funcdata;
+} IntervalLocusSweep;
+
+/**
+ * Function and data passed to :c:func:`agn_locus_index_find_batch`.
+ */
+typedef struct
+{
+  AgnLocusIndexHitFunc func;
+  void *data;
+} LocusIndexBatch;
+
 
 //------------------------------------------------------------------------------
 // Prototypes for private methods
 //------------------------------------------------------------------------------
 
+/**
+ * Hit function passed to the sealed index, which passes each locus on to the
+ * caller's function.
+ *
+ * @param[in] query    position of the query
+ * @param[in] value    the locus
+ * @param[in] data     the caller's function and data
+ */
+static void agn_locus_index_batch_hit(GtUword query, void *value, void *data);
+
 /**
  * Function used to traverse the given interval tree and add all its loci to the
  * given array.
@@ -29,6 +72,18 @@ struct AgnLocusIndex
  */
 static int agn_locus_index_it_traverse(GtIntervalTreeNode *itn, void *lp);
 
+/**
+ * Retrieve the sealed interval index for the given sequence, building it from
+ * the sequence's interval tree the first time it is needed.
+ *
+ * @param[in] idx      the locus index
+ * @param[in] seqid    the sequence ID
+ * @returns            the sealed index, or NULL if there are no loci for the
+ *                     sequence
+ */
+static AgnIntervalIndex *agn_locus_index_sealed(AgnLocusIndex *idx,
+                                                const char *seqid);
+
 /**
  * Given two sets of annotations for the same sequence (a reference set and a
  * prediction set), this function associates each gene annotation with the
@@ -73,6 +128,63 @@ static int agn_locus_index_pairwise_test_overlap(AgnLocusIndex *idx,
                                                  AgnComparisonSource source,
                                                  AgnLogger *logger);
 
+/**
+ * Callback for collecting interval loci in an array.
+ *
+ * @param[in]  ilocus    the iLocus
+ * @param[in]  seqid     the sequence ID (unused)
+ * @param[out] data      the array
+ */
+static void agn_locus_index_sweep_collect(AgnIntervalLocus *ilocus,
+                                          const char *seqid, void *data);
+
+/**
+ * Pass an iLocus to the sweep's callback, then delete its gene locus if the
+ * sweep owns it.
+ *
+ * @param[in] sweep     the sweep
+ * @param[in] ilocus    the iLocus
+ */
+static void agn_locus_index_sweep_emit(IntervalLocusSweep *sweep,
+                                       AgnIntervalLocus *ilocus);
+
+/**
+ * Report the remaining iLoci of the sequence once its end is known.
+ *
+ * @param[in] sweep     the sweep
+ * @param[in] seqend    end coordinate of the sequence
+ */
+static void agn_locus_index_sweep_finish(IntervalLocusSweep *sweep,
+                                         GtUword seqend);
+
+/**
+ * Initialize a sweep over the gene loci of a sequence.
+ *
+ * @param[out] sweep           the sweep
+ * @param[in]  seqid           the sequence ID
+ * @param[in]  seqstart        start coordinate of the sequence
+ * @param[in]  delta           the iLocus delta
+ * @param[in]  skipterminal    whether to skip gene-less iLoci at either end
+ * @param[in]  ownsloci        whether to delete gene loci once reported
+ * @param[in]  func            function to which each iLocus is passed
+ * @param[in]  funcdata        data passed to ``func``
+ */
+static void agn_locus_index_sweep_init(IntervalLocusSweep *sweep,
+                                       const char *seqid, GtUword seqstart,
+                                       GtUword delta, bool skipterminal,
+                                       bool ownsloci,
+                                       AgnIntervalLocusVisitFunc func,
+                                       void *funcdata);
+
+/**
+ * Add the next gene locus of the sequence, reporting the iLoci preceding it.
+ *
+ * @param[in] sweep    the sweep
+ * @param[in] locus    the gene locus
+ */
+static void agn_locus_index_sweep_push(IntervalLocusSweep *sweep,
+                                       AgnGeneLocus *locus);
+
 /**
  * Given a locus and a collection of genomic features, search for genes that
  * overlap with the locus and assign them to the locus.
@@ -104,32 +216,25 @@ void agn_locus_index_comparative_analysis(AgnLocusIndex *idx, const char *seqid,
                                           void *analyfuncdata,
                                           AgnLogger *logger)
 {
-  GtArray *seqloci = agn_locus_index_get(idx, seqid);
+  GtArray *seqloci = agn_locus_index_get_sorted(idx, seqid);
   GtUword nloci = gt_array_size(seqloci);
 
   int i;
+  // Loci with profiling enabled time their own analysis (see
+  // agn_gene_locus_get_profile), so that the post-analysis function can
+  // report it
   for(i = 0; i < nloci; i++)
   {
-    GtTimer *timer = gt_timer_new();
-    gt_timer_start(timer);
     AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(seqloci, i);
     preanalyfunc(locus, analyfuncdata);
     agn_gene_locus_comparative_analysis(locus);
     postanalyfunc(locus, analyfuncdata);
-    gt_timer_stop(timer);
-    //agn_logger_log_status(logger, "proc=%d; locus=%s[%lu, %lu]; length=%lu; "
-    //    "trans=%lu,%lu; pairs=%lu,%lu", rank, agn_gene_locus_get_seqid(locus),
-    //    agn_gene_locus_get_start(locus), agn_gene_locus_get_end(locus),
-    //    agn_gene_locus_get_length(locus),
-    //    agn_gene_locus_num_refr_transcripts(locus),
-    //    agn_gene_locus_num_pred_transcripts(locus), npairs,
-    //    gt_array_size(reportedpairs));
-    gt_timer_delete(timer);
   }
 }
 
 void agn_locus_index_delete(AgnLocusIndex *idx)
 {
+  gt_hashmap_delete(idx->sealed);
   gt_hashmap_delete(idx->locus_trees);
   gt_str_array_delete(idx->seqids);
   gt_hashmap_delete(idx->seqranges);
@@ -141,143 +246,95 @@ void agn_locus_index_find(AgnLocusIndex *idx, const char *seqid, GtRange *range,
                           GtArray *loci)
 {
   gt_assert(loci != NULL);
-  GtIntervalTree *it = gt_hashmap_get(idx->locus_trees, seqid);
-  if(it == NULL)
+  AgnIntervalIndex *sealed = agn_locus_index_sealed(idx, seqid);
+  if(sealed == NULL)
     return;
 
-  gt_interval_tree_find_all_overlapping(it, range->start, range->end, loci);
+  agn_interval_index_find(sealed, range, loci);
+}
+
+GtUword agn_locus_index_find_batch(AgnLocusIndex *idx, const char *seqid,
+                                   const GtRange *queries, GtUword numqueries,
+                                   AgnLocusIndexHitFunc func, void *data)
+{
+  AgnIntervalIndex *sealed = agn_locus_index_sealed(idx, seqid);
+  if(sealed == NULL)
+    return 0;
+
+  LocusIndexBatch batch = { func, data };
+  return agn_interval_index_find_sorted(sealed, queries, numqueries,
+                                        agn_locus_index_batch_hit, &batch);
 }
 
 GtArray *agn_locus_index_get(AgnLocusIndex *idx, const char *seqid)
 {
-  GtIntervalTree *it = gt_hashmap_get(idx->locus_trees, seqid);
-  if(it == NULL)
+  GtArray *sorted = agn_locus_index_get_sorted(idx, seqid);
+  if(sorted == NULL)
     return NULL;
 
   GtArray *loci = gt_array_new( sizeof(AgnGeneLocus *) );
-  gt_interval_tree_traverse(it, agn_locus_index_it_traverse, loci);
+  GtUword i;
+  for(i = 0; i < gt_array_size(sorted); i++)
+    gt_array_add(loci, *(AgnGeneLocus **)gt_array_get(sorted, i));
   return loci;
 }
 
-GtArray *agn_locus_index_interval_loci(AgnLocusIndex *idx, const char *seqid,
-                                       GtUword delta, bool skipterminal)
+GtArray *agn_locus_index_get_sorted(AgnLocusIndex *idx, const char *seqid)
 {
-  GtArray *loci = agn_locus_index_get(idx, seqid);
-  if(loci == NULL)
+  AgnIntervalIndex *sealed = agn_locus_index_sealed(idx, seqid);
+  if(sealed == NULL)
     return NULL;
-  gt_array_sort(loci, (GtCompare)agn_gene_locus_array_compare);
-
-  GtUword nloci = gt_array_size(loci);
-  GtArray *iloci = gt_array_new( sizeof(AgnGeneLocus *) );
-  GtRange *seqrange = gt_hashmap_get(idx->seqranges, seqid);
-
-  GtUword i;
-  GtArray *clonedloci = gt_array_new( sizeof(AgnGeneLocus *) );
-  for(i = 0; i < nloci; i++)
-  {
-    AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(loci, i);
-    AgnGeneLocus *clone = agn_gene_locus_clone(locus);
-    gt_array_add(clonedloci, clone);
-  }
-  gt_array_delete(loci);
-  loci = clonedloci;
-
-  // Handle trivial case
-  if(nloci == 0)
-  {
-    if(skipterminal)
-      return iloci;
-
-    AgnGeneLocus *ilocus = agn_gene_locus_new(seqid);
-    agn_gene_locus_set_range(ilocus, seqrange->start, seqrange->end);
-    gt_array_add(iloci, ilocus);
-    gt_array_delete(loci);
-    return iloci;
-  }
 
-  // Handle initial ilocus
-  AgnGeneLocus *l1 = *(AgnGeneLocus **)gt_array_get(loci, 0);
-  GtRange r1 = agn_gene_locus_range(l1);
-  if(r1.start >= seqrange->start + (2*delta))
-  {
-    if(nloci == 1)
-      agn_gene_locus_set_range(l1, r1.start - delta, r1.end);
+  return agn_interval_index_values(sealed);
+}
 
-    if(!skipterminal)
-    {
-      AgnGeneLocus *ilocus = agn_gene_locus_new(seqid);
-      agn_gene_locus_set_range(ilocus, seqrange->start, r1.start - delta - 1);
-      gt_array_add(iloci, ilocus);
-    }
-  }
-  else
+GtArray *agn_locus_index_interval_loci(AgnLocusIndex *idx, const char *seqid,
+                                       GtUword delta, bool skipterminal)
+{
+  GtArray *iloci;
+  if(!agn_locus_index_interval_loci_deltas(idx, seqid, &delta, 1, skipterminal,
+                                           &iloci))
   {
-    agn_gene_locus_set_range(l1, seqrange->start, r1.end);
+    return NULL;
   }
+  return iloci;
+}
 
-  // Handle internal iloci
-  for(i = 0; i < nloci - 1; i++)
-  {
-    AgnGeneLocus *llocus = *(AgnGeneLocus **)gt_array_get(loci, i);
-    AgnGeneLocus *rlocus = *(AgnGeneLocus **)gt_array_get(loci, i+1);
-    GtRange lrange = agn_gene_locus_range(llocus);
-    GtRange rrange = agn_gene_locus_range(rlocus);
-
-    gt_array_add(iloci, llocus);
-    if(lrange.end + delta >= rrange.start)
-    {
-      agn_gene_locus_set_range(llocus, lrange.start, rrange.start - 1);
-      agn_gene_locus_set_range(rlocus, lrange.end + 1, rrange.end);
-    }
-    else if(lrange.end + (2*delta) >= rrange.start)
-    {
-      agn_gene_locus_set_range(llocus, lrange.start, lrange.end + delta);
-      agn_gene_locus_set_range(rlocus, rrange.start - delta, rrange.end);
-    }
-    else if(lrange.end + (3*delta) >= rrange.start)
-    {
-      GtUword midpoint = (lrange.end + rrange.start) / 2;
-      agn_gene_locus_set_range(llocus, lrange.start, midpoint);
-      agn_gene_locus_set_range(rlocus, midpoint + 1, rrange.end);
-    }
-    else
-    {
-      agn_gene_locus_set_range(llocus, lrange.start, lrange.end + delta);
-      agn_gene_locus_set_range(rlocus, rrange.start - delta, rrange.end);
-      AgnGeneLocus *ilocus = agn_gene_locus_new(seqid);
-      agn_gene_locus_set_range(ilocus, lrange.end + delta + 1,
-                               rrange.start - delta - 1);
-      gt_array_add(iloci, ilocus);
-    }
-
-    if(i == nloci - 2)
-      gt_array_add(iloci, rlocus);
-  }
+bool agn_locus_index_interval_loci_deltas(AgnLocusIndex *idx,
+                                          const char *seqid,
+                                          const GtUword *deltas,
+                                          GtUword numdeltas, bool skipterminal,
+                                          GtArray **iloci)
+{
+  GtArray *loci = agn_locus_index_get_sorted(idx, seqid);
+  if(loci == NULL)
+    return false;
 
-  // Handle terminal ilocus
-  l1 = *(AgnGeneLocus **)gt_array_get(loci, nloci - 1);
-  r1 = agn_gene_locus_range(l1);
-  if(seqrange->end > (2*delta) && r1.end <= seqrange->end - (2*delta))
+  // The loci are sorted once and then swept once for each delta; gene loci are
+  // only referenced by the iLoci, never copied or modified
+  GtRange *seqrange = gt_hashmap_get(idx->seqranges, seqid);
+  GtUword i, j;
+  for(i = 0; i < numdeltas; i++)
   {
-    agn_gene_locus_set_range(l1, r1.start, r1.end + delta);
-
-    if(!skipterminal)
+    iloci[i] = gt_array_new( sizeof(AgnIntervalLocus) );
+    IntervalLocusSweep sweep;
+    agn_locus_index_sweep_init(&sweep, seqid, seqrange->start, deltas[i],
+                               skipterminal, false,
+                               agn_locus_index_sweep_collect, iloci[i]);
+    for(j = 0; j < gt_array_size(loci); j++)
     {
-      AgnGeneLocus *ilocus = agn_gene_locus_new(seqid);
-      agn_gene_locus_set_range(ilocus, r1.end + delta + 1, seqrange->end);
-      gt_array_add(iloci, ilocus);
+      AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(loci, j);
+      agn_locus_index_sweep_push(&sweep, locus);
     }
+    agn_locus_index_sweep_finish(&sweep, seqrange->end);
   }
-  else
-  {
-    agn_gene_locus_set_range(l1, r1.start, seqrange->end);
-  }
-  if(nloci == 1)
-    gt_array_add(iloci, l1);
+  return true;
+}
 
-  gt_array_delete(loci);
-  gt_array_sort(iloci, (GtCompare)agn_gene_locus_array_compare);
-  return iloci;
+static void agn_locus_index_batch_hit(GtUword query, void *value, void *data)
+{
+  LocusIndexBatch *batch = data;
+  batch->func(query, value, batch->data);
 }
 
 static int agn_locus_index_it_traverse(GtIntervalTreeNode *itn, void *lp)
@@ -295,6 +352,8 @@ AgnLocusIndex *agn_locus_index_new(bool freeondelete)
   idx->seqranges = gt_hashmap_new(GT_HASH_STRING, NULL, (GtFree)gt_free_func);
   idx->locus_trees = gt_hashmap_new(GT_HASH_STRING, NULL,
                                     (GtFree)gt_interval_tree_delete);
+  idx->sealed = gt_hashmap_new(GT_HASH_STRING, gt_free_func,
+                               (GtFree)agn_interval_index_delete);
   idx->locusfreefunc = NULL;
   if(freeondelete)
     idx->locusfreefunc = (GtFree)agn_gene_locus_delete;
@@ -303,12 +362,13 @@ AgnLocusIndex *agn_locus_index_new(bool freeondelete)
 }
 
 GtUword agn_locus_index_parse_disk(AgnLocusIndex * idx, int numfiles,
-                                   const char **filenames, AgnLogger *logger)
+                                   const char **filenames, int flags,
+                                   AgnLogger *logger)
 {
   gt_assert(idx != NULL);
   GtUword nloci;
   GtFeatureIndex *features = agn_import_simple(numfiles, filenames, "gene",
-                                               logger);
+                                               flags, logger);
   if(agn_logger_has_error(logger))
   {
     gt_feature_index_delete(features);
@@ -614,6 +674,7 @@ GtUword agn_locus_index_parse_pairwise_memory(AgnLocusIndex *idx,
     seqrange->end   = trange.end;
 
     totalloci += gt_interval_tree_size(loci);
+    gt_hashmap_remove(idx->sealed, seqid);
     gt_hashmap_add(idx->locus_trees, (char *)seqid, loci);
     gt_hashmap_add(idx->seqranges, (char *)seqid, seqrange);
     agn_logger_log_status(logger, "computed loci for sequence '%s'", seqid);
@@ -626,14 +687,16 @@ GtUword agn_locus_index_parse_pairwise_memory(AgnLocusIndex *idx,
 
 GtUword agn_locus_index_parse_pairwise_disk(AgnLocusIndex *idx,
                                             const char *refrfile,
-                                            const char *predfile,
+                                            const char *predfile, int flags,
                                             AgnCompareFilters *filters,
                                             AgnLogger *logger)
 {
   gt_assert(idx != NULL);
   GtUword nloci;
-  GtFeatureIndex *refrfeats = agn_import_canonical(1, &refrfile, logger);
-  GtFeatureIndex *predfeats = agn_import_canonical(1, &predfile, logger);
+  GtFeatureIndex *refrfeats = agn_import_canonical(1, &refrfile, flags,
+                                                   logger);
+  GtFeatureIndex *predfeats = agn_import_canonical(1, &predfile, flags,
+                                                   logger);
   if(agn_logger_has_error(logger))
   {
     gt_feature_index_delete(refrfeats);
@@ -681,6 +744,7 @@ GtUword agn_locus_index_parse_memory(AgnLocusIndex *idx,
     seqrange->end   = trange.end;
 
     totalloci += gt_interval_tree_size(loci);
+    gt_hashmap_remove(idx->sealed, seqid);
     gt_hashmap_add(idx->locus_trees, (char *)seqid, loci);
     gt_hashmap_add(idx->seqranges, (char *)seqid, seqrange);
     agn_logger_log_status(logger, "computed loci for sequence '%s'", seqid);
@@ -739,11 +803,345 @@ int agn_locus_index_test_overlap(AgnLocusIndex *idx, GtFeatureIndex *features,
   return new_gene_count;
 }
 
+void agn_locus_index_seal(AgnLocusIndex *idx)
+{
+  GtUword i;
+  for(i = 0; i < gt_str_array_size(idx->seqids); i++)
+    agn_locus_index_sealed(idx, gt_str_array_get(idx->seqids, i));
+}
+
+static AgnIntervalIndex *agn_locus_index_sealed(AgnLocusIndex *idx,
+                                                const char *seqid)
+{
+  AgnIntervalIndex *sealed = gt_hashmap_get(idx->sealed, seqid);
+  if(sealed != NULL)
+    return sealed;
+
+  GtIntervalTree *it = gt_hashmap_get(idx->locus_trees, seqid);
+  if(it == NULL)
+    return NULL;
+
+  GtArray *loci = gt_array_new( sizeof(AgnGeneLocus *) );
+  gt_interval_tree_traverse(it, agn_locus_index_it_traverse, loci);
+  sealed = agn_interval_index_new();
+  GtUword i;
+  for(i = 0; i < gt_array_size(loci); i++)
+  {
+    AgnGeneLocus *locus = *(AgnGeneLocus **)gt_array_get(loci, i);
+    GtRange range = agn_gene_locus_range(locus);
+    agn_interval_index_add(sealed, &range, locus);
+  }
+  agn_interval_index_seal(sealed);
+  gt_array_delete(loci);
+  gt_hashmap_add(idx->sealed, gt_cstr_dup(seqid), sealed);
+  return sealed;
+}
+
 GtStrArray *agn_locus_index_seqids(AgnLocusIndex *idx)
 {
   return idx->seqids;
 }
 
+int agn_locus_index_stream_interval_loci(GtNodeStream *in_stream,
+                                         GtUword delta, bool skipterminal,
+                                         AgnIntervalLocusVisitFunc func,
+                                         void *funcdata, GtError *error)
+{
+  GtHashmap *regions = gt_hashmap_new(GT_HASH_STRING, gt_free_func,
+                                      gt_free_func);
+  GtStrArray *regionorder = gt_str_array_new();
+  GtHashmap *seqids = gt_hashmap_new(GT_HASH_STRING, gt_free_func, NULL);
+  GtStr *seqid = gt_str_new();
+  IntervalLocusSweep sweep;
+  GtRange seqrange = { 0, 0 };
+  bool explicitrange = false;
+  AgnGeneLocus *locus = NULL;
+  GtUword laststart = 0;
+
+  GtGenomeNode *gn;
+  int had_err;
+  while(!(had_err = gt_node_stream_next(in_stream, &gn, error)) && gn != NULL)
+  {
+    // Declared sequence regions precede the features they contain
+    GtRegionNode *rn = gt_region_node_try_cast(gn);
+    if(rn != NULL)
+    {
+      const char *rnseqid = gt_str_get(gt_genome_node_get_seqid(gn));
+      if(gt_hashmap_get(regions, rnseqid) == NULL)
+      {
+        GtRange *range = gt_malloc( sizeof(GtRange) );
+        *range = gt_genome_node_get_range(gn);
+        gt_hashmap_add(regions, gt_cstr_dup(rnseqid), range);
+        gt_str_array_add_cstr(regionorder, rnseqid);
+      }
+      gt_genome_node_delete(gn);
+      continue;
+    }
+    GtFeatureNode *fn = gt_feature_node_try_cast(gn);
+    if(fn == NULL)
+    {
+      gt_genome_node_delete(gn);
+      continue;
+    }
+
+    const char *fnseqid = gt_str_get(gt_genome_node_get_seqid(gn));
+    GtRange fnrange = gt_genome_node_get_range(gn);
+    if(gt_str_length(seqid) == 0 || strcmp(fnseqid, gt_str_get(seqid)) != 0)
+    {
+      if(gt_str_length(seqid) > 0)
+      {
+        if(locus != NULL)
+          agn_locus_index_sweep_push(&sweep, locus);
+        locus = NULL;
+        agn_locus_index_sweep_finish(&sweep, seqrange.end);
+      }
+      if(gt_hashmap_get(seqids, fnseqid) != NULL)
+      {
+        gt_error_set(error, "file \"%s\": line %u: features for sequence '%s' "
+                     "are not contiguous; input is not sorted",
+                     gt_genome_node_get_filename(gn),
+                     gt_genome_node_get_line_number(gn), fnseqid);
+        gt_str_reset(seqid);
+        gt_genome_node_delete(gn);
+        had_err = -1;
+        break;
+      }
+      gt_hashmap_add(seqids, gt_cstr_dup(fnseqid), seqids);
+      gt_str_reset(seqid);
+      gt_str_append_cstr(seqid, fnseqid);
+
+      // Without a declared region, the sequence spans its features
+      GtRange *region = gt_hashmap_get(regions, fnseqid);
+      explicitrange = region != NULL;
+      seqrange = explicitrange ? *region : fnrange;
+      agn_locus_index_sweep_init(&sweep, gt_str_get(seqid), seqrange.start,
+                                 delta, skipterminal, true, func, funcdata);
+      laststart = 0;
+    }
+    if(!explicitrange && fnrange.end > seqrange.end)
+      seqrange.end = fnrange.end;
+
+    // Genes are merged into the current locus for as long as they overlap it
+    GtFeatureNodeIterator *iter = gt_feature_node_iterator_new(fn);
+    GtFeatureNode *feature;
+    for(feature  = gt_feature_node_iterator_next(iter);
+        feature != NULL && !had_err;
+        feature  = gt_feature_node_iterator_next(iter))
+    {
+      if(!gt_feature_node_has_type(feature, "gene"))
+        continue;
+
+      GtRange generange = gt_genome_node_get_range((GtGenomeNode *)feature);
+      if(generange.start < laststart)
+      {
+        gt_error_set(error, "file \"%s\": line %u: gene starting at %lu "
+                     "follows a gene starting at %lu on sequence '%s'; input "
+                     "is not sorted", gt_genome_node_get_filename(gn),
+                     gt_genome_node_get_line_number((GtGenomeNode *)feature),
+                     generange.start, laststart, fnseqid);
+        had_err = -1;
+        break;
+      }
+      laststart = generange.start;
+
+      if(locus != NULL && generange.start > agn_gene_locus_get_end(locus))
+      {
+        agn_locus_index_sweep_push(&sweep, locus);
+        locus = NULL;
+      }
+      if(locus == NULL)
+        locus = agn_gene_locus_new(gt_str_get(seqid));
+      agn_gene_locus_add_gene(locus, feature);
+    }
+    gt_feature_node_iterator_delete(iter);
+    gt_genome_node_delete(gn);
+    if(had_err)
+      break;
+  }
+
+  if(!had_err)
+  {
+    if(gt_str_length(seqid) > 0)
+    {
+      if(locus != NULL)
+        agn_locus_index_sweep_push(&sweep, locus);
+      agn_locus_index_sweep_finish(&sweep, seqrange.end);
+    }
+
+    // Declared sequences without any features form a single iLocus
+    GtUword i;
+    for(i = 0; i < gt_str_array_size(regionorder) && !skipterminal; i++)
+    {
+      const char *rnseqid = gt_str_array_get(regionorder, i);
+      if(gt_hashmap_get(seqids, rnseqid) != NULL)
+        continue;
+      GtRange *region = gt_hashmap_get(regions, rnseqid);
+      agn_locus_index_sweep_init(&sweep, rnseqid, region->start, delta,
+                                 skipterminal, true, func, funcdata);
+      agn_locus_index_sweep_finish(&sweep, region->end);
+    }
+  }
+  else
+  {
+    if(locus != NULL)
+      agn_gene_locus_delete(locus);
+    if(gt_str_length(seqid) > 0 && sweep.numloci > 0)
+      agn_gene_locus_delete(sweep.current.locus);
+  }
+
+  gt_hashmap_delete(regions);
+  gt_str_array_delete(regionorder);
+  gt_hashmap_delete(seqids);
+  gt_str_delete(seqid);
+  return had_err;
+}
+
+static void agn_locus_index_sweep_collect(AgnIntervalLocus *ilocus,
+                                          const char *seqid, void *data)
+{
+  GtArray *iloci = data;
+  gt_array_add(iloci, *ilocus);
+}
+
+static void agn_locus_index_sweep_emit(IntervalLocusSweep *sweep,
+                                       AgnIntervalLocus *ilocus)
+{
+  sweep->func(ilocus, sweep->seqid, sweep->funcdata);
+  if(sweep->ownsloci && ilocus->locus != NULL)
+    agn_gene_locus_delete(ilocus->locus);
+}
+
+static void agn_locus_index_sweep_finish(IntervalLocusSweep *sweep,
+                                         GtUword seqend)
+{
+  GtUword delta = sweep->delta;
+  AgnIntervalLocus intergenic = { { 0, 0 }, false, NULL };
+
+  // Handle trivial case
+  if(sweep->numloci == 0)
+  {
+    if(!sweep->skipterminal)
+    {
+      intergenic.range.start = sweep->seqstart;
+      intergenic.range.end = seqend;
+      agn_locus_index_sweep_emit(sweep, &intergenic);
+    }
+    return;
+  }
+
+  // A lone locus is extended at its start as well as its end
+  if(sweep->numloci == 1 && sweep->extendfirst)
+    sweep->current.range.start = sweep->firststart - delta;
+
+  // Handle terminal ilocus
+  GtRange r1 = sweep->current.range;
+  if(seqend > (2*delta) && r1.end <= seqend - (2*delta))
+  {
+    sweep->current.range.end = r1.end + delta;
+    agn_locus_index_sweep_emit(sweep, &sweep->current);
+
+    if(!sweep->skipterminal)
+    {
+      intergenic.range.start = r1.end + delta + 1;
+      intergenic.range.end = seqend;
+      agn_locus_index_sweep_emit(sweep, &intergenic);
+    }
+  }
+  else
+  {
+    sweep->current.range.end = seqend;
+    agn_locus_index_sweep_emit(sweep, &sweep->current);
+  }
+  sweep->numloci = 0;
+}
+
+static void agn_locus_index_sweep_init(IntervalLocusSweep *sweep,
+                                       const char *seqid, GtUword seqstart,
+                                       GtUword delta, bool skipterminal,
+                                       bool ownsloci,
+                                       AgnIntervalLocusVisitFunc func,
+                                       void *funcdata)
+{
+  sweep->seqid = seqid;
+  sweep->delta = delta;
+  sweep->skipterminal = skipterminal;
+  sweep->ownsloci = ownsloci;
+  sweep->seqstart = seqstart;
+  sweep->numloci = 0;
+  sweep->firststart = 0;
+  sweep->extendfirst = false;
+  sweep->func = func;
+  sweep->funcdata = funcdata;
+}
+
+static void agn_locus_index_sweep_push(IntervalLocusSweep *sweep,
+                                       AgnGeneLocus *locus)
+{
+  GtUword delta = sweep->delta;
+  AgnIntervalLocus next;
+  next.locus = locus;
+  next.range = agn_gene_locus_range(locus);
+  next.genic = true;
+
+  // Handle initial ilocus
+  if(sweep->numloci++ == 0)
+  {
+    GtRange r1 = next.range;
+    sweep->firststart = r1.start;
+    if(r1.start >= sweep->seqstart + (2*delta))
+    {
+      sweep->extendfirst = true;
+      if(!sweep->skipterminal)
+      {
+        AgnIntervalLocus intergenic = { { sweep->seqstart,
+                                          r1.start - delta - 1 }, false, NULL };
+        agn_locus_index_sweep_emit(sweep, &intergenic);
+      }
+    }
+    else
+    {
+      next.range.start = sweep->seqstart;
+    }
+    sweep->current = next;
+    return;
+  }
+
+  // Handle internal iloci
+  GtRange lrange = sweep->current.range;
+  GtRange rrange = next.range;
+  AgnIntervalLocus intergenic = { { 0, 0 }, false, NULL };
+  bool addintergenic = false;
+  if(lrange.end + delta >= rrange.start)
+  {
+    sweep->current.range.end = rrange.start - 1;
+    next.range.start = lrange.end + 1;
+  }
+  else if(lrange.end + (2*delta) >= rrange.start)
+  {
+    sweep->current.range.end = lrange.end + delta;
+    next.range.start = rrange.start - delta;
+  }
+  else if(lrange.end + (3*delta) >= rrange.start)
+  {
+    GtUword midpoint = (lrange.end + rrange.start) / 2;
+    sweep->current.range.end = midpoint;
+    next.range.start = midpoint + 1;
+  }
+  else
+  {
+    sweep->current.range.end = lrange.end + delta;
+    next.range.start = rrange.start - delta;
+    intergenic.range.start = lrange.end + delta + 1;
+    intergenic.range.end = rrange.start - delta - 1;
+    addintergenic = true;
+  }
+
+  agn_locus_index_sweep_emit(sweep, &sweep->current);
+  if(addintergenic)
+    agn_locus_index_sweep_emit(sweep, &intergenic);
+  sweep->current = next;
+}
+
 bool agn_locus_index_unit_test(AgnUnitTest *test)
 {
   AgnLocusIndex *index = agn_locus_index_new(true);
@@ -762,7 +1160,7 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   }
 
   GtArray *iloci;
-  AgnGeneLocus *ilocus;
+  AgnIntervalLocus *ilocus;
   GtStr *seqid;
   GtUword delta = 200;
 
@@ -771,8 +1169,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange = ilocus->range;
     GtRange testrange = {1, 900};
     if(gt_range_compare(&locusrange, &testrange) != 0)
       test1pass = false;
@@ -785,15 +1183,15 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 2)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange = ilocus->range;
     GtRange testrange = {1, 200};
     if(gt_range_compare(&locusrange, &testrange) != 0)
       test1pass = false;
     else
     {
-      ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-      locusrange = agn_gene_locus_range(ilocus);
+      ilocus = gt_array_get(iloci, 1);
+      locusrange = ilocus->range;
       GtRange newtestrange = {201, 900};
       if(gt_range_compare(&locusrange, &newtestrange) != 0)
         test1pass = false;
@@ -807,15 +1205,15 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 2)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange = ilocus->range;
     GtRange testrange = {1, 201};
     if(gt_range_compare(&locusrange, &testrange) != 0)
       test1pass = false;
     else
     {
-      ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-      locusrange = agn_gene_locus_range(ilocus);
+      ilocus = gt_array_get(iloci, 1);
+      locusrange = ilocus->range;
       GtRange newtestrange = {202, 900};
       if(gt_range_compare(&locusrange, &newtestrange) != 0)
         test1pass = false;
@@ -829,8 +1227,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange = ilocus->range;
     GtRange testrange = {1, 900};
     if(gt_range_compare(&locusrange, &testrange) != 0)
       test1pass = false;
@@ -843,8 +1241,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange = ilocus->range;
     GtRange testrange = {1, 900};
     if(gt_range_compare(&locusrange, &testrange) != 0)
       test1pass = false;
@@ -857,8 +1255,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange = ilocus->range;
     GtRange testrange = {1, 900};
     if(gt_range_compare(&locusrange, &testrange) != 0)
       test1pass = false;
@@ -875,23 +1273,23 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 4)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {801, 1001};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1002, 1600};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 3);
-    GtRange locusrange4 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 3);
+    GtRange locusrange4 = ilocus->range;
     GtRange testrange4 = {1601, 2000};
     if(gt_range_compare(&locusrange4, &testrange4) != 0)
       test2pass = false;
@@ -904,23 +1302,23 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 4)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {801, 1000};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1001, 1600};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 3);
-    GtRange locusrange4 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 3);
+    GtRange locusrange4 = ilocus->range;
     GtRange testrange4 = {1601, 2000};
     if(gt_range_compare(&locusrange4, &testrange4) != 0)
       test2pass = false;
@@ -933,18 +1331,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 900};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {901, 1600};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test2pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1601, 2000};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test2pass = false;
@@ -961,18 +1359,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 801};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test3pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {802, 1500};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test3pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1501, 2000};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test3pass = false;
@@ -985,18 +1383,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test3pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {801, 1500};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test3pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1501, 2000};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test3pass = false;
@@ -1009,18 +1407,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test3pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {800, 1500};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test3pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1501, 2000};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test3pass = false;
@@ -1037,18 +1435,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {603, 1300};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1301, 1500};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test4pass = false;
@@ -1061,18 +1459,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {602, 1300};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1301, 1500};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test4pass = false;
@@ -1085,18 +1483,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {601, 1300};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1301, 1500};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test4pass = false;
@@ -1109,18 +1507,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 799};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {601, 1300};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test4pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1301, 1500};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test4pass = false;
@@ -1137,18 +1535,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 605};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test5pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {601, 1200};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test5pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1201, 1500};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test5pass = false;
@@ -1161,18 +1559,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 601};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test5pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {601, 1200};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test5pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1201, 1500};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test5pass = false;
@@ -1185,18 +1583,18 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 3)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 600};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test5pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {601, 1200};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test5pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 2);
-    GtRange locusrange3 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 2);
+    GtRange locusrange3 = ilocus->range;
     GtRange testrange3 = {1201, 1500};
     if(gt_range_compare(&locusrange3, &testrange3) != 0)
       test5pass = false;
@@ -1213,13 +1611,13 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 2)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test6pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {801, 1001};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test6pass = false;
@@ -1232,13 +1630,13 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 2)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test6pass = false;
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 1);
-    GtRange locusrange2 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 1);
+    GtRange locusrange2 = ilocus->range;
     GtRange testrange2 = {801, 1000};
     if(gt_range_compare(&locusrange2, &testrange2) != 0)
       test6pass = false;
@@ -1251,8 +1649,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 999};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test6pass = false;
@@ -1265,8 +1663,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 801};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test6pass = false;
@@ -1279,8 +1677,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 800};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test6pass = false;
@@ -1293,8 +1691,8 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid), delta, false);
   if(gt_array_size(iloci) == 1)
   {
-    ilocus = *(AgnGeneLocus **)gt_array_get(iloci, 0);
-    GtRange locusrange1 = agn_gene_locus_range(ilocus);
+    ilocus = gt_array_get(iloci, 0);
+    GtRange locusrange1 = ilocus->range;
     GtRange testrange1 = {1, 799};
     if(gt_range_compare(&locusrange1, &testrange1) != 0)
       test6pass = false;
@@ -1306,6 +1704,40 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   agn_unit_test_result(test, "iLocus parsing: terminal iLoci", test6pass);
 
 
+  // A sweep over several deltas must match separate runs for each delta
+  bool test7pass = true;
+  GtUword deltas[] = { 0, 100, 200, 500 };
+  GtUword numdeltas = sizeof(deltas) / sizeof(GtUword);
+  for(i = 0; i < gt_array_size(seqids) && test7pass; i++)
+  {
+    GtArray *multiloci[4];
+    seqid = *(GtStr **)gt_array_get(seqids, i);
+    bool found = agn_locus_index_interval_loci_deltas(index,
+                                                      gt_str_get(seqid),
+                                                      deltas, numdeltas, false,
+                                                      multiloci);
+    test7pass = found;
+    GtUword j, k;
+    for(j = 0; test7pass && j < numdeltas; j++)
+    {
+      iloci = agn_locus_index_interval_loci(index, gt_str_get(seqid),
+                                            deltas[j], false);
+      test7pass = gt_array_size(iloci) == gt_array_size(multiloci[j]);
+      for(k = 0; test7pass && k < gt_array_size(iloci); k++)
+      {
+        AgnIntervalLocus *il1 = gt_array_get(iloci, k);
+        AgnIntervalLocus *il2 = gt_array_get(multiloci[j], k);
+        test7pass = gt_range_compare(&il1->range, &il2->range) == 0 &&
+                    il1->locus == il2->locus;
+      }
+      gt_array_delete(iloci);
+    }
+    for(j = 0; found && j < numdeltas; j++)
+      gt_array_delete(multiloci[j]);
+  }
+  agn_unit_test_result(test, "iLocus parsing: multiple deltas", test7pass);
+
+
   while(gt_array_size(seqids) > 0)
   {
     GtStr **seqid = gt_array_pop(seqids);
@@ -1315,5 +1747,5 @@ bool agn_locus_index_unit_test(AgnUnitTest *test)
   agn_locus_index_delete(index);
 
   return test1pass && test2pass && test3pass && test4pass && test5pass &&
-         test6pass;
+         test6pass && test7pass;
 }
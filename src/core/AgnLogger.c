@@ -1,26 +1,170 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 #include "AgnLogger.h"
 
+#define LOGGER_RING_SIZE      1024
+#define LOGGER_MESSAGE_SIZE   512
+#define LOGGER_TEMPLATE_SLOTS 1024
+#define LOGGER_TEMPLATE_PROBE 16
+
 //----------------------------------------------------------------------------//
 // Data structure definition
 //----------------------------------------------------------------------------//
+typedef enum
+{
+  LOGGER_STATUS,
+  LOGGER_WARNING,
+  LOGGER_ERROR,
+  LOGGER_NUM_CLASSES
+} LoggerClass;
+
+/**
+ * A slot in the ring buffer. The sequence number is used to coordinate the
+ * producers and the writer without locks: a slot at ring position ``pos`` is
+ * free for writing when its sequence equals ``pos``, and ready for the writer
+ * when its sequence equals ``pos + 1``.
+ */
+typedef struct
+{
+  GtUword sequence;
+  LoggerClass msgclass;
+  char text[LOGGER_MESSAGE_SIZE];
+} LoggerSlot;
+
+/**
+ * Occurrence count for a given format string, used for rate limiting.
+ */
+typedef struct
+{
+  const char *format;
+  GtUword count;
+} LoggerTemplate;
+
+/**
+ * State for streaming mode. Everything here is allocated once, at construction
+ * time.
+ */
+typedef struct
+{
+  FILE *outstream;
+  GtUword ratelimit;
+  LoggerSlot slots[LOGGER_RING_SIZE];
+  GtUword head;
+  GtUword tail;
+  LoggerTemplate templates[LOGGER_TEMPLATE_SLOTS];
+  GtUword logged[LOGGER_NUM_CLASSES];
+  GtUword suppressed[LOGGER_NUM_CLASSES];
+  GtUword dropped[LOGGER_NUM_CLASSES];
+  char last[LOGGER_MESSAGE_SIZE];
+  LoggerClass lastclass;
+  GtUword repeats;
+  bool shutdown;
+  pthread_t writer;
+} LoggerStream;
+
 struct AgnLogger
 {
   GtArray *errors;
   GtArray *messages;
   GtArray *warnings;
+  LoggerStream *stream;
 };
 
+static const char *logger_class_labels[] = { "status", "warning", "error" };
+
 
 //----------------------------------------------------------------------------//
 // Prototypes of private methods
 //----------------------------------------------------------------------------//
 
+/**
+ * Store or stream a message, depending on the logger's mode.
+ *
+ * @param[in] logger      the logger
+ * @param[in] msgclass    status, warning, or error
+ * @param[in] format      printf-style format string
+ * @param[in] ap          format arguments
+ */
+static void logger_log(AgnLogger *logger, LoggerClass msgclass,
+                       const char *format, va_list ap);
+
+/**
+ * Determine whether another message with the given format string should be
+ * written, or whether the rate limit for that format has been exceeded.
+ *
+ * @param[in] stream    the logger's streaming state
+ * @param[in] format    printf-style format string
+ * @returns             true if the message should be written
+ */
+static bool logger_stream_admit(LoggerStream *stream, const char *format);
+
+/**
+ * Block until the writer has written every message placed in the ring buffer.
+ *
+ * @param[in] stream    the logger's streaming state
+ */
+static void logger_stream_drain(LoggerStream *stream);
+
+/**
+ * Format a message into the next free slot of the ring buffer.
+ *
+ * @param[in] stream      the logger's streaming state
+ * @param[in] msgclass    status, warning, or error
+ * @param[in] format      printf-style format string
+ * @param[in] ap          format arguments
+ * @returns               false if the ring buffer is full
+ */
+static bool logger_stream_push(LoggerStream *stream, LoggerClass msgclass,
+                               const char *format, va_list ap);
+
+/**
+ * Write a message (or a pending repeat count) to the output stream. Only ever
+ * called by the writer thread.
+ *
+ * @param[in] stream      the logger's streaming state
+ * @param[in] msgclass    status, warning, or error
+ * @param[in] text        the message; NULL to flush a pending repeat count
+ */
+static void logger_stream_write(LoggerStream *stream, LoggerClass msgclass,
+                                const char *text);
+
+/**
+ * Main loop of the background writer thread.
+ *
+ * @param[in] data    the logger's streaming state
+ * @returns           NULL
+ */
+static void *logger_stream_writer(void *data);
+
 
 //----------------------------------------------------------------------------//
 // Method implementations
 //----------------------------------------------------------------------------//
 void agn_logger_delete(AgnLogger *logger)
 {
+  if(logger->stream != NULL)
+  {
+    LoggerStream *stream = logger->stream;
+    __atomic_store_n(&stream->shutdown, true, __ATOMIC_RELEASE);
+    pthread_join(stream->writer, NULL);
+
+    GtUword i;
+    for(i = 0; i < LOGGER_TEMPLATE_SLOTS; i++)
+    {
+      LoggerTemplate *template = stream->templates + i;
+      if(template->format != NULL && template->count > stream->ratelimit)
+      {
+        fprintf(stream->outstream, "%lu more messages like '%s' suppressed\n",
+                template->count - stream->ratelimit, template->format);
+      }
+    }
+    fflush(stream->outstream);
+    gt_free(stream);
+  }
+
   agn_logger_unset(logger);
   gt_array_delete(logger->errors);
   gt_array_delete(logger->messages);
@@ -44,56 +188,53 @@ GtArray *agn_logger_get_messages(AgnLogger *logger)
 
 bool agn_logger_has_error(AgnLogger *logger)
 {
+  if(logger->stream != NULL)
+    return __atomic_load_n(logger->stream->logged + LOGGER_ERROR,
+                           __ATOMIC_ACQUIRE) > 0;
   return gt_array_size(logger->errors) > 0;
 }
 
 bool agn_logger_has_status(AgnLogger *logger)
 {
+  if(logger->stream != NULL)
+    return __atomic_load_n(logger->stream->logged + LOGGER_STATUS,
+                           __ATOMIC_ACQUIRE) > 0;
   return gt_array_size(logger->messages) > 0;
 }
 
 bool agn_logger_has_warning(AgnLogger *logger)
 {
+  if(logger->stream != NULL)
+    return __atomic_load_n(logger->stream->logged + LOGGER_WARNING,
+                           __ATOMIC_ACQUIRE) > 0;
   return gt_array_size(logger->warnings) > 0;
 }
 
 void agn_logger_log_error(AgnLogger *logger, const char *format, ...)
 {
   gt_assert(format);
-
-  GtError *message = gt_error_new();
   va_list ap;
   va_start(ap, format);
-  gt_error_vset(message, format, ap);
+  logger_log(logger, LOGGER_ERROR, format, ap);
   va_end(ap);
-
-  gt_array_add(logger->errors, message);
 }
 
 void agn_logger_log_status(AgnLogger *logger, const char *format, ...)
 {
   gt_assert(format);
-
-  GtError *message = gt_error_new();
   va_list ap;
   va_start(ap, format);
-  gt_error_vset(message, format, ap);
+  logger_log(logger, LOGGER_STATUS, format, ap);
   va_end(ap);
-
-  gt_array_add(logger->messages, message);
 }
 
 void agn_logger_log_warning(AgnLogger *logger, const char *format, ...)
 {
   gt_assert(format);
-
-  GtError *message = gt_error_new();
   va_list ap;
   va_start(ap, format);
-  gt_error_vset(message, format, ap);
+  logger_log(logger, LOGGER_WARNING, format, ap);
   va_end(ap);
-
-  gt_array_add(logger->warnings, message);
 }
 
 AgnLogger *agn_logger_new()
@@ -102,12 +243,70 @@ AgnLogger *agn_logger_new()
   logger->errors   = gt_array_new( sizeof(GtError *) );
   logger->messages = gt_array_new( sizeof(GtError *) );
   logger->warnings = gt_array_new( sizeof(GtError *) );
+  logger->stream = NULL;
+  return logger;
+}
+
+AgnLogger *agn_logger_new_streaming(FILE *outstream, GtUword ratelimit)
+{
+  AgnLogger *logger = agn_logger_new();
+  LoggerStream *stream = gt_calloc(1, sizeof(LoggerStream));
+  stream->outstream = outstream;
+  stream->ratelimit = ratelimit;
+  GtUword i;
+  for(i = 0; i < LOGGER_RING_SIZE; i++)
+    stream->slots[i].sequence = i;
+
+  int result = pthread_create(&stream->writer, NULL, logger_stream_writer,
+                              stream);
+  if(result != 0)
+  {
+    fprintf(stderr, "warning: could not start logger thread; messages will be "
+            "stored until printed\n");
+    gt_free(stream);
+    return logger;
+  }
+  logger->stream = stream;
   return logger;
 }
 
 bool agn_logger_print_all(AgnLogger *logger, FILE *outstream,
                           const char *format, ...)
 {
+  if(logger->stream != NULL)
+  {
+    LoggerStream *stream = logger->stream;
+    logger_stream_drain(stream);
+    GtUword nlogged = stream->logged[LOGGER_STATUS] +
+                      stream->logged[LOGGER_WARNING] +
+                      stream->logged[LOGGER_ERROR];
+    if(nlogged == 0)
+      return false;
+
+    if(format)
+    {
+      va_list ap;
+      va_start(ap, format);
+      vfprintf(outstream, format, ap);
+      va_end(ap);
+      fputs("\n", outstream);
+    }
+    int i;
+    for(i = 0; i < LOGGER_NUM_CLASSES; i++)
+    {
+      if(stream->logged[i] == 0)
+        continue;
+      fprintf(outstream, "    %s: %lu messages", logger_class_labels[i],
+              stream->logged[i]);
+      if(stream->suppressed[i] > 0)
+        fprintf(outstream, ", %lu suppressed", stream->suppressed[i]);
+      if(stream->dropped[i] > 0)
+        fprintf(outstream, ", %lu dropped", stream->dropped[i]);
+      fputs("\n", outstream);
+    }
+    return stream->logged[LOGGER_ERROR] > 0;
+  }
+
   GtUword nerrors   = gt_array_size(logger->errors);
   GtUword nmessages = gt_array_size(logger->messages);
   GtUword nwarnings = gt_array_size(logger->warnings);
@@ -235,6 +434,86 @@ bool agn_logger_print_warning(AgnLogger *logger, FILE *outstream,
   return true;
 }
 
+typedef struct
+{
+  AgnLogger *logger;
+  int id;
+} LoggerTestThreadData;
+
+static void *logger_test_thread(void *data)
+{
+  LoggerTestThreadData *dat = data;
+  int i;
+  for(i = 0; i < 5000; i++)
+    agn_logger_log_warning(dat->logger, "thread %d, message %d", dat->id, i);
+  agn_logger_log_status(dat->logger, "thread %d done", dat->id);
+  return NULL;
+}
+
+bool agn_logger_unit_test(AgnUnitTest *test)
+{
+  FILE *outstream = tmpfile();
+  if(outstream == NULL)
+  {
+    agn_unit_test_result(test, "temporary file", false);
+    return false;
+  }
+
+  AgnLogger *logger = agn_logger_new_streaming(outstream, 0);
+  agn_logger_log_status(logger, "begin test");
+  agn_logger_log_warning(logger, "duplicate warning");
+  agn_logger_log_warning(logger, "duplicate warning");
+  agn_logger_log_warning(logger, "duplicate warning");
+  agn_logger_log_status(logger, "end test");
+  bool haderror = agn_logger_print_all(logger, outstream, NULL);
+  bool dedupepass = !haderror && agn_logger_has_warning(logger) &&
+                    !agn_logger_has_error(logger);
+  agn_logger_delete(logger);
+  rewind(outstream);
+  char buffer[LOGGER_MESSAGE_SIZE];
+  int numlines = 0;
+  while(fgets(buffer, LOGGER_MESSAGE_SIZE, outstream) != NULL)
+  {
+    numlines++;
+    if(numlines == 3 && strcmp(buffer, "    (previous message repeated 2 "
+                               "times)\n") != 0)
+      dedupepass = false;
+  }
+  dedupepass = dedupepass && numlines == 6;
+  agn_unit_test_result(test, "collapse duplicates", dedupepass);
+  fclose(outstream);
+
+  outstream = tmpfile();
+  logger = agn_logger_new_streaming(outstream, 100);
+  pthread_t threads[4];
+  LoggerTestThreadData threaddata[4];
+  int i;
+  for(i = 0; i < 4; i++)
+  {
+    threaddata[i].logger = logger;
+    threaddata[i].id = i;
+    pthread_create(threads + i, NULL, logger_test_thread, threaddata + i);
+  }
+  for(i = 0; i < 4; i++)
+    pthread_join(threads[i], NULL);
+  agn_logger_log_error(logger, "an error");
+  FILE *summary = tmpfile();
+  haderror = agn_logger_print_all(logger, summary, NULL);
+  LoggerStream *stream = logger->stream;
+  bool threadpass = haderror &&
+                    stream->logged[LOGGER_WARNING] == 20000 &&
+                    stream->logged[LOGGER_STATUS] == 4 &&
+                    stream->logged[LOGGER_ERROR] == 1 &&
+                    stream->suppressed[LOGGER_WARNING] == 19900 &&
+                    stream->dropped[LOGGER_ERROR] == 0;
+  agn_unit_test_result(test, "concurrent logging, rate limit", threadpass);
+  agn_logger_delete(logger);
+  fclose(summary);
+  fclose(outstream);
+
+  return dedupepass && threadpass;
+}
+
 void agn_logger_unset(AgnLogger *logger)
 {
   while(gt_array_size(logger->errors) > 0)
@@ -253,3 +532,169 @@ void agn_logger_unset(AgnLogger *logger)
     gt_error_delete(message);
   }
 }
+
+static void logger_log(AgnLogger *logger, LoggerClass msgclass,
+                       const char *format, va_list ap)
+{
+  LoggerStream *stream = logger->stream;
+  if(stream == NULL)
+  {
+    GtError *message = gt_error_new();
+    gt_error_vset(message, format, ap);
+    if(msgclass == LOGGER_ERROR)
+      gt_array_add(logger->errors, message);
+    else if(msgclass == LOGGER_WARNING)
+      gt_array_add(logger->warnings, message);
+    else
+      gt_array_add(logger->messages, message);
+    return;
+  }
+
+  __atomic_add_fetch(stream->logged + msgclass, 1, __ATOMIC_RELEASE);
+  if(msgclass != LOGGER_ERROR && !logger_stream_admit(stream, format))
+  {
+    __atomic_add_fetch(stream->suppressed + msgclass, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  while(true)
+  {
+    va_list apcopy;
+    va_copy(apcopy, ap);
+    bool pushed = logger_stream_push(stream, msgclass, format, apcopy);
+    va_end(apcopy);
+    if(pushed)
+      break;
+
+    if(msgclass != LOGGER_ERROR)
+    {
+      __atomic_add_fetch(stream->dropped + msgclass, 1, __ATOMIC_RELAXED);
+      break;
+    }
+    sched_yield();
+  }
+}
+
+static bool logger_stream_admit(LoggerStream *stream, const char *format)
+{
+  if(stream->ratelimit == 0)
+    return true;
+
+  GtUword hash = (GtUword)(uintptr_t)format;
+  hash ^= hash >> 17;
+  hash *= 0x9e3779b1UL;
+  GtUword probe;
+  for(probe = 0; probe < LOGGER_TEMPLATE_PROBE; probe++)
+  {
+    LoggerTemplate *template;
+    template = stream->templates + ((hash + probe) % LOGGER_TEMPLATE_SLOTS);
+    const char *current = __atomic_load_n(&template->format, __ATOMIC_ACQUIRE);
+    if(current == NULL)
+    {
+      const char *expected = NULL;
+      if(__atomic_compare_exchange_n(&template->format, &expected, format,
+                                     false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        current = format;
+      else
+        current = expected;
+    }
+    if(current == format)
+    {
+      GtUword count = __atomic_add_fetch(&template->count, 1, __ATOMIC_RELAXED);
+      return count <= stream->ratelimit;
+    }
+  }
+
+  // Table is crowded; let the message through rather than block or allocate
+  return true;
+}
+
+static void logger_stream_drain(LoggerStream *stream)
+{
+  GtUword head = __atomic_load_n(&stream->head, __ATOMIC_ACQUIRE);
+  while(__atomic_load_n(&stream->tail, __ATOMIC_ACQUIRE) < head)
+    sched_yield();
+  fflush(stream->outstream);
+}
+
+static bool logger_stream_push(LoggerStream *stream, LoggerClass msgclass,
+                               const char *format, va_list ap)
+{
+  LoggerSlot *slot;
+  GtUword pos = __atomic_load_n(&stream->head, __ATOMIC_RELAXED);
+  while(true)
+  {
+    slot = stream->slots + (pos % LOGGER_RING_SIZE);
+    GtUword sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+    if(diff == 0)
+    {
+      if(__atomic_compare_exchange_n(&stream->head, &pos, pos + 1, true,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    }
+    else if(diff < 0)
+      return false;
+    else
+      pos = __atomic_load_n(&stream->head, __ATOMIC_RELAXED);
+  }
+
+  slot->msgclass = msgclass;
+  vsnprintf(slot->text, LOGGER_MESSAGE_SIZE, format, ap);
+  __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void logger_stream_write(LoggerStream *stream, LoggerClass msgclass,
+                                const char *text)
+{
+  if(text != NULL && stream->last[0] != '\0' && msgclass == stream->lastclass &&
+     strcmp(text, stream->last) == 0)
+  {
+    stream->repeats++;
+    return;
+  }
+
+  if(stream->repeats > 0)
+  {
+    fprintf(stream->outstream, "    (previous message repeated %lu times)\n",
+            stream->repeats);
+    stream->repeats = 0;
+  }
+  if(text == NULL)
+    return;
+
+  fprintf(stream->outstream, "%s: %s\n", logger_class_labels[msgclass], text);
+  strncpy(stream->last, text, LOGGER_MESSAGE_SIZE);
+  stream->lastclass = msgclass;
+}
+
+static void *logger_stream_writer(void *data)
+{
+  LoggerStream *stream = data;
+  struct timespec pause = { 0, 200000 };
+  while(true)
+  {
+    bool shutdown = __atomic_load_n(&stream->shutdown, __ATOMIC_ACQUIRE);
+    LoggerSlot *slot = stream->slots + (stream->tail % LOGGER_RING_SIZE);
+    GtUword sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if(sequence != stream->tail + 1)
+    {
+      if(shutdown &&
+         __atomic_load_n(&stream->head, __ATOMIC_ACQUIRE) == stream->tail)
+        break;
+
+      // Either the ring is empty or a producer is still formatting its message
+      nanosleep(&pause, NULL);
+      continue;
+    }
+
+    logger_stream_write(stream, slot->msgclass, slot->text);
+    __atomic_store_n(&slot->sequence, stream->tail + LOGGER_RING_SIZE,
+                     __ATOMIC_RELEASE);
+    __atomic_store_n(&stream->tail, stream->tail + 1, __ATOMIC_RELEASE);
+  }
+
+  logger_stream_write(stream, stream->lastclass, NULL);
+  return NULL;
+}
@@ -0,0 +1,923 @@
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "AgnBgzf.h"
+#include "AgnGtExtensions.h"
+#include "AgnMappedInStream.h"
+
+#define MAPPED_IN_STREAM_NUM_COLUMNS 9
+#define MAPPED_IN_STREAM_READ_SIZE   65536
+
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+struct AgnMappedInStream
+{
+  const GtNodeStream parent_instance;
+  GtStrArray *filenames;
+  bool parsed;
+  GtQueue *nodes;
+  GtArray *features;
+  GtHashmap *seqids;
+  GtHashmap *sources;
+  GtHashmap *regions;
+  GtArray *regionorder;
+  GtStr *scratch;
+};
+
+/**
+ * The sequence region for a given seqid, either declared explicitly or
+ * spanning all features annotated on the sequence.
+ */
+typedef struct
+{
+  GtStr *seqid;
+  GtRange range;
+  bool hasrange;
+  bool isexplicit;
+} MappedRegion;
+
+/**
+ * A feature whose ``Parent`` attribute has not yet been resolved.
+ */
+typedef struct
+{
+  GtFeatureNode *fn;
+  char *parents;
+  unsigned int line;
+  bool attached;
+} MappedFeature;
+
+/**
+ * State kept while parsing a single file. ``ids`` maps the IDs of the features
+ * in the current block to the features themselves; ``block`` holds all of the
+ * features of the current block.
+ */
+typedef struct
+{
+  const char *filename;
+  unsigned int line;
+  GtHashmap *ids;
+  GtArray *block;
+} MappedParseState;
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+#define mapped_in_stream_cast(GS)\
+        gt_node_stream_cast(mapped_in_stream_class(), GS)
+
+/**
+ * Add a feature to the current block, registering its ID and turning it into
+ * a multi-feature if the ID has already been used in this block.
+ *
+ * @param[in]  stream    the node stream
+ * @param[in]  state     the parse state
+ * @param[in]  mf        the feature
+ * @param[out] error     error object
+ * @returns              0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_add_feature(AgnMappedInStream *stream,
+                                        MappedParseState *state,
+                                        MappedFeature *mf, GtError *error);
+
+/**
+ * Append an attribute value to a string, decoding any %XX escape sequences as
+ * the GenomeTools parser does.
+ *
+ * @param[out] dest      the string to which the value is appended
+ * @param[in]  value     the escaped value
+ * @param[in]  length    length of the value
+ */
+static void mapped_in_stream_append_unescaped(GtStr *dest, const char *value,
+                                              GtUword length);
+
+/**
+ * Function that implements the GtNodeStream interface for this class.
+ *
+ * @returns    a node stream class object
+ */
+static const GtNodeStreamClass* mapped_in_stream_class(void);
+
+/**
+ * Delete all features of the current block that have not been attached to a
+ * parent (which in turn deletes their descendants), and clear the block.
+ *
+ * @param[in] state    the parse state
+ */
+static void mapped_in_stream_discard_block(MappedParseState *state);
+
+/**
+ * Destructor for the class.
+ *
+ * @param[in] ns    the node stream to be destroyed
+ */
+static void mapped_in_stream_free(GtNodeStream *ns);
+
+/**
+ * Find the shared string object matching the given string, creating it if it
+ * does not exist yet. Features on the same sequence (or from the same source)
+ * share a single string object.
+ *
+ * @param[in] stream     the node stream
+ * @param[in] strings    table of shared strings
+ * @param[in] str        the string (not NUL-terminated)
+ * @param[in] length     length of the string
+ * @returns              the shared string object
+ */
+static GtStr *mapped_in_stream_intern(AgnMappedInStream *stream,
+                                      GtHashmap *strings, const char *str,
+                                      GtUword length);
+
+/**
+ * Pulls nodes from the input files. All input is parsed on the first call.
+ *
+ * @param[in]  ns       the node stream
+ * @param[out] gn       pointer to a genome node
+ * @param[out] error    error object
+ * @returns             0 in case of no error (*gn is set to next node or NULL
+ *                      if stream is exhausted), -1 in case of error (error
+ *                      object is set)
+ */
+static int mapped_in_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                 GtError *error);
+
+/**
+ * Parse the ``ID``, ``Parent`` and ``Name`` attributes from a feature's
+ * attribute column, ignoring all others.
+ *
+ * @param[in]  stream    the node stream
+ * @param[in]  state     the parse state
+ * @param[in]  mf        the feature
+ * @param[in]  attrs     the attribute column (not NUL-terminated)
+ * @param[in]  length    length of the attribute column
+ * @param[out] error     error object
+ * @returns              0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_parse_attributes(AgnMappedInStream *stream,
+                                             MappedParseState *state,
+                                             MappedFeature *mf,
+                                             const char *attrs, GtUword length,
+                                             GtError *error);
+
+/**
+ * Parse GFF3 data held in memory, one line at a time.
+ *
+ * @param[in]  stream      the node stream
+ * @param[in]  filename    name of the file from which the data was read
+ * @param[in]  data        the data
+ * @param[in]  length      length of the data
+ * @param[out] error       error object
+ * @returns                0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_parse_buffer(AgnMappedInStream *stream,
+                                         const char *filename,
+                                         const char *data, GtUword length,
+                                         GtError *error);
+
+/**
+ * Parse a single feature line.
+ *
+ * @param[in]  stream    the node stream
+ * @param[in]  state     the parse state
+ * @param[in]  line      the line (not NUL-terminated)
+ * @param[in]  length    length of the line
+ * @param[out] error     error object
+ * @returns              0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_parse_feature(AgnMappedInStream *stream,
+                                          MappedParseState *state,
+                                          const char *line, GtUword length,
+                                          GtError *error);
+
+/**
+ * Parse the contents of a file, decompressing them first if they are gzip
+ * compressed.
+ *
+ * @param[in]  stream      the node stream
+ * @param[in]  filename    the file name, for error messages
+ * @param[in]  data        the file contents
+ * @param[in]  length      length of the file contents
+ * @param[out] error       error object
+ * @returns                0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_parse_data(AgnMappedInStream *stream,
+                                       const char *filename, const char *data,
+                                       GtUword length, GtError *error);
+
+/**
+ * Memory map the given file (or read it, if it cannot be mapped) and parse
+ * its contents.
+ *
+ * @param[in]  stream      the node stream
+ * @param[in]  filename    the file, or NULL for standard input
+ * @param[out] error       error object
+ * @returns                0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_parse_file(AgnMappedInStream *stream,
+                                       const char *filename, GtError *error);
+
+/**
+ * Parse a ``##sequence-region`` directive.
+ *
+ * @param[in]  stream    the node stream
+ * @param[in]  state     the parse state
+ * @param[in]  line      the line (not NUL-terminated)
+ * @param[in]  length    length of the line
+ * @param[out] error     error object
+ * @returns              0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_parse_region(AgnMappedInStream *stream,
+                                         MappedParseState *state,
+                                         const char *line, GtUword length,
+                                         GtError *error);
+
+/**
+ * Read everything from the given file handle into memory.
+ *
+ * @param[in]  instream    the file handle
+ * @param[out] length      length of the data read
+ * @returns                the data, to be freed with ``gt_free``
+ */
+static char *mapped_in_stream_read_all(FILE *instream, GtUword *length);
+
+/**
+ * Find the sequence region for the given seqid, creating it if needed.
+ *
+ * @param[in] stream    the node stream
+ * @param[in] seqid     the seqid
+ * @returns             the sequence region
+ */
+static MappedRegion *mapped_in_stream_region(AgnMappedInStream *stream,
+                                             GtStr *seqid);
+
+/**
+ * Attach each feature of the current block to its parent(s). Features with no
+ * parent are kept as top-level features.
+ *
+ * @param[in]  stream    the node stream
+ * @param[in]  state     the parse state
+ * @param[out] error     error object
+ * @returns              0 on success, -1 on error (error object is set)
+ */
+static int mapped_in_stream_resolve_block(AgnMappedInStream *stream,
+                                          MappedParseState *state,
+                                          GtError *error);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+GtNodeStream* agn_mapped_in_stream_new(int numfiles, const char **filenames)
+{
+  GtNodeStream *ns;
+  AgnMappedInStream *stream;
+  ns = gt_node_stream_create(mapped_in_stream_class(), false);
+  stream = mapped_in_stream_cast(ns);
+
+  int i;
+  stream->filenames = gt_str_array_new();
+  for(i = 0; i < numfiles; i++)
+    gt_str_array_add_cstr(stream->filenames, filenames[i]);
+  stream->parsed = false;
+  stream->nodes = gt_queue_new();
+  stream->features = gt_array_new( sizeof(GtFeatureNode *) );
+  stream->seqids = gt_hashmap_new(GT_HASH_STRING, NULL,
+                                  (GtFree)gt_str_delete);
+  stream->sources = gt_hashmap_new(GT_HASH_STRING, NULL,
+                                   (GtFree)gt_str_delete);
+  stream->regions = gt_hashmap_new(GT_HASH_STRING, NULL, gt_free_func);
+  stream->regionorder = gt_array_new( sizeof(MappedRegion *) );
+  stream->scratch = gt_str_new();
+
+  return ns;
+}
+
+static int mapped_in_stream_add_feature(AgnMappedInStream *stream,
+                                        MappedParseState *state,
+                                        MappedFeature *mf, GtError *error)
+{
+  const char *id = gt_feature_node_get_attribute(mf->fn, "ID");
+  if(id != NULL)
+  {
+    GtFeatureNode *first = gt_hashmap_get(state->ids, id);
+    if(first == NULL)
+      gt_hashmap_add(state->ids, (char *)id, mf->fn);
+    else
+    {
+      GtGenomeNode *gn1 = (GtGenomeNode *)first;
+      GtGenomeNode *gn2 = (GtGenomeNode *)mf->fn;
+      if(strcmp(gt_feature_node_get_type(first),
+                gt_feature_node_get_type(mf->fn)) != 0 ||
+         gt_str_cmp(gt_genome_node_get_seqid(gn1),
+                    gt_genome_node_get_seqid(gn2)) != 0)
+      {
+        gt_error_set(error, "file \"%s\": line %u: the ID \"%s\" has already "
+                     "been used by a feature of a different type or sequence",
+                     state->filename, mf->line, id);
+        gt_genome_node_delete(gn2);
+        gt_free(mf->parents);
+        return -1;
+      }
+      if(!gt_feature_node_is_multi(first))
+        gt_feature_node_make_multi_representative(first);
+      gt_feature_node_set_multi_representative(mf->fn, first);
+    }
+  }
+
+  gt_array_add(state->block, *mf);
+  return 0;
+}
+
+static void mapped_in_stream_append_unescaped(GtStr *dest, const char *value,
+                                              GtUword length)
+{
+  const char *end = value + length;
+  while(value < end)
+  {
+    const char *percent = memchr(value, '%', end - value);
+    if(percent == NULL || end - percent < 3 ||
+       !isxdigit(percent[1]) || !isxdigit(percent[2]))
+    {
+      // Malformed escapes are kept verbatim
+      const char *stop = percent == NULL ? end : percent + 1;
+      gt_str_append_cstr_nt(dest, value, stop - value);
+      value = stop;
+      continue;
+    }
+
+    char hex[3] = { percent[1], percent[2], '\0' };
+    gt_str_append_cstr_nt(dest, value, percent - value);
+    gt_str_append_char(dest, (char)strtol(hex, NULL, 16));
+    value = percent + 3;
+  }
+}
+
+static const GtNodeStreamClass *mapped_in_stream_class(void)
+{
+  static const GtNodeStreamClass *nsc = NULL;
+  if(!nsc)
+  {
+    nsc = gt_node_stream_class_new(sizeof (AgnMappedInStream),
+                                   mapped_in_stream_free,
+                                   mapped_in_stream_next);
+  }
+  return nsc;
+}
+
+static void mapped_in_stream_discard_block(MappedParseState *state)
+{
+  GtUword i;
+  for(i = 0; i < gt_array_size(state->block); i++)
+  {
+    MappedFeature *mf = gt_array_get(state->block, i);
+    if(!mf->attached)
+      gt_genome_node_delete((GtGenomeNode *)mf->fn);
+    gt_free(mf->parents);
+  }
+  gt_array_reset(state->block);
+  gt_hashmap_reset(state->ids);
+}
+
+static void mapped_in_stream_free(GtNodeStream *ns)
+{
+  AgnMappedInStream *stream = mapped_in_stream_cast(ns);
+  GtUword i;
+  while(gt_queue_size(stream->nodes) > 0)
+  {
+    GtGenomeNode *gn = gt_queue_get(stream->nodes);
+    gt_genome_node_delete(gn);
+  }
+  gt_queue_delete(stream->nodes);
+  for(i = 0; i < gt_array_size(stream->features); i++)
+  {
+    GtGenomeNode **gn = gt_array_get(stream->features, i);
+    gt_genome_node_delete(*gn);
+  }
+  gt_array_delete(stream->features);
+  gt_str_array_delete(stream->filenames);
+  gt_hashmap_delete(stream->regions);
+  gt_array_delete(stream->regionorder);
+  gt_hashmap_delete(stream->seqids);
+  gt_hashmap_delete(stream->sources);
+  gt_str_delete(stream->scratch);
+}
+
+static GtStr *mapped_in_stream_intern(AgnMappedInStream *stream,
+                                      GtHashmap *strings, const char *str,
+                                      GtUword length)
+{
+  gt_str_reset(stream->scratch);
+  gt_str_append_cstr_nt(stream->scratch, str, length);
+  GtStr *interned = gt_hashmap_get(strings, gt_str_get(stream->scratch));
+  if(interned == NULL)
+  {
+    interned = gt_str_clone(stream->scratch);
+    gt_hashmap_add(strings, gt_str_get(interned), interned);
+  }
+  return interned;
+}
+
+static int mapped_in_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                 GtError *error)
+{
+  AgnMappedInStream *stream;
+  gt_error_check(error);
+  stream = mapped_in_stream_cast(ns);
+
+  if(!stream->parsed)
+  {
+    GtUword i, numfiles = gt_str_array_size(stream->filenames);
+    stream->parsed = true;
+    if(numfiles == 0 && mapped_in_stream_parse_file(stream, NULL, error))
+      return -1;
+    for(i = 0; i < numfiles; i++)
+    {
+      const char *filename = gt_str_array_get(stream->filenames, i);
+      if(mapped_in_stream_parse_file(stream, filename, error))
+        return -1;
+    }
+
+    for(i = 0; i < gt_array_size(stream->regionorder); i++)
+    {
+      MappedRegion *region = *(MappedRegion **)
+                             gt_array_get(stream->regionorder, i);
+      if(!region->hasrange)
+        continue;
+      GtGenomeNode *rn = gt_region_node_new(region->seqid, region->range.start,
+                                            region->range.end);
+      gt_queue_add(stream->nodes, rn);
+    }
+    gt_array_sort(stream->features, (GtCompare)agn_gt_genome_node_compare);
+    for(i = 0; i < gt_array_size(stream->features); i++)
+    {
+      GtGenomeNode **feature = gt_array_get(stream->features, i);
+      gt_queue_add(stream->nodes, *feature);
+    }
+    gt_array_reset(stream->features);
+  }
+
+  *gn = NULL;
+  if(gt_queue_size(stream->nodes) > 0)
+    *gn = gt_queue_get(stream->nodes);
+  return 0;
+}
+
+static int mapped_in_stream_parse_attributes(AgnMappedInStream *stream,
+                                             MappedParseState *state,
+                                             MappedFeature *mf,
+                                             const char *attrs, GtUword length,
+                                             GtError *error)
+{
+  if(length == 1 && attrs[0] == '.')
+    return 0;
+
+  const char *end = attrs + length;
+  while(attrs < end)
+  {
+    const char *semicolon = memchr(attrs, ';', end - attrs);
+    if(semicolon == NULL)
+      semicolon = end;
+    const char *equals = memchr(attrs, '=', semicolon - attrs);
+    GtUword keylength = equals ? equals - attrs : 0;
+    const char *key = NULL;
+    if(keylength == 2 && strncmp(attrs, "ID", 2) == 0)
+      key = "ID";
+    else if(keylength == 6 && strncmp(attrs, "Parent", 6) == 0)
+      key = "Parent";
+    else if(keylength == 4 && strncmp(attrs, "Name", 4) == 0)
+      key = "Name";
+
+    if(key != NULL)
+    {
+      if(gt_feature_node_get_attribute(mf->fn, key) != NULL)
+      {
+        gt_error_set(error, "file \"%s\": line %u: more than one %s "
+                     "attribute", state->filename, mf->line, key);
+        return -1;
+      }
+      gt_str_reset(stream->scratch);
+      mapped_in_stream_append_unescaped(stream->scratch, equals + 1,
+                                        semicolon - equals - 1);
+      if(gt_str_length(stream->scratch) == 0)
+      {
+        gt_error_set(error, "file \"%s\": line %u: empty %s attribute",
+                     state->filename, mf->line, key);
+        return -1;
+      }
+      gt_feature_node_add_attribute(mf->fn, key, gt_str_get(stream->scratch));
+      if(key[0] == 'P')
+        mf->parents = gt_cstr_dup(gt_str_get(stream->scratch));
+    }
+    attrs = semicolon + 1;
+  }
+
+  return 0;
+}
+
+static int mapped_in_stream_parse_buffer(AgnMappedInStream *stream,
+                                         const char *filename,
+                                         const char *data, GtUword length,
+                                         GtError *error)
+{
+  MappedParseState state;
+  state.filename = filename;
+  state.line = 0;
+  state.ids = gt_hashmap_new(GT_HASH_STRING, NULL, NULL);
+  state.block = gt_array_new( sizeof(MappedFeature) );
+
+  int had_err = 0;
+  const char *line = data, *end = data + length;
+  while(!had_err && line < end)
+  {
+    const char *eol = memchr(line, '\n', end - line);
+    if(eol == NULL)
+      eol = end;
+    GtUword linelength = eol - line;
+    if(linelength > 0 && line[linelength - 1] == '\r')
+      linelength--;
+    state.line++;
+
+    if(linelength > 0 && (line[0] == '>' ||
+       (linelength >= 7 && strncmp(line, "##FASTA", 7) == 0)))
+      break;
+    else if(linelength == 3 && strncmp(line, "###", 3) == 0)
+      had_err = mapped_in_stream_resolve_block(stream, &state, error);
+    else if(linelength >= 17 && strncmp(line, "##sequence-region", 17) == 0)
+    {
+      had_err = mapped_in_stream_parse_region(stream, &state, line,
+                                              linelength, error);
+    }
+    else if(linelength > 0 && line[0] != '#')
+    {
+      had_err = mapped_in_stream_parse_feature(stream, &state, line,
+                                               linelength, error);
+    }
+    line = eol + 1;
+  }
+
+  if(!had_err)
+    had_err = mapped_in_stream_resolve_block(stream, &state, error);
+  if(had_err)
+    mapped_in_stream_discard_block(&state);
+  gt_hashmap_delete(state.ids);
+  gt_array_delete(state.block);
+  return had_err;
+}
+
+static int mapped_in_stream_parse_data(AgnMappedInStream *stream,
+                                       const char *filename, const char *data,
+                                       GtUword length, GtError *error)
+{
+  if(length >= 3 && strncmp(data, "BZh", 3) == 0)
+  {
+    gt_error_set(error, "file \"%s\": bzip2 compressed input is not "
+                 "supported", filename);
+    return -1;
+  }
+  if(!agn_bgzf_is_gzip(data, length))
+    return mapped_in_stream_parse_buffer(stream, filename, data, length, error);
+
+  GtUword inflatedlength;
+  char *inflated = agn_bgzf_inflate(data, length, 0, &inflatedlength, error);
+  if(inflated == NULL)
+  {
+    char *message = gt_cstr_dup(gt_error_get(error));
+    gt_error_set(error, "file \"%s\": %s", filename, message);
+    gt_free(message);
+    return -1;
+  }
+  int had_err = mapped_in_stream_parse_buffer(stream, filename, inflated,
+                                              inflatedlength, error);
+  gt_free(inflated);
+  return had_err;
+}
+
+static int mapped_in_stream_parse_feature(AgnMappedInStream *stream,
+                                          MappedParseState *state,
+                                          const char *line, GtUword length,
+                                          GtError *error)
+{
+  // Split the line into columns
+  const char *columns[MAPPED_IN_STREAM_NUM_COLUMNS];
+  GtUword lengths[MAPPED_IN_STREAM_NUM_COLUMNS];
+  const char *end = line + length;
+  int i;
+  for(i = 0; i < MAPPED_IN_STREAM_NUM_COLUMNS - 1; i++)
+  {
+    const char *tab = memchr(line, '\t', end - line);
+    if(tab == NULL)
+    {
+      gt_error_set(error, "file \"%s\": line %u: expected %d tab-separated "
+                   "columns, found %d", state->filename, state->line,
+                   MAPPED_IN_STREAM_NUM_COLUMNS, i + 1);
+      return -1;
+    }
+    columns[i] = line;
+    lengths[i] = tab - line;
+    line = tab + 1;
+  }
+  columns[i] = line;
+  lengths[i] = end - line;
+
+  // Coordinates
+  GtUword coords[2];
+  for(i = 0; i < 2; i++)
+  {
+    GtUword j;
+    coords[i] = 0;
+    for(j = 0; j < lengths[3 + i]; j++)
+    {
+      char c = columns[3 + i][j];
+      if(c < '0' || c > '9')
+        break;
+      coords[i] = coords[i] * 10 + (c - '0');
+    }
+    if(lengths[3 + i] == 0 || j < lengths[3 + i] || coords[i] == 0)
+    {
+      gt_error_set(error, "file \"%s\": line %u: invalid coordinate '%.*s'",
+                   state->filename, state->line, (int)lengths[3 + i],
+                   columns[3 + i]);
+      return -1;
+    }
+  }
+  if(coords[0] > coords[1])
+  {
+    gt_error_set(error, "file \"%s\": line %u: start %lu is larger than end "
+                 "%lu", state->filename, state->line, coords[0], coords[1]);
+    return -1;
+  }
+
+  // Strand and phase
+  GtStrand strand = GT_NUM_OF_STRAND_TYPES;
+  if(lengths[6] == 1)
+  {
+    switch(columns[6][0])
+    {
+      case '+': strand = GT_STRAND_FORWARD; break;
+      case '-': strand = GT_STRAND_REVERSE; break;
+      case '.': strand = GT_STRAND_BOTH;    break;
+      case '?': strand = GT_STRAND_UNKNOWN; break;
+    }
+  }
+  if(strand == GT_NUM_OF_STRAND_TYPES)
+  {
+    gt_error_set(error, "file \"%s\": line %u: invalid strand '%.*s'",
+                 state->filename, state->line, (int)lengths[6], columns[6]);
+    return -1;
+  }
+  GtPhase phase = GT_PHASE_UNDEFINED;
+  bool validphase = lengths[7] == 1;
+  if(validphase)
+  {
+    switch(columns[7][0])
+    {
+      case '0': phase = GT_PHASE_ZERO;      break;
+      case '1': phase = GT_PHASE_ONE;       break;
+      case '2': phase = GT_PHASE_TWO;       break;
+      case '.': phase = GT_PHASE_UNDEFINED; break;
+      default:  validphase = false;         break;
+    }
+  }
+  if(!validphase)
+  {
+    gt_error_set(error, "file \"%s\": line %u: invalid phase '%.*s'",
+                 state->filename, state->line, (int)lengths[7], columns[7]);
+    return -1;
+  }
+
+  // Score
+  bool hasscore = !(lengths[5] == 1 && columns[5][0] == '.');
+  float score = 0.0;
+  if(hasscore)
+  {
+    char *scoreend;
+    gt_str_reset(stream->scratch);
+    gt_str_append_cstr_nt(stream->scratch, columns[5], lengths[5]);
+    score = strtof(gt_str_get(stream->scratch), &scoreend);
+    if(lengths[5] == 0 || *scoreend != '\0')
+    {
+      gt_error_set(error, "file \"%s\": line %u: invalid score '%s'",
+                   state->filename, state->line, gt_str_get(stream->scratch));
+      return -1;
+    }
+  }
+
+  // Create the feature
+  GtStr *seqid = mapped_in_stream_intern(stream, stream->seqids, columns[0],
+                                         lengths[0]);
+  GtStr *source = mapped_in_stream_intern(stream, stream->sources, columns[1],
+                                          lengths[1]);
+  gt_str_reset(stream->scratch);
+  gt_str_append_cstr_nt(stream->scratch, columns[2], lengths[2]);
+  GtGenomeNode *gn = gt_feature_node_new(seqid, gt_str_get(stream->scratch),
+                                         coords[0], coords[1], strand);
+  MappedFeature mf = { (GtFeatureNode *)gn, NULL, state->line, false };
+  gt_feature_node_set_source(mf.fn, source);
+  if(hasscore)
+    gt_feature_node_set_score(mf.fn, score);
+  gt_feature_node_set_phase(mf.fn, phase);
+  if(mapped_in_stream_parse_attributes(stream, state, &mf, columns[8],
+                                       lengths[8], error))
+  {
+    gt_genome_node_delete(gn);
+    gt_free(mf.parents);
+    return -1;
+  }
+
+  MappedRegion *region = mapped_in_stream_region(stream, seqid);
+  if(!region->isexplicit)
+  {
+    if(!region->hasrange)
+    {
+      region->range.start = coords[0];
+      region->range.end = coords[1];
+      region->hasrange = true;
+    }
+    if(coords[0] < region->range.start)
+      region->range.start = coords[0];
+    if(coords[1] > region->range.end)
+      region->range.end = coords[1];
+  }
+
+  return mapped_in_stream_add_feature(stream, state, &mf, error);
+}
+
+static int mapped_in_stream_parse_file(AgnMappedInStream *stream,
+                                       const char *filename, GtError *error)
+{
+  int had_err;
+  GtUword length;
+  char *data;
+
+  if(filename == NULL)
+  {
+    data = mapped_in_stream_read_all(stdin, &length);
+    had_err = mapped_in_stream_parse_data(stream, "stdin", data, length,
+                                          error);
+    gt_free(data);
+    return had_err;
+  }
+
+  int fd = open(filename, O_RDONLY);
+  struct stat filestat;
+  if(fd < 0 || fstat(fd, &filestat) != 0)
+  {
+    gt_error_set(error, "could not open file \"%s\": %s", filename,
+                 strerror(errno));
+    if(fd >= 0)
+      close(fd);
+    return -1;
+  }
+
+  // Pipes and other special files cannot be mapped
+  if(!S_ISREG(filestat.st_mode))
+  {
+    FILE *instream = fdopen(fd, "r");
+    data = mapped_in_stream_read_all(instream, &length);
+    fclose(instream);
+    had_err = mapped_in_stream_parse_data(stream, filename, data, length,
+                                          error);
+    gt_free(data);
+    return had_err;
+  }
+
+  length = filestat.st_size;
+  if(length == 0)
+  {
+    close(fd);
+    return 0;
+  }
+  data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data == MAP_FAILED)
+  {
+    gt_error_set(error, "could not map file \"%s\": %s", filename,
+                 strerror(errno));
+    return -1;
+  }
+  madvise(data, length, MADV_SEQUENTIAL);
+  had_err = mapped_in_stream_parse_data(stream, filename, data, length,
+                                        error);
+  munmap(data, length);
+  return had_err;
+}
+
+static int mapped_in_stream_parse_region(AgnMappedInStream *stream,
+                                         MappedParseState *state,
+                                         const char *line, GtUword length,
+                                         GtError *error)
+{
+  GtUword start, end;
+  char *seqidstr = gt_malloc(length + 1);
+  gt_str_reset(stream->scratch);
+  gt_str_append_cstr_nt(stream->scratch, line, length);
+  if(sscanf(gt_str_get(stream->scratch), "##sequence-region %s %lu %lu",
+            seqidstr, &start, &end) != 3 || start > end)
+  {
+    gt_error_set(error, "file \"%s\": line %u: could not parse sequence "
+                 "region '%s'", state->filename, state->line,
+                 gt_str_get(stream->scratch));
+    gt_free(seqidstr);
+    return -1;
+  }
+
+  GtStr *seqid = mapped_in_stream_intern(stream, stream->seqids, seqidstr,
+                                         strlen(seqidstr));
+  MappedRegion *region = mapped_in_stream_region(stream, seqid);
+  region->range.start = start;
+  region->range.end = end;
+  region->hasrange = true;
+  region->isexplicit = true;
+  gt_free(seqidstr);
+  return 0;
+}
+
+static char *mapped_in_stream_read_all(FILE *instream, GtUword *length)
+{
+  GtUword capacity = MAPPED_IN_STREAM_READ_SIZE;
+  char *data = gt_malloc(capacity);
+  size_t bytesread;
+  *length = 0;
+  while((bytesread = fread(data + *length, 1, capacity - *length,
+                           instream)) > 0)
+  {
+    *length += bytesread;
+    if(*length == capacity)
+    {
+      capacity *= 2;
+      data = gt_realloc(data, capacity);
+    }
+  }
+  return data;
+}
+
+static MappedRegion *mapped_in_stream_region(AgnMappedInStream *stream,
+                                             GtStr *seqid)
+{
+  MappedRegion *region = gt_hashmap_get(stream->regions, gt_str_get(seqid));
+  if(region == NULL)
+  {
+    region = gt_malloc( sizeof(MappedRegion) );
+    region->seqid = seqid;
+    region->range.start = 0;
+    region->range.end = 0;
+    region->hasrange = false;
+    region->isexplicit = false;
+    gt_hashmap_add(stream->regions, gt_str_get(seqid), region);
+    gt_array_add(stream->regionorder, region);
+  }
+  return region;
+}
+
+static int mapped_in_stream_resolve_block(AgnMappedInStream *stream,
+                                          MappedParseState *state,
+                                          GtError *error)
+{
+  GtUword i;
+  for(i = 0; i < gt_array_size(state->block); i++)
+  {
+    MappedFeature *mf = gt_array_get(state->block, i);
+    if(mf->parents == NULL)
+      continue;
+
+    char *saveptr;
+    char *parentid = strtok_r(mf->parents, ",", &saveptr);
+    GtUword numparents = 0;
+    for(; parentid != NULL; parentid = strtok_r(NULL, ",", &saveptr))
+    {
+      GtFeatureNode *parent = gt_hashmap_get(state->ids, parentid);
+      if(parent == NULL || parent == mf->fn)
+      {
+        gt_error_set(error, "file \"%s\": line %u: Parent \"%s\" was not "
+                     "defined", state->filename, mf->line, parentid);
+        return -1;
+      }
+      if(numparents > 0)
+        gt_genome_node_ref((GtGenomeNode *)mf->fn);
+      gt_feature_node_add_child(parent, mf->fn);
+      mf->attached = true;
+      numparents++;
+    }
+  }
+
+  for(i = 0; i < gt_array_size(state->block); i++)
+  {
+    MappedFeature *mf = gt_array_get(state->block, i);
+    if(!mf->attached)
+      gt_array_add(stream->features, mf->fn);
+    gt_free(mf->parents);
+  }
+  gt_array_reset(state->block);
+  gt_hashmap_reset(state->ids);
+  return 0;
+}
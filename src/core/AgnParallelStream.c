@@ -0,0 +1,725 @@
+#include <pthread.h>
+#include <string.h>
+#include "AgnFilterStream.h"
+#include "AgnParallelStream.h"
+#include "AgnTestData.h"
+
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+/**
+ * A single node read from the input stream, along with the nodes produced from
+ * it by a worker's processing chain.
+ */
+typedef struct
+{
+  GtGenomeNode *node;
+  GtArray *outputs;
+  GtStr *errmsg;
+  bool done;
+} ParallelStreamJob;
+
+/**
+ * Node stream at the head of each worker's processing chain. It returns the
+ * node it has been given, and NULL thereafter.
+ */
+typedef struct
+{
+  const GtNodeStream parent_instance;
+  GtGenomeNode *node;
+} ParallelFeedStream;
+
+typedef struct
+{
+  AgnParallelStream *stream;
+  GtNodeStream *feed;
+  GtNodeStream *chain;
+  GtError *error;
+  pthread_t thread;
+} ParallelStreamWorker;
+
+struct AgnParallelStream
+{
+  const GtNodeStream parent_instance;
+  GtNodeStream *in_stream;
+  ParallelStreamWorker *workers;
+  GtUword numworkers;
+  GtUword numrunning;
+  pthread_t reader;
+  bool readerrunning;
+  bool started;
+
+  // Held for writing by the reader while it uses the input stream, and for
+  // reading by each worker while it processes a node; see the class header
+  pthread_rwlock_t gtlock;
+
+  // Everything below (except the current job) is protected by the lock
+  pthread_mutex_t lock;
+  pthread_cond_t jobready;
+  pthread_cond_t jobdone;
+  pthread_cond_t slotfree;
+  GtQueue *pending;
+  ParallelStreamJob **slots;
+  GtUword capacity;
+  GtUword numread;
+  GtUword numreturned;
+  bool eof;
+  bool abort;
+  GtStr *readerror;
+
+  ParallelStreamJob *current;
+  GtUword outindex;
+};
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+#define parallel_stream_cast(GS)\
+        gt_node_stream_cast(parallel_stream_class(), GS)
+
+#define parallel_feed_stream_cast(GS)\
+        gt_node_stream_cast(parallel_feed_stream_class(), GS)
+
+/**
+ * Function that implements the GtNodeStream interface for the feed stream.
+ *
+ * @returns    a node stream class object
+ */
+static const GtNodeStreamClass* parallel_feed_stream_class(void);
+
+/**
+ * Returns the node stored in the feed stream, if any, and clears it.
+ *
+ * @param[in]  ns       the feed stream
+ * @param[out] gn       pointer to a genome node
+ * @param[out] error    error object
+ * @returns             0, always
+ */
+static int parallel_feed_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                     GtError *error);
+
+/**
+ * Function that implements the GtNodeStream interface for this class.
+ *
+ * @returns    a node stream class object
+ */
+static const GtNodeStreamClass* parallel_stream_class(void);
+
+/**
+ * Destructor for the class. Any threads still running are stopped.
+ *
+ * @param[in] ns    the node stream to be destroyed
+ */
+static void parallel_stream_free(GtNodeStream *ns);
+
+/**
+ * The GenomeTools string objects holding sequence IDs and sources are shared
+ * by all nodes parsed from the same sequence/file, and their reference counts
+ * are not thread safe. Before a feature is handed to a worker, give it private
+ * copies of these strings so that the worker can create and delete features
+ * without touching objects that the parser is still using. Region nodes get a
+ * private copy of their sequence ID for the same reason.
+ *
+ * @param[in] gn    node read from the input stream
+ */
+static void parallel_stream_isolate(GtGenomeNode *gn);
+
+/**
+ * Free a job, deleting any nodes it still holds.
+ *
+ * @param[in] job      the job
+ * @param[in] first    index of the first output node not yet returned
+ */
+static void parallel_stream_job_delete(ParallelStreamJob *job, GtUword first);
+
+/**
+ * Returns the output nodes of each job, in the order in which the jobs were
+ * read from the input stream.
+ *
+ * @param[in]  ns       the node stream
+ * @param[out] gn       pointer to a genome node
+ * @param[out] error    error object
+ * @returns             0 in case of no error (*gn is set to next node or NULL
+ *                      if stream is exhausted), -1 in case of error (error
+ *                      object is set)
+ */
+static int parallel_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                GtError *error);
+
+/**
+ * Pass a job's node through a worker's processing chain, collecting all of the
+ * resulting nodes.
+ *
+ * @param[in] worker    the worker
+ * @param[in] job       the job
+ */
+static void parallel_stream_process(ParallelStreamWorker *worker,
+                                    ParallelStreamJob *job);
+
+/**
+ * Thread function for the reader, which pulls nodes from the input stream and
+ * creates a job for each one, blocking while the maximum number of jobs is in
+ * flight.
+ *
+ * @param[in] data    the parallel stream
+ * @returns           NULL
+ */
+static void *parallel_stream_reader(void *data);
+
+/**
+ * Launch the reader and worker threads.
+ *
+ * @param[in]  stream    the parallel stream
+ * @param[out] error     error object
+ * @returns              0 on success, -1 if a thread could not be created
+ */
+static int parallel_stream_start(AgnParallelStream *stream, GtError *error);
+
+/**
+ * Stop the reader and worker threads and wait for them to exit.
+ *
+ * @param[in] stream    the parallel stream
+ */
+static void parallel_stream_stop(AgnParallelStream *stream);
+
+/**
+ * Thread function for the workers, which process jobs until the input stream
+ * is exhausted.
+ *
+ * @param[in] data    the worker
+ * @returns           NULL
+ */
+static void *parallel_stream_worker(void *data);
+
+/**
+ * Processing chain for unit tests: keep only gene features.
+ *
+ * @param[in] in_stream    the chain's input stream
+ * @param[in] data         hashmap of types to keep
+ * @returns                the filter stream
+ */
+static GtNodeStream *parallel_stream_test_chain(GtNodeStream *in_stream,
+                                                void *data);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+GtNodeStream* agn_parallel_stream_new(GtNodeStream *in_stream,
+                                      GtUword numthreads, GtUword queuesize,
+                                      AgnStreamChainFunc chainfunc,
+                                      void *chaindata, const char **types)
+{
+  GtNodeStream *ns;
+  AgnParallelStream *stream;
+  gt_assert(in_stream && chainfunc && numthreads > 0);
+
+  ns = gt_node_stream_create(parallel_stream_class(), false);
+  stream = parallel_stream_cast(ns);
+  stream->in_stream = gt_node_stream_ref(in_stream);
+  stream->numworkers = numthreads;
+  stream->numrunning = 0;
+  stream->readerrunning = false;
+  stream->started = false;
+
+  // Workers hold the lock most of the time, so the reader must not have to
+  // wait for all of them to be idle at once
+  pthread_rwlockattr_t attr;
+  pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+  pthread_rwlockattr_setkind_np(&attr,
+                                PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+  pthread_rwlock_init(&stream->gtlock, &attr);
+  pthread_rwlockattr_destroy(&attr);
+  pthread_mutex_init(&stream->lock, NULL);
+  pthread_cond_init(&stream->jobready, NULL);
+  pthread_cond_init(&stream->jobdone, NULL);
+  pthread_cond_init(&stream->slotfree, NULL);
+  stream->pending = gt_queue_new();
+  stream->capacity = queuesize < numthreads ? numthreads : queuesize;
+  stream->slots = gt_calloc(stream->capacity, sizeof(ParallelStreamJob *));
+  stream->numread = 0;
+  stream->numreturned = 0;
+  stream->eof = false;
+  stream->abort = false;
+  stream->readerror = NULL;
+  stream->current = NULL;
+  stream->outindex = 0;
+
+  // Node stream classes are created on first use, which is not thread safe, so
+  // all of the chains are built here rather than in the worker threads.
+  GtUword i;
+  stream->workers = gt_malloc(numthreads * sizeof(ParallelStreamWorker));
+  for(i = 0; i < numthreads; i++)
+  {
+    ParallelStreamWorker *worker = stream->workers + i;
+    worker->stream = stream;
+    worker->feed = gt_node_stream_create(parallel_feed_stream_class(), false);
+    ParallelFeedStream *feed = parallel_feed_stream_cast(worker->feed);
+    feed->node = NULL;
+    worker->chain = chainfunc(worker->feed, chaindata);
+    worker->error = gt_error_new();
+  }
+
+  // Creating a feature interns its type, which changes a global table only
+  // the first time the type is seen; do that here for the chains' types
+  if(types != NULL)
+  {
+    GtStr *seqid = gt_str_new_cstr("intern");
+    for(i = 0; types[i] != NULL; i++)
+    {
+      GtGenomeNode *gn = gt_feature_node_new(seqid, types[i], 1, 1,
+                                             GT_STRAND_BOTH);
+      gt_genome_node_delete(gn);
+    }
+    gt_str_delete(seqid);
+  }
+
+  return ns;
+}
+
+static const GtNodeStreamClass *parallel_feed_stream_class(void)
+{
+  static const GtNodeStreamClass *nsc = NULL;
+  if(!nsc)
+  {
+    nsc = gt_node_stream_class_new(sizeof (ParallelFeedStream), NULL,
+                                   parallel_feed_stream_next);
+  }
+  return nsc;
+}
+
+static int parallel_feed_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                     GtError *error)
+{
+  gt_error_check(error);
+  ParallelFeedStream *feed = parallel_feed_stream_cast(ns);
+  *gn = feed->node;
+  feed->node = NULL;
+  return 0;
+}
+
+static const GtNodeStreamClass *parallel_stream_class(void)
+{
+  static const GtNodeStreamClass *nsc = NULL;
+  if(!nsc)
+  {
+    nsc = gt_node_stream_class_new(sizeof (AgnParallelStream),
+                                   parallel_stream_free,
+                                   parallel_stream_next);
+  }
+  return nsc;
+}
+
+static void parallel_stream_free(GtNodeStream *ns)
+{
+  AgnParallelStream *stream = parallel_stream_cast(ns);
+  parallel_stream_stop(stream);
+
+  GtUword i;
+  for(i = 0; i < stream->numworkers; i++)
+  {
+    ParallelStreamWorker *worker = stream->workers + i;
+    gt_node_stream_delete(worker->chain);
+    gt_node_stream_delete(worker->feed);
+    gt_error_delete(worker->error);
+  }
+  gt_free(stream->workers);
+
+  if(stream->current != NULL)
+    parallel_stream_job_delete(stream->current, stream->outindex);
+  for(i = stream->numreturned; i < stream->numread; i++)
+  {
+    ParallelStreamJob *job = stream->slots[i % stream->capacity];
+    parallel_stream_job_delete(job, 0);
+  }
+  gt_free(stream->slots);
+  gt_queue_delete(stream->pending);
+  if(stream->readerror != NULL)
+    gt_str_delete(stream->readerror);
+
+  pthread_cond_destroy(&stream->slotfree);
+  pthread_cond_destroy(&stream->jobdone);
+  pthread_cond_destroy(&stream->jobready);
+  pthread_mutex_destroy(&stream->lock);
+  pthread_rwlock_destroy(&stream->gtlock);
+  gt_node_stream_delete(stream->in_stream);
+}
+
+static void parallel_stream_isolate(GtGenomeNode *gn)
+{
+  // Region nodes bypass the workers, but are deleted downstream while the
+  // parser may still be using their sequence ID
+  if(gt_region_node_try_cast(gn) != NULL)
+  {
+    GtStr *seqid = gt_str_clone(gt_genome_node_get_seqid(gn));
+    gt_genome_node_change_seqid(gn, seqid);
+    gt_str_delete(seqid);
+    return;
+  }
+
+  GtFeatureNode *fn = gt_feature_node_try_cast(gn);
+  if(fn == NULL)
+    return;
+
+  GtStr *seqid = gt_str_clone(gt_genome_node_get_seqid(gn));
+  GtStr *source = NULL;
+
+  GtFeatureNode *current;
+  GtFeatureNodeIterator *iter = gt_feature_node_iterator_new(fn);
+  for(current  = gt_feature_node_iterator_next(iter);
+      current != NULL;
+      current  = gt_feature_node_iterator_next(iter))
+  {
+    gt_genome_node_change_seqid((GtGenomeNode *)current, seqid);
+
+    const char *featsource = gt_feature_node_get_source(current);
+    if(source == NULL || strcmp(gt_str_get(source), featsource) != 0)
+    {
+      if(source != NULL)
+        gt_str_delete(source);
+      source = gt_str_new_cstr(featsource);
+    }
+    gt_feature_node_set_source(current, source);
+  }
+  gt_feature_node_iterator_delete(iter);
+
+  gt_str_delete(seqid);
+  if(source != NULL)
+    gt_str_delete(source);
+}
+
+static void parallel_stream_job_delete(ParallelStreamJob *job, GtUword first)
+{
+  GtUword i;
+  for(i = first; i < gt_array_size(job->outputs); i++)
+  {
+    GtGenomeNode *gn = *(GtGenomeNode **)gt_array_get(job->outputs, i);
+    gt_genome_node_delete(gn);
+  }
+  gt_array_delete(job->outputs);
+  if(job->node != NULL)
+    gt_genome_node_delete(job->node);
+  if(job->errmsg != NULL)
+    gt_str_delete(job->errmsg);
+  gt_free(job);
+}
+
+static int parallel_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                GtError *error)
+{
+  AgnParallelStream *stream;
+  gt_error_check(error);
+  stream = parallel_stream_cast(ns);
+  *gn = NULL;
+
+  if(!stream->started && parallel_stream_start(stream, error))
+    return -1;
+
+  while(1)
+  {
+    if(stream->current != NULL)
+    {
+      if(stream->outindex < gt_array_size(stream->current->outputs))
+      {
+        *gn = *(GtGenomeNode **)gt_array_get(stream->current->outputs,
+                                             stream->outindex);
+        stream->outindex++;
+        return 0;
+      }
+      parallel_stream_job_delete(stream->current, stream->outindex);
+      stream->current = NULL;
+    }
+
+    ParallelStreamJob *job = NULL;
+    pthread_mutex_lock(&stream->lock);
+    while(1)
+    {
+      job = NULL;
+      if(stream->numreturned < stream->numread)
+        job = stream->slots[stream->numreturned % stream->capacity];
+      if(job != NULL && job->done)
+        break;
+      if(job == NULL && stream->eof)
+        break;
+      pthread_cond_wait(&stream->jobdone, &stream->lock);
+    }
+
+    // Errors from the input stream are reported only after all of the nodes
+    // read before the error have been returned, as they would be serially.
+    if(job == NULL)
+    {
+      int had_err = 0;
+      if(stream->readerror != NULL)
+      {
+        gt_error_set(error, "%s", gt_str_get(stream->readerror));
+        had_err = -1;
+      }
+      pthread_mutex_unlock(&stream->lock);
+      return had_err;
+    }
+
+    stream->slots[stream->numreturned % stream->capacity] = NULL;
+    stream->numreturned++;
+    pthread_cond_signal(&stream->slotfree);
+    pthread_mutex_unlock(&stream->lock);
+
+    if(job->errmsg != NULL)
+    {
+      gt_error_set(error, "%s", gt_str_get(job->errmsg));
+      parallel_stream_job_delete(job, 0);
+      return -1;
+    }
+    stream->current = job;
+    stream->outindex = 0;
+  }
+
+  return 0;
+}
+
+static void parallel_stream_process(ParallelStreamWorker *worker,
+                                    ParallelStreamJob *job)
+{
+  ParallelFeedStream *feed = parallel_feed_stream_cast(worker->feed);
+  feed->node = job->node;
+  job->node = NULL;
+  gt_error_unset(worker->error);
+
+  while(1)
+  {
+    GtGenomeNode *gn;
+    int had_err = gt_node_stream_next(worker->chain, &gn, worker->error);
+    if(had_err)
+    {
+      job->errmsg = gt_str_new_cstr(gt_error_get(worker->error));
+      if(feed->node != NULL)
+      {
+        gt_genome_node_delete(feed->node);
+        feed->node = NULL;
+      }
+      break;
+    }
+    if(gn == NULL)
+      break;
+
+    gt_array_add(job->outputs, gn);
+  }
+}
+
+static void *parallel_stream_reader(void *data)
+{
+  AgnParallelStream *stream = data;
+  GtError *error = gt_error_new();
+
+  while(1)
+  {
+    pthread_mutex_lock(&stream->lock);
+    while(!stream->abort &&
+          stream->numread - stream->numreturned >= stream->capacity)
+    {
+      pthread_cond_wait(&stream->slotfree, &stream->lock);
+    }
+    bool abort = stream->abort;
+    pthread_mutex_unlock(&stream->lock);
+    if(abort)
+      break;
+
+    // Parsing interns feature types and creates shared strings, so it must
+    // not overlap with any worker's processing
+    GtGenomeNode *gn = NULL;
+    pthread_rwlock_wrlock(&stream->gtlock);
+    int had_err = gt_node_stream_next(stream->in_stream, &gn, error);
+    GtFeatureNode *fn = NULL;
+    if(!had_err && gn != NULL)
+    {
+      fn = gt_feature_node_try_cast(gn);
+      parallel_stream_isolate(gn);
+    }
+    pthread_rwlock_unlock(&stream->gtlock);
+    if(had_err || gn == NULL)
+    {
+      pthread_mutex_lock(&stream->lock);
+      if(had_err)
+        stream->readerror = gt_str_new_cstr(gt_error_get(error));
+      stream->eof = true;
+      pthread_cond_broadcast(&stream->jobready);
+      pthread_cond_broadcast(&stream->jobdone);
+      pthread_mutex_unlock(&stream->lock);
+      break;
+    }
+
+    ParallelStreamJob *job = gt_malloc(sizeof(ParallelStreamJob));
+    job->outputs = gt_array_new( sizeof(GtGenomeNode *) );
+    job->errmsg = NULL;
+    if(fn != NULL)
+    {
+      job->node = gn;
+      job->done = false;
+    }
+    else
+    {
+      gt_array_add(job->outputs, gn);
+      job->node = NULL;
+      job->done = true;
+    }
+
+    pthread_mutex_lock(&stream->lock);
+    stream->slots[stream->numread % stream->capacity] = job;
+    stream->numread++;
+    if(job->done)
+      pthread_cond_broadcast(&stream->jobdone);
+    else
+    {
+      gt_queue_add(stream->pending, job);
+      pthread_cond_signal(&stream->jobready);
+    }
+    pthread_mutex_unlock(&stream->lock);
+  }
+
+  gt_error_delete(error);
+  return NULL;
+}
+
+static int parallel_stream_start(AgnParallelStream *stream, GtError *error)
+{
+  stream->started = true;
+  for(stream->numrunning = 0;
+      stream->numrunning < stream->numworkers;
+      stream->numrunning++)
+  {
+    ParallelStreamWorker *worker = stream->workers + stream->numrunning;
+    if(pthread_create(&worker->thread, NULL, parallel_stream_worker, worker))
+    {
+      gt_error_set(error, "could not create worker thread");
+      parallel_stream_stop(stream);
+      return -1;
+    }
+  }
+
+  if(pthread_create(&stream->reader, NULL, parallel_stream_reader, stream))
+  {
+    gt_error_set(error, "could not create reader thread");
+    parallel_stream_stop(stream);
+    return -1;
+  }
+  stream->readerrunning = true;
+  return 0;
+}
+
+static void parallel_stream_stop(AgnParallelStream *stream)
+{
+  pthread_mutex_lock(&stream->lock);
+  stream->abort = true;
+  pthread_cond_broadcast(&stream->jobready);
+  pthread_cond_broadcast(&stream->jobdone);
+  pthread_cond_broadcast(&stream->slotfree);
+  pthread_mutex_unlock(&stream->lock);
+
+  if(stream->readerrunning)
+    pthread_join(stream->reader, NULL);
+  stream->readerrunning = false;
+
+  GtUword i;
+  for(i = 0; i < stream->numrunning; i++)
+    pthread_join(stream->workers[i].thread, NULL);
+  stream->numrunning = 0;
+}
+
+static void *parallel_stream_worker(void *data)
+{
+  ParallelStreamWorker *worker = data;
+  AgnParallelStream *stream = worker->stream;
+
+  while(1)
+  {
+    pthread_mutex_lock(&stream->lock);
+    while(!stream->abort && !stream->eof &&
+          gt_queue_size(stream->pending) == 0)
+    {
+      pthread_cond_wait(&stream->jobready, &stream->lock);
+    }
+    if(stream->abort || gt_queue_size(stream->pending) == 0)
+    {
+      pthread_mutex_unlock(&stream->lock);
+      break;
+    }
+    ParallelStreamJob *job = gt_queue_get(stream->pending);
+    pthread_mutex_unlock(&stream->lock);
+
+    pthread_rwlock_rdlock(&stream->gtlock);
+    parallel_stream_process(worker, job);
+    pthread_rwlock_unlock(&stream->gtlock);
+
+    pthread_mutex_lock(&stream->lock);
+    job->done = true;
+    pthread_cond_broadcast(&stream->jobdone);
+    pthread_mutex_unlock(&stream->lock);
+  }
+
+  return NULL;
+}
+
+bool agn_parallel_stream_unit_test(AgnUnitTest *test)
+{
+  GtUword i, numgenes = 64;
+  GtArray *genes = gt_array_new( sizeof(GtGenomeNode *) );
+  for(i = 0; i < numgenes; i++)
+  {
+    GtGenomeNode *gene = (GtGenomeNode *)agn_test_data_eden();
+    gt_array_add(genes, gene);
+  }
+
+  GtError *error = gt_error_new();
+  GtHashmap *typestokeep = gt_hashmap_new(GT_HASH_STRING, NULL, NULL);
+  gt_hashmap_add(typestokeep, "gene", "gene");
+  GtNodeStream *arraystream = gt_array_in_stream_new(genes, NULL, error);
+  GtNodeStream *stream = agn_parallel_stream_new(arraystream, 4, 8,
+                                                 parallel_stream_test_chain,
+                                                 typestokeep, NULL);
+
+  // Each gene should come back exactly once, in input order, even though the
+  // workers finish them in an arbitrary order.
+  bool orderpass = true;
+  GtUword numreturned = 0;
+  GtGenomeNode *gn;
+  int had_err;
+  for(had_err = gt_node_stream_next(stream, &gn, error);
+      !had_err && gn != NULL;
+      had_err = gt_node_stream_next(stream, &gn, error))
+  {
+    if(numreturned >= numgenes ||
+       gn != *(GtGenomeNode **)gt_array_get(genes, numreturned))
+    {
+      orderpass = false;
+    }
+    numreturned++;
+    gt_genome_node_delete(gn);
+  }
+  orderpass = orderpass && !had_err && numreturned == numgenes;
+  agn_unit_test_result(test, "output order", orderpass);
+
+  gt_node_stream_delete(stream);
+  gt_node_stream_delete(arraystream);
+  gt_hashmap_delete(typestokeep);
+  gt_error_delete(error);
+  for(i = 0; i < numgenes; i++)
+  {
+    GtGenomeNode *gene = *(GtGenomeNode **)gt_array_get(genes, i);
+    gt_genome_node_delete(gene);
+  }
+  gt_array_delete(genes);
+
+  return orderpass;
+}
+
+static GtNodeStream *parallel_stream_test_chain(GtNodeStream *in_stream,
+                                                void *data)
+{
+  GtHashmap *typestokeep = data;
+  return agn_filter_stream_new(in_stream, typestokeep);
+}
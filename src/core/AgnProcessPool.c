@@ -0,0 +1,478 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "AgnProcessPool.h"
+#include "AgnUtils.h"
+
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+// Alignment of each region of shared memory
+#define PROCESS_POOL_ALIGN 16
+
+// Microseconds between checks on worker processes when reporting progress
+#define PROCESS_POOL_POLL 20000
+
+// State shared by all worker processes
+typedef struct
+{
+  volatile GtUword next;
+  volatile int failed;
+} ProcessPoolState;
+
+// Position of the output written by a task to one of its streams
+typedef struct
+{
+  GtUword worker;
+  off_t offset;
+  off_t length;
+} ProcessPoolSegment;
+
+struct AgnProcessPool
+{
+  GtUword numprocs;
+  GtUword numtasks;
+  GtUword numstreams;
+  size_t resultsize;
+  FILE **files;
+  void *shared;
+  size_t sharedsize;
+  ProcessPoolState *state;
+  ProcessPoolSegment *segments;
+  volatile char *done;
+  char *results;
+  AgnProcessProgressFunc progressfunc;
+  void *progressdata;
+  double interval;
+  double lastreport;
+};
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+/**
+ * Round the given size up to a multiple of PROCESS_POOL_ALIGN.
+ *
+ * @param[in] size    a size in bytes
+ * @returns           the aligned size
+ */
+static size_t process_pool_align(size_t size);
+
+/**
+ * Call the progress function if one was set and at least the requested
+ * interval has passed since it was last called.
+ *
+ * @param[in] pool    the pool
+ */
+static void process_pool_progress(AgnProcessPool *pool);
+
+/**
+ * Progress function for unit tests: count the number of calls.
+ *
+ * @param[in]  pool    the pool
+ * @param[out] data    number of calls so far
+ */
+static void process_pool_test_progress(AgnProcessPool *pool, void *data);
+
+/**
+ * Task function for unit tests: write a line to the first stream for each
+ * task, a line to the second stream for even tasks only, and store the square
+ * of the task number as the result. Task 7 fails if ``data`` is not NULL.
+ *
+ * @param[in]  task       task number
+ * @param[out] streams    output streams
+ * @param[out] result     the task's result
+ * @param[in]  data       NULL, or any value to simulate a failure
+ * @returns               0 on success, 1 on failure
+ */
+static int process_pool_test_task(GtUword task, FILE **streams, void *result,
+                                  void *data);
+
+/**
+ * Run tasks and check the assembled output for unit tests.
+ *
+ * @param[in] numprocs    number of worker processes
+ * @param[in] reverse     whether to run the tasks in reverse order
+ * @returns               true if the results and output are as expected
+ */
+static bool process_pool_test_run(GtUword numprocs, bool reverse);
+
+/**
+ * Take tasks from the work counter and run them until none are left or a task
+ * has failed.
+ *
+ * @param[in] pool      the pool
+ * @param[in] worker    number of the calling worker
+ * @param[in] order     order in which to run the tasks, or NULL
+ * @param[in] func      task function
+ * @param[in] data      supplementary data for the task function
+ * @returns             0 on success, -1 if a task failed
+ */
+static int process_pool_work(AgnProcessPool *pool, GtUword worker,
+                             const GtUword *order, AgnProcessTaskFunc func,
+                             void *data);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+void agn_process_pool_delete(AgnProcessPool *pool)
+{
+  GtUword i;
+  for(i = 0; i < pool->numprocs * pool->numstreams; i++)
+  {
+    if(pool->files[i] != NULL)
+      fclose(pool->files[i]);
+  }
+  gt_free(pool->files);
+  munmap(pool->shared, pool->sharedsize);
+  gt_free(pool);
+}
+
+AgnProcessPool *agn_process_pool_new(GtUword numprocs, GtUword numtasks,
+                                     GtUword numstreams, size_t resultsize)
+{
+  gt_assert(numprocs > 0);
+  AgnProcessPool *pool = gt_malloc( sizeof(AgnProcessPool) );
+  pool->numprocs = numprocs;
+  pool->numtasks = numtasks;
+  pool->numstreams = numstreams;
+  pool->resultsize = process_pool_align(resultsize);
+  pool->files = gt_calloc(numprocs * numstreams + 1, sizeof(FILE *));
+  pool->progressfunc = NULL;
+  pool->progressdata = NULL;
+  pool->interval = 0.0;
+  pool->lastreport = 0.0;
+
+  // Anonymous shared mappings are zeroed, so no further initialization is
+  // needed
+  size_t statesize = process_pool_align(sizeof(ProcessPoolState));
+  size_t segmentsize = process_pool_align(numtasks * numstreams *
+                                          sizeof(ProcessPoolSegment));
+  size_t donesize = process_pool_align(numtasks);
+  pool->sharedsize = statesize + segmentsize + donesize +
+                     numtasks * pool->resultsize;
+  pool->shared = mmap(NULL, pool->sharedsize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if(pool->shared == MAP_FAILED)
+  {
+    fprintf(stderr, "error: could not allocate %lu bytes of shared memory for "
+            "worker processes\n", (GtUword)pool->sharedsize);
+    exit(1);
+  }
+  pool->state = pool->shared;
+  pool->segments = (ProcessPoolSegment *)((char *)pool->shared + statesize);
+  pool->done = (char *)pool->shared + statesize + segmentsize;
+  pool->results = (char *)pool->shared + statesize + segmentsize + donesize;
+  return pool;
+}
+
+void *agn_process_pool_result(AgnProcessPool *pool, GtUword task)
+{
+  gt_assert(task < pool->numtasks);
+  return pool->results + task * pool->resultsize;
+}
+
+int agn_process_pool_run(AgnProcessPool *pool, const GtUword *order,
+                         AgnProcessTaskFunc func, void *data, GtError *error)
+{
+  GtUword i;
+  for(i = 0; i < pool->numprocs * pool->numstreams; i++)
+  {
+    pool->files[i] = tmpfile();
+    if(pool->files[i] == NULL)
+    {
+      gt_error_set(error, "could not create temporary file for worker "
+                   "output");
+      return -1;
+    }
+  }
+
+  // Anything left in a buffer would otherwise be written by each worker
+  fflush(NULL);
+  pool->lastreport = agn_wallclock();
+  if(pool->numprocs == 1)
+  {
+    if(process_pool_work(pool, 0, order, func, data))
+    {
+      gt_error_set(error, "task failed");
+      return -1;
+    }
+    return 0;
+  }
+
+  GtUword numworkers = pool->numprocs, started;
+  pid_t *workers = gt_malloc( numworkers * sizeof(pid_t) );
+  for(started = 0; started < numworkers; started++)
+  {
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+      pool->state->failed = 1;
+      gt_error_set(error, "could not create worker process: %s",
+                   strerror(errno));
+      break;
+    }
+    if(pid == 0)
+    {
+      int status = process_pool_work(pool, started, order, func, data);
+      fflush(NULL);
+      _exit(status ? 1 : 0);
+    }
+    workers[started] = pid;
+  }
+
+  // Without a progress function, simply wait for each worker in turn
+  int had_err = gt_error_is_set(error) ? -1 : 0;
+  int options = pool->progressfunc != NULL ? WNOHANG : 0;
+  bool *exited = gt_calloc(started + 1, sizeof(bool));
+  GtUword running = started;
+  while(running > 0)
+  {
+    for(i = 0; i < started; i++)
+    {
+      int status = 0;
+      pid_t pid = exited[i] ? 0 : waitpid(workers[i], &status, options);
+      if(pid == 0)
+        continue;
+
+      exited[i] = true;
+      running--;
+      if(pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        continue;
+      if(!had_err)
+      {
+        if(pid > 0 && WIFSIGNALED(status))
+        {
+          gt_error_set(error, "worker process %lu terminated by signal %d",
+                       i + 1, WTERMSIG(status));
+        }
+        else
+          gt_error_set(error, "worker process %lu failed", i + 1);
+      }
+      had_err = -1;
+    }
+    if(running > 0 && pool->progressfunc != NULL)
+    {
+      usleep(PROCESS_POOL_POLL);
+      process_pool_progress(pool);
+    }
+  }
+  gt_free(exited);
+  gt_free(workers);
+  return had_err;
+}
+
+bool agn_process_pool_unit_test(AgnUnitTest *test)
+{
+  bool serialpass = process_pool_test_run(1, false);
+  agn_unit_test_result(test, "single process", serialpass);
+
+  bool parallelpass = process_pool_test_run(3, false) &&
+                      process_pool_test_run(8, true);
+  agn_unit_test_result(test, "multiple processes, ordered output",
+                       parallelpass);
+
+  // A failed task fails the run
+  GtError *error = gt_error_new();
+  AgnProcessPool *pool = agn_process_pool_new(3, 20, 2, sizeof(GtUword));
+  int dummy;
+  bool failpass = agn_process_pool_run(pool, NULL, process_pool_test_task,
+                                       &dummy, error) == -1 &&
+                  gt_error_is_set(error);
+  agn_process_pool_delete(pool);
+  gt_error_delete(error);
+  agn_unit_test_result(test, "failed task", failpass);
+
+  return serialpass && parallelpass && failpass;
+}
+
+void agn_process_pool_set_progress(AgnProcessPool *pool,
+                                   AgnProcessProgressFunc func, void *data,
+                                   double interval)
+{
+  pool->progressfunc = func;
+  pool->progressdata = data;
+  pool->interval = interval;
+}
+
+bool agn_process_pool_task_done(AgnProcessPool *pool, GtUword task)
+{
+  gt_assert(task < pool->numtasks);
+  return pool->done[task] != 0;
+}
+
+int agn_process_pool_write_output(AgnProcessPool *pool, GtUword task,
+                                  GtUword stream, FILE *outstream,
+                                  GtError *error)
+{
+  gt_assert(task < pool->numtasks && stream < pool->numstreams);
+  ProcessPoolSegment *segment = pool->segments + task * pool->numstreams +
+                                stream;
+  if(segment->length == 0)
+    return 0;
+
+  FILE *instream = pool->files[segment->worker * pool->numstreams + stream];
+  if(fseeko(instream, segment->offset, SEEK_SET) != 0)
+  {
+    gt_error_set(error, "could not read output of task %lu", task);
+    return -1;
+  }
+  char buffer[65536];
+  off_t remaining = segment->length;
+  while(remaining > 0)
+  {
+    size_t chunk = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
+    if(fread(buffer, 1, chunk, instream) != chunk)
+    {
+      gt_error_set(error, "could not read output of task %lu", task);
+      return -1;
+    }
+    fwrite(buffer, 1, chunk, outstream);
+    remaining -= chunk;
+  }
+  return 0;
+}
+
+static size_t process_pool_align(size_t size)
+{
+  return (size + PROCESS_POOL_ALIGN - 1) / PROCESS_POOL_ALIGN *
+         PROCESS_POOL_ALIGN;
+}
+
+static void process_pool_progress(AgnProcessPool *pool)
+{
+  if(pool->progressfunc == NULL)
+    return;
+
+  double now = agn_wallclock();
+  if(now - pool->lastreport >= pool->interval)
+  {
+    pool->progressfunc(pool, pool->progressdata);
+    pool->lastreport = now;
+  }
+}
+
+static void process_pool_test_progress(AgnProcessPool *pool, void *data)
+{
+  GtUword *calls = data;
+  (*calls)++;
+}
+
+static int process_pool_test_task(GtUword task, FILE **streams, void *result,
+                                  void *data)
+{
+  if(data != NULL && task == 7)
+    return 1;
+
+  GtUword i;
+  for(i = 0; i <= task % 4; i++)
+    fprintf(streams[0], "task %lu line %lu\n", task, i);
+  if(task % 2 == 0)
+    fprintf(streams[1], "even task %lu\n", task);
+  *(GtUword *)result = task * task;
+  return 0;
+}
+
+static bool process_pool_test_run(GtUword numprocs, bool reverse)
+{
+  GtUword numtasks = 50, i, j;
+  GtUword order[50];
+  for(i = 0; i < numtasks; i++)
+    order[i] = reverse ? numtasks - i - 1 : i;
+
+  GtError *error = gt_error_new();
+  AgnProcessPool *pool = agn_process_pool_new(numprocs, numtasks, 2,
+                                              sizeof(GtUword));
+  GtUword calls = 0;
+  agn_process_pool_set_progress(pool, process_pool_test_progress, &calls, 0.0);
+  bool pass = agn_process_pool_run(pool, order, process_pool_test_task, NULL,
+                                   error) == 0;
+
+  // A single process reports progress after every task
+  for(i = 0; pass && i < numtasks; i++)
+    pass = agn_process_pool_task_done(pool, i);
+  pass = pass && (numprocs > 1 || calls == numtasks);
+
+  // Output should be assembled in task order, whatever the order of execution
+  GtStr *expected = gt_str_new();
+  FILE *outstream = tmpfile();
+  pass = pass && outstream != NULL;
+  for(i = 0; pass && i < numtasks; i++)
+  {
+    pass = *(GtUword *)agn_process_pool_result(pool, i) == i * i &&
+           agn_process_pool_write_output(pool, i, 0, outstream, error) == 0 &&
+           agn_process_pool_write_output(pool, i, 1, outstream, error) == 0;
+    char line[64];
+    for(j = 0; j <= i % 4; j++)
+    {
+      sprintf(line, "task %lu line %lu\n", i, j);
+      gt_str_append_cstr(expected, line);
+    }
+    if(i % 2 == 0)
+    {
+      sprintf(line, "even task %lu\n", i);
+      gt_str_append_cstr(expected, line);
+    }
+  }
+  if(pass)
+  {
+    GtUword length = gt_str_length(expected);
+    char *observed = gt_malloc(length + 1);
+    rewind(outstream);
+    pass = fread(observed, 1, length + 1, outstream) == length &&
+           strncmp(observed, gt_str_get(expected), length) == 0;
+    gt_free(observed);
+  }
+
+  if(outstream != NULL)
+    fclose(outstream);
+  gt_str_delete(expected);
+  agn_process_pool_delete(pool);
+  gt_error_delete(error);
+  return pass;
+}
+
+static int process_pool_work(AgnProcessPool *pool, GtUword worker,
+                             const GtUword *order, AgnProcessTaskFunc func,
+                             void *data)
+{
+  FILE **streams = pool->files + worker * pool->numstreams;
+  while(!pool->state->failed)
+  {
+    GtUword next = __sync_fetch_and_add(&pool->state->next, 1);
+    if(next >= pool->numtasks)
+      break;
+    GtUword task = order == NULL ? next : order[next];
+
+    GtUword i;
+    ProcessPoolSegment *segments = pool->segments + task * pool->numstreams;
+    for(i = 0; i < pool->numstreams; i++)
+    {
+      segments[i].worker = worker;
+      segments[i].offset = ftello(streams[i]);
+    }
+    if(func(task, streams, agn_process_pool_result(pool, task), data) != 0)
+    {
+      pool->state->failed = 1;
+      return -1;
+    }
+    for(i = 0; i < pool->numstreams; i++)
+    {
+      fflush(streams[i]);
+      segments[i].length = ftello(streams[i]) - segments[i].offset;
+    }
+    __sync_synchronize();
+    pool->done[task] = 1;
+    if(pool->numprocs == 1)
+      process_pool_progress(pool);
+  }
+  return 0;
+}
@@ -0,0 +1,381 @@
+#include <errno.h>
+#include <string.h>
+#include "AgnRegionIndex.h"
+
+// Each window covers 2^14 = 16384 bp, as in the tabix linear index
+#define REGION_INDEX_WINDOW_SHIFT 14
+
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+/**
+ * Windows of a single sequence. While the index is being built, windows hold
+ * offsets into the uncompressed data (or ``GT_UNDEF_UWORD`` if no feature
+ * overlaps them); once written or read, they hold virtual offsets.
+ */
+typedef struct
+{
+  char *seqid;
+  GtArray *windows;
+} RegionIndexSequence;
+
+struct AgnRegionIndex
+{
+  GtArray *sequences;
+  GtHashmap *seqsbyid;
+  RegionIndexSequence *current;
+  GtUword laststart;
+  GtStr *seqid;
+  GtStr *errmsg;
+};
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+/**
+ * Line function passed to the writer: index each top-level feature line,
+ * checking that features are sorted.
+ *
+ * @param[in] line      the line
+ * @param[in] length    length of the line
+ * @param[in] offset    offset of the line in the uncompressed data
+ * @param[in] data      the index
+ */
+static void region_index_add_line(const char *line, GtUword length,
+                                  GtUword offset, void *data);
+
+/**
+ * Add a sequence to the index.
+ *
+ * @param[in] idx      the index
+ * @param[in] seqid    the sequence ID
+ * @returns            the new sequence
+ */
+static RegionIndexSequence *region_index_add_sequence(AgnRegionIndex *idx,
+                                                      const char *seqid);
+
+/**
+ * Parse an unsigned integer of ``length`` characters.
+ *
+ * @param[in]  data      the characters
+ * @param[in]  length    number of characters
+ * @param[out] value     the integer
+ * @returns              true if the characters are all digits, false otherwise
+ */
+static bool region_index_parse_uword(const char *data, GtUword length,
+                                     GtUword *value);
+
+/**
+ * Destructor for an indexed sequence.
+ *
+ * @param[in] seq    the sequence
+ */
+static void region_index_sequence_delete(RegionIndexSequence *seq);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+void agn_region_index_attach(AgnRegionIndex *idx, AgnBgzfWriter *writer)
+{
+  agn_bgzf_writer_set_line_func(writer, region_index_add_line, idx);
+}
+
+void agn_region_index_delete(AgnRegionIndex *idx)
+{
+  GtUword i;
+  for(i = 0; i < gt_array_size(idx->sequences); i++)
+  {
+    RegionIndexSequence **seq = gt_array_get(idx->sequences, i);
+    region_index_sequence_delete(*seq);
+  }
+  gt_array_delete(idx->sequences);
+  gt_hashmap_delete(idx->seqsbyid);
+  gt_str_delete(idx->seqid);
+  gt_str_delete(idx->errmsg);
+  gt_free(idx);
+}
+
+bool agn_region_index_lookup(AgnRegionIndex *idx, const char *seqid,
+                             GtUword start, GtUword *voffset)
+{
+  RegionIndexSequence *seq = gt_hashmap_get(idx->seqsbyid, seqid);
+  if(seq == NULL)
+    return false;
+
+  // No feature ends beyond the last window
+  GtUword window = start >> REGION_INDEX_WINDOW_SHIFT;
+  if(window >= gt_array_size(seq->windows))
+    return false;
+  *voffset = *(GtUword *)gt_array_get(seq->windows, window);
+  return true;
+}
+
+AgnRegionIndex *agn_region_index_new(void)
+{
+  AgnRegionIndex *idx = gt_malloc( sizeof(AgnRegionIndex) );
+  idx->sequences = gt_array_new( sizeof(RegionIndexSequence *) );
+  idx->seqsbyid = gt_hashmap_new(GT_HASH_STRING, NULL, NULL);
+  idx->current = NULL;
+  idx->laststart = 0;
+  idx->seqid = gt_str_new();
+  idx->errmsg = gt_str_new();
+  return idx;
+}
+
+bool agn_region_index_parse_record(const char *line, GtUword length,
+                                   GtStr *seqid, GtRange *range,
+                                   bool *toplevel)
+{
+  if(length == 0 || line[0] == '#')
+    return false;
+
+  const char *columns[9], *end = line + length;
+  GtUword lengths[9];
+  int i;
+  for(i = 0; i < 8; i++)
+  {
+    const char *tab = memchr(line, '\t', end - line);
+    if(tab == NULL)
+      return false;
+    columns[i] = line;
+    lengths[i] = tab - line;
+    line = tab + 1;
+  }
+  columns[8] = line;
+  lengths[8] = end - line;
+
+  if(!region_index_parse_uword(columns[3], lengths[3], &range->start) ||
+     !region_index_parse_uword(columns[4], lengths[4], &range->end))
+  {
+    return false;
+  }
+  gt_str_reset(seqid);
+  gt_str_append_cstr_nt(seqid, columns[0], lengths[0]);
+
+  // Only features without a Parent attribute begin a new record
+  const char *attrs = columns[8], *attrsend = attrs + lengths[8];
+  *toplevel = true;
+  while(attrs < attrsend)
+  {
+    if(attrsend - attrs >= 7 && strncmp(attrs, "Parent=", 7) == 0)
+    {
+      *toplevel = false;
+      break;
+    }
+    const char *semicolon = memchr(attrs, ';', attrsend - attrs);
+    if(semicolon == NULL)
+      break;
+    attrs = semicolon + 1;
+  }
+  return true;
+}
+
+AgnRegionIndex *agn_region_index_read(const char *filename, GtError *error)
+{
+  FILE *instream = fopen(filename, "r");
+  if(instream == NULL)
+  {
+    gt_error_set(error, "could not open index file \"%s\": %s", filename,
+                 strerror(errno));
+    return NULL;
+  }
+
+  AgnRegionIndex *idx = agn_region_index_new();
+  char *line = NULL;
+  size_t capacity = 0;
+  ssize_t length;
+  unsigned int linenum = 0;
+  int shift = -1;
+  bool valid = true;
+  while(valid && (length = getline(&line, &capacity, instream)) > 0)
+  {
+    linenum++;
+    if(line[length - 1] == '\n')
+      line[--length] = '\0';
+    if(linenum == 1)
+    {
+      valid = strcmp(line, "##agn-region-index\t1") == 0;
+      continue;
+    }
+    if(linenum == 2)
+    {
+      valid = sscanf(line, "##window-shift\t%d", &shift) == 1 &&
+              shift == REGION_INDEX_WINDOW_SHIFT;
+      continue;
+    }
+
+    // Sequence ID, number of windows, and comma-separated window offsets
+    char *tab = strchr(line, '\t');
+    if(tab == NULL)
+    {
+      valid = false;
+      break;
+    }
+    *tab = '\0';
+    RegionIndexSequence *seq = region_index_add_sequence(idx, line);
+    char *pos = tab + 1, *next;
+    GtUword i, numwindows = strtoul(pos, &next, 10);
+    for(i = 0; i < numwindows && valid; i++)
+    {
+      pos = next + 1;
+      valid = (*next == '\t' || *next == ',') && *pos >= '0' && *pos <= '9';
+      GtUword voffset = strtoul(pos, &next, 10);
+      gt_array_add(seq->windows, voffset);
+    }
+    valid = valid && *next == '\0';
+  }
+  free(line);
+  fclose(instream);
+
+  if(!valid || shift < 0)
+  {
+    gt_error_set(error, "index file \"%s\": invalid or unsupported format at "
+                 "line %u", filename, linenum);
+    agn_region_index_delete(idx);
+    return NULL;
+  }
+  return idx;
+}
+
+int agn_region_index_write(AgnRegionIndex *idx, const char *filename,
+                           AgnBgzfWriter *writer, GtError *error)
+{
+  if(gt_str_length(idx->errmsg) > 0)
+  {
+    gt_error_set(error, "could not index \"%s\": %s", filename,
+                 gt_str_get(idx->errmsg));
+    return -1;
+  }
+
+  FILE *outstream = fopen(filename, "w");
+  if(outstream == NULL)
+  {
+    gt_error_set(error, "could not open index file \"%s\": %s", filename,
+                 strerror(errno));
+    return -1;
+  }
+
+  fprintf(outstream, "##agn-region-index\t1\n##window-shift\t%d\n",
+          REGION_INDEX_WINDOW_SHIFT);
+  GtUword i;
+  for(i = 0; i < gt_array_size(idx->sequences); i++)
+  {
+    RegionIndexSequence *seq;
+    seq = *(RegionIndexSequence **)gt_array_get(idx->sequences, i);
+
+    // Empty windows take the offset of the next window that is not empty; the
+    // last window always has a feature ending in it
+    GtUword *windows = gt_array_get_space(seq->windows);
+    GtUword w, numwindows = gt_array_size(seq->windows), next = 0;
+    for(w = numwindows; w > 0; w--)
+    {
+      if(windows[w - 1] == GT_UNDEF_UWORD)
+        windows[w - 1] = next;
+      else
+      {
+        windows[w - 1] = agn_bgzf_writer_virtual_offset(writer,
+                                                        windows[w - 1]);
+        next = windows[w - 1];
+      }
+    }
+
+    fprintf(outstream, "%s\t%lu", seq->seqid, numwindows);
+    for(w = 0; w < numwindows; w++)
+      fprintf(outstream, "%c%lu", w == 0 ? '\t' : ',', windows[w]);
+    fputc('\n', outstream);
+  }
+
+  if(ferror(outstream) | fclose(outstream))
+  {
+    gt_error_set(error, "could not write index file \"%s\"", filename);
+    return -1;
+  }
+  return 0;
+}
+
+static void region_index_add_line(const char *line, GtUword length,
+                                  GtUword offset, void *data)
+{
+  AgnRegionIndex *idx = data;
+  GtRange range;
+  bool toplevel;
+  if(gt_str_length(idx->errmsg) > 0 ||
+     !agn_region_index_parse_record(line, length, idx->seqid, &range,
+                                    &toplevel) || !toplevel)
+  {
+    return;
+  }
+
+  const char *seqid = gt_str_get(idx->seqid);
+  if(idx->current == NULL || strcmp(idx->current->seqid, seqid) != 0)
+  {
+    if(gt_hashmap_get(idx->seqsbyid, seqid) != NULL)
+    {
+      gt_str_append_cstr(idx->errmsg, "features for sequence '");
+      gt_str_append_cstr(idx->errmsg, seqid);
+      gt_str_append_cstr(idx->errmsg, "' are not contiguous");
+      return;
+    }
+    idx->current = region_index_add_sequence(idx, seqid);
+    idx->laststart = 0;
+  }
+  if(range.start < idx->laststart)
+  {
+    gt_str_append_cstr(idx->errmsg, "features for sequence '");
+    gt_str_append_cstr(idx->errmsg, seqid);
+    gt_str_append_cstr(idx->errmsg, "' are not sorted");
+    return;
+  }
+  idx->laststart = range.start;
+
+  // Features are sorted, so the first to overlap a window has the lowest offset
+  GtArray *windows = idx->current->windows;
+  GtUword w, first = range.start >> REGION_INDEX_WINDOW_SHIFT;
+  GtUword last = range.end >> REGION_INDEX_WINDOW_SHIFT;
+  GtUword unset = GT_UNDEF_UWORD;
+  while(gt_array_size(windows) <= last)
+    gt_array_add(windows, unset);
+  for(w = first; w <= last; w++)
+  {
+    GtUword *window = gt_array_get(windows, w);
+    if(*window == GT_UNDEF_UWORD)
+      *window = offset;
+  }
+}
+
+static RegionIndexSequence *region_index_add_sequence(AgnRegionIndex *idx,
+                                                      const char *seqid)
+{
+  RegionIndexSequence *seq = gt_malloc( sizeof(RegionIndexSequence) );
+  seq->seqid = gt_cstr_dup(seqid);
+  seq->windows = gt_array_new( sizeof(GtUword) );
+  gt_array_add(idx->sequences, seq);
+  gt_hashmap_add(idx->seqsbyid, seq->seqid, seq);
+  return seq;
+}
+
+static bool region_index_parse_uword(const char *data, GtUword length,
+                                     GtUword *value)
+{
+  GtUword i;
+  *value = 0;
+  for(i = 0; i < length; i++)
+  {
+    if(data[i] < '0' || data[i] > '9')
+      return false;
+    *value = *value * 10 + (data[i] - '0');
+  }
+  return length > 0;
+}
+
+static void region_index_sequence_delete(RegionIndexSequence *seq)
+{
+  gt_free(seq->seqid);
+  gt_array_delete(seq->windows);
+  gt_free(seq);
+}
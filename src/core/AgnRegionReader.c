@@ -0,0 +1,339 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "AgnBgzf.h"
+#include "AgnRegionIndex.h"
+#include "AgnRegionReader.h"
+
+//------------------------------------------------------------------------------
+// Data structure definitions
+//------------------------------------------------------------------------------
+
+struct AgnRegionReader
+{
+  AgnBgzfReader *bgzf;
+  AgnRegionIndex *index;
+  GtStr *seqid;
+  GtRange range;
+  GtStr *line;
+  GtStr *pending;
+  bool haspending;
+  bool done;
+  GtStr *lineseqid;
+};
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+/**
+ * Append a line and its newline to a record.
+ *
+ * @param[out] record    the record
+ * @param[in]  line      the line
+ */
+static void region_reader_append_line(GtStr *record, GtStr *line);
+
+/**
+ * Write an indexed test file of genes and mRNAs on two sequences, storing the
+ * coordinates of the genes on each sequence for comparison.
+ *
+ * @param[in]  filename    name of the file to write
+ * @param[out] genes       coordinates of the genes on each sequence
+ * @param[out] error       error object
+ * @returns                0 on success, -1 on error
+ */
+static int region_reader_test_write(const char *filename, GtArray **genes,
+                                    GtError *error);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+void agn_region_reader_delete(AgnRegionReader *reader)
+{
+  agn_bgzf_reader_delete(reader->bgzf);
+  agn_region_index_delete(reader->index);
+  gt_str_delete(reader->seqid);
+  gt_str_delete(reader->line);
+  gt_str_delete(reader->pending);
+  gt_str_delete(reader->lineseqid);
+  gt_free(reader);
+}
+
+AgnRegionReader *agn_region_reader_new(const char *filename, GtError *error)
+{
+  GtStr *indexfile = gt_str_new_cstr(filename);
+  gt_str_append_cstr(indexfile, AGN_REGION_INDEX_SUFFIX);
+  AgnRegionIndex *index = agn_region_index_read(gt_str_get(indexfile), error);
+  gt_str_delete(indexfile);
+  if(index == NULL)
+    return NULL;
+
+  AgnBgzfReader *bgzf = agn_bgzf_reader_new(filename, error);
+  if(bgzf == NULL)
+  {
+    agn_region_index_delete(index);
+    return NULL;
+  }
+
+  AgnRegionReader *reader = gt_malloc( sizeof(AgnRegionReader) );
+  reader->bgzf = bgzf;
+  reader->index = index;
+  reader->seqid = gt_str_new();
+  reader->range.start = 0;
+  reader->range.end = 0;
+  reader->line = gt_str_new();
+  reader->pending = gt_str_new();
+  reader->haspending = false;
+  reader->done = true;
+  reader->lineseqid = gt_str_new();
+  return reader;
+}
+
+int agn_region_reader_next(AgnRegionReader *reader, GtStr *record,
+                           GtError *error)
+{
+  gt_str_reset(record);
+  while(!reader->done)
+  {
+    // Start with the top-level feature left over from the previous record
+    int status = 1;
+    if(reader->haspending)
+    {
+      GtStr *temp = reader->line;
+      reader->line = reader->pending;
+      reader->pending = temp;
+      reader->haspending = false;
+    }
+    else
+      status = agn_bgzf_reader_getline(reader->bgzf, reader->line, error);
+    if(status <= 0)
+    {
+      reader->done = true;
+      return status;
+    }
+
+    GtRange range;
+    bool toplevel;
+    if(!agn_region_index_parse_record(gt_str_get(reader->line),
+                                      gt_str_length(reader->line),
+                                      reader->lineseqid, &range, &toplevel) ||
+       !toplevel)
+    {
+      continue;
+    }
+    if(gt_str_cmp(reader->lineseqid, reader->seqid) != 0 ||
+       range.start > reader->range.end)
+    {
+      reader->done = true;
+      return 0;
+    }
+
+    // Subfeatures follow their top-level feature, up to the next top-level
+    // feature or directive
+    region_reader_append_line(record, reader->line);
+    GtRange subrange;
+    bool subtoplevel;
+    while((status = agn_bgzf_reader_getline(reader->bgzf, reader->pending,
+                                            error)) > 0)
+    {
+      if(!agn_region_index_parse_record(gt_str_get(reader->pending),
+                                        gt_str_length(reader->pending),
+                                        reader->lineseqid, &subrange,
+                                        &subtoplevel))
+      {
+        break;
+      }
+      if(subtoplevel)
+      {
+        reader->haspending = true;
+        break;
+      }
+      region_reader_append_line(record, reader->pending);
+    }
+    if(status < 0)
+    {
+      reader->done = true;
+      return -1;
+    }
+
+    if(range.end >= reader->range.start)
+      return 1;
+    gt_str_reset(record);
+  }
+  return 0;
+}
+
+int agn_region_reader_seek(AgnRegionReader *reader, const char *seqid,
+                           GtRange *range, GtError *error)
+{
+  gt_str_reset(reader->seqid);
+  gt_str_append_cstr(reader->seqid, seqid);
+  reader->range = *range;
+  reader->haspending = false;
+  reader->done = true;
+
+  GtUword voffset;
+  if(!agn_region_index_lookup(reader->index, seqid, range->start, &voffset))
+    return 0;
+  if(agn_bgzf_reader_seek(reader->bgzf, voffset, error) != 0)
+    return -1;
+  reader->done = false;
+  return 0;
+}
+
+bool agn_region_reader_unit_test(AgnUnitTest *test)
+{
+  GtError *error = gt_error_new();
+  char filename[] = "/tmp/AgnRegionReaderTestXXXXXX";
+  int fd = mkstemp(filename);
+  if(fd < 0)
+  {
+    agn_unit_test_result(test, "write indexed file", false);
+    gt_error_delete(error);
+    return false;
+  }
+  close(fd);
+  GtStr *indexfile = gt_str_new_cstr(filename);
+  gt_str_append_cstr(indexfile, AGN_REGION_INDEX_SUFFIX);
+
+  GtArray *genes[2];
+  genes[0] = gt_array_new( sizeof(GtRange) );
+  genes[1] = gt_array_new( sizeof(GtRange) );
+  int had_err = region_reader_test_write(filename, genes, error);
+  agn_unit_test_result(test, "write indexed file", !had_err);
+
+  // Compare each query against a scan of all genes
+  const char *seqids[] = { "chr1", "chr2", "chr3" };
+  GtRange queries[] = {
+    { 1, 1000 }, { 50000, 120000 }, { 1500000, 1600000 }, { 5000000, 6000000 },
+  };
+  bool querypass = !had_err;
+  AgnRegionReader *reader = had_err ? NULL :
+                            agn_region_reader_new(filename, error);
+  querypass = querypass && reader != NULL;
+  GtStr *record = gt_str_new();
+  GtUword s, q, i;
+  for(s = 0; s < 3 && querypass; s++)
+  {
+    for(q = 0; q < sizeof(queries) / sizeof(GtRange) && querypass; q++)
+    {
+      GtUword expected = 0, found = 0;
+      for(i = 0; s < 2 && i < gt_array_size(genes[s]); i++)
+      {
+        GtRange *gene = gt_array_get(genes[s], i);
+        if(gt_range_overlap(gene, queries + q))
+          expected++;
+      }
+
+      int status = agn_region_reader_seek(reader, seqids[s], queries + q,
+                                          error);
+      while(status == 0 &&
+            agn_region_reader_next(reader, record, error) == 1)
+      {
+        // Each record is a gene followed by its mRNA
+        GtRange range;
+        bool toplevel;
+        GtStr *seqid = gt_str_new();
+        const char *newline = strchr(gt_str_get(record), '\n');
+        querypass = querypass && newline != NULL &&
+                    agn_region_index_parse_record(gt_str_get(record),
+                                                  newline - gt_str_get(record),
+                                                  seqid, &range, &toplevel) &&
+                    strcmp(gt_str_get(seqid), seqids[s]) == 0 &&
+                    gt_range_overlap(&range, queries + q) &&
+                    strstr(newline, "\tmRNA\t") != NULL;
+        gt_str_delete(seqid);
+        found++;
+      }
+      querypass = querypass && status == 0 && !gt_error_is_set(error) &&
+                  found == expected;
+    }
+  }
+  agn_unit_test_result(test, "region queries", querypass);
+  gt_str_delete(record);
+  if(reader != NULL)
+    agn_region_reader_delete(reader);
+
+  // Unsorted input cannot be indexed
+  bool unsortedpass = false;
+  AgnBgzfWriter *writer = agn_bgzf_writer_new(filename, 1, error);
+  if(writer != NULL)
+  {
+    AgnRegionIndex *idx = agn_region_index_new();
+    agn_region_index_attach(idx, writer);
+    FILE *outstream = agn_bgzf_writer_stream(writer);
+    fputs("chr1\tAEGeAn\tgene\t5000\t6000\t.\t+\t.\tID=gene1\n", outstream);
+    fputs("chr1\tAEGeAn\tgene\t1000\t2000\t.\t+\t.\tID=gene2\n", outstream);
+    gt_error_unset(error);
+    if(agn_bgzf_writer_finish(writer, error) == 0)
+    {
+      unsortedpass = agn_region_index_write(idx, gt_str_get(indexfile), writer,
+                                            error) == -1 &&
+                     gt_error_is_set(error);
+    }
+    agn_region_index_delete(idx);
+    agn_bgzf_writer_delete(writer);
+  }
+  agn_unit_test_result(test, "unsorted input", unsortedpass);
+
+  unlink(filename);
+  unlink(gt_str_get(indexfile));
+  gt_str_delete(indexfile);
+  gt_array_delete(genes[0]);
+  gt_array_delete(genes[1]);
+  gt_error_delete(error);
+  return !had_err && querypass && unsortedpass;
+}
+
+static void region_reader_append_line(GtStr *record, GtStr *line)
+{
+  gt_str_append_str(record, line);
+  gt_str_append_char(record, '\n');
+}
+
+static int region_reader_test_write(const char *filename, GtArray **genes,
+                                    GtError *error)
+{
+  AgnBgzfWriter *writer = agn_bgzf_writer_new(filename, 3, error);
+  if(writer == NULL)
+    return -1;
+  AgnRegionIndex *idx = agn_region_index_new();
+  agn_region_index_attach(idx, writer);
+
+  // Enough genes for many blocks and windows, with an occasional long gene
+  // spanning several windows
+  FILE *outstream = agn_bgzf_writer_stream(writer);
+  GtUword s, i;
+  for(s = 0; s < 2; s++)
+  {
+    for(i = 0; i < 10000; i++)
+    {
+      GtRange gene;
+      gene.start = i * 150 + 1;
+      gene.end = gene.start + (i % 100 == 0 ? 60000 : 100);
+      gt_array_add(genes[s], gene);
+      fprintf(outstream, "chr%lu\tAEGeAn\tgene\t%lu\t%lu\t.\t+\t.\t"
+              "ID=gene%lu\n", s + 1, gene.start, gene.end, i);
+      fprintf(outstream, "chr%lu\tAEGeAn\tmRNA\t%lu\t%lu\t.\t+\t.\t"
+              "ID=mRNA%lu;Parent=gene%lu\n###\n", s + 1, gene.start,
+              gene.end, i, i);
+    }
+  }
+
+  int had_err = agn_bgzf_writer_finish(writer, error);
+  if(!had_err)
+  {
+    GtStr *indexfile = gt_str_new_cstr(filename);
+    gt_str_append_cstr(indexfile, AGN_REGION_INDEX_SUFFIX);
+    had_err = agn_region_index_write(idx, gt_str_get(indexfile), writer,
+                                     error);
+    gt_str_delete(indexfile);
+  }
+  agn_region_index_delete(idx);
+  agn_bgzf_writer_delete(writer);
+  return had_err;
+}
@@ -0,0 +1,219 @@
+#include <string.h>
+#include "AgnSortedInStream.h"
+
+//------------------------------------------------------------------------------
+// Data structure definition
+//------------------------------------------------------------------------------
+
+struct AgnSortedInStream
+{
+  const GtNodeStream parent_instance;
+  GtStrArray *filenames;
+  GtUword fileindex;
+  GtNodeStream *in_stream;
+  GtHashmap *seqids;
+  const char *lastseqid;
+  GtUword laststart;
+};
+
+
+//------------------------------------------------------------------------------
+// Prototypes for private functions
+//------------------------------------------------------------------------------
+
+#define sorted_in_stream_cast(GS)\
+        gt_node_stream_cast(sorted_in_stream_class(), GS)
+
+/**
+ * Check that the given feature does not precede the previous feature from the
+ * same file.
+ *
+ * @param[in]  stream    the node stream
+ * @param[in]  fn        the feature
+ * @param[out] error     error object
+ * @returns              0 if the feature is in order, -1 otherwise (error
+ *                       object is set)
+ */
+static int sorted_in_stream_check_order(AgnSortedInStream *stream,
+                                        GtFeatureNode *fn, GtError *error);
+
+/**
+ * Function that implements the GtNodeStream interface for this class.
+ *
+ * @returns    a node stream class object
+ */
+static const GtNodeStreamClass* sorted_in_stream_class(void);
+
+/**
+ * Destructor for the class.
+ *
+ * @param[in] ns    the node stream to be destroyed
+ */
+static void sorted_in_stream_free(GtNodeStream *ns);
+
+/**
+ * Pulls nodes from the GFF3 input stream of the current file, moving on to the
+ * next file when one is exhausted, and checks that features are in order.
+ *
+ * @param[in]  ns       the node stream
+ * @param[out] gn       pointer to a genome node
+ * @param[out] error    error object
+ * @returns             0 in case of no error (*gn is set to next node or NULL
+ *                      if stream is exhausted), -1 in case of error (error
+ *                      object is set)
+ */
+static int sorted_in_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                 GtError *error);
+
+/**
+ * Open the next input file and reset the order check.
+ *
+ * @param[in] stream    the node stream
+ */
+static void sorted_in_stream_open(AgnSortedInStream *stream);
+
+
+//------------------------------------------------------------------------------
+// Method implementations
+//------------------------------------------------------------------------------
+
+GtNodeStream* agn_sorted_in_stream_new(int numfiles, const char **filenames)
+{
+  GtNodeStream *ns;
+  AgnSortedInStream *stream;
+  ns = gt_node_stream_create(sorted_in_stream_class(), true);
+  stream = sorted_in_stream_cast(ns);
+
+  int i;
+  stream->filenames = gt_str_array_new();
+  for(i = 0; i < numfiles; i++)
+    gt_str_array_add_cstr(stream->filenames, filenames[i]);
+  stream->fileindex = 0;
+  stream->in_stream = NULL;
+  stream->seqids = gt_hashmap_new(GT_HASH_STRING, gt_free_func, NULL);
+  stream->lastseqid = NULL;
+  stream->laststart = 0;
+
+  return ns;
+}
+
+static int sorted_in_stream_check_order(AgnSortedInStream *stream,
+                                        GtFeatureNode *fn, GtError *error)
+{
+  GtGenomeNode *gn = (GtGenomeNode *)fn;
+  const char *seqid = gt_str_get(gt_genome_node_get_seqid(gn));
+  GtUword start = gt_genome_node_get_start(gn);
+
+  if(stream->lastseqid != NULL && strcmp(seqid, stream->lastseqid) == 0)
+  {
+    if(start < stream->laststart)
+    {
+      gt_error_set(error, "file \"%s\": line %u: feature starting at %lu "
+                   "follows a feature starting at %lu on sequence '%s'; input "
+                   "is not sorted", gt_genome_node_get_filename(gn),
+                   gt_genome_node_get_line_number(gn), start,
+                   stream->laststart, seqid);
+      return -1;
+    }
+  }
+  else
+  {
+    if(gt_hashmap_get(stream->seqids, seqid) != NULL)
+    {
+      gt_error_set(error, "file \"%s\": line %u: features for sequence '%s' "
+                   "are not contiguous; input is not sorted",
+                   gt_genome_node_get_filename(gn),
+                   gt_genome_node_get_line_number(gn), seqid);
+      return -1;
+    }
+    char *seqidcopy = gt_cstr_dup(seqid);
+    gt_hashmap_add(stream->seqids, seqidcopy, seqidcopy);
+    stream->lastseqid = seqidcopy;
+  }
+
+  stream->laststart = start;
+  return 0;
+}
+
+static const GtNodeStreamClass *sorted_in_stream_class(void)
+{
+  static const GtNodeStreamClass *nsc = NULL;
+  if(!nsc)
+  {
+    nsc = gt_node_stream_class_new(sizeof (AgnSortedInStream),
+                                   sorted_in_stream_free,
+                                   sorted_in_stream_next);
+  }
+  return nsc;
+}
+
+static void sorted_in_stream_free(GtNodeStream *ns)
+{
+  AgnSortedInStream *stream = sorted_in_stream_cast(ns);
+  if(stream->in_stream != NULL)
+    gt_node_stream_delete(stream->in_stream);
+  gt_str_array_delete(stream->filenames);
+  gt_hashmap_delete(stream->seqids);
+}
+
+static int sorted_in_stream_next(GtNodeStream *ns, GtGenomeNode **gn,
+                                 GtError *error)
+{
+  AgnSortedInStream *stream;
+  GtFeatureNode *fn;
+  int had_err;
+  gt_error_check(error);
+  stream = sorted_in_stream_cast(ns);
+
+  while(1)
+  {
+    // With no files, a single stream reads from standard input
+    GtUword numfiles = gt_str_array_size(stream->filenames);
+    if(stream->in_stream == NULL)
+    {
+      if(stream->fileindex >= numfiles && (numfiles > 0 || stream->fileindex))
+      {
+        *gn = NULL;
+        return 0;
+      }
+      sorted_in_stream_open(stream);
+    }
+
+    had_err = gt_node_stream_next(stream->in_stream, gn, error);
+    if(had_err)
+      return had_err;
+    if(!*gn)
+    {
+      gt_node_stream_delete(stream->in_stream);
+      stream->in_stream = NULL;
+      stream->fileindex++;
+      continue;
+    }
+
+    fn = gt_feature_node_try_cast(*gn);
+    if(fn && sorted_in_stream_check_order(stream, fn, error))
+    {
+      gt_genome_node_delete(*gn);
+      *gn = NULL;
+      return -1;
+    }
+    return 0;
+  }
+
+  return 0;
+}
+
+static void sorted_in_stream_open(AgnSortedInStream *stream)
+{
+  const char *filename = NULL;
+  if(stream->fileindex < gt_str_array_size(stream->filenames))
+    filename = gt_str_array_get(stream->filenames, stream->fileindex);
+
+  stream->in_stream = gt_gff3_in_stream_new_sorted(filename);
+  gt_gff3_in_stream_check_id_attributes((GtGFF3InStream *)stream->in_stream);
+  gt_gff3_in_stream_enable_tidy_mode((GtGFF3InStream *)stream->in_stream);
+
+  gt_hashmap_reset(stream->seqids);
+  stream->lastseqid = NULL;
+  stream->laststart = 0;
+}
@@ -11,14 +11,18 @@
 //----------------------------------------------------------------------------//
 
 /**
- * This data structure is pretty minimal. At one point it contained more than a
- * single member, and it may yet again in the future. For now though, there is
- * enough logic built around these data that a class is still necessary, even if
- * much of the core logic belongs to the GtDlist class.
+ * Aside from the list of transcripts, the clique caches its structural segments
+ * and fingerprints so that they are computed only once, regardless of how many
+ * clique pairs the clique participates in. Adding a transcript invalidates the
+ * cache.
  */
 struct AgnTranscriptClique
 {
   GtDlist *transcripts;
+  GtArray *segments;
+  GtUword fingerprint;
+  GtUword cds_fingerprint;
+  bool overlapping;
 };
 
 typedef struct
@@ -47,6 +51,23 @@ typedef struct
  */
 static void clique_cds_length(GtFeatureNode *transcript, void *cdslength);
 
+/**
+ * Traversal function for collecting the structural segments (CDS, UTR, intron)
+ * of each transcript in the clique.
+ *
+ * @param[in]  transcript    transcript in the clique
+ * @param[out] segments      array of AgnCliqueSegment objects
+ */
+static void clique_collect_segments(GtFeatureNode *transcript, void *segments);
+
+/**
+ * Collect and sort the clique's structural segments, and compute the full and
+ * CDS-only fingerprints from them.
+ *
+ * @param[out] clique    the clique
+ */
+static void clique_compute_fingerprints(AgnTranscriptClique *clique);
+
 /**
  * Traversal function for copying the contents of one clique to another.
  *
@@ -75,6 +96,15 @@ static void clique_id_check(GtFeatureNode *transcript, void *data);
  */
 static void clique_ids_put(GtFeatureNode *transcript, void *map);
 
+/**
+ * Mix a value into a running hash.
+ *
+ * @param[in] hash     the running hash
+ * @param[in] value    the value to add
+ * @returns            the updated hash
+ */
+static GtUword clique_hash_combine(GtUword hash, GtUword value);
+
 /**
  * Traversal function for determining the number of exons belonging to this
  * transcript clique.
@@ -101,6 +131,27 @@ static void clique_num_utrs(GtFeatureNode *transcript, void *numutrs);
  */
 static void clique_print_ids(GtFeatureNode *transcript, void *data);
 
+/**
+ * Compare two segments by start coordinate, end coordinate, and type.
+ *
+ * @param[in] s1    a segment
+ * @param[in] s2    another segment
+ * @returns         -1, 0, or 1, as with strcmp
+ */
+static int clique_segment_compare(const void *s1, const void *s2);
+
+/**
+ * Compare the (sorted) segments of two cliques, optionally considering only
+ * CDS segments.
+ *
+ * @param[in] c1         a clique
+ * @param[in] c2         another clique
+ * @param[in] cdsonly    ignore UTR segments and introns
+ * @returns              true if the segments are identical
+ */
+static bool clique_segments_equal(AgnTranscriptClique *c1,
+                                  AgnTranscriptClique *c2, bool cdsonly);
+
 /**
  * Traversal function for copying contents of this clique to an array.
  *
@@ -126,6 +177,18 @@ void agn_transcript_clique_add(AgnTranscriptClique *clique,
                                GtFeatureNode *transcript)
 {
   gt_dlist_add(clique->transcripts, transcript);
+  if(clique->segments != NULL)
+  {
+    gt_array_delete(clique->segments);
+    clique->segments = NULL;
+  }
+}
+
+GtUword agn_transcript_clique_cds_fingerprint(AgnTranscriptClique *clique)
+{
+  if(clique->segments == NULL)
+    clique_compute_fingerprints(clique);
+  return clique->cds_fingerprint;
 }
 
 GtUword agn_transcript_clique_cds_length(AgnTranscriptClique *clique)
@@ -136,6 +199,18 @@ GtUword agn_transcript_clique_cds_length(AgnTranscriptClique *clique)
   return length;
 }
 
+bool agn_transcript_clique_cds_match(AgnTranscriptClique *c1,
+                                     AgnTranscriptClique *c2)
+{
+  if(agn_transcript_clique_cds_fingerprint(c1) !=
+     agn_transcript_clique_cds_fingerprint(c2))
+    return false;
+  if(c1->overlapping || c2->overlapping)
+    return false;
+
+  return clique_segments_equal(c1, c2, true);
+}
+
 AgnTranscriptClique* agn_transcript_clique_copy(AgnTranscriptClique *clique)
 {
   AgnTranscriptClique *new = agn_transcript_clique_new();
@@ -146,10 +221,19 @@ AgnTranscriptClique* agn_transcript_clique_copy(AgnTranscriptClique *clique)
 void agn_transcript_clique_delete(AgnTranscriptClique *clique)
 {
   gt_dlist_delete(clique->transcripts);
+  if(clique->segments != NULL)
+    gt_array_delete(clique->segments);
   gt_free(clique);
   clique = NULL;
 }
 
+GtUword agn_transcript_clique_fingerprint(AgnTranscriptClique *clique)
+{
+  if(clique->segments == NULL)
+    clique_compute_fingerprints(clique);
+  return clique->fingerprint;
+}
+
 bool agn_transcript_clique_has_id_in_hash(AgnTranscriptClique *clique,
                                           GtHashmap *map)
 {
@@ -171,6 +255,10 @@ AgnTranscriptClique* agn_transcript_clique_new()
 {
   AgnTranscriptClique *clique = gt_malloc(sizeof(AgnTranscriptClique));
   clique->transcripts = gt_dlist_new((GtCompare)gt_genome_node_cmp);
+  clique->segments = NULL;
+  clique->fingerprint = 0;
+  clique->cds_fingerprint = 0;
+  clique->overlapping = false;
   return clique;
 }
 
@@ -214,11 +302,30 @@ void agn_transcript_clique_put_ids_in_hash(AgnTranscriptClique *clique,
   agn_transcript_clique_traverse(clique, clique_ids_put, map);
 }
 
+GtArray *agn_transcript_clique_segments(AgnTranscriptClique *clique)
+{
+  if(clique->segments == NULL)
+    clique_compute_fingerprints(clique);
+  return clique->segments;
+}
+
 GtUword agn_transcript_clique_size(AgnTranscriptClique *clique)
 {
   return gt_dlist_size(clique->transcripts);
 }
 
+bool agn_transcript_clique_structure_match(AgnTranscriptClique *c1,
+                                           AgnTranscriptClique *c2)
+{
+  if(agn_transcript_clique_fingerprint(c1) !=
+     agn_transcript_clique_fingerprint(c2))
+    return false;
+  if(c1->overlapping || c2->overlapping)
+    return false;
+
+  return clique_segments_equal(c1, c2, false);
+}
+
 GtArray* agn_transcript_clique_to_array(AgnTranscriptClique *clique)
 {
   GtArray *new = gt_array_new( sizeof(GtFeatureNode *) );
@@ -319,6 +426,66 @@ static void clique_cds_length(GtFeatureNode *transcript, void *cdslength)
   *length += agn_gt_feature_node_cds_length(transcript);
 }
 
+static void clique_collect_segments(GtFeatureNode *transcript, void *segments)
+{
+  GtArray *segs = segments;
+  GtFeatureNode *fn;
+  GtFeatureNodeIterator *iter = gt_feature_node_iterator_new(transcript);
+  for(fn = gt_feature_node_iterator_next(iter);
+      fn != NULL;
+      fn = gt_feature_node_iterator_next(iter))
+  {
+    AgnCliqueSegment segment;
+    AgnFeatureClass class = agn_gt_feature_node_classify(fn);
+    if(class == AGN_FEATURE_CDS)
+      segment.type = 'C';
+    else if(class == AGN_FEATURE_FIVE_PRIME_UTR)
+      segment.type = 'F';
+    else if(class & AGN_FEATURE_ANY_UTR)
+      segment.type = 'T';
+    else if(class == AGN_FEATURE_INTRON)
+      segment.type = 'I';
+    else
+      continue;
+
+    segment.range = gt_genome_node_get_range((GtGenomeNode *)fn);
+    gt_array_add(segs, segment);
+  }
+  gt_feature_node_iterator_delete(iter);
+}
+
+static void clique_compute_fingerprints(AgnTranscriptClique *clique)
+{
+  clique->segments = gt_array_new( sizeof(AgnCliqueSegment) );
+  agn_transcript_clique_traverse(clique, clique_collect_segments,
+                                 clique->segments);
+  gt_array_sort(clique->segments, clique_segment_compare);
+
+  GtUword hash = 0, cdshash = 0, i;
+  clique->overlapping = false;
+  for(i = 0; i < gt_array_size(clique->segments); i++)
+  {
+    AgnCliqueSegment *segment = gt_array_get(clique->segments, i);
+    if(i > 0)
+    {
+      AgnCliqueSegment *prev = gt_array_get(clique->segments, i - 1);
+      if(segment->range.start <= prev->range.end)
+        clique->overlapping = true;
+    }
+
+    hash = clique_hash_combine(hash, segment->range.start);
+    hash = clique_hash_combine(hash, segment->range.end);
+    hash = clique_hash_combine(hash, segment->type);
+    if(segment->type == 'C')
+    {
+      cdshash = clique_hash_combine(cdshash, segment->range.start);
+      cdshash = clique_hash_combine(cdshash, segment->range.end);
+    }
+  }
+  clique->fingerprint = hash;
+  clique->cds_fingerprint = cdshash;
+}
+
 static void clique_copy(GtFeatureNode *transcript, void *clique)
 {
   AgnTranscriptClique *cq = clique;
@@ -341,6 +508,13 @@ static void clique_ids_put(GtFeatureNode *transcript, void *map)
   gt_hashmap_add(map, (char *)tid, (char *)tid);
 }
 
+static GtUword clique_hash_combine(GtUword hash, GtUword value)
+{
+  // Same mixing step as boost::hash_combine
+  return hash ^ (value + (GtUword)0x9e3779b97f4a7c15ULL + (hash << 6) +
+                 (hash >> 2));
+}
+
 static void clique_num_exons(GtFeatureNode *transcript, void *numexons)
 {
   GtUword *num = numexons;
@@ -380,6 +554,46 @@ static void clique_print_ids(GtFeatureNode *transcript, void *data)
     fputc(',', dat->outstream);
 }
 
+static int clique_segment_compare(const void *s1, const void *s2)
+{
+  const AgnCliqueSegment *seg1 = s1;
+  const AgnCliqueSegment *seg2 = s2;
+  int result = gt_range_compare(&seg1->range, &seg2->range);
+  if(result != 0)
+    return result;
+  if(seg1->type == seg2->type)
+    return 0;
+  return seg1->type < seg2->type ? -1 : 1;
+}
+
+static bool clique_segments_equal(AgnTranscriptClique *c1,
+                                  AgnTranscriptClique *c2, bool cdsonly)
+{
+  GtArray *segs1 = agn_transcript_clique_segments(c1);
+  GtArray *segs2 = agn_transcript_clique_segments(c2);
+  GtUword n1 = gt_array_size(segs1), n2 = gt_array_size(segs2);
+  GtUword i = 0, j = 0;
+  while(true)
+  {
+    if(cdsonly)
+    {
+      while(i < n1 && ((AgnCliqueSegment *)gt_array_get(segs1,i))->type != 'C')
+        i++;
+      while(j < n2 && ((AgnCliqueSegment *)gt_array_get(segs2,j))->type != 'C')
+        j++;
+    }
+    if(i == n1 || j == n2)
+      return i == n1 && j == n2;
+
+    AgnCliqueSegment *seg1 = gt_array_get(segs1, i);
+    AgnCliqueSegment *seg2 = gt_array_get(segs2, j);
+    if(clique_segment_compare(seg1, seg2) != 0)
+      return false;
+    i++;
+    j++;
+  }
+}
+
 static void clique_to_array(GtFeatureNode *transcript, void *array)
 {
   GtArray *ar = (GtArray *)array;
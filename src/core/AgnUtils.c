@@ -7,12 +7,36 @@
 #include "AgnGeneLocus.h"
 #include "AgnInferCDSVisitor.h"
 #include "AgnInferExonsVisitor.h"
+#include "AgnMappedInStream.h"
+#include "AgnSortedInStream.h"
 #include "AgnUtils.h"
 
+/**
+ * Bron-Kerbosch clique enumeration, stopping early once the given limits are
+ * exceeded (see agn_enumerate_feature_cliques_bounded).
+ *
+ * @returns    false if a limit was exceeded, true otherwise
+ */
+static bool utils_bron_kerbosch(GtArray *R, GtArray *P, GtArray *X,
+                                GtArray *cliques, bool skipsimplecliques,
+                                GtUword maxcliques, double deadline);
+
 void agn_bron_kerbosch( GtArray *R, GtArray *P, GtArray *X, GtArray *cliques,
                         bool skipsimplecliques )
+{
+  utils_bron_kerbosch(R, P, X, cliques, skipsimplecliques, 0, 0.0);
+}
+
+static bool utils_bron_kerbosch(GtArray *R, GtArray *P, GtArray *X,
+                                GtArray *cliques, bool skipsimplecliques,
+                                GtUword maxcliques, double deadline)
 {
   gt_assert(R != NULL && P != NULL && X != NULL && cliques != NULL);
+  if((maxcliques > 0 && gt_array_size(cliques) > maxcliques) ||
+     (deadline > 0.0 && agn_wallclock() > deadline))
+  {
+    return false;
+  }
 
   if(gt_array_size(P) == 0 && gt_array_size(X) == 0)
   {
@@ -43,12 +67,16 @@ void agn_bron_kerbosch( GtArray *R, GtArray *P, GtArray *X, GtArray *cliques,
 
     // Recursive call
     // agn_bron_kerbosch(R \union {v}, P \intersect N(v), X \intersect N(X))
-    agn_bron_kerbosch(newR, newP, newX, cliques, skipsimplecliques);
+    bool withinlimits = utils_bron_kerbosch(newR, newP, newX, cliques,
+                                            skipsimplecliques, maxcliques,
+                                            deadline);
 
     // Delete temporary arrays just created
     gt_array_delete(newR);
     gt_array_delete(newP);
     gt_array_delete(newX);
+    if(!withinlimits)
+      return false;
 
     // P := P \ {v}
     gt_array_rem(P, 0);
@@ -78,7 +106,6 @@ double agn_calc_edit_distance(GtFeatureNode *t1, GtFeatureNode *t2)
 
   AgnCliquePair *pair = agn_clique_pair_new(gt_str_get(seqid), clique1, clique2,
                                             &local_range);
-  agn_clique_pair_build_model_vectors(pair);
   agn_clique_pair_comparative_analysis(pair);
 
   double ed = agn_clique_pair_get_edit_distance(pair);
@@ -113,6 +140,13 @@ double agn_calc_splice_complexity(GtArray *transcripts)
 }
 
 GtArray* agn_enumerate_feature_cliques(GtArray *feature_set)
+{
+  return agn_enumerate_feature_cliques_bounded(feature_set, 0, 0.0);
+}
+
+GtArray* agn_enumerate_feature_cliques_bounded(GtArray *feature_set,
+                                               GtUword maxcliques,
+                                               double deadline)
 {
   GtArray *cliques = gt_array_new( sizeof(GtArray *) );
 
@@ -142,11 +176,33 @@ GtArray* agn_enumerate_feature_cliques(GtArray *feature_set)
     GtArray *X = gt_array_new( sizeof(GtGenomeNode *) );
 
     // Initial call: agn_bron_kerbosch(\emptyset, vertex_set, \emptyset )
-    agn_bron_kerbosch(R, P, X, cliques, true);
+    bool withinlimits = utils_bron_kerbosch(R, P, X, cliques, true,
+                                            maxcliques, deadline);
 
     gt_array_delete(R);
     gt_array_delete(P);
     gt_array_delete(X);
+    if(!withinlimits || (maxcliques > 0 && gt_array_size(cliques) > maxcliques))
+    {
+      while(gt_array_size(cliques) > 0)
+      {
+        AgnTranscriptClique *clique;
+        clique = *(AgnTranscriptClique **)gt_array_pop(cliques);
+        agn_transcript_clique_delete(clique);
+      }
+      gt_array_delete(cliques);
+      return NULL;
+    }
+  }
+
+  // Fingerprint each clique up front; each one will be compared against every
+  // clique from the other source
+  GtUword i;
+  for(i = 0; i < gt_array_size(cliques); i++)
+  {
+    AgnTranscriptClique *clique;
+    clique = *(AgnTranscriptClique **)gt_array_get(cliques, i);
+    agn_transcript_clique_fingerprint(clique);
   }
 
   return cliques;
@@ -182,12 +238,24 @@ FILE *agn_fopen(const char *filename, const char *mode, FILE *errstream)
   return fp;
 }
 
-GtFeatureIndex *agn_import_canonical(int numfiles, const char **filenames,
-                                     AgnLogger *logger)
+GtNodeStream *agn_gff3_in_stream_new(int numfiles, const char **filenames,
+                                     int flags)
 {
+  if(flags & AGN_GFF3_MAPPED)
+    return agn_mapped_in_stream_new(numfiles, filenames);
+  if(flags & AGN_GFF3_SORTED)
+    return agn_sorted_in_stream_new(numfiles, filenames);
+
   GtNodeStream *gff3 = gt_gff3_in_stream_new_unsorted(numfiles, filenames);
   gt_gff3_in_stream_check_id_attributes((GtGFF3InStream *)gff3);
   gt_gff3_in_stream_enable_tidy_mode((GtGFF3InStream *)gff3);
+  return gff3;
+}
+
+GtFeatureIndex *agn_import_canonical(int numfiles, const char **filenames,
+                                     int flags, AgnLogger *logger)
+{
+  GtNodeStream *gff3 = agn_gff3_in_stream_new(numfiles, filenames, flags);
 
   GtFeatureIndex *features = gt_feature_index_memory_new();
   GtNodeStream *cgstream = agn_canon_gene_stream_new(gff3, logger);
@@ -214,13 +282,11 @@ GtFeatureIndex *agn_import_canonical(int numfiles, const char **filenames,
 }
 
 GtFeatureIndex *agn_import_simple(int numfiles, const char **filenames,
-                                  char *type, AgnLogger *logger)
+                                  char *type, int flags, AgnLogger *logger)
 {
   GtFeatureIndex *features = gt_feature_index_memory_new();
 
-  GtNodeStream *gff3 = gt_gff3_in_stream_new_unsorted(numfiles, filenames);
-  gt_gff3_in_stream_check_id_attributes((GtGFF3InStream *)gff3);
-  gt_gff3_in_stream_enable_tidy_mode((GtGFF3InStream *)gff3);
+  GtNodeStream *gff3 = agn_gff3_in_stream_new(numfiles, filenames, flags);
 
   GtHashmap *typestokeep = gt_hashmap_new(GT_HASH_STRING, NULL, NULL);
   gt_hashmap_add(typestokeep, type, type);
@@ -505,3 +571,10 @@ void agn_transcript_structure_gbk(GtFeatureNode *transcript, FILE *outstream)
   if(gt_feature_node_get_strand(transcript) == GT_STRAND_REVERSE)
     fputs(")", outstream);
 }
+
+double agn_wallclock(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -1,39 +1,103 @@
 #include <getopt.h>
+#include <string.h>
 #include "genometools.h"
+#include "AgnBgzf.h"
 #include "AgnGeneLocus.h"
+#include "AgnIntervalIndex.h"
 #include "AgnLocusIndex.h"
+#include "AgnProcessPool.h"
+#include "AgnRegionIndex.h"
+
+// Number of records from a file being annotated that are queried together
+#define LOCUSPOCUS_ANNOTATE_BATCH 4096
 
 // Simple data structure for program options
 typedef struct
 {
+  const char *annotate;
   bool debug;
+  bool fast;
   FILE *genestream;
+  bool index;
   bool intloci;
   unsigned long delta;
+  GtArray *deltas;
   FILE *outstream;
+  const char *outfilename;
+  AgnBgzfWriter *bgzf;
+  GtUword procs;
+  bool sorted;
   bool skipends;
   FILE *transstream;
   bool verbose;
 } LocusPocusOptions;
 
+// Summary of the interval loci computed with a single delta
+typedef struct
+{
+  GtUword genic;
+  GtUword genicbp;
+  GtUword intergenic;
+  GtUword intergenicbp;
+} DeltaSummary;
+
+// Records from a file being annotated, buffered so that consecutive records on
+// the same sequence can be queried together
+typedef struct
+{
+  AgnLocusIndex *loci;
+  LocusPocusOptions *options;
+  GtHashmap *iloci;
+  GtStr *seqid;
+  GtArray *queries;
+  GtArray *lines;
+  GtArray *labels;
+  GtUword numrecords;
+} AnnotateBatch;
+
+// Interval loci of a sequence, indexed for annotation
+typedef struct
+{
+  GtArray *iloci;
+  AgnIntervalIndex *index;
+} AnnotateSequence;
+
+// Data shared by the worker processes that compute and print loci, one
+// sequence per task
+typedef struct
+{
+  AgnLocusIndex *loci;
+  GtStrArray *seqids;
+  LocusPocusOptions *options;
+} PrintTaskData;
+
+void annotate_gene_hit(GtUword query, AgnGeneLocus *locus, void *data);
+void annotate_ilocus_hit(GtUword query, void *value, void *data);
+void annotate_sequence_delete(AnnotateSequence *seq);
 void print_usage(FILE *outstream);
 
 void parse_options(int argc, char **argv, LocusPocusOptions *options)
 {
   int opt = 0;
   int optindex = 0;
-  const char *optstr = "dg:hil:n:o:st:v";
+  const char *optstr = "a:dfg:hil:L:n:o:p:rst:vx";
   const struct option locuspocus_options[] =
   {
+    { "annotate",  required_argument, NULL, 'a' },
     { "debug",     no_argument,       NULL, 'd' },
+    { "fast",      no_argument,       NULL, 'f' },
     { "genemap",   required_argument, NULL, 'g' },
     { "help",      no_argument,       NULL, 'h' },
     { "intloci",   no_argument,       NULL, 'i' },
     { "delta",     required_argument, NULL, 'l' },
+    { "deltas",    required_argument, NULL, 'L' },
     { "outfile",   required_argument, NULL, 'o' },
+    { "procs",     required_argument, NULL, 'p' },
+    { "sorted",    no_argument,       NULL, 'r' },
     { "skipends",  no_argument,       NULL, 's' },
     { "transmap",  required_argument, NULL, 't' },
     { "verbose",   no_argument,       NULL, 'v' },
+    { "index",     no_argument,       NULL, 'x' },
   };
   for( opt = getopt_long(argc, argv + 0, optstr, locuspocus_options, &optindex);
        opt != -1;
@@ -41,10 +105,16 @@ void parse_options(int argc, char **argv, LocusPocusOptions *options)
   {
     switch(opt)
     {
+      case 'a':
+        options->annotate = optarg;
+        break;
       case 'd':
         options->debug = 1;
         options->verbose = 1;
         break;
+      case 'f':
+        options->fast = 1;
+        break;
       case 'g':
         options->genestream = fopen(optarg, "w");
         if(options->genestream == NULL)
@@ -69,7 +139,45 @@ void parse_options(int argc, char **argv, LocusPocusOptions *options)
           exit(1);
         }
         break;
+      case 'L':
+      {
+        char *pos = optarg, *end;
+        options->intloci = 1;
+        if(options->deltas != NULL)
+          gt_array_delete(options->deltas);
+        options->deltas = gt_array_new( sizeof(GtUword) );
+        do
+        {
+          // strtoul accepts a sign and would wrap negative values, so each
+          // delta must start with a digit
+          GtUword delta = strtoul(pos, &end, 10);
+          if(*pos < '0' || *pos > '9' || end == pos ||
+             (*end != ',' && *end != '\0'))
+          {
+            fprintf(stderr, "[LocusPocus] error: could not convert deltas "
+                    "'%s' to a list of integers\n", optarg);
+            exit(1);
+          }
+          gt_array_add(options->deltas, delta);
+          pos = end + 1;
+        } while(*end == ',');
+        break;
+      }
       case 'o':
+        options->outfilename = optarg;
+        if(agn_bgzf_has_extension(optarg))
+        {
+          GtError *error = gt_error_new();
+          options->bgzf = agn_bgzf_writer_new(optarg, 0, error);
+          if(options->bgzf == NULL)
+          {
+            fprintf(stderr, "[LocusPocus] error: %s\n", gt_error_get(error));
+            exit(1);
+          }
+          gt_error_delete(error);
+          options->outstream = agn_bgzf_writer_stream(options->bgzf);
+          break;
+        }
         options->outstream = fopen(optarg, "w");
         if(options->outstream == NULL)
         {
@@ -78,6 +186,21 @@ void parse_options(int argc, char **argv, LocusPocusOptions *options)
           exit(1);
         }
         break;
+      case 'p':
+      {
+        char *end;
+        options->procs = strtoul(optarg, &end, 10);
+        if(end == optarg || *end != '\0' || options->procs == 0)
+        {
+          fprintf(stderr, "[LocusPocus] error: number of processes must be a "
+                  "positive integer, not '%s'\n", optarg);
+          exit(1);
+        }
+        break;
+      }
+      case 'r':
+        options->sorted = 1;
+        break;
       case 's':
         options->skipends = 1;
         break;
@@ -93,6 +216,9 @@ void parse_options(int argc, char **argv, LocusPocusOptions *options)
       case 'v':
         options->verbose = 1;
         break;
+      case 'x':
+        options->index = 1;
+        break;
     }
   }
 }
@@ -103,8 +229,18 @@ void print_usage(FILE *outstream)
   fprintf( outstream,
 "Usage: ./locuspocus [options] gff3file1 [gff3file2 gff3file3 ...]\n"
 "  Options:\n"
+"    -a|--annotate: FILE    instead of reporting loci, annotate each record of\n"
+"                           the given BED or VCF file (VCF if the name ends in\n"
+"                           .vcf or the file has a VCF header; '-' for\n"
+"                           standard input) with the loci it overlaps, or the\n"
+"                           iLoci with -i; records are read in one pass and\n"
+"                           written with an extra column listing the loci as\n"
+"                           seqid:start-end, or '.' if there are none\n"
 "    -d|--debug             print detailed debugging messages to terminal\n"
 "                           (standard error)\n"
+"    -f|--fast              read input with AEGeAn's own GFF3 reader, which is\n"
+"                           faster than the default GenomeTools parser but\n"
+"                           keeps only the ID, Parent, and Name attributes\n"
 "    -g|--genemap: FILE     print a mapping from each gene annotation to its\n"
 "                           corresponding locus to the given file\n"
 "    -h|--help              print this help message and exit\n"
@@ -113,21 +249,461 @@ void print_usage(FILE *outstream)
 "    -l|--delta: INT        when parsing interval loci, use the following\n"
 "                           delta to extend gene loci and include potential\n"
 "                           regulatory regions; default is 500\n"
+"    -L|--deltas: LIST      compute interval loci for each delta in a comma-\n"
+"                           separated list (such as 0,100,250,500), parsing\n"
+"                           the input only once, and print a table of iLocus\n"
+"                           counts and lengths for each delta instead of\n"
+"                           GFF3; implies -i\n"
 "    -o|--outfile: FILE     name of file to which results will be written;\n"
-"                           default is terminal (standard output)\n"
+"                           default is terminal (standard output); output is\n"
+"                           BGZF compressed if the name ends in .gz\n"
+"    -p|--procs: INT        compute and print the loci of different sequences\n"
+"                           in the given number of worker processes; output\n"
+"                           is identical to that of a single process; default\n"
+"                           is 1\n"
+"    -r|--sorted            input is sorted: all features for a sequence are\n"
+"                           contiguous and in order of start coordinate; with\n"
+"                           -i, iLoci are reported as the input is read, so\n"
+"                           memory use stays bounded by a few loci\n"
 "    -s|--skipends          when enumerating interval loci, exclude gene-less\n"
 "                           iloci at either end of the sequence\n"
 "    -t|--transmap: FILE    print a mapping from each transcript annotation\n"
 "                           to its corresponding locus to the given file\n"
 "    -v|--verbose           print detailed log messages to terminal (standard\n"
-"                           error)\n\n" );
+"                           error)\n"
+"    -x|--index             write a coordinate index alongside the output, for\n"
+"                           use with AgnRegionReader; requires BGZF output,\n"
+"                           and the index is written to the output file name\n"
+"                           plus '.agi'\n\n" );
+}
+
+// Print an iLocus (or gene locus) and, if requested, its gene and transcript
+// mappings
+void print_locus(AgnIntervalLocus *ilocus, const char *seqid, void *data)
+{
+  LocusPocusOptions *options = data;
+  agn_interval_locus_to_gff3(ilocus, seqid, options->outstream,
+                             "AEGeAn::LocusPocus");
+  if(options->genestream != NULL)
+    agn_interval_locus_print_gene_mapping(ilocus, seqid, options->genestream);
+  if(options->transstream != NULL)
+  {
+    agn_interval_locus_print_transcript_mapping(ilocus, seqid,
+                                                options->transstream);
+  }
+}
+
+// Compute the loci of a sequence: interval loci, or gene loci reported with
+// their own coordinates; the caller is responsible for deleting the array
+GtArray *sequence_loci(AgnLocusIndex *loci, const char *seqid,
+                       LocusPocusOptions *options)
+{
+  if(options->intloci)
+  {
+    return agn_locus_index_interval_loci(loci, seqid, options->delta,
+                                         options->skipends);
+  }
+
+  GtArray *geneloci = agn_locus_index_get_sorted(loci, seqid);
+  GtArray *seqloci = gt_array_new( sizeof(AgnIntervalLocus) );
+  GtUword i;
+  for(i = 0; i < gt_array_size(geneloci); i++)
+  {
+    AgnIntervalLocus ilocus;
+    ilocus.locus = *(AgnGeneLocus **)gt_array_get(geneloci, i);
+    ilocus.range = agn_gene_locus_range(ilocus.locus);
+    ilocus.genic = true;
+    gt_array_add(seqloci, ilocus);
+  }
+  return seqloci;
+}
+
+// Compute and print the loci of a single sequence
+GtUword print_sequence(AgnLocusIndex *loci, const char *seqid,
+                       LocusPocusOptions *options)
+{
+  GtArray *seqloci = sequence_loci(loci, seqid, options);
+  GtUword i, numloci = gt_array_size(seqloci);
+  if(numloci > 0 && options->verbose)
+  {
+    fprintf(stderr,"[LocusPocus] found %lu loci for sequence '%s'\n", numloci,
+            seqid);
+  }
+  for(i = 0; i < numloci; i++)
+    print_locus(gt_array_get(seqloci, i), seqid, options);
+  gt_array_delete(seqloci);
+  return numloci;
+}
+
+// Task run in a worker process: print the loci of one sequence to the
+// worker's own output streams
+int print_sequence_task(GtUword task, FILE **streams, void *result,
+                        void *data)
+{
+  PrintTaskData *taskdata = data;
+  LocusPocusOptions options = *taskdata->options;
+  options.outstream = streams[0];
+  if(options.genestream != NULL)
+    options.genestream = streams[1];
+  if(options.transstream != NULL)
+    options.transstream = streams[2];
+  const char *seqid = gt_str_array_get(taskdata->seqids, task);
+  *(GtUword *)result = print_sequence(taskdata->loci, seqid, &options);
+  return 0;
+}
+
+// Print the loci of all sequences using worker processes, then assemble their
+// output in sequence order
+int print_sequences_parallel(AgnLocusIndex *loci, GtStrArray *seqids,
+                             LocusPocusOptions *options)
+{
+  PrintTaskData data = { loci, seqids, options };
+  GtUword numseqs = gt_str_array_size(seqids);
+  GtUword numprocs = options->procs < numseqs ? options->procs : numseqs;
+  if(numprocs == 0)
+    return 0;
+
+  GtError *error = gt_error_new();
+  AgnProcessPool *pool = agn_process_pool_new(numprocs, numseqs, 3,
+                                              sizeof(GtUword));
+  int had_err = agn_process_pool_run(pool, NULL, print_sequence_task, &data,
+                                     error);
+  GtUword i;
+  for(i = 0; !had_err && i < numseqs; i++)
+  {
+    had_err = agn_process_pool_write_output(pool, i, 0, options->outstream,
+                                            error);
+    if(!had_err && options->genestream != NULL)
+    {
+      had_err = agn_process_pool_write_output(pool, i, 1, options->genestream,
+                                              error);
+    }
+    if(!had_err && options->transstream != NULL)
+    {
+      had_err = agn_process_pool_write_output(pool, i, 2,
+                                              options->transstream, error);
+    }
+  }
+  if(had_err)
+    fprintf(stderr, "[LocusPocus] error: %s\n", gt_error_get(error));
+  agn_process_pool_delete(pool);
+  gt_error_delete(error);
+  return had_err ? 1 : 0;
+}
+
+// Compute interval loci for every delta, sorting the loci of each sequence
+// only once, and print a table summarizing the iLoci for each delta
+void print_delta_table(AgnLocusIndex *loci, GtStrArray *seqids,
+                       LocusPocusOptions *options)
+{
+  GtUword numdeltas = gt_array_size(options->deltas);
+  const GtUword *deltas = gt_array_get_space(options->deltas);
+  GtArray **iloci = gt_malloc( numdeltas * sizeof(GtArray *) );
+  DeltaSummary *summaries = gt_calloc(numdeltas, sizeof(DeltaSummary));
+  GtUword i, j, k;
+  for(i = 0; i < gt_str_array_size(seqids); i++)
+  {
+    const char *seqid = gt_str_array_get(seqids, i);
+    if(!agn_locus_index_interval_loci_deltas(loci, seqid, deltas, numdeltas,
+                                             options->skipends, iloci))
+    {
+      continue;
+    }
+    for(j = 0; j < numdeltas; j++)
+    {
+      for(k = 0; k < gt_array_size(iloci[j]); k++)
+      {
+        AgnIntervalLocus *ilocus = gt_array_get(iloci[j], k);
+        GtUword length = gt_range_length(&ilocus->range);
+        if(ilocus->genic)
+        {
+          summaries[j].genic++;
+          summaries[j].genicbp += length;
+        }
+        else
+        {
+          summaries[j].intergenic++;
+          summaries[j].intergenicbp += length;
+        }
+      }
+      gt_array_delete(iloci[j]);
+    }
+  }
+
+  fputs("delta\tiloci\tgenic_iloci\tintergenic_iloci\tgenic_bp\t"
+        "intergenic_bp\tmean_genic_length\tmean_intergenic_length\n",
+        options->outstream);
+  for(j = 0; j < numdeltas; j++)
+  {
+    DeltaSummary *sum = summaries + j;
+    double genicmean = sum->genic ? (double)sum->genicbp / sum->genic : 0.0;
+    double intergenicmean = sum->intergenic ?
+                            (double)sum->intergenicbp / sum->intergenic : 0.0;
+    fprintf(options->outstream, "%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%.1lf\t"
+            "%.1lf\n", deltas[j], sum->genic + sum->intergenic, sum->genic,
+            sum->intergenic, sum->genicbp, sum->intergenicbp, genicmean,
+            intergenicmean);
+  }
+  gt_free(iloci);
+  gt_free(summaries);
+}
+
+// Append a locus to the annotation of a buffered record
+void annotate_add_label(AnnotateBatch *batch, GtUword query, GtRange *range)
+{
+  GtStr *label = *(GtStr **)gt_array_get(batch->labels, query);
+  char buffer[64];
+  if(gt_str_length(label) > 0)
+    gt_str_append_char(label, ',');
+  gt_str_append_str(label, batch->seqid);
+  sprintf(buffer, ":%lu-%lu", range->start, range->end);
+  gt_str_append_cstr(label, buffer);
+}
+
+// Buffer a record to be annotated
+void annotate_add_record(AnnotateBatch *batch, const char *line,
+                         GtUword length, GtRange *range)
+{
+  if(batch->numrecords == gt_array_size(batch->lines))
+  {
+    GtStr *newline = gt_str_new();
+    GtStr *newlabel = gt_str_new();
+    gt_array_add(batch->lines, newline);
+    gt_array_add(batch->labels, newlabel);
+  }
+  GtStr *record = *(GtStr **)gt_array_get(batch->lines, batch->numrecords);
+  GtStr *label = *(GtStr **)gt_array_get(batch->labels, batch->numrecords);
+  gt_str_reset(record);
+  gt_str_append_cstr_nt(record, line, length);
+  gt_str_reset(label);
+  gt_array_add(batch->queries, *range);
+  batch->numrecords++;
+}
+
+// Query the loci for all buffered records at once, then print the records
+// with their annotations
+void annotate_flush(AnnotateBatch *batch)
+{
+  if(batch->numrecords == 0)
+    return;
+
+  const char *seqid = gt_str_get(batch->seqid);
+  const GtRange *queries = gt_array_get_space(batch->queries);
+  LocusPocusOptions *options = batch->options;
+  if(options->intloci)
+  {
+    // iLoci are computed for each sequence the first time it is needed
+    AnnotateSequence *seq = gt_hashmap_get(batch->iloci, seqid);
+    GtArray *iloci = NULL;
+    if(seq == NULL)
+    {
+      iloci = agn_locus_index_interval_loci(batch->loci, seqid, options->delta,
+                                            options->skipends);
+    }
+    if(iloci != NULL)
+    {
+      seq = gt_malloc( sizeof(AnnotateSequence) );
+      seq->iloci = iloci;
+      seq->index = agn_interval_index_new();
+      GtUword i;
+      for(i = 0; i < gt_array_size(iloci); i++)
+      {
+        AgnIntervalLocus *ilocus = gt_array_get(iloci, i);
+        agn_interval_index_add(seq->index, &ilocus->range, ilocus);
+      }
+      agn_interval_index_seal(seq->index);
+      gt_hashmap_add(batch->iloci, gt_cstr_dup(seqid), seq);
+    }
+    if(seq != NULL)
+    {
+      agn_interval_index_find_sorted(seq->index, queries, batch->numrecords,
+                                     annotate_ilocus_hit, batch);
+    }
+  }
+  else
+  {
+    agn_locus_index_find_batch(batch->loci, seqid, queries, batch->numrecords,
+                               annotate_gene_hit, batch);
+  }
+
+  GtUword i;
+  for(i = 0; i < batch->numrecords; i++)
+  {
+    GtStr *record = *(GtStr **)gt_array_get(batch->lines, i);
+    GtStr *label = *(GtStr **)gt_array_get(batch->labels, i);
+    fprintf(options->outstream, "%s\t%s\n", gt_str_get(record),
+            gt_str_length(label) > 0 ? gt_str_get(label) : ".");
+  }
+  gt_array_reset(batch->queries);
+  batch->numrecords = 0;
+}
+
+// Add a gene locus overlapping a record to the record's annotation
+void annotate_gene_hit(GtUword query, AgnGeneLocus *locus, void *data)
+{
+  GtRange range = agn_gene_locus_range(locus);
+  annotate_add_label(data, query, &range);
+}
+
+// Add an iLocus overlapping a record to the record's annotation
+void annotate_ilocus_hit(GtUword query, void *value, void *data)
+{
+  AgnIntervalLocus *ilocus = value;
+  annotate_add_label(data, query, &ilocus->range);
+}
+
+// Parse the sequence ID and range of a BED or VCF record; BED coordinates are
+// 0-based and half-open, and a VCF record spans its reference allele
+bool annotate_parse_record(const char *line, bool vcf, GtStr *seqid,
+                           GtRange *range)
+{
+  const char *tab = strchr(line, '\t');
+  if(tab == NULL || tab == line)
+    return false;
+  char *end;
+  GtUword start = strtoul(tab + 1, &end, 10);
+  if(end == tab + 1 || (*end != '\t' && *end != '\0'))
+    return false;
+  gt_str_reset(seqid);
+  gt_str_append_cstr_nt(seqid, line, tab - line);
+
+  if(vcf)
+  {
+    if(start == 0)
+      return false;
+    range->start = start;
+    range->end = start;
+    const char *ref = *end == '\t' ? strchr(end + 1, '\t') : NULL;
+    if(ref != NULL)
+    {
+      GtUword reflength = strcspn(ref + 1, "\t");
+      if(reflength > 0)
+        range->end = start + reflength - 1;
+    }
+    return true;
+  }
+
+  if(*end != '\t')
+    return false;
+  const char *endfield = end + 1;
+  GtUword stop = strtoul(endfield, &end, 10);
+  if(end == endfield || (*end != '\t' && *end != '\0') || stop < start)
+    return false;
+  range->start = start + 1;
+  range->end = stop > start ? stop : start + 1;
+  return true;
+}
+
+// Annotate each record of a BED or VCF file with the loci it overlaps, reading
+// the file in a single pass; records are buffered and queried in batches, so
+// memory use does not depend on the size of the file
+int annotate_file(AgnLocusIndex *loci, LocusPocusOptions *options)
+{
+  const char *filename = options->annotate;
+  FILE *instream = stdin;
+  if(strcmp(filename, "-") != 0)
+  {
+    instream = fopen(filename, "r");
+    if(instream == NULL)
+    {
+      fprintf(stderr, "[LocusPocus] error: could not open file '%s' to "
+              "annotate\n", filename);
+      return 1;
+    }
+  }
+  GtUword namelength = strlen(filename);
+  bool vcf = namelength >= 4 && strcmp(filename + namelength - 4, ".vcf") == 0;
+
+  AnnotateBatch batch;
+  batch.loci = loci;
+  batch.options = options;
+  batch.iloci = gt_hashmap_new(GT_HASH_STRING, gt_free_func,
+                               (GtFree)annotate_sequence_delete);
+  batch.seqid = gt_str_new();
+  batch.queries = gt_array_new( sizeof(GtRange) );
+  batch.lines = gt_array_new( sizeof(GtStr *) );
+  batch.labels = gt_array_new( sizeof(GtStr *) );
+  batch.numrecords = 0;
+
+  GtStr *seqid = gt_str_new();
+  char *line = NULL;
+  size_t capacity = 0;
+  ssize_t length;
+  unsigned int linenum = 0;
+  int code = 0;
+  while((length = getline(&line, &capacity, instream)) > 0)
+  {
+    linenum++;
+    if(line[length - 1] == '\n')
+      line[--length] = '\0';
+    if(length > 0 && line[length - 1] == '\r')
+      line[--length] = '\0';
+    if(strncmp(line, "##fileformat=VCF", 16) == 0)
+      vcf = true;
+
+    // Headers and comments are passed through in place
+    if(length == 0 || line[0] == '#' || strncmp(line, "track", 5) == 0 ||
+       strncmp(line, "browser", 7) == 0)
+    {
+      annotate_flush(&batch);
+      fprintf(options->outstream, "%s\n", line);
+      continue;
+    }
+
+    GtRange range;
+    if(!annotate_parse_record(line, vcf, seqid, &range))
+    {
+      fprintf(stderr, "[LocusPocus] error: file '%s', line %u: could not "
+              "parse %s record\n", filename, linenum, vcf ? "VCF" : "BED");
+      code = 1;
+      break;
+    }
+    if(gt_str_cmp(seqid, batch.seqid) != 0 ||
+       batch.numrecords == LOCUSPOCUS_ANNOTATE_BATCH)
+    {
+      annotate_flush(&batch);
+      gt_str_reset(batch.seqid);
+      gt_str_append_str(batch.seqid, seqid);
+    }
+    annotate_add_record(&batch, line, length, &range);
+  }
+  if(code == 0)
+    annotate_flush(&batch);
+
+  GtUword i;
+  for(i = 0; i < gt_array_size(batch.lines); i++)
+  {
+    gt_str_delete(*(GtStr **)gt_array_get(batch.lines, i));
+    gt_str_delete(*(GtStr **)gt_array_get(batch.labels, i));
+  }
+  gt_array_delete(batch.lines);
+  gt_array_delete(batch.labels);
+  gt_array_delete(batch.queries);
+  gt_str_delete(batch.seqid);
+  gt_hashmap_delete(batch.iloci);
+  gt_str_delete(seqid);
+  free(line);
+  if(instream != stdin)
+    fclose(instream);
+  return code;
+}
+
+// Destructor for the iLoci of a sequence being annotated
+void annotate_sequence_delete(AnnotateSequence *seq)
+{
+  agn_interval_index_delete(seq->index);
+  gt_array_delete(seq->iloci);
+  gt_free(seq);
 }
 
 // Main program
 int main(int argc, char **argv)
 {
-  // Parse options from command line
-  LocusPocusOptions options = { 0, NULL, 0, 500, stdout, 0, NULL, 0 };
+  // Parse options from command line (compressed output is set up with
+  // GenomeTools objects, so the library is initialized first)
+  gt_lib_init();
+  LocusPocusOptions options = { NULL, 0, 0, NULL, 0, 0, 500, NULL, stdout,
+                               NULL, NULL, 1, 0, 0, NULL, 0 };
   parse_options(argc, argv, &options);
   int numfiles = argc - optind;
   if(numfiles < 1)
@@ -137,76 +713,148 @@ int main(int argc, char **argv)
     print_usage(stderr);
     return 1;
   }
-
-  // Load data into memory
-  gt_lib_init();
-  AgnLogger *logger = agn_logger_new();
-  AgnLocusIndex *loci = agn_locus_index_new(true);
-  unsigned long numloci = agn_locus_index_parse_disk(loci, numfiles,
-                              (const char **)argv + optind, logger);
-  if(options.verbose)
-    fprintf(stderr, "[LocusPocus] found %lu total loci\n", numloci);
-  bool haderror = agn_logger_print_all(logger, stderr, "[LocusPocus] loading "
-                                       "features from %d input files",
-                                       numfiles);
-  if(haderror)
+  if(options.deltas != NULL &&
+     (options.genestream != NULL || options.transstream != NULL ||
+      options.index))
+  {
+    fprintf(stderr, "[LocusPocus] error: --deltas reports a summary table, and "
+            "cannot be combined with -g, -t, or -x\n");
+    return 1;
+  }
+  if(options.annotate != NULL &&
+     (options.genestream != NULL || options.transstream != NULL ||
+      options.index || options.deltas != NULL))
+  {
+    fprintf(stderr, "[LocusPocus] error: --annotate cannot be combined with "
+            "-g, -t, -x, or --deltas\n");
+    return 1;
+  }
+  if(options.procs > 1 && (options.annotate != NULL || options.deltas != NULL))
+  {
+    fprintf(stderr, "[LocusPocus] error: --procs cannot be combined with "
+            "--annotate or --deltas\n");
     return 1;
-  agn_logger_delete(logger);
+  }
 
-  // Iterate over each gene to find sets of mutually overlapping genes and print
-  // them
-  fputs("##gff-version\t3\n", options.outstream);
-  GtStrArray *seqids = agn_locus_index_seqids(loci);
-  if(options.verbose)
+  // Loci are written in sorted order, so they can be indexed as they are
+  // compressed
+  AgnRegionIndex *regionindex = NULL;
+  if(options.index)
   {
-    fprintf(stderr, "[LocusPocus] found %lu sequences\n",
-            gt_str_array_size(seqids));
+    if(options.bgzf == NULL)
+    {
+      fprintf(stderr, "[LocusPocus] error: indexing requires BGZF output; "
+              "provide an output file name ending in .gz\n");
+      return 1;
+    }
+    regionindex = agn_region_index_new();
+    agn_region_index_attach(regionindex, options.bgzf);
   }
-  unsigned long i;
-  for(i = 0; i < gt_str_array_size(seqids); i++)
+
+  // Sorted input allows iLoci to be reported as the input is read, rather than
+  // after all of it has been loaded into memory
+  int code = 0;
+  AgnLocusIndex *loci = NULL;
+  const char **filenames = (const char **)argv + optind;
+  if(options.intloci && options.sorted && options.deltas == NULL &&
+     options.annotate == NULL && options.procs == 1)
   {
-    const char *seqid = gt_str_array_get(seqids, i);
-    GtArray *seqloci;
-    if(options.intloci)
+    fputs("##gff-version\t3\n", options.outstream);
+    int flags = options.fast ? AGN_GFF3_MAPPED : AGN_GFF3_SORTED;
+    GtNodeStream *gff3in = agn_gff3_in_stream_new(numfiles, filenames, flags);
+    GtError *error = gt_error_new();
+    if(agn_locus_index_stream_interval_loci(gff3in, options.delta,
+                                            options.skipends, print_locus,
+                                            &options, error))
     {
-       seqloci = agn_locus_index_interval_loci(loci, seqid, options.delta,
-                                               options.skipends);
+      fprintf(stderr, "[LocusPocus] error: %s\n", gt_error_get(error));
+      code = 1;
     }
-    else
+    gt_error_delete(error);
+    gt_node_stream_delete(gff3in);
+  }
+  else
+  {
+    // Load data into memory
+    AgnLogger *logger = agn_logger_new();
+    loci = agn_locus_index_new(true);
+    int flags = options.sorted ? AGN_GFF3_SORTED : AGN_GFF3_DEFAULT;
+    if(options.fast)
+      flags = AGN_GFF3_MAPPED;
+    unsigned long numloci = agn_locus_index_parse_disk(loci, numfiles,
+                                                       filenames, flags,
+                                                       logger);
+    if(options.verbose)
+      fprintf(stderr, "[LocusPocus] found %lu total loci\n", numloci);
+    bool haderror = agn_logger_print_all(logger, stderr, "[LocusPocus] loading "
+                                         "features from %d input files",
+                                         numfiles);
+    if(haderror)
+      return 1;
+    agn_logger_delete(logger);
+
+    // Iterate over each gene to find sets of mutually overlapping genes and
+    // print them
+    GtStrArray *seqids = agn_locus_index_seqids(loci);
+    if(options.verbose)
     {
-      seqloci = agn_locus_index_get(loci, seqid);
+      fprintf(stderr, "[LocusPocus] found %lu sequences\n",
+              gt_str_array_size(seqids));
     }
-    if(gt_array_size(seqloci) == 0)
+    if(options.annotate != NULL)
     {
-      gt_array_delete(seqloci);
-      continue;
+      agn_locus_index_seal(loci);
+      code = annotate_file(loci, &options);
+    }
+    else if(options.deltas != NULL)
+      print_delta_table(loci, seqids, &options);
+    else
+    {
+      fputs("##gff-version\t3\n", options.outstream);
+      if(options.procs > 1)
+        code = print_sequences_parallel(loci, seqids, &options);
+      else
+      {
+        unsigned long i;
+        for(i = 0; i < gt_str_array_size(seqids); i++)
+          print_sequence(loci, gt_str_array_get(seqids, i), &options);
+      }
     }
+  }
 
-    gt_array_sort(seqloci, (GtCompare)agn_gene_locus_array_compare);
-    gt_array_reverse(seqloci);
-    if(options.verbose)
+  if(options.bgzf != NULL)
+  {
+    GtError *error = gt_error_new();
+    if(agn_bgzf_writer_finish(options.bgzf, error))
     {
-      fprintf(stderr,"[LocusPocus] found %lu loci for sequence '%s'\n",
-              gt_array_size(seqloci), seqid);
+      fprintf(stderr, "[LocusPocus] error: %s\n", gt_error_get(error));
+      code = 1;
     }
-    while(gt_array_size(seqloci) > 0)
+    else if(regionindex != NULL)
     {
-      AgnGeneLocus **locus = gt_array_pop(seqloci);
-      agn_gene_locus_to_gff3(*locus, options.outstream, "AEGeAn::LocusPocus");
-      if(options.genestream != NULL)
-        agn_gene_locus_print_gene_mapping(*locus, options.genestream);
-      if(options.transstream != NULL)
-        agn_gene_locus_print_transcript_mapping(*locus, options.transstream);
-      if(options.intloci)
-        agn_gene_locus_delete(*locus);
+      GtStr *indexfile = gt_str_new_cstr(options.outfilename);
+      gt_str_append_cstr(indexfile, AGN_REGION_INDEX_SUFFIX);
+      if(agn_region_index_write(regionindex, gt_str_get(indexfile),
+                                options.bgzf, error))
+      {
+        fprintf(stderr, "[LocusPocus] error: %s\n", gt_error_get(error));
+        code = 1;
+      }
+      gt_str_delete(indexfile);
     }
-    gt_array_delete(seqloci);
+    gt_error_delete(error);
+    agn_bgzf_writer_delete(options.bgzf);
   }
-
-  fclose(options.outstream);
+  else
+    fclose(options.outstream);
+  if(regionindex != NULL)
+    agn_region_index_delete(regionindex);
   if(options.genestream != NULL)  fclose(options.genestream);
   if(options.transstream != NULL) fclose(options.transstream);
-  agn_locus_index_delete(loci);
+  if(loci != NULL)
+    agn_locus_index_delete(loci);
+  if(options.deltas != NULL)
+    gt_array_delete(options.deltas);
   gt_lib_clean();
-  return 0;
+  return code;
 }
@@ -15,3 +15,31 @@ do
   printf "        | %-36s | %s\n" $test $result
   rm $tempfile
 done
+for flags in "--sorted" "--threads=2" "--sorted --threads=2"
+do
+  tempfile="${testname}-flags-temp.gff3"
+  bin/canon-gff3 $flags -o $tempfile -s TAIR10 data/gff3/AT1G05320-withprot.gff3
+  bin/parseval -s $tempfile data/gff3/AT1G05320.gff3 2> /dev/null | grep 'perfect matches\.' | grep '100.0%' > /dev/null
+  status=$?
+  result="FAIL"
+  if [ $status == 0 ]; then
+    result="PASS"
+  fi
+  printf "        | %-36s | %s\n" "withprot $flags" $result
+  rm $tempfile
+done
+
+# One reference against several predictions, summarized side by side
+preds=""
+for test in codons sansexons sansutrs withprot
+do
+  bin/canon-gff3 -o ${testname}-${test}-multi.gff3 -s TAIR10 data/gff3/AT1G05320-${test}.gff3
+  preds="$preds ${testname}-${test}-multi.gff3"
+done
+matches=$(bin/parseval -s data/gff3/AT1G05320.gff3 $preds 2> /dev/null | grep '^    perfect matches ' | grep -o '100\.0%' | wc -l)
+result="FAIL"
+if [ $matches == 4 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "multiple predictions" $result
+rm $preds
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+
+echo "    Compressed Input and Output"
+
+refr="BgzfIOTest.refr.gff3"
+test="BgzfIOTest.test.gff3"
+bin/locuspocus --intloci --delta=200 --outfile=${refr} data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+
+# Plain gzip input, read by both the GenomeTools parser and the mapped reader
+gzip -c data/gff3/ilocus.in.gff3 > BgzfIOTest.in.gff3.gz
+for mode in "" "--fast"
+do
+  bin/locuspocus --intloci --delta=200 --outfile=${test} ${mode} BgzfIOTest.in.gff3.gz > /dev/null 2>&1
+  diff ${test} ${refr} > /dev/null 2>&1
+  status=$?
+  result="FAIL"
+  if [ $status == 0 ]; then
+    result="PASS"
+  fi
+  printf "        | %-36s | %s\n" "gzip input ${mode}" $result
+  rm -f ${test}
+done
+
+# BGZF output, which should also be readable as BGZF input
+bin/locuspocus --intloci --delta=200 --outfile=${test}.gz data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+gunzip -c ${test}.gz | diff - ${refr} > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "BGZF output" $result
+
+bin/canon-gff3 --outfile=BgzfIOTest.canon.gff3 data/gff3/grape-refr.gff3 > /dev/null 2>&1
+bin/canon-gff3 --threads=2 --outfile=BgzfIOTest.canon.gff3.gz data/gff3/grape-refr.gff3 > /dev/null 2>&1
+gunzip -c BgzfIOTest.canon.gff3.gz | diff - BgzfIOTest.canon.gff3 > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "BGZF output, canon-gff3" $result
+
+# Indexed output, which requires BGZF compression
+bin/locuspocus --intloci --delta=200 --index --outfile=${test}.gz data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ] && head -n 1 ${test}.gz.agi | grep -q '^##agn-region-index'; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "indexed output" $result
+
+bin/locuspocus --intloci --index --outfile=${test} data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status != 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "index requires BGZF output" $result
+
+rm -f ${refr} ${test} ${test}.gz ${test}.gz.agi BgzfIOTest.in.gff3.gz BgzfIOTest.canon.gff3 BgzfIOTest.canon.gff3.gz
@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+
+echo "    Locus Annotation"
+
+# Each iLocus, given as a BED record, should be annotated with (at least)
+# itself; neighboring iLoci may overlap it slightly
+bed="LocusAnnotationTest.bed"
+out="LocusAnnotationTest.out"
+grep -v '^#' data/gff3/ilocus.out.noskipends.gff3 | awk -F'\t' '{ printf("%s\t%d\t%d\n", $1, $4 - 1, $5) }' > ${bed}
+bin/locuspocus --intloci --delta=200 --annotate=${bed} --outfile=${out} data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+awk -F'\t' '
+  { label = $1 ":" ($2 + 1) "-" $3; n = split($4, hits, ","); found = 0
+    for(i = 1; i <= n; i++) { if(hits[i] == label) found = 1 }
+    if(!found) missing++ }
+  END { exit(missing > 0 || NR == 0) }' ${out} > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ] && [ $(wc -l < ${out}) == $(wc -l < ${bed}) ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "iLoci, BED records" $result
+rm -f ${bed} ${out}
+
+# VCF records span their reference allele; records on sequences without loci
+# are annotated with '.'
+vcf="LocusAnnotationTest.vcf"
+printf "##fileformat=VCFv4.1\n#CHROM\tPOS\tID\tREF\tALT\n" > ${vcf}
+printf "seq01\t400\t.\tA\tC\nseq01\t850\t.\tA\tC\nseq99\t10\t.\tA\tC\n" >> ${vcf}
+bin/locuspocus --annotate=${vcf} --outfile=${out} data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+hits=$(grep -v '^#' ${out} | cut -f 6 | tr '\n' ' ')
+result="FAIL"
+if [ "$hits" == "seq01:400-600 . . " ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "gene loci, VCF records" $result
+rm -f ${vcf} ${out}
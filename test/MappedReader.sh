@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+
+echo "    Mapped GFF3 Reader"
+
+# Loci parsed with the mapped reader should be identical to those parsed with
+# the GenomeTools GFF3 parser.
+refr="MappedReaderTest.refr.gff3"
+test="MappedReaderTest.test.gff3"
+for data in ilocus.in grape-refr grape-pred
+do
+  bin/locuspocus --intloci --delta=200 --outfile=${refr} data/gff3/${data}.gff3 > /dev/null 2>&1
+  bin/locuspocus --intloci --delta=200 --outfile=${test} --fast data/gff3/${data}.gff3 > /dev/null 2>&1
+  diff ${test} ${refr} > /dev/null 2>&1
+  status=$?
+  result="FAIL"
+  if [ $status == 0 ]; then
+    result="PASS"
+  fi
+  printf "        | %-36s | %s\n" "iLoci, ${data}" $result
+  rm -f ${refr} ${test}
+done
+
+refr="MappedReaderTest.refr.txt"
+test="MappedReaderTest.test.txt"
+bin/parseval --outfile=${refr} data/gff3/grape-refr.gff3 data/gff3/grape-pred.gff3 > /dev/null 2>&1
+bin/parseval --outfile=${test} --fast data/gff3/grape-refr.gff3 data/gff3/grape-pred.gff3 > /dev/null 2>&1
+# The summary header records the start time and command, which will differ
+grep -v '^Started:\|^Executing command:' ${refr} > ${refr}.body
+grep -v '^Started:\|^Executing command:' ${test} > ${test}.body
+diff ${test}.body ${refr}.body > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "ParsEval, grape" $result
+rm -f ${refr} ${test} ${refr}.body ${test}.body
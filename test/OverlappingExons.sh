@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+
+echo "    Overlapping Exons"
+
+# A gene with overlapping exons is skipped with a warning, and the remaining
+# genes are still analyzed
+input="data/gff3/overlapping-exons.gff3"
+temp="OverlappingExonsTest.txt"
+bin/locuspocus --outfile=${temp} ${input} > /dev/null 2>&1
+status=$?
+numloci=$(grep -c $'\tlocus\t' ${temp})
+result="FAIL"
+if [ $status == 0 ] && [ ${numloci} -eq 2 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "LocusPocus" $result
+rm -f ${temp}
+
+bin/parseval --summary --outfile=${temp} ${input} ${input} > /dev/null 2>&1
+status=$?
+numloci=$(grep '^  Gene loci' ${temp} | sed 's/.*\.//')
+result="FAIL"
+if [ $status == 0 ] && [ "${numloci}" == "2" ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "ParsEval" $result
+rm -f ${temp}
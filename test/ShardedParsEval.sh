@@ -0,0 +1,73 @@
+#!/usr/bin/env bash
+
+echo "    Sharded ParsEval"
+
+# Merging the partial results of all shards should give the same summary as a
+# single run over all sequences.
+refr="data/gff3/ilocus.in.gff3"
+pred="data/gff3/ilocus.out.skipends.gff3"
+full="ShardedParsEvalTest.full.txt"
+merged="ShardedParsEvalTest.merged.txt"
+bin/parseval --summary --outfile=${full} ${refr} ${pred} > /dev/null 2>&1
+for shard in 1 2 3
+do
+  bin/parseval --shard=${shard}/3 --outfile=ShardedParsEvalTest.${shard}.part ${refr} ${pred} > /dev/null 2>&1
+done
+bin/parseval-merge --outfile=${merged} ShardedParsEvalTest.1.part ShardedParsEvalTest.2.part ShardedParsEvalTest.3.part > /dev/null 2>&1
+# The summary header records the start time and command, which will differ
+grep -v '^Started:\|^Executing command:' ${full} > ${full}.body
+grep -v '^Started:\|^Executing command:' ${merged} > ${merged}.body
+diff ${merged}.body ${full}.body > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "3 shards, merged" $result
+
+# A missing shard is an error
+bin/parseval-merge ShardedParsEvalTest.1.part ShardedParsEvalTest.3.part > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status != 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "missing shard" $result
+
+# Shards analyzed with different limits or filters cannot be merged
+bin/parseval --shard=2/3 --maxcliques=64 --overwrite --outfile=ShardedParsEvalTest.2.part ${refr} ${pred} > /dev/null 2>&1
+bin/parseval-merge ShardedParsEvalTest.1.part ShardedParsEvalTest.2.part ShardedParsEvalTest.3.part > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status != 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "shards with different settings" $result
+rm -f ${full} ${merged} ${full}.body ${merged}.body ShardedParsEvalTest.*.part
+
+# Analyzing sequences in several processes should not change the summary
+parallel="ShardedParsEvalTest.parallel.txt"
+bin/parseval --summary --procs=3 --outfile=${parallel} ${refr} ${pred} > /dev/null 2>&1
+bin/parseval --summary --outfile=${full} ${refr} ${pred} > /dev/null 2>&1
+grep -v '^Started:\|^Executing command:' ${full} > ${full}.body
+grep -v '^Started:\|^Executing command:' ${parallel} > ${parallel}.body
+diff ${parallel}.body ${full}.body > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "multiple processes" $result
+rm -f ${full} ${parallel} ${full}.body ${parallel}.body
+
+# The profile has one line for each locus, however many processes write it
+profile="ShardedParsEvalTest.profile.tsv"
+bin/parseval --summary --procs=3 --profile=${profile} --outfile=${full} ${refr} ${pred} > /dev/null 2>&1
+numloci=$(grep '^  Gene loci' ${full} | sed 's/.*\.//')
+numlines=$(tail -n +2 ${profile} | wc -l)
+result="FAIL"
+if [ -n "${numloci}" ] && [ ${numlines} -eq ${numloci} ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "per-locus profile" $result
+rm -f ${full} ${profile}
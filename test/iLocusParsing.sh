@@ -23,3 +23,36 @@ fi
 printf "        | %-36s | %s\n" "end skip" $result
 rm ${temp}
 
+bin/locuspocus --intloci --delta=200 --outfile=${temp} --sorted data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+diff ${temp} data/gff3/ilocus.out.noskipends.gff3 > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "sorted input (streaming)" $result
+rm ${temp}
+
+# The row for each delta summarizes the iLoci computed with that delta alone
+expected=$(grep -v '^#' data/gff3/ilocus.out.noskipends.gff3 | awk -F'\t' '
+  { len = $5 - $4 + 1; if($9 == "gene=0") { i++; ibp += len } else { g++; gbp += len } }
+  END { printf("200\t%d\t%d\t%d\t%d\t%d\n", g + i, g, i, gbp, ibp) }')
+bin/locuspocus --deltas=0,200,500 --outfile=${temp} data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+observed=$(awk -F'\t' '$1 == 200' ${temp} | cut -f 1-6)
+result="FAIL"
+if [ -n "$observed" ] && [ "$observed" == "$expected" ] && [ $(wc -l < ${temp}) == 4 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "multiple deltas" $result
+rm ${temp}
+
+
+bin/locuspocus --intloci --delta=200 --procs=3 --outfile=${temp} data/gff3/ilocus.in.gff3 > /dev/null 2>&1
+diff ${temp} data/gff3/ilocus.out.noskipends.gff3 > /dev/null 2>&1
+status=$?
+result="FAIL"
+if [ $status == 0 ]; then
+  result="PASS"
+fi
+printf "        | %-36s | %s\n" "multiple processes" $result
+rm ${temp}
@@ -0,0 +1,530 @@
+#include <getopt.h>
+#include <string.h>
+#include "AgnCliquePair.h"
+#include "AgnGeneLocus.h"
+#include "AgnLocusIndex.h"
+#include "AgnLogger.h"
+#include "AgnTranscriptClique.h"
+#include "AgnUtils.h"
+
+#define fn_cast(X) ((GtFeatureNode *)X)
+
+//----------------------------------------------------------------------------//
+// Data structure definitions
+//----------------------------------------------------------------------------//
+
+/**
+ * Settings shared by all benchmarks: the number of untimed warmup operations,
+ * the number of timed samples, the minimum duration of each sample, and a
+ * substring that benchmark names must contain to be run.
+ */
+typedef struct
+{
+  GtUword warmup;
+  GtUword samples;
+  double mintime;
+  const char *filter;
+} MicrobenchOptions;
+
+/**
+ * One operation of a benchmark; ``data`` holds the inputs, built before timing
+ * begins.
+ */
+typedef void (*MicrobenchFunc)(void *data);
+
+/**
+ * Inputs for the clique pair benchmarks. Each operation builds a new pair,
+ * since model vectors and statistics are computed only once per pair.
+ */
+typedef struct
+{
+  AgnTranscriptClique *refr;
+  AgnTranscriptClique *pred;
+  GtRange range;
+} PairData;
+
+/**
+ * Inputs for the locus construction benchmark.
+ */
+typedef struct
+{
+  GtFeatureIndex *refr;
+  GtFeatureIndex *pred;
+  AgnCompareFilters filters;
+} IndexData;
+
+/**
+ * Inputs for the gene locus filter benchmark.
+ */
+typedef struct
+{
+  AgnGeneLocus *locus;
+  AgnCompareFilters filters;
+} FilterData;
+
+//----------------------------------------------------------------------------//
+// Prototypes for private functions
+//----------------------------------------------------------------------------//
+
+/**
+ * Create a gene with ``numtrans`` isoforms of up to ``numexons`` exons each,
+ * beginning at ``start``. Isoforms after the first each skip one internal exon.
+ * If ``shift`` is non-zero, internal exon boundaries are moved by that many
+ * bases, so that the gene can serve as an imperfect prediction.
+ */
+static GtFeatureNode *microbench_gene(GtStr *seqid, const char *id,
+                                      GtUword start, GtUword numtrans,
+                                      GtUword numexons, GtUword shift);
+
+/**
+ * Run a benchmark and print the median time per operation and the number of
+ * memory allocations per operation.
+ */
+static void microbench_run(MicrobenchOptions *options, const char *name,
+                           const char *params, MicrobenchFunc func, void *data);
+
+/**
+ * Collect the transcripts of a gene.
+ */
+static GtArray *microbench_transcripts(GtFeatureNode *gene);
+
+static void op_build_model_vectors(PairData *data);
+static void op_comparative_analysis(PairData *data);
+static void op_enumerate_cliques(GtArray *transcripts);
+static void op_gene_locus_filter(FilterData *data);
+static void op_parse_pairwise(IndexData *data);
+static void op_splice_complexity(GtArray *transcripts);
+
+static void print_usage(FILE *outstream);
+
+//----------------------------------------------------------------------------//
+// Allocation counting
+//----------------------------------------------------------------------------//
+
+// With glibc, the allocation functions are wrapped so that every allocation
+// made by AEGeAn or GenomeTools is counted; elsewhere, allocations are not
+// reported.
+#ifdef __GLIBC__
+#define MICROBENCH_COUNT_ALLOCS
+static GtUword allocations = 0;
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+  allocations++;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+  allocations++;
+  return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+  allocations++;
+  return __libc_realloc(ptr, size);
+}
+#endif
+
+//----------------------------------------------------------------------------//
+// Main program
+//----------------------------------------------------------------------------//
+
+int main(int argc, char **argv)
+{
+  MicrobenchOptions options = { 100, 5, 0.1, NULL };
+  int opt = 0;
+  int optindex = 0;
+  const char *optstr = "hm:s:w:";
+  const struct option microbench_options[] =
+  {
+    { "help",    no_argument,       NULL, 'h' },
+    { "mintime", required_argument, NULL, 'm' },
+    { "samples", required_argument, NULL, 's' },
+    { "warmup",  required_argument, NULL, 'w' },
+    { NULL,      no_argument,       NULL,  0  },
+  };
+  for( opt = getopt_long(argc, argv, optstr, microbench_options, &optindex);
+       opt != -1;
+       opt = getopt_long(argc, argv, optstr, microbench_options, &optindex) )
+  {
+    switch(opt)
+    {
+      case 'h':
+        print_usage(stdout);
+        return 0;
+      case 'm':
+        if(sscanf(optarg, "%lf", &options.mintime) != 1)
+        {
+          fprintf(stderr, "[Microbench] error: invalid time '%s'\n", optarg);
+          return 1;
+        }
+        break;
+      case 's':
+        if(sscanf(optarg, "%lu", &options.samples) != 1 || options.samples==0)
+        {
+          fprintf(stderr, "[Microbench] error: invalid number of samples "
+                  "'%s'\n", optarg);
+          return 1;
+        }
+        break;
+      case 'w':
+        if(sscanf(optarg, "%lu", &options.warmup) != 1)
+        {
+          fprintf(stderr, "[Microbench] error: invalid number of warmup "
+                  "operations '%s'\n", optarg);
+          return 1;
+        }
+        break;
+      default:
+        print_usage(stderr);
+        return 1;
+    }
+  }
+  if(optind < argc)
+    options.filter = argv[optind];
+
+  gt_lib_init();
+  puts("AEGeAn Microbenchmarks");
+  printf("        | %-24s | %-16s | %12s | %10s\n", "benchmark", "parameters",
+         "ns/op", "allocs/op");
+
+  GtStr *seqid = gt_str_new_cstr("chr1");
+  char params[64];
+  GtUword n, i;
+
+  // Clique enumeration: n transcripts in a row, each overlapping the next two,
+  // so that the number of maximal cliques grows quickly with n
+  GtUword sizes[] = { 8, 16, 24 };
+  for(n = 0; n < sizeof(sizes) / sizeof(GtUword); n++)
+  {
+    GtArray *transcripts = gt_array_new( sizeof(GtFeatureNode *) );
+    for(i = 0; i < sizes[n]; i++)
+    {
+      GtGenomeNode *mrna = gt_feature_node_new(seqid, "mRNA", 1 + i * 400,
+                                               1000 + i * 400,
+                                               GT_STRAND_FORWARD);
+      gt_array_add(transcripts, mrna);
+    }
+    sprintf(params, "transcripts=%lu", sizes[n]);
+    microbench_run(&options, "enumerate_cliques", params,
+                   (MicrobenchFunc)op_enumerate_cliques, transcripts);
+    for(i = 0; i < sizes[n]; i++)
+      gt_genome_node_delete(*(GtGenomeNode **)gt_array_get(transcripts, i));
+    gt_array_delete(transcripts);
+  }
+
+  // Clique pair analysis: a reference transcript compared to a prediction
+  // with shifted exon boundaries (full analysis: model vectors, nucleotide
+  // counts, and structure stats together) or to an identical prediction
+  // (exact-match shortcut, which skips all three); the structure stats are
+  // not timed on their own
+  GtUword exons[] = { 4, 16, 64 };
+  for(n = 0; n < sizeof(exons) / sizeof(GtUword); n++)
+  {
+    GtFeatureNode *refrgene = microbench_gene(seqid, "refr", 1, 1, exons[n], 0);
+    GtFeatureNode *predgene = microbench_gene(seqid, "pred", 1, 1, exons[n],
+                                              10);
+    GtFeatureNode *samegene = microbench_gene(seqid, "same", 1, 1, exons[n], 0);
+    GtArray *rt = microbench_transcripts(refrgene);
+    GtArray *pt = microbench_transcripts(predgene);
+    GtArray *st = microbench_transcripts(samegene);
+    PairData data, samedata;
+    data.refr = agn_transcript_clique_new();
+    data.pred = agn_transcript_clique_new();
+    samedata.pred = agn_transcript_clique_new();
+    agn_transcript_clique_add(data.refr, *(GtFeatureNode **)gt_array_get(rt,0));
+    agn_transcript_clique_add(data.pred, *(GtFeatureNode **)gt_array_get(pt,0));
+    agn_transcript_clique_add(samedata.pred,
+                              *(GtFeatureNode **)gt_array_get(st, 0));
+    samedata.refr = data.refr;
+    data.range = gt_genome_node_get_range((GtGenomeNode *)refrgene);
+    GtRange predrange = gt_genome_node_get_range((GtGenomeNode *)predgene);
+    data.range = gt_range_join(&data.range, &predrange);
+    samedata.range = data.range;
+
+    sprintf(params, "exons=%lu", exons[n]);
+    microbench_run(&options, "build_model_vectors", params,
+                   (MicrobenchFunc)op_build_model_vectors, &data);
+    microbench_run(&options, "pair_analysis", params,
+                   (MicrobenchFunc)op_comparative_analysis, &data);
+    microbench_run(&options, "pair_analysis_shortcut", params,
+                   (MicrobenchFunc)op_comparative_analysis, &samedata);
+
+    agn_transcript_clique_delete(data.refr);
+    agn_transcript_clique_delete(data.pred);
+    agn_transcript_clique_delete(samedata.pred);
+    gt_array_delete(rt);
+    gt_array_delete(pt);
+    gt_array_delete(st);
+    gt_genome_node_delete((GtGenomeNode *)refrgene);
+    gt_genome_node_delete((GtGenomeNode *)predgene);
+    gt_genome_node_delete((GtGenomeNode *)samegene);
+  }
+
+  // Splice complexity and locus filtering: a single gene with n isoforms
+  GtUword isoforms[] = { 2, 8, 32 };
+  for(n = 0; n < sizeof(isoforms) / sizeof(GtUword); n++)
+  {
+    GtFeatureNode *gene = microbench_gene(seqid, "gene", 1, isoforms[n], 40, 0);
+    GtArray *transcripts = microbench_transcripts(gene);
+    sprintf(params, "isoforms=%lu", isoforms[n]);
+    microbench_run(&options, "splice_complexity", params,
+                   (MicrobenchFunc)op_splice_complexity, transcripts);
+
+    FilterData data;
+    data.locus = agn_gene_locus_new("chr1");
+    agn_gene_locus_add_refr_gene(data.locus, gene);
+    agn_compare_filters_init(&data.filters);
+    data.filters.MaxReferenceGeneModels = 1;
+    data.filters.MinReferenceExons = 2;
+    data.filters.MaxTranscriptsPerReferenceGeneModel = 64;
+    data.filters.MinReferenceCDSLength = 300;
+    agn_compare_filters_compile(&data.filters);
+    microbench_run(&options, "gene_locus_filter", params,
+                   (MicrobenchFunc)op_gene_locus_filter, &data);
+
+    agn_gene_locus_delete(data.locus);
+    gt_array_delete(transcripts);
+    gt_genome_node_delete((GtGenomeNode *)gene);
+  }
+
+  // Locus construction: n reference genes, and the same genes with shifted
+  // boundaries as the prediction; the feature indices take ownership of the
+  // nodes added to them
+  GtUword genes[] = { 100, 1000 };
+  for(n = 0; n < sizeof(genes) / sizeof(GtUword); n++)
+  {
+    IndexData data;
+    GtError *error = gt_error_new();
+    data.refr = gt_feature_index_memory_new();
+    data.pred = gt_feature_index_memory_new();
+    GtUword seqlength = genes[n] * 20000;
+    GtGenomeNode *region = gt_region_node_new(seqid, 1, seqlength);
+    gt_feature_index_add_region_node(data.refr, (GtRegionNode *)region, error);
+    region = gt_region_node_new(seqid, 1, seqlength);
+    gt_feature_index_add_region_node(data.pred, (GtRegionNode *)region, error);
+    for(i = 0; i < genes[n]; i++)
+    {
+      char id[32];
+      sprintf(id, "refr%lu", i);
+      GtFeatureNode *gene = microbench_gene(seqid, id, 1 + i*20000, 2, 6, 0);
+      gt_feature_index_add_feature_node(data.refr, gene, error);
+      sprintf(id, "pred%lu", i);
+      gene = microbench_gene(seqid, id, 1 + i*20000, 2, 6, 10);
+      gt_feature_index_add_feature_node(data.pred, gene, error);
+    }
+    agn_compare_filters_init(&data.filters);
+    agn_compare_filters_compile(&data.filters);
+
+    sprintf(params, "genes=%lu", genes[n]);
+    microbench_run(&options, "parse_pairwise", params,
+                   (MicrobenchFunc)op_parse_pairwise, &data);
+
+    gt_feature_index_delete(data.refr);
+    gt_feature_index_delete(data.pred);
+    gt_error_delete(error);
+  }
+
+  gt_str_delete(seqid);
+  gt_lib_clean();
+  return 0;
+}
+
+//----------------------------------------------------------------------------//
+// Function implementations
+//----------------------------------------------------------------------------//
+
+static GtFeatureNode *microbench_gene(GtStr *seqid, const char *id,
+                                      GtUword start, GtUword numtrans,
+                                      GtUword numexons, GtUword shift)
+{
+  GtUword exonlength = 200, intronlength = 300;
+  GtUword end = start + numexons * (exonlength + intronlength) - intronlength
+                - 1;
+  GtGenomeNode *gene = gt_feature_node_new(seqid, "gene", start, end,
+                                           GT_STRAND_FORWARD);
+  gt_feature_node_add_attribute(fn_cast(gene), "ID", id);
+
+  GtUword i, j;
+  for(i = 0; i < numtrans; i++)
+  {
+    char mrnaid[64];
+    sprintf(mrnaid, "%s.%lu", id, i + 1);
+    GtGenomeNode *mrna = gt_feature_node_new(seqid, "mRNA", start, end,
+                                             GT_STRAND_FORWARD);
+    gt_feature_node_add_attribute(fn_cast(mrna), "ID", mrnaid);
+    gt_feature_node_add_child(fn_cast(gene), fn_cast(mrna));
+
+    GtUword skip = numexons > 2 && i > 0 ? 1 + (i - 1) % (numexons - 2) : 0;
+    GtFeatureNode *firstcds = NULL;
+    for(j = 0; j < numexons; j++)
+    {
+      if(skip > 0 && j == skip)
+        continue;
+
+      GtUword exonstart = start + j * (exonlength + intronlength);
+      GtUword exonend = exonstart + exonlength - 1;
+      if(j > 0)
+        exonstart += shift;
+      if(j < numexons - 1)
+        exonend -= shift;
+      GtGenomeNode *exon = gt_feature_node_new(seqid, "exon", exonstart,
+                                               exonend, GT_STRAND_FORWARD);
+      gt_feature_node_add_child(fn_cast(mrna), fn_cast(exon));
+
+      GtUword cdsstart = j == 0 ? exonstart + 30 : exonstart;
+      GtUword cdsend = j == numexons - 1 ? exonend - 30 : exonend;
+      GtGenomeNode *cds = gt_feature_node_new(seqid, "CDS", cdsstart, cdsend,
+                                              GT_STRAND_FORWARD);
+      if(firstcds == NULL)
+      {
+        firstcds = fn_cast(cds);
+        gt_feature_node_make_multi_representative(firstcds);
+      }
+      else
+        gt_feature_node_set_multi_representative(fn_cast(cds), firstcds);
+      gt_feature_node_add_child(fn_cast(mrna), fn_cast(cds));
+    }
+  }
+
+  return fn_cast(gene);
+}
+
+static void microbench_run(MicrobenchOptions *options, const char *name,
+                           const char *params, MicrobenchFunc func, void *data)
+{
+  if(options->filter != NULL && strstr(name, options->filter) == NULL)
+    return;
+
+  GtUword i, j;
+  for(i = 0; i < options->warmup; i++)
+    func(data);
+
+  // Double the number of operations per sample until a sample takes at least
+  // the minimum time, so that timer resolution does not dominate
+  GtUword ops = 1;
+  while(1)
+  {
+    double start = agn_wallclock();
+    for(i = 0; i < ops; i++)
+      func(data);
+    if(agn_wallclock() - start >= options->mintime || ops >= (1UL << 30))
+      break;
+    ops *= 2;
+  }
+
+  double *nsperop = gt_malloc( sizeof(double) * options->samples );
+#ifdef MICROBENCH_COUNT_ALLOCS
+  GtUword allocstart = allocations;
+#endif
+  for(j = 0; j < options->samples; j++)
+  {
+    double start = agn_wallclock();
+    for(i = 0; i < ops; i++)
+      func(data);
+    nsperop[j] = (agn_wallclock() - start) * 1e9 / ops;
+  }
+
+  // Insertion sort; there are only a handful of samples
+  for(j = 1; j < options->samples; j++)
+  {
+    double value = nsperop[j];
+    for(i = j; i > 0 && nsperop[i-1] > value; i--)
+      nsperop[i] = nsperop[i-1];
+    nsperop[i] = value;
+  }
+
+  printf("        | %-24s | %-16s | %12.1lf | ", name, params,
+         nsperop[options->samples / 2]);
+#ifdef MICROBENCH_COUNT_ALLOCS
+  printf("%10.1lf\n", (double)(allocations - allocstart) /
+                       (ops * options->samples));
+#else
+  printf("%10s\n", "NA");
+#endif
+  gt_free(nsperop);
+}
+
+static GtArray *microbench_transcripts(GtFeatureNode *gene)
+{
+  GtArray *transcripts = gt_array_new( sizeof(GtFeatureNode *) );
+  GtFeatureNodeIterator *iter = gt_feature_node_iterator_new_direct(gene);
+  GtFeatureNode *mrna;
+  for(mrna = gt_feature_node_iterator_next(iter);
+      mrna != NULL;
+      mrna = gt_feature_node_iterator_next(iter))
+  {
+    gt_array_add(transcripts, mrna);
+  }
+  gt_feature_node_iterator_delete(iter);
+  return transcripts;
+}
+
+static void op_build_model_vectors(PairData *data)
+{
+  AgnCliquePair *pair = agn_clique_pair_new("chr1", data->refr, data->pred,
+                                            &data->range);
+  agn_clique_pair_build_model_vectors(pair);
+  agn_clique_pair_delete(pair);
+}
+
+static void op_comparative_analysis(PairData *data)
+{
+  AgnCliquePair *pair = agn_clique_pair_new("chr1", data->refr, data->pred,
+                                            &data->range);
+  agn_clique_pair_comparative_analysis(pair);
+  agn_clique_pair_delete(pair);
+}
+
+static void op_enumerate_cliques(GtArray *transcripts)
+{
+  GtArray *cliques = agn_enumerate_feature_cliques(transcripts);
+  while(gt_array_size(cliques) > 0)
+  {
+    AgnTranscriptClique *clique;
+    clique = *(AgnTranscriptClique **)gt_array_pop(cliques);
+    agn_transcript_clique_delete(clique);
+  }
+  gt_array_delete(cliques);
+}
+
+static void op_gene_locus_filter(FilterData *data)
+{
+  agn_gene_locus_filter(data->locus, &data->filters);
+}
+
+static void op_parse_pairwise(IndexData *data)
+{
+  AgnLocusIndex *idx = agn_locus_index_new(false);
+  AgnLogger *logger = agn_logger_new();
+  agn_locus_index_parse_pairwise_memory(idx, data->refr, data->pred,
+                                        &data->filters, logger);
+  agn_logger_delete(logger);
+  agn_locus_index_delete(idx);
+}
+
+static void op_splice_complexity(GtArray *transcripts)
+{
+  agn_calc_splice_complexity(transcripts);
+}
+
+static void print_usage(FILE *outstream)
+{
+  fputs("Usage: microbench [options] [name]\n"
+"  Run microbenchmarks of AEGeAn's comparison routines on synthetic data, and\n"
+"  report the median time and the number of memory allocations per\n"
+"  operation; if a name is given, run only the benchmarks whose names\n"
+"  contain it\n"
+"  Options:\n"
+"    -h|--help              print this help message and exit\n"
+"    -m|--mintime: REAL     minimum duration of each timed sample, in\n"
+"                           seconds; default is 0.1\n"
+"    -s|--samples: INT      number of timed samples; default is 5\n"
+"    -w|--warmup: INT       number of untimed operations before sampling;\n"
+"                           default is 100\n", outstream);
+}
@@ -1,8 +1,14 @@
 #include <string.h>
+#include "AgnBgzf.h"
 #include "AgnGeneLocus.h"
 #include "AgnInferCDSVisitor.h"
 #include "AgnInferExonsVisitor.h"
+#include "AgnIntervalIndex.h"
 #include "AgnLocusIndex.h"
+#include "AgnLogger.h"
+#include "AgnParallelStream.h"
+#include "AgnProcessPool.h"
+#include "AgnRegionReader.h"
 #include "AgnUnitTest.h"
 #include "AgnUtils.h"
 #include "AgnTranscriptClique.h"
@@ -19,12 +25,24 @@ int main(int argc, char **argv)
                                         agn_clique_pair_unit_test));
   gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnGeneLocus",
                                         agn_gene_locus_unit_test));
+  gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnIntervalIndex",
+                                        agn_interval_index_unit_test));
   gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnLocusIndex",
                                         agn_locus_index_unit_test));
   gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnInferCDSVisitor",
                                         agn_infer_cds_visitor_unit_test));
   gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnInferExonsVisitor",
                                         agn_infer_exons_visitor_unit_test));
+  gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnLogger",
+                                        agn_logger_unit_test));
+  gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnParallelStream",
+                                        agn_parallel_stream_unit_test));
+  gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnProcessPool",
+                                        agn_process_pool_unit_test));
+  gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnBgzf",
+                                        agn_bgzf_unit_test));
+  gt_queue_add(tests, agn_unit_test_new("AEGeAn::AgnRegionReader",
+                                        agn_region_reader_unit_test));
 
   while(gt_queue_size(tests) > 0)
   {